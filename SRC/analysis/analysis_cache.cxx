@@ -0,0 +1,345 @@
+/*
+	A content-addressed, on-disk cache of final analysis results.
+
+	Architecture sweeps tend to re-evaluate the same (graph, options) point many times -- for instance a reference
+architecture is re-analyzed for every comparison against it. Each analysis run is therefore identified by a hash of
+the rr structs file contents together with every option that can affect the result. Results of finished runs (final
+metrics and node demands) are written to a cache directory under that key, and a later run with the same key reuses
+them instead of redoing path enumeration and probability analysis.
+
+	Entries are plain text files. Least-recently used entries (by file modification time, which is refreshed on every
+hit) are evicted when the total size of the cache directory exceeds the user-specified limit.
+*/
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <stdint.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <utime.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include "analysis_cache.h"
+#include "exception.h"
+#include "io.h"
+
+using namespace std;
+
+
+/**** Defines ****/
+/* bump this whenever the format of cache entries (or the meaning of cached values) changes */
+#define CACHE_FORMAT_VERSION 2
+
+/* extension of cache entry files */
+#define CACHE_ENTRY_EXTENSION ".wcache"
+
+/* FNV-1a hash parameters */
+#define FNV_OFFSET_BASIS 14695981039346656037ULL
+#define FNV_PRIME 1099511628211ULL
+
+
+/**** Classes ****/
+/* an entry of the cache directory. used for LRU eviction */
+class Cache_Entry_File{
+public:
+	string path;
+	off_t size;
+	time_t last_used;
+
+	bool operator < (const Cache_Entry_File &obj) const{
+		return this->last_used < obj.last_used;
+	}
+};
+
+
+/**** Function Declarations ****/
+/* folds specified bytes into an FNV-1a hash */
+static void hash_bytes(const char *bytes, size_t num_bytes, uint64_t *hash);
+/* folds the contents of the specified file into an FNV-1a hash */
+static void hash_file(string path, uint64_t *hash);
+/* returns the path of the cache entry with the specified key */
+static string get_cache_entry_path(User_Options *user_opts, string key);
+/* creates the cache directory if it doesn't exist yet */
+static void make_cache_dir(User_Options *user_opts);
+/* removes least-recently used entries from the cache directory until it fits into the size limit.
+   the entry at 'keep_path' is never evicted */
+static void evict_cache_entries(User_Options *user_opts, string keep_path);
+
+
+/**** Function Definitions ****/
+Cached_Result::Cached_Result(){
+	this->demand_multiplier = UNDEFINED;
+}
+
+/* adds a metric to the result */
+void Cached_Result::add_metric(string label, double value){
+	this->metrics.push_back( make_pair(label, value) );
+}
+
+
+/* returns a key identifying the current analysis. the key is a hash of the rr structs file contents together with all
+   analysis-relevant user options and the specified signature of compile-time analysis settings.
+   returns an empty string if result caching is disabled */
+string get_result_cache_key(User_Options *user_opts, string analysis_signature){
+	string key = "";
+
+	if (user_opts->cache_dir.empty()){
+		return key;
+	}
+
+	/* options that affect analysis results. graphics, caching options, etc don't matter here. the number of threads
+	   does matter since it affects the order in which floating-point demands are accumulated */
+	stringstream options;
+	options << setprecision(9);
+	options << "version " << CACHE_FORMAT_VERSION << endl;
+	options << "analysis " << analysis_signature << endl;
+	options << "rr_structs_mode " << user_opts->rr_structs_mode << endl;
+	options << "max_connection_length " << user_opts->max_connection_length << endl;
+	options << "analyze_core " << user_opts->analyze_core << endl;
+	options << "use_routing_node_demand " << user_opts->use_routing_node_demand << endl;
+	options << "threads " << user_opts->num_threads << endl;
+	options << "weight_epoch " << user_opts->weight_epoch_conns << endl;
+	options << "demand_iterations " << user_opts->demand_iterations << endl;
+	options << "target_reliability " << user_opts->target_reliability << endl;
+	options << "search_proxy_length " << user_opts->search_proxy_length << endl;
+	options << "self_congestion_mode " << user_opts->self_congestion_mode << endl;
+	options << "enumerate_engine " << user_opts->enumerate_engine << endl;
+	options << "probability_mode " << user_opts->probability_mode << endl;
+	options << "monte_carlo_trials " << user_opts->monte_carlo_trials << endl;
+	options << "exact_frontier_limit " << user_opts->exact_frontier_limit << endl;
+	options << "tail_sampling " << user_opts->tail_sampling_budget << endl;
+	options << "path_weight_tolerance " << user_opts->path_weight_tolerance << endl;
+	options << "ipin_probability " << user_opts->ipin_probability << endl;
+	options << "opin_probability " << user_opts->opin_probability << endl;
+	options << "demand_multiplier " << user_opts->demand_multiplier << endl;
+	options << "seed " << user_opts->seed << endl;
+	options << "blocked_tile_order " << !user_opts->scratch_dir.empty() << endl;
+	options << "window " << user_opts->use_window << " " << user_opts->window_xlow << " " << user_opts->window_ylow << " " <<
+	           user_opts->window_xhigh << " " << user_opts->window_yhigh << endl;
+	options << "length_probabilities";
+	for (int ilen = 0; ilen < (int)user_opts->length_probabilities.size(); ilen++){
+		options << " " << user_opts->length_probabilities[ilen];
+	}
+	options << endl;
+
+	uint64_t hash = FNV_OFFSET_BASIS;
+	hash_file(user_opts->rr_structs_file, &hash);
+	string options_str = options.str();
+	hash_bytes(options_str.c_str(), options_str.size(), &hash);
+
+	stringstream key_ss;
+	key_ss << hex << setw(16) << setfill('0') << hash;
+	key = key_ss.str();
+
+	return key;
+}
+
+/* looks up the result with the specified key in the cache directory. on a hit the result is read into 'result',
+   the entry is marked as most-recently used, and true is returned */
+bool lookup_cached_result(User_Options *user_opts, string key, Cached_Result *result){
+	string path = get_cache_entry_path(user_opts, key);
+
+	ifstream entry(path.c_str());
+	if (!entry.is_open()){
+		return false;
+	}
+
+	/* header */
+	string token;
+	int version;
+	string entry_key;
+	entry >> token >> version;
+	if (token != "wotan_result_cache" || version != CACHE_FORMAT_VERSION){
+		cout << "WARNING: ignoring cache entry with unexpected format: " << path << endl;
+		return false;
+	}
+	entry >> token >> entry_key;
+	if (token != "key" || entry_key != key){
+		cout << "WARNING: ignoring cache entry with mismatched key: " << path << endl;
+		return false;
+	}
+
+	Cached_Result read_result;
+	entry >> token >> read_result.demand_multiplier;
+
+	/* metrics -- one per line as '<value> <label>' */
+	int num_metrics = 0;
+	entry >> token >> num_metrics;
+	for (int imetric = 0; imetric < num_metrics && entry.good(); imetric++){
+		double value;
+		string label;
+		entry >> value;
+		getline(entry, label);
+		if (!label.empty() && label[0] == ' '){
+			label.erase(0, 1);
+		}
+		read_result.add_metric(label, value);
+	}
+
+	/* node demands */
+	int num_nodes = 0;
+	entry >> token >> num_nodes;
+	read_result.node_demands.assign(max(0, num_nodes), 0.0);
+	for (int inode = 0; inode < num_nodes && entry.good(); inode++){
+		entry >> read_result.node_demands[inode];
+	}
+
+	if (entry.fail()){
+		/* most likely an entry that was truncated while it was being written by an old version */
+		cout << "WARNING: ignoring corrupt cache entry: " << path << endl;
+		return false;
+	}
+	entry.close();
+
+	/* refresh the modification time of this entry -- this is what LRU eviction is based on */
+	utime(path.c_str(), NULL);
+
+	(*result) = read_result;
+	return true;
+}
+
+/* writes the specified result into the cache directory, then evicts least-recently used entries until
+   the cache fits into its size limit */
+void store_cached_result(User_Options *user_opts, string key, Cached_Result &result){
+	make_cache_dir(user_opts);
+
+	string path = get_cache_entry_path(user_opts, key);
+
+	/* several Wotan processes may share a cache directory -- write to a temporary file first, then move it into place */
+	stringstream tmp_path_ss;
+	tmp_path_ss << path << ".tmp" << getpid();
+	string tmp_path = tmp_path_ss.str();
+
+	fstream entry;
+	open_file(&entry, tmp_path, ios::out | ios::trunc);
+
+	entry << setprecision(17);
+	entry << "wotan_result_cache " << CACHE_FORMAT_VERSION << endl;
+	entry << "key " << key << endl;
+	entry << "demand_multiplier " << result.demand_multiplier << endl;
+	entry << "metrics " << result.metrics.size() << endl;
+	for (int imetric = 0; imetric < (int)result.metrics.size(); imetric++){
+		entry << result.metrics[imetric].second << " " << result.metrics[imetric].first << endl;
+	}
+	entry << "node_demands " << result.node_demands.size() << endl;
+	for (int inode = 0; inode < (int)result.node_demands.size(); inode++){
+		entry << result.node_demands[inode] << endl;
+	}
+
+	bool write_ok = entry.good();
+	entry.close();
+
+	if (!write_ok || rename(tmp_path.c_str(), path.c_str()) != 0){
+		remove(tmp_path.c_str());
+		cout << "WARNING: could not write result cache entry " << path << endl;
+		return;
+	}
+
+	evict_cache_entries(user_opts, path);
+}
+
+
+/* folds specified bytes into an FNV-1a hash */
+static void hash_bytes(const char *bytes, size_t num_bytes, uint64_t *hash){
+	uint64_t h = (*hash);
+	for (size_t ibyte = 0; ibyte < num_bytes; ibyte++){
+		h ^= (uint64_t)(unsigned char)bytes[ibyte];
+		h *= FNV_PRIME;
+	}
+	(*hash) = h;
+}
+
+/* folds the contents of the specified file into an FNV-1a hash */
+static void hash_file(string path, uint64_t *hash){
+	ifstream file(path.c_str(), ios::in | ios::binary);
+	if (!file.is_open()){
+		WTHROW(EX_OTHER, "Could not open file for hashing: " << path);
+	}
+
+	vector<char> buffer(1 << 16);
+	while (file.good()){
+		file.read(&buffer[0], buffer.size());
+		hash_bytes(&buffer[0], (size_t)file.gcount(), hash);
+	}
+}
+
+/* returns the path of the cache entry with the specified key */
+static string get_cache_entry_path(User_Options *user_opts, string key){
+	string path = user_opts->cache_dir;
+	if (!path.empty() && path[path.size()-1] != '/'){
+		path += "/";
+	}
+	path += key + CACHE_ENTRY_EXTENSION;
+	return path;
+}
+
+/* creates the cache directory if it doesn't exist yet */
+static void make_cache_dir(User_Options *user_opts){
+	struct stat dir_stat;
+	if (stat(user_opts->cache_dir.c_str(), &dir_stat) == 0){
+		if (!S_ISDIR(dir_stat.st_mode)){
+			WTHROW(EX_OTHER, "Specified cache directory is not a directory: " << user_opts->cache_dir);
+		}
+		return;
+	}
+
+	/* another process may have created the directory in the meantime, so check again on failure */
+	if (mkdir(user_opts->cache_dir.c_str(), 0755) != 0 && stat(user_opts->cache_dir.c_str(), &dir_stat) != 0){
+		WTHROW(EX_OTHER, "Could not create cache directory: " << user_opts->cache_dir);
+	}
+}
+
+/* removes least-recently used entries from the cache directory until it fits into the size limit.
+   the entry at 'keep_path' is never evicted */
+static void evict_cache_entries(User_Options *user_opts, string keep_path){
+	DIR *dir = opendir(user_opts->cache_dir.c_str());
+	if (dir == NULL){
+		return;
+	}
+
+	string dir_path = user_opts->cache_dir;
+	if (dir_path[dir_path.size()-1] != '/'){
+		dir_path += "/";
+	}
+
+	/* get the size and last-use time of each cache entry */
+	vector<Cache_Entry_File> entries;
+	double total_size = 0;
+	struct dirent *dir_entry;
+	while ( (dir_entry = readdir(dir)) != NULL ){
+		string name = dir_entry->d_name;
+		if ( !check_file_extension(name, CACHE_ENTRY_EXTENSION) ){
+			continue;
+		}
+
+		Cache_Entry_File entry_file;
+		entry_file.path = dir_path + name;
+
+		struct stat file_stat;
+		if (stat(entry_file.path.c_str(), &file_stat) != 0){
+			continue;
+		}
+		entry_file.size = file_stat.st_size;
+		entry_file.last_used = file_stat.st_mtime;
+
+		total_size += (double)entry_file.size;
+		entries.push_back(entry_file);
+	}
+	closedir(dir);
+
+	/* evict oldest entries first */
+	double size_limit = (double)user_opts->cache_size_limit * 1024.0 * 1024.0;
+	sort(entries.begin(), entries.end());
+	for (int ientry = 0; ientry < (int)entries.size() && total_size > size_limit; ientry++){
+		if (entries[ientry].path == keep_path){
+			continue;
+		}
+
+		if (remove(entries[ientry].path.c_str()) == 0){
+			total_size -= (double)entries[ientry].size;
+		}
+	}
+}
@@ -0,0 +1,48 @@
+#ifndef ANALYSIS_CACHE_H
+#define ANALYSIS_CACHE_H
+
+#include <string>
+#include <vector>
+#include <utility>
+#include "wotan_types.h"
+
+
+/**** Typedefs ****/
+/* a list of (label, value) pairs that make up the final metrics of an analysis run */
+typedef std::vector< std::pair<std::string, double> > t_cached_metrics;
+
+
+/**** Classes ****/
+/* The final results of an analysis run, as stored in the on-disk result cache */
+class Cached_Result{
+public:
+	/* final metrics of the run. these are printed as '<label>: <value>' when a cached result is reused */
+	t_cached_metrics metrics;
+	/* the demand multiplier in effect at the end of the run (it may have been searched for) */
+	double demand_multiplier;
+	/* raw demand of each rr node at the end of the run */
+	std::vector<double> node_demands;
+
+	Cached_Result();
+
+	/* adds a metric to the result */
+	void add_metric(std::string label, double value);
+};
+
+
+/**** Function Declarations ****/
+/* returns a key identifying the current analysis. the key is a hash of the rr structs file contents together with all
+   analysis-relevant user options and the specified signature of compile-time analysis settings.
+   returns an empty string if result caching is disabled */
+std::string get_result_cache_key(User_Options *user_opts, std::string analysis_signature);
+
+/* looks up the result with the specified key in the cache directory. on a hit the result is read into 'result',
+   the entry is marked as most-recently used, and true is returned */
+bool lookup_cached_result(User_Options *user_opts, std::string key, Cached_Result *result);
+
+/* writes the specified result into the cache directory, then evicts least-recently used entries until
+   the cache fits into its size limit */
+void store_cached_result(User_Options *user_opts, std::string key, Cached_Result &result);
+
+
+#endif
@@ -32,14 +32,14 @@ static void add_node_to_cutline_structure(int node_ind, t_node_topo_inf &node_to
 /* sets topological traversal level of specified node according to the parent node */
 static void set_node_level(int parent_ind, int node_ind, t_node_topo_inf &node_topo_inf);
 /* estimates probability that a source/dest connection can be made based on the cutline structure */
-static float connection_probability_cutlines(int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_node_topo_inf &node_topo_inf, Cutline_Structs *cutline_structs,
+static float connection_probability_cutlines(int from_node_ind, int to_node_ind, t_rr_node &rr_node, const Node_Values &node_values, t_node_topo_inf &node_topo_inf, Cutline_Structs *cutline_structs,
                                              User_Options *user_opts);
 
 
 
 /**** Function Definitions ****/
 /* Called when node is popped from expansion queue during topological traversal */
-void cutline_node_popped_func(int popped_node, int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, 
+void cutline_node_popped_func(int popped_node, int from_node_ind, int to_node_ind, t_rr_node &rr_node, const Node_Values &node_values, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, 
                           e_traversal_dir traversal_dir, int max_path_weight, User_Options *user_opts, void *user_data){
 	
 	//cout << "popped node: " << popped_node << endl;
@@ -48,7 +48,7 @@ void cutline_node_popped_func(int popped_node, int from_node_ind, int to_node_in
 }
 
 /* Called when topological traversal is iterateing over a node's children */
-bool cutline_child_iterated_func(int parent_ind, int parent_edge_ind, int node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
+bool cutline_child_iterated_func(int parent_ind, int parent_edge_ind, int node_ind, t_rr_node &rr_node, const Node_Values &node_values, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
                           e_traversal_dir traversal_dir, int max_path_weight, int from_node_ind, int to_node_ind, User_Options *user_opts, void *user_data){
 
 	bool ignore_node = false;
@@ -60,11 +60,11 @@ bool cutline_child_iterated_func(int parent_ind, int parent_edge_ind, int node_i
 
 /* Called once topological traversal is complete.
    Calculates probability of a source/sink connection being routable */
-void cutline_traversal_done_func(int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, 
+void cutline_traversal_done_func(int from_node_ind, int to_node_ind, t_rr_node &rr_node, const Node_Values &node_values, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, 
                           e_traversal_dir traversal_dir, int max_path_weight, User_Options *user_opts, void *user_data){
 	
 	Cutline_Structs *cutline_structs = (Cutline_Structs*)user_data;
-	float prob_routable = connection_probability_cutlines(from_node_ind, to_node_ind, rr_node, node_topo_inf, cutline_structs, user_opts);
+	float prob_routable = connection_probability_cutlines(from_node_ind, to_node_ind, rr_node, node_values, node_topo_inf, cutline_structs, user_opts);
 
 	cutline_structs->prob_routable = prob_routable;
 }
@@ -75,9 +75,7 @@ static void add_node_to_cutline_structure(int node_ind, t_node_topo_inf &node_to
 	int node_level = node_topo_inf[node_ind].get_level();
 	int max_cutline_level = (int)cutline_probability_struct.size() - 1;
 
-	if (node_level < 0){
-		WTHROW(EX_PATH_ENUM, "Got node with topological traversal level less than 0");
-	}
+	WCHECK(1, node_level >= 0, EX_PATH_ENUM, "Got node with topological traversal level less than 0");
 
 	if (node_level - max_cutline_level > 1){
 		WTHROW(EX_PATH_ENUM, "Should not get node with topological traversal level 2 (or more) above any nodes encountered so far");
@@ -96,9 +94,7 @@ static void set_node_level(int parent_ind, int node_ind, t_node_topo_inf &node_t
 	int parent_level = node_topo_inf[parent_ind].get_level();
 	int node_level = node_topo_inf[node_ind].get_level();
 
-	if (parent_level == UNDEFINED){
-		WTHROW(EX_PATH_ENUM, "Parent level is undefined");
-	}
+	WCHECK(1, parent_level != UNDEFINED, EX_PATH_ENUM, "Parent level is undefined");
 
 	/* child level according to lowest parent level */
 	if (node_level == UNDEFINED || parent_level < node_level){
@@ -115,7 +111,7 @@ static void set_node_level(int parent_ind, int node_ind, t_node_topo_inf &node_t
 }
 
 /* estimates probability that a source/dest connection can be made based on the cutline structure */
-static float connection_probability_cutlines(int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_node_topo_inf &node_topo_inf, Cutline_Structs *cutline_structs,
+static float connection_probability_cutlines(int from_node_ind, int to_node_ind, t_rr_node &rr_node, const Node_Values &node_values, t_node_topo_inf &node_topo_inf, Cutline_Structs *cutline_structs,
                                              User_Options *user_opts){
 	
 	t_cutline_prob_struct &cutline_probability_struct = cutline_structs->cutline_prob_struct;
@@ -144,13 +140,11 @@ static float connection_probability_cutlines(int from_node_ind, int to_node_ind,
 			int node_ind = cutline_probability_struct[ilevel][inode];
 
 
-			/* skip if this node is the source or target node */
-			if (node_ind == from_node_ind || node_ind == to_node_ind){
-				WTHROW(EX_PATH_ENUM, "Should not find source/dest nodes on level structure");
-			}
+			/* the source and target nodes never make it onto the level structure */
+			WCHECK(2, node_ind != from_node_ind && node_ind != to_node_ind, EX_PATH_ENUM, "Should not find source/dest nodes on level structure");
 
 			//float node_demand = rr_node[node_ind].get_demand();
-			float node_demand = get_node_demand_adjusted_for_path_history(node_ind, rr_node, from_node_ind, to_node_ind, cutline_structs->fill_type, user_opts);
+			float node_demand = get_node_demand_adjusted_for_path_history(node_ind, rr_node, node_values, from_node_ind, to_node_ind, cutline_structs->fill_type, user_opts);
 
 			/* bound probability that node is unavailable to 1 */
 			float node_unavailable = min(1.0F, node_demand);
@@ -159,9 +153,7 @@ static float connection_probability_cutlines(int from_node_ind, int to_node_ind,
 			//	cout << "  to " << to_node_ind << "  level " << ilevel << " node " << node_ind << "  unavailable " << node_unavailable << endl;
 			//}
 
-			if (node_unavailable < 0){
-				WTHROW(EX_PATH_ENUM, "node unavailable prob smaller than 0??");
-			}
+			WCHECK(2, node_unavailable >= 0, EX_PATH_ENUM, "node unavailable prob smaller than 0??");
 
 			level_prob *= node_unavailable;
 		}
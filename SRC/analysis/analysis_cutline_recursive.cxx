@@ -24,13 +24,13 @@ using namespace std;
 /* returns height of node based on node's corresponding ss_distances */
 static int get_node_height(SS_Distances &node_ss_distances);
 /* returns true if specified node has legal parents (their source-hop number is smaller) at the specified height */
-static bool has_parents_of_height(int node_ind, int height, t_rr_node &rr_node, t_ss_distances &ss_distances, e_traversal_dir traversal_dir,
+static bool has_parents_of_height(int node_ind, int height, t_rr_node &rr_node, const Node_Values &node_values, t_ss_distances &ss_distances, e_traversal_dir traversal_dir,
                                   int max_path_weight);
 /* adds specified node to the cutline probability structure according to the node's level in the topological traversal */
 static void add_node_to_cutline_structure(int node_ind, int level, t_cutline_rec_prob_struct &cutline_probability_struct);
 /* estimates probability that a source/dest connection can be made based on the cutline structure. 
    returns UNDEFINED if any one of the levels is empty */
-static float connection_probability_cutlines(t_rr_node &rr_node, Cutline_Recursive_Structs *cutline_rec_structs, t_node_topo_inf &node_topo_inf,
+static float connection_probability_cutlines(t_rr_node &rr_node, const Node_Values &node_values, Cutline_Recursive_Structs *cutline_rec_structs, t_node_topo_inf &node_topo_inf,
                                          t_topo_inf_backups &topo_inf_backups, int recursion_level, t_ss_distances &ss_distances,
 					 User_Options *user_opts);
 
@@ -38,7 +38,7 @@ static float connection_probability_cutlines(t_rr_node &rr_node, Cutline_Recursi
 
 /**** Function Definitions ****/
 /* Called when node is popped from expansion queue during topological traversal */
-void cutline_recursive_node_popped_func(int popped_node, int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, 
+void cutline_recursive_node_popped_func(int popped_node, int from_node_ind, int to_node_ind, t_rr_node &rr_node, const Node_Values &node_values, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, 
                           e_traversal_dir traversal_dir, int max_path_weight, User_Options *user_opts, void *user_data){
 
 	Cutline_Recursive_Structs *cutline_rec_structs = (Cutline_Recursive_Structs*)user_data;
@@ -56,16 +56,9 @@ void cutline_recursive_node_popped_func(int popped_node, int from_node_ind, int
 
 
 	/* Error Checks */
-	//TODO: remove this after debugging done
-	if (relative_source_hops < 0){
-		WTHROW(EX_PATH_ENUM, "Seem to have stepped backward from root node");
-	}
-	if (relative_source_hops >= cutline_rec_structs->bound_source_hops){
-		WTHROW(EX_PATH_ENUM, "Seem to have exceeded source-hop bounds");
-	}
-	if (relative_height < 0){
-		WTHROW(EX_PATH_ENUM, "Seem to have stepped down in height");
-	}
+	WCHECK(2, relative_source_hops >= 0, EX_PATH_ENUM, "Seem to have stepped backward from root node");
+	WCHECK(2, relative_source_hops < cutline_rec_structs->bound_source_hops, EX_PATH_ENUM, "Seem to have exceeded source-hop bounds");
+	WCHECK(2, relative_height >= 0, EX_PATH_ENUM, "Seem to have stepped down in height");
 
 
 	/* If node hasn't been 'smoothed' out in a different traversal, then it will be assigned a level.
@@ -77,7 +70,7 @@ void cutline_recursive_node_popped_func(int popped_node, int from_node_ind, int
 			/* at same height as root --> level is relative hops from root */
 			relative_level = relative_source_hops;
 		} else {
-			if ( has_parents_of_height(popped_node, node_height, rr_node, ss_distances, traversal_dir, max_path_weight) ){
+			if ( has_parents_of_height(popped_node, node_height, rr_node, node_values, ss_distances, traversal_dir, max_path_weight) ){
 				/* not the first node of its height */
 				relative_level = relative_source_hops - relative_height;
 			} else {
@@ -98,7 +91,7 @@ void cutline_recursive_node_popped_func(int popped_node, int from_node_ind, int
 				node_backup.clear_node_topo_inf(node_topo_inf);
 
 				/* RECURSE on this node */
-				do_topological_traversal(popped_node, to_node_ind, rr_node, ss_distances, node_topo_inf, traversal_dir,
+				do_topological_traversal(popped_node, to_node_ind, rr_node, node_values, ss_distances, node_topo_inf, traversal_dir,
 							max_path_weight, user_opts, (void*)&new_cutline_rec_structs,
 							cutline_recursive_node_popped_func,
 						 	cutline_recursive_child_iterated_func,
@@ -114,7 +107,7 @@ void cutline_recursive_node_popped_func(int popped_node, int from_node_ind, int
 					node_topo_inf[popped_node].set_node_smoothed(true);
 					node_smoothed = true;
 				} else {
-					float popped_node_demand = get_node_demand_adjusted_for_path_history(popped_node, rr_node, cutline_rec_structs->source_ind,
+					float popped_node_demand = get_node_demand_adjusted_for_path_history(popped_node, rr_node, node_values, cutline_rec_structs->source_ind,
 										 cutline_rec_structs->sink_ind, cutline_rec_structs->fill_type, user_opts);
 
 					float adjusted_demand = or_two_probs(popped_node_demand, 1-prob_routable);
@@ -146,7 +139,7 @@ void cutline_recursive_node_popped_func(int popped_node, int from_node_ind, int
 
 
 /* Called when topological traversal is iterateing over a node's children */
-bool cutline_recursive_child_iterated_func(int parent_ind, int parent_edge_ind, int node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
+bool cutline_recursive_child_iterated_func(int parent_ind, int parent_edge_ind, int node_ind, t_rr_node &rr_node, const Node_Values &node_values, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
                           e_traversal_dir traversal_dir, int max_path_weight, int from_node_ind, int to_node_ind, User_Options *user_opts, void *user_data){
 
 	Cutline_Recursive_Structs *cutline_rec_structs = (Cutline_Recursive_Structs*)user_data;
@@ -201,12 +194,12 @@ bool cutline_recursive_child_iterated_func(int parent_ind, int parent_edge_ind,
 
 /* Called once topological traversal is complete.
    Calculates probability of a source/sink connection being routable */
-void cutline_recursive_traversal_done_func(int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, 
+void cutline_recursive_traversal_done_func(int from_node_ind, int to_node_ind, t_rr_node &rr_node, const Node_Values &node_values, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, 
                           e_traversal_dir traversal_dir, int max_path_weight, User_Options *user_opts, void *user_data){
 	/* compute probability that connection is routable. also restore backed-up node inf's */
 	Cutline_Recursive_Structs *cutline_rec_structs = (Cutline_Recursive_Structs*)user_data;
 
-	float routable = connection_probability_cutlines(rr_node, cutline_rec_structs, node_topo_inf,
+	float routable = connection_probability_cutlines(rr_node, node_values, cutline_rec_structs, node_topo_inf,
 	                                               cutline_rec_structs->topo_inf_backups, cutline_rec_structs->recurse_level, ss_distances, user_opts);
 	cutline_rec_structs->prob_routable = routable;
 }
@@ -230,7 +223,7 @@ static int get_node_height(SS_Distances &node_ss_distances){
 }
 
 /* returns true if specified node has legal parents (their source-hop number is smaller) at the specified height */
-static bool has_parents_of_height(int node_ind, int height, t_rr_node &rr_node, t_ss_distances &ss_distances, e_traversal_dir traversal_dir,
+static bool has_parents_of_height(int node_ind, int height, t_rr_node &rr_node, const Node_Values &node_values, t_ss_distances &ss_distances, e_traversal_dir traversal_dir,
                                   int max_path_weight){
 	bool result = false;
 	int node_source_hops = ss_distances[node_ind].get_source_hops();
@@ -252,7 +245,7 @@ static bool has_parents_of_height(int node_ind, int height, t_rr_node &rr_node,
 		int parent_ind = edge_list[inode];
 
 		/* skip illegal parents */
-		int parent_weight = rr_node[parent_ind].get_weight();
+		int parent_weight = node_values.weight[parent_ind];
 		if ( !ss_distances[parent_ind].is_legal(parent_weight, max_path_weight) ){
 			continue;
 		}
@@ -278,9 +271,7 @@ static void add_node_to_cutline_structure(int node_ind, int level, t_cutline_rec
 		//TODO: figure out how the above condition is possible!
 		return;
 	}
-	if (level < 0){
-		WTHROW(EX_PATH_ENUM, "Level of node with index " << node_ind << " is less than 0: " << level);
-	}
+	WCHECK(1, level >= 0, EX_PATH_ENUM, "Level of node with index " << node_ind << " is less than 0: " << level);
 
 	/* put node onto the cutline structure according to its level */
 	//cout << "  level: " << level << "  num_cutlines: " << num_cutlines << endl;
@@ -290,7 +281,7 @@ static void add_node_to_cutline_structure(int node_ind, int level, t_cutline_rec
 
 /* estimates probability that a source/dest connection can be made based on the cutline structure. 
    returns UNDEFINED if any one of the levels is empty */
-static float connection_probability_cutlines(t_rr_node &rr_node, Cutline_Recursive_Structs *cutline_rec_structs, t_node_topo_inf &node_topo_inf,
+static float connection_probability_cutlines(t_rr_node &rr_node, const Node_Values &node_values, Cutline_Recursive_Structs *cutline_rec_structs, t_node_topo_inf &node_topo_inf,
                                          t_topo_inf_backups &topo_inf_backups, int recursion_level, t_ss_distances &ss_distances,
 					 User_Options *user_opts){
 	
@@ -324,7 +315,7 @@ static float connection_probability_cutlines(t_rr_node &rr_node, Cutline_Recursi
 			/* look at adjusted node demand (node may have been root of a recursed traversal */
 			float node_demand = node_topo_inf[node_ind].get_adjusted_demand();
 			if (node_demand == UNDEFINED){
-				node_demand = get_node_demand_adjusted_for_path_history(node_ind, rr_node, cutline_rec_structs->source_ind,
+				node_demand = get_node_demand_adjusted_for_path_history(node_ind, rr_node, node_values, cutline_rec_structs->source_ind,
 				                                         cutline_rec_structs->sink_ind, cutline_rec_structs->fill_type, user_opts);
 			}
 
@@ -21,12 +21,12 @@ using namespace std;
 
 /**** Function Declarations ****/
 /* returns estimate of probability that sink is reachable from source */
-static float get_prob_reachable(t_rr_node &rr_node, int from_node_ind, int to_node_ind, Cutline_Simple_Structs *cutline_simple_structs, User_Options *user_opts);
+static float get_prob_reachable(t_rr_node &rr_node, const Node_Values &node_values, int from_node_ind, int to_node_ind, Cutline_Simple_Structs *cutline_simple_structs, User_Options *user_opts);
 
 
 /**** Function Definitions ****/
 /* Called when node is popped from expansion queue during topological traversal */
-void cutline_simple_node_popped_func(int popped_node, int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, 
+void cutline_simple_node_popped_func(int popped_node, int from_node_ind, int to_node_ind, t_rr_node &rr_node, const Node_Values &node_values, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, 
                           e_traversal_dir traversal_dir, int max_path_weight, User_Options *user_opts, void *user_data){
 
 	Cutline_Simple_Structs *cutline_simple_structs = (Cutline_Simple_Structs*)user_data;
@@ -83,7 +83,7 @@ void cutline_simple_node_popped_func(int popped_node, int from_node_ind, int to_
 }
 
 /* Called when topological traversal is iterateing over a node's children */
-bool cutline_simple_child_iterated_func(int parent_ind, int parent_edge_ind, int node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
+bool cutline_simple_child_iterated_func(int parent_ind, int parent_edge_ind, int node_ind, t_rr_node &rr_node, const Node_Values &node_values, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
                           e_traversal_dir traversal_dir, int max_path_weight, int from_node_ind, int to_node_ind, User_Options *user_opts, void *user_data){
 	bool ignore_node = false;
 
@@ -92,20 +92,20 @@ bool cutline_simple_child_iterated_func(int parent_ind, int parent_edge_ind, int
 
 /* Called once topological traversal is complete.
    Calculates probability of a source/sink connection being routable */
-void cutline_simple_traversal_done_func(int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, 
+void cutline_simple_traversal_done_func(int from_node_ind, int to_node_ind, t_rr_node &rr_node, const Node_Values &node_values, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, 
                           e_traversal_dir traversal_dir, int max_path_weight, User_Options *user_opts, void *user_data){
 
 	Cutline_Simple_Structs *cutline_simple_structs = (Cutline_Simple_Structs*)user_data;
 
 
-	float prob_routable = get_prob_reachable( rr_node, from_node_ind, to_node_ind, cutline_simple_structs, user_opts );
+	float prob_routable = get_prob_reachable( rr_node, node_values, from_node_ind, to_node_ind, cutline_simple_structs, user_opts );
 
 	cutline_simple_structs->prob_routable = prob_routable;
 }
 
 
 /* returns estimate of probability that sink is reachable from source */
-static float get_prob_reachable(t_rr_node &rr_node, int from_node_ind, int to_node_ind, Cutline_Simple_Structs *cutline_simple_structs, User_Options *user_opts){
+static float get_prob_reachable(t_rr_node &rr_node, const Node_Values &node_values, int from_node_ind, int to_node_ind, Cutline_Simple_Structs *cutline_simple_structs, User_Options *user_opts){
 	float prob_unreachable = 0;
 
 	t_cutline_simple_prob_struct &cutline_simple_prob_struct = cutline_simple_structs->cutline_simple_prob_struct;
@@ -130,7 +130,7 @@ static float get_prob_reachable(t_rr_node &rr_node, int from_node_ind, int to_no
 
 			//cout << "node ind: " << node_ind << endl;
 
-			float node_demand = get_node_demand_adjusted_for_path_history(node_ind, rr_node, from_node_ind, to_node_ind, fill_type, user_opts);
+			float node_demand = get_node_demand_adjusted_for_path_history(node_ind, rr_node, node_values, from_node_ind, to_node_ind, fill_type, user_opts);
 
 			float node_unavailable = min(1.0F, node_demand);
 
@@ -0,0 +1,426 @@
+/*
+	The 'exact' method of analyzing reachability in a graph is invoked after paths have been enumerated
+through the routing resource graph.
+
+	Every node is taken to be blocked (unavailable for routing) with probability equal to its demand, independently of
+other nodes, and the probability that the destination can be reached over available nodes along a path that respects the
+maximum path weight is computed exactly. Nodes are processed in the order of a topological traversal of the legal subgraph
+(the same traversal, with the same path weight bounds, as used by the 'propagate' and 'monte carlo' methods). The nodes that
+have been reached but not yet expanded form a frontier, and the state of the computation is the weight of the lightest
+available path to each frontier node. Expanding a node branches on whether the node is available, propagates its weight to
+its children, and then removes it from the frontier. Identical states are merged as they are produced, so this amounts to
+building a frontier-based decision diagram level by level, with a unique table providing the node sharing.
+
+	The number of states can grow exponentially with the width of the frontier, so traversals whose frontier grows wider
+than a user-specified limit (or that produce too many states) are abandoned, and the connection is analyzed with the
+'propagate' method instead.
+
+	The 'exact' method of reachability analysis builds on top of a topological traversal of the subraph. Hence
+the constituent functions are meant to be passed-in to a topological traversal function (see topological_traversal.h)
+
+*/
+
+#include <algorithm>
+#include <cstring>
+#include "analysis_main.h"
+#include "analysis_exact.h"
+#include "exception.h"
+#include "wotan_util.h"
+
+using namespace std;
+
+
+
+/**** Function Declarations ****/
+/* returns a hash of the specified state */
+static unsigned long long hash_state(const short *state_values, int width);
+
+
+
+/**** Function Definitions ****/
+/*==== Exact_Frontier Class ====*/
+Exact_Frontier::Exact_Frontier(){
+	this->width = 0;
+	this->num_states = 0;
+	this->frontier_limit = 0;
+	this->failed = false;
+	this->last_popped = UNDEFINED;
+	this->start_time = 0;
+	this->peak_width = 0;
+	this->peak_states = 0;
+	this->next_num_states = 0;
+
+	this->num_attempted = 0;
+	this->num_applied = 0;
+	this->exact_seconds = 0;
+	this->abandoned_seconds = 0;
+	this->max_width = 0;
+	this->max_states = 0;
+}
+
+void Exact_Frontier::init(int num_nodes, int set_frontier_limit){
+	this->frontier_limit = set_frontier_limit;
+	this->node_column.assign(num_nodes, UNDEFINED);
+	this->column_node.clear();
+	this->width = 0;
+	this->num_states = 0;
+}
+
+/* forgets the current traversal and starts a new one in which only the specified node is reached (via a path of weight 0) */
+void Exact_Frontier::start(int start_node_ind){
+	for (int icol = 0; icol < (int)this->column_node.size(); icol++){
+		this->node_column[ this->column_node[icol] ] = UNDEFINED;
+	}
+	this->column_node.clear();
+	this->width = 0;
+	this->failed = false;
+	this->last_popped = UNDEFINED;
+	this->start_time = get_wall_seconds();
+	this->peak_width = 0;
+	this->peak_states = 1;
+	this->num_attempted++;
+
+	/* a single state with probability 1 */
+	this->num_states = 1;
+	this->values.clear();
+	this->probs.assign(1, 1.0);
+
+	int column = this->get_column(start_node_ind);
+	this->values[column] = 0;
+}
+
+/* reached nodes join the frontier as unreached in every state */
+int Exact_Frontier::get_column(int node_ind){
+	int column = this->node_column[node_ind];
+	if (column != UNDEFINED || this->failed){
+		return column;
+	}
+
+	if (this->width + 1 > this->frontier_limit){
+		this->failed = true;
+		return UNDEFINED;
+	}
+
+	/* widen every state by one column. states stay distinct, so no merging is needed */
+	int old_width = this->width;
+	int new_width = old_width + 1;
+	this->next_values.resize((size_t)this->num_states * new_width);
+	for (int istate = 0; istate < this->num_states; istate++){
+		short *new_row = &this->next_values[(size_t)istate * new_width];
+		if (old_width > 0){
+			memcpy(new_row, &this->values[(size_t)istate * old_width], old_width * sizeof(short));
+		}
+		new_row[old_width] = UNREACHED_WEIGHT;
+	}
+	this->values.swap(this->next_values);
+
+	column = old_width;
+	this->width = new_width;
+	this->peak_width = max(this->peak_width, new_width);
+	this->node_column[node_ind] = column;
+	this->column_node.push_back(node_ind);
+	return column;
+}
+
+/* removes the specified node from the frontier */
+void Exact_Frontier::drop_node(int node_ind){
+	int column = this->node_column[node_ind];
+	if (column == UNDEFINED || this->failed){
+		return;
+	}
+
+	/* the last column is moved into the dropped one */
+	int last_column = this->width - 1;
+	int new_width = this->width - 1;
+
+	vector<short> row(max(1, new_width));
+	this->begin_level();
+	this->width = new_width;
+	for (int istate = 0; istate < this->num_states; istate++){
+		const short *old_row = &this->values[(size_t)istate * (new_width+1)];
+		for (int icol = 0; icol < new_width; icol++){
+			row[icol] = old_row[icol];
+		}
+		if (column != last_column){
+			row[column] = old_row[last_column];
+		}
+		this->add_state(&row[0], this->probs[istate]);
+	}
+	this->end_level();
+
+	int moved_node = this->column_node[last_column];
+	this->column_node[column] = moved_node;
+	this->node_column[moved_node] = column;
+	this->column_node.pop_back();
+	this->node_column[node_ind] = UNDEFINED;
+}
+
+/* each state splits into one in which the node is available and one in which it is blocked (and therefore unreached) */
+void Exact_Frontier::branch_on_availability(int node_ind, double prob_blocked){
+	int column = this->get_column(node_ind);
+	if (this->failed || prob_blocked <= 0.0){
+		return;
+	}
+
+	vector<short> row(this->width);
+	this->begin_level();
+	for (int istate = 0; istate < this->num_states; istate++){
+		const short *old_row = &this->values[(size_t)istate * this->width];
+		double prob = this->probs[istate];
+
+		if (old_row[column] == UNREACHED_WEIGHT || prob_blocked >= 1.0){
+			/* nothing to branch on */
+			memcpy(&row[0], old_row, this->width * sizeof(short));
+			if (prob_blocked >= 1.0){
+				row[column] = UNREACHED_WEIGHT;
+			}
+			this->add_state(&row[0], prob);
+		} else {
+			this->add_state(old_row, prob * (1.0 - prob_blocked));
+
+			memcpy(&row[0], old_row, this->width * sizeof(short));
+			row[column] = UNREACHED_WEIGHT;
+			this->add_state(&row[0], prob * prob_blocked);
+		}
+	}
+	this->end_level();
+}
+
+/* the child is reached via the parent if the parent's weight doesn't exceed the specified maximum */
+void Exact_Frontier::propagate(int parent_ind, int child_ind, int child_weight, int max_parent_weight){
+	int parent_column = this->get_column(parent_ind);
+	if (this->failed){
+		return;
+	}
+
+	/* a child that can't be reached via the parent in any state doesn't need to join the frontier (yet) */
+	bool parent_reached = false;
+	for (int istate = 0; istate < this->num_states && !parent_reached; istate++){
+		short parent_weight = this->values[(size_t)istate * this->width + parent_column];
+		parent_reached = (parent_weight != UNREACHED_WEIGHT && parent_weight <= max_parent_weight);
+	}
+	if (!parent_reached){
+		return;
+	}
+
+	int child_column = this->get_column(child_ind);
+	if (this->failed){
+		return;
+	}
+
+	vector<short> row(this->width);
+	this->begin_level();
+	for (int istate = 0; istate < this->num_states; istate++){
+		const short *old_row = &this->values[(size_t)istate * this->width];
+		memcpy(&row[0], old_row, this->width * sizeof(short));
+
+		short parent_weight = old_row[parent_column];
+		if (parent_weight != UNREACHED_WEIGHT && parent_weight <= max_parent_weight){
+			row[child_column] = min(row[child_column], (short)(parent_weight + child_weight));
+		}
+		this->add_state(&row[0], this->probs[istate]);
+	}
+	this->end_level();
+}
+
+/* returns the probability that the specified frontier node is reached */
+double Exact_Frontier::get_prob_reached(int node_ind) const{
+	int column = this->node_column[node_ind];
+	if (column == UNDEFINED){
+		return 0.0;
+	}
+
+	double prob_reached = 0;
+	for (int istate = 0; istate < this->num_states; istate++){
+		if (this->values[(size_t)istate * this->width + column] != UNREACHED_WEIGHT){
+			prob_reached += this->probs[istate];
+		}
+	}
+	return prob_reached;
+}
+
+/* starts building a new level */
+void Exact_Frontier::begin_level(){
+	this->next_num_states = 0;
+	this->next_values.clear();
+	this->next_probs.clear();
+
+	int table_size = 64;
+	while (table_size < 4 * this->num_states){
+		table_size *= 2;
+	}
+	this->unique_table.assign(table_size, UNDEFINED);
+}
+
+/* adds a state to the level being built, merging it with an identical state if there is one */
+void Exact_Frontier::add_state(const short *state_values, double prob){
+	if (this->failed){
+		return;
+	}
+
+	int table_mask = (int)this->unique_table.size() - 1;
+	int slot = (int)(hash_state(state_values, this->width) & table_mask);
+	while (this->unique_table[slot] != UNDEFINED){
+		int istate = this->unique_table[slot];
+		if (memcmp(&this->next_values[(size_t)istate * this->width], state_values, this->width * sizeof(short)) == 0){
+			this->next_probs[istate] += prob;
+			return;
+		}
+		slot = (slot + 1) & table_mask;
+	}
+
+	if (this->next_num_states >= MAX_EXACT_STATES){
+		this->failed = true;
+		return;
+	}
+
+	int new_state = this->next_num_states;
+	this->next_num_states++;
+	this->next_values.insert(this->next_values.end(), state_values, state_values + this->width);
+	this->next_probs.push_back(prob);
+	this->unique_table[slot] = new_state;
+
+	/* keep the table at most half full */
+	if (2 * this->next_num_states > (int)this->unique_table.size()){
+		this->rehash(2 * (int)this->unique_table.size());
+	}
+}
+
+/* resizes the unique table to the specified (power of two) size and re-inserts the states of the level being built */
+void Exact_Frontier::rehash(int table_size){
+	this->unique_table.assign(table_size, UNDEFINED);
+	int table_mask = table_size - 1;
+	for (int istate = 0; istate < this->next_num_states; istate++){
+		int slot = (int)(hash_state(&this->next_values[(size_t)istate * this->width], this->width) & table_mask);
+		while (this->unique_table[slot] != UNDEFINED){
+			slot = (slot + 1) & table_mask;
+		}
+		this->unique_table[slot] = istate;
+	}
+}
+
+/* makes the level that was built current */
+void Exact_Frontier::end_level(){
+	if (this->failed){
+		return;
+	}
+	this->values.swap(this->next_values);
+	this->probs.swap(this->next_probs);
+	this->num_states = this->next_num_states;
+	this->peak_states = max(this->peak_states, this->num_states);
+}
+
+
+/*==== Exact_Structs Class ====*/
+Exact_Structs::Exact_Structs(){
+	this->prob_routable = UNDEFINED;
+	this->fill_type = NULL;
+	this->frontier = NULL;
+}
+
+
+/* Called when node is popped from expansion queue during topological traversal */
+void exact_node_popped_func(int popped_node, int from_node_ind, int to_node_ind, t_rr_node &rr_node, const Node_Values &node_values, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
+                          e_traversal_dir traversal_dir, int max_path_weight, User_Options *user_opts, void *user_data){
+
+	Exact_Structs *exact_structs = (Exact_Structs*)user_data;
+	Exact_Frontier *frontier = exact_structs->frontier;
+	if (frontier->failed){
+		return;
+	}
+
+	/* the children of the previously expanded node have all been iterated -- it is no longer needed */
+	if (frontier->last_popped != UNDEFINED && frontier->last_popped != to_node_ind){
+		frontier->drop_node(frontier->last_popped);
+	}
+	frontier->last_popped = popped_node;
+
+	float node_demand = get_node_demand_adjusted_for_path_history(popped_node, rr_node, node_values, from_node_ind, to_node_ind, exact_structs->fill_type, user_opts);
+	float prob_blocked = max(0.0F, min(1.0F, node_demand));
+	frontier->branch_on_availability(popped_node, prob_blocked);
+}
+
+/* Called when topological traversal is iterateing over a node's children */
+bool exact_child_iterated_func(int parent_ind, int parent_edge_ind, int node_ind, t_rr_node &rr_node, const Node_Values &node_values, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
+                          e_traversal_dir traversal_dir, int max_path_weight, int from_node_ind, int to_node_ind, User_Options *user_opts, void *user_data){
+
+	Exact_Structs *exact_structs = (Exact_Structs*)user_data;
+	bool ignore_node = false;
+
+	if (traversal_dir != FORWARD_TRAVERSAL){
+		WTHROW(EX_PATH_ENUM, "The exact method only supports forward traversal");
+	}
+
+	/* paths reaching the parent with weight w reach the child with weight w+child_weight. same bounds as in the 'propagate' method */
+	int child_weight = node_values.weight[node_ind];
+	int child_path_weight_to_dest = ss_distances[node_ind].get_sink_distance();
+	exact_structs->frontier->propagate(parent_ind, node_ind, child_weight, max_path_weight - child_path_weight_to_dest);
+
+	return ignore_node;
+}
+
+/* Called once topological traversal is complete.
+   Calculates probability of a source/sink connection being routable */
+void exact_traversal_done_func(int from_node_ind, int to_node_ind, t_rr_node &rr_node, const Node_Values &node_values, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
+                          e_traversal_dir traversal_dir, int max_path_weight, User_Options *user_opts, void *user_data){
+
+	Exact_Structs *exact_structs = (Exact_Structs*)user_data;
+	Exact_Frontier *frontier = exact_structs->frontier;
+
+	double elapsed = get_wall_seconds() - frontier->start_time;
+	if (frontier->failed){
+		frontier->abandoned_seconds += elapsed;
+		exact_structs->prob_routable = UNDEFINED;
+	} else {
+		frontier->num_applied++;
+		frontier->exact_seconds += elapsed;
+		frontier->max_width = max(frontier->max_width, frontier->peak_width);
+		frontier->max_states = max(frontier->max_states, frontier->peak_states);
+		exact_structs->prob_routable = (float)frontier->get_prob_reached(to_node_ind);
+	}
+}
+
+/* prints how often the exact method applied, and how long it took, summed over the specified per-thread frontiers */
+void print_exact_stats(const vector<Exact_Frontier> &frontiers){
+	int num_attempted = 0;
+	int num_applied = 0;
+	double exact_seconds = 0;
+	double abandoned_seconds = 0;
+	int max_width = 0;
+	int max_states = 0;
+	int frontier_limit = 0;
+	for (int ifrontier = 0; ifrontier < (int)frontiers.size(); ifrontier++){
+		const Exact_Frontier &frontier = frontiers[ifrontier];
+		num_attempted += frontier.num_attempted;
+		num_applied += frontier.num_applied;
+		exact_seconds += frontier.exact_seconds;
+		abandoned_seconds += frontier.abandoned_seconds;
+		max_width = max(max_width, frontier.max_width);
+		max_states = max(max_states, frontier.max_states);
+		frontier_limit = frontier.frontier_limit;
+	}
+
+	cout << "Exact reliability: applied to " << num_applied << " of " << num_attempted << " connections";
+	if (num_attempted > 0){
+		cout << " (" << 100.0 * num_applied / (double)num_attempted << "%)";
+	}
+	cout << " with a frontier limit of " << frontier_limit << endl;
+	if (num_applied > 0){
+		cout << "  avg time per exact connection: " << 1e6 * exact_seconds / (double)num_applied << " us" << endl;
+		cout << "  widest frontier: " << max_width << ", most states: " << max_states << endl;
+	}
+	if (num_attempted > num_applied){
+		cout << "  avg time per abandoned connection: " << 1e6 * abandoned_seconds / (double)(num_attempted - num_applied) << " us" << endl;
+	}
+}
+
+
+/* returns a hash of the specified state */
+static unsigned long long hash_state(const short *state_values, int width){
+	unsigned long long hash = 0xcbf29ce484222325ULL;
+	for (int icol = 0; icol < width; icol++){
+		hash ^= (unsigned short)state_values[icol];
+		hash *= 0x100000001b3ULL;
+	}
+	return hash ^ (hash >> 29);
+}
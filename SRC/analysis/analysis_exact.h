@@ -0,0 +1,113 @@
+#ifndef ANALYSIS_EXACT_H
+#define ANALYSIS_EXACT_H
+
+#include <vector>
+#include "wotan_types.h"
+
+
+/**** Defines ****/
+/* maximum number of distinct frontier states kept during a traversal. connections that need more fall back to another method */
+#define MAX_EXACT_STATES 200000
+
+/* frontier value of a node that is not reachable via available nodes (within the maximum path weight) */
+#define UNREACHED_WEIGHT 0x7fff
+
+
+/**** Classes ****/
+/* Per-thread pool for the 'exact' method. The frontier consists of the nodes that have been reached during the current traversal
+   but not yet expanded (plus the destination). A state assigns each frontier node the weight of the lightest path over
+   available nodes by which it can be reached (or UNREACHED_WEIGHT), and every distinct state is kept once, together with its
+   probability. States are interned through a unique table, so that states which become identical are merged -- this is
+   what keeps the number of states (the width of the decision diagram at the current level) small. Storage is kept across
+   connections so that it doesn't have to be reallocated */
+class Exact_Frontier{
+public:
+	int width;				/* number of frontier nodes */
+	int num_states;
+	int frontier_limit;			/* traversals whose frontier grows wider than this are abandoned */
+	bool failed;				/* set if the current traversal was abandoned */
+	int last_popped;			/* the most recently expanded node. it leaves the frontier once its children have been iterated */
+	double start_time;
+	int peak_width;				/* largest frontier and number of states during the current traversal */
+	int peak_states;
+
+	std::vector<int> node_column;		/* [0..num_nodes-1] the column of each frontier node. UNDEFINED if not on the frontier */
+	std::vector<int> column_node;		/* node index of each column */
+
+	std::vector<short> values;		/* [state*width + column] */
+	std::vector<double> probs;		/* [state] */
+
+	/* the next level is built into these, then swapped with the current one */
+	std::vector<short> next_values;
+	std::vector<double> next_probs;
+	int next_num_states;
+	std::vector<int> unique_table;		/* open-addressing hash table of next-level state indices (UNDEFINED if empty) */
+
+	/* statistics over all connections */
+	int num_attempted;
+	int num_applied;			/* connections whose exact probability was computed */
+	double exact_seconds;			/* time spent on connections to which the method applied */
+	double abandoned_seconds;		/* time spent on abandoned traversals */
+	int max_width;				/* largest frontier and number of states seen on connections to which the method applied */
+	int max_states;
+
+	Exact_Frontier();
+	void init(int num_nodes, int set_frontier_limit);
+
+	/* forgets the current traversal and starts a new one in which only the specified node is reached (via a path of weight 0) */
+	void start(int start_node_ind);
+
+	/* reached nodes join the frontier as unreached in every state */
+	int get_column(int node_ind);
+	/* removes the specified node from the frontier */
+	void drop_node(int node_ind);
+
+	/* the state operations. each builds the next level (merging identical states) and makes it current */
+	void branch_on_availability(int node_ind, double prob_blocked);
+	void propagate(int parent_ind, int child_ind, int child_weight, int max_parent_weight);
+
+	/* returns the probability that the specified frontier node is reached */
+	double get_prob_reached(int node_ind) const;
+
+private:
+	/* starts building a new level */
+	void begin_level();
+	/* adds a state to the level being built, merging it with an identical state if there is one */
+	void add_state(const short *state_values, double prob);
+	/* makes the level that was built current */
+	void end_level();
+	/* resizes the unique table to the specified (power of two) size and re-inserts the states of the level being built */
+	void rehash(int table_size);
+};
+
+/* A class used to lump together all data structures specific to the exact analysis method that
+   need to be passed around during topological traversal */
+class Exact_Structs{
+public:
+	float prob_routable;
+	Physical_Type_Descriptor *fill_type;
+	Exact_Frontier *frontier;
+
+	Exact_Structs();
+};
+
+
+/**** Function Declarations ****/
+/* Called when node is popped from expansion queue during topological traversal */
+void exact_node_popped_func(int popped_node, int from_node_ind, int to_node_ind, t_rr_node &rr_node, const Node_Values &node_values, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
+                          e_traversal_dir traversal_dir, int max_path_weight, User_Options *user_opts, void *user_data);
+
+/* Called when topological traversal is iterateing over a node's children */
+bool exact_child_iterated_func(int parent_ind, int parent_edge_ind, int node_ind, t_rr_node &rr_node, const Node_Values &node_values, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
+                          e_traversal_dir traversal_dir, int max_path_weight, int from_node_ind, int to_node_ind, User_Options *user_opts, void *user_data);
+
+/* Called once topological traversal is complete.
+   Calculates probability of a source/sink connection being routable */
+void exact_traversal_done_func(int from_node_ind, int to_node_ind, t_rr_node &rr_node, const Node_Values &node_values, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
+                          e_traversal_dir traversal_dir, int max_path_weight, User_Options *user_opts, void *user_data);
+
+/* prints how often the exact method applied, and how long it took, summed over the specified per-thread frontiers */
+void print_exact_stats(const std::vector<Exact_Frontier> &frontiers);
+
+
+#endif
@@ -6,6 +6,8 @@
 #include <set>
 #include <utility>
 #include <functional>
+#include <sstream>
+#include <fstream>
 #include <pthread.h>
 #include <malloc.h>
 #include "globals.h"
@@ -21,6 +23,20 @@
 #include "analysis_propagate.h"
 #include "analysis_cutline_simple.h"
 #include "analysis_reliability_poly.h"
+#include "analysis_monte_carlo.h"
+#include "analysis_exact.h"
+#include "analysis_cache.h"
+#include "connection_plan.h"
+#include "sensitivity_map.h"
+#include "enumerate_tiled.h"
+#include "path_weight_table.h"
+#include "tail_sampling.h"
+#include "conn_profile.h"
+#include "graph_profile.h"
+#include "traversal_trace.h"
+#include "wotan_scratch.h"
+#include "wotan_init.h"
+#include "parse_rr_structs_file.h"
 
 
 using namespace std;
@@ -33,13 +49,29 @@ using namespace std;
      - if (weight from source to sink) exceeds this then the connection simply won't be analyzed. */
 #define PATH_FLEXIBILITY_FACTOR 2.0
 
+/* Path weight calibration: number of sample connections of each length, and the range of candidate bounds relative to the
+   default bound of each length (see Analysis_Settings::get_max_path_weight) */
+#define CALIBRATION_CONNS_PER_LENGTH 24
+#define CALIBRATION_LOWEST_BOUND_FACTOR 0.25
+#define CALIBRATION_HIGHEST_BOUND_FACTOR 2.0
+
+/* Analysis cost prediction: number of sample connections of each length */
+#define PREDICTION_CONNS_PER_LENGTH 24
+
+/* Demand multiplier search: the range of multipliers searched, how close the routability metric has to get to the target, and
+   the maximum number of probes in each stage of the search */
+#define SEARCH_MULTIPLIER_HIGH 200.0
+#define SEARCH_TOLERANCE 0.02
+#define SEARCH_MAX_PROBES 20
+
+/* Simple graph analysis: the connection length and maximum path weight used for every simple graph */
+#define SIMPLE_GRAPH_CONNECTION_LENGTH 10
+#define SIMPLE_GRAPH_MAX_PATH_WEIGHT 10
+
 /* If core analysis is enabled in user options then probability analysis is only performed for blocks in the region 
    that is >= 'CORE_OFFSET' blocks away from the perimeter */
 #define CORE_OFFSET 3
 
-/* Which probability analysis mode should be used? See e_probability_mode for options */
-#define PROBABILITY_MODE PROPAGATE //CUTLINE_SIMPLE
-
 /* what percentage of worst node demands to look at? */
 //#define WORST_NODE_DEMAND_PERCENTILE 0.05
 
@@ -51,11 +83,10 @@ using namespace std;
 #define DRIVER_PROB_WEIGHT 0.5
 #define FANOUT_PROB_WEIGHT 0.0
 
-#define FRACTION_CONNS 0.1
-
 
 /************ Forward-Declarations ************/
 class Conn_Info;
+class Demand_Refinement;
 
 
 
@@ -63,26 +94,12 @@ class Conn_Info;
 /* specified a mode for topological graph traversal */
 enum e_topological_mode{
 	ENUMERATE = 0,		/* enumerates paths through each node */
-	PROBABILITY		/* calculate probability of reaching the destination node based on already-calculated node demands */
-};
-
-/* specifies mode of probability analysis to do								//TODO: outdated comment
-   PROPAGATE: probabilities are propagated from source to sink using bucket structures.
-   	Can estimate probabilities of reaching a node by looking at the probabilities of reaching
-	that node's parents (and so forth)
-   CUTLINE: probability of reaching sink is analyzed by looking at probabilities along different
-   	levels of a topological traversal through a graph (i.e. can't reach sink if an entire level
-	is unavailable for routing) */
-enum e_probability_mode{
-	PROPAGATE = 0,
-	CUTLINE,
-	CUTLINE_SIMPLE,
-	CUTLINE_RECURSIVE,
-	RELIABILITY_POLYNOMIAL
+	PROBABILITY,		/* calculate probability of reaching the destination node based on already-calculated node demands */
+	SENSITIVITY,		/* repeat probability analysis, back-propagating the routability metric to the demands of traversed nodes */
+	REFINE			/* re-enumerates paths of the connections affected by node weight changes since the previous pass */
 };
 
 
-
 /************ Typedefs ************/
 /* a t_ss_distances structure for each thread */
 typedef vector< t_ss_distances > t_thread_ss_distances;
@@ -94,6 +111,8 @@ typedef vector< int > t_nodes_visited;
 typedef vector< t_nodes_visited > t_thread_nodes_visited;
 /* contains pthread info for each thread */
 typedef vector< pthread_t > t_threads;
+/* a block of scratch memory for each thread */
+typedef vector< Scratch_Region* > t_thread_scratch;
 
 /* A structure that is used to break cycles during topological traversal. Objects of the
    Node_Waiting class are put on this sorted structure, and if the traditional expansion queue 
@@ -106,25 +125,28 @@ typedef My_Fixed_Size_PQ< float, less<float> > t_lowest_probs_pq;
 
 /* for each thread, a structure that defines the enumeration problem for said thread */
 typedef vector< Conn_Info > t_thread_conn_info;
+/* a propagate tape for each thread */
+typedef vector< Propagate_Tape > t_thread_tapes;
+/* a cache of enumeration templates for each thread */
+typedef vector< Enumerate_Template_Cache > t_thread_template_caches;
+/* monte carlo trial storage for each thread */
+typedef vector< Monte_Carlo_Lanes > t_thread_monte_carlo_lanes;
+/* exact reliability frontier for each thread */
+typedef vector< Exact_Frontier > t_thread_exact_frontiers;
+/* a connection cost profile for each thread */
+typedef vector< Conn_Profile > t_thread_conn_profiles;
 
 
 
 /************ Classes ************/
 
-/* contains the node indices of a source/sink pair for which a connection should be analyzed */
-class Source_Sink_Pair{
-public:
-	int source_ind;
-	int sink_ind;
-	int ss_length;		//TODO this and below variable should be computed in "enumerate_paths_from_source". but i was lazy here so i'm wasting memory
-	int source_conns_at_length;
-};
-
 /* used for multithreading of path enumeration / probability analysis.
    defines the problem parameters for each thread */
 class Conn_Info{
 public:
-	vector<Source_Sink_Pair> source_sink_pairs;
+	const Connection_Plan *connection_plan;
+	vector<int> plan_sources;	/* indices of the planned sources whose connections this thread analyzes */
+	int num_conns;			/* total number of connections planned from those sources */
 	User_Options *user_opts;
 	Analysis_Settings *analysis_settings;
 	Arch_Structs *arch_structs;
@@ -133,8 +155,112 @@ public:
 	t_node_topo_inf *node_topo_inf;
 	t_nodes_visited *nodes_visited;
 	e_topological_mode topological_mode;
+	Propagate_Tape *tape;		/* connections are recorded onto this tape during the SENSITIVITY phase. NULL otherwise */
+	Enumerate_Template_Cache *template_cache;	/* used by the tiled enumerate engine during the ENUMERATE phase. NULL otherwise */
+	const t_tile_signatures *tile_signatures;
+	Monte_Carlo_Lanes *monte_carlo_lanes;	/* used during the PROBABILITY phase by the monte carlo mode and for validating estimators. NULL otherwise */
+	Exact_Frontier *exact_frontier;		/* used during the PROBABILITY phase by the exact mode and for validating estimators. NULL otherwise */
+	Demand_Refinement *demand_refinement;	/* per-connection demand contributions. used during the ENUMERATE and REFINE phases if demand is
+						   refined over several passes. NULL otherwise */
+	Tail_Sampler *tail_sampler;		/* picks the connections evaluated during the PROBABILITY phase if tail sampling is on. NULL otherwise */
+	Conn_Profile *conn_profile;		/* the cost of every analyzed connection is recorded here if the user asked for a profile. NULL otherwise */
+
+	int thread_ind;			/* index of this thread */
+	int num_threads;		/* total number of analysis threads */
+	int conns_per_epoch;		/* number of connections this thread analyzes between node weight snapshots */
+	int num_epochs;			/* number of weight epochs in this phase. identical for all threads -- they synchronize at the end of each */
+};
+
+
+/* keeps what each planned connection contributed during path enumeration, so that the connection can later be re-enumerated
+   in isolation: the demand it added to each node and the nodes its distance searches visited (a superset of its legal subgraph).
+   a connection's enumeration only depends on the weights of the visited nodes -- if none of them changed, neither would its demand */
+class Demand_Refinement{
+public:
+	vector< t_demand_record > demand_records;	/* [0..num_planned_conns-1] */
+	vector< vector<int> > subgraphs;		/* [0..num_planned_conns-1] */
+	vector<char> conn_affected;			/* [0..num_planned_conns-1] whether a connection is to be re-enumerated in the REFINE phase */
+
+	void init(int num_conns){
+		this->demand_records.assign(num_conns, t_demand_record());
+		this->subgraphs.assign(num_conns, vector<int>());
+		this->conn_affected.assign(num_conns, 0);
+	}
+	void clear(){
+		vector< t_demand_record >().swap(this->demand_records);
+		vector< vector<int> >().swap(this->subgraphs);
+		vector<char>().swap(this->conn_affected);
+	}
+};
+
+
+/* node structures for analyzing simple graphs. a thread working through a batch of simple graphs keeps one of these and
+   reuses it for every graph, only growing it when a graph has more nodes than it was sized for. the structures are left
+   clean after each graph */
+class Simple_Graph_Scratch{
+private:
+	/* owns its bucket storage and can't be copied */
+	Simple_Graph_Scratch(const Simple_Graph_Scratch&);
+	Simple_Graph_Scratch& operator=(const Simple_Graph_Scratch&);
+public:
+	int num_nodes;				/* number of nodes the structures are sized for */
+	t_ss_distances ss_distances;
+	t_node_topo_inf node_topo_inf;
+	t_nodes_visited nodes_visited;
+	t_thread_scratch bucket_storage;	/* source/sink buckets of all nodes */
+	Monte_Carlo_Lanes monte_carlo_lanes;
+	Exact_Frontier exact_frontier;
+
+	Simple_Graph_Scratch();
+	~Simple_Graph_Scratch();
+
+	/* grows the node structures to accommodate a graph with the specified number of nodes */
+	void reserve(int num_graph_nodes);
 };
 
+/* a batch of simple graphs that is being analyzed by several threads */
+class Simple_Batch{
+public:
+	const vector<Simple_Graph_Location> *graphs;
+	User_Options *user_opts;
+	Analysis_Settings *analysis_settings;
+	Arch_Structs *arch_structs;
+
+	pthread_mutex_t mutex;		/* protects the variables below */
+	int next_graph;			/* index of the next graph to be handed out to a thread */
+	int num_failed;			/* number of graphs that couldn't be analyzed */
+	ofstream *results_file;
+};
+
+
+/* a connection analyzed in the monte carlo probability mode */
+class Monte_Carlo_Sample{
+public:
+	int length;
+	e_pin_type pin_type;
+	float prob;			/* estimated probability of routing the connection */
+	float push_value;		/* the value pushed onto the worst-connection priority queues */
+	int num_pushes;
+	double increment_variance;	/* variance of the connection's (scaled) probability increment */
+};
+
+/* error of an analytic probability estimator w.r.t. the monte carlo estimate, summed over connections */
+class Estimator_Error{
+public:
+	int num_conns;
+	double sum_error;
+	double sum_abs_error;
+	double sum_squared_error;
+	int num_outside_interval;	/* connections for which the error lies outside the 95% confidence interval of the monte carlo estimate */
+
+	Estimator_Error(){
+		this->num_conns = 0;
+		this->sum_error = 0;
+		this->sum_abs_error = 0;
+		this->sum_squared_error = 0;
+		this->num_outside_interval = 0;
+	}
+};
 
 /* Contains path enumeration & probability analysis results */
 class Analysis_Results{
@@ -158,11 +284,29 @@ public:
 	vector< t_lowest_probs_pq > lowest_probs_pqs_drivers;	/* for paths enumerated from drivers (i.e. regular sources + opins) */
 	vector< t_lowest_probs_pq > lowest_probs_pqs_fanout;	/* for paths enumerated for fanout purposes (via virtual sources */
 
+	/* [0..max_conn_length] largest value that made it into the above priority queues at each length (UNDEFINED if none did).
+	   recorded at the end of probability analysis for the sensitivity phase, which treats the set of worst connections as fixed */
+	vector<float> worst_probs_cutoff_drivers;
+	vector<float> worst_probs_cutoff_fanout;
+	/* derivative of the routability metric w.r.t. the (scaled) probability of a connection among the worst ones */
+	double driver_metric_scale;
+	double fanout_metric_scale;
+
+	/* [0..num_nodes-1] derivative of the routability metric w.r.t. the demand of each node (computed in the sensitivity phase) */
+	vector<double> node_sensitivity;
+
+	/* every connection analyzed in the monte carlo probability mode (used to compute confidence intervals) */
+	vector<Monte_Carlo_Sample> monte_carlo_samples;
+	/* [0..NUM_VALIDATED_MODES-1][0..max_conn_length] error of each analytic estimator at each connection length (if estimators are validated) */
+	vector< vector<Estimator_Error> > estimator_errors;
+
 
 	/* total number of connections that we WANT to analyze */
 	int desired_conns;
 	/* total number of connections that we ACTUALLY analyzed (maybe some connections were unroutable so we just couldn't enumerate paths from them, etc) */
 	int num_conns;
+	/* number of connections whose path searches were skipped because their reach label put the sink out of reach */
+	int num_skipped_searches;
 
 	/* constructor to initialize constituent variables to 0 */
 	Analysis_Results(){
@@ -171,8 +315,11 @@ public:
 		this->max_possible_total_prob_fanout = 0;
 		this->total_prob_drivers = 0;
 		this->total_prob_fanout = 0;
+		this->driver_metric_scale = 0;
+		this->fanout_metric_scale = 0;
 		this->desired_conns = 0;
 		this->num_conns = 0;
+		this->num_skipped_searches = 0;
 	}
 };
 
@@ -182,6 +329,18 @@ public:
    It can be written to by different threads with the help of the thread_mutex member variable */
 static Analysis_Results f_analysis_results = Analysis_Results();
 
+/* per-connection contributions kept while node demands are refined over several enumeration passes */
+static Demand_Refinement f_demand_refinement;
+
+/* picks and weighs the connections evaluated during probability analysis if the user asked for tail sampling */
+static Tail_Sampler f_tail_sampler;
+
+/* the analytic probability modes that are compared against the monte carlo mode when validating estimators. the reliability
+   polynomial mode is left out since it increments node demands as it goes. the exact mode is only compared on connections to
+   which it applies */
+#define NUM_VALIDATED_MODES 5
+static const e_probability_mode f_validated_modes[NUM_VALIDATED_MODES] = {PROPAGATE, CUTLINE, CUTLINE_SIMPLE, CUTLINE_RECURSIVE, EXACT};
+
 
 /************ Function Declarations ************/
 /* performs routability analysis on an FPGA architecture */
@@ -192,13 +351,25 @@ static void analyze_fpga_architecture(User_Options *user_opts, Analysis_Settings
 static void analyze_simple_graph(User_Options *user_opts, Analysis_Settings *analysis_settings, Arch_Structs *arch_structs, 
 			Routing_Structs *routing_structs);
 
+/* throws an exception if the user options ask for something that simple graph analysis doesn't support */
+static void check_simple_graph_settings(User_Options *user_opts);
+
+/* enumerates paths between the source and the sink of a simple graph and returns the probability of routing from one to the other.
+   the node structures of 'scratch' are grown to the size of the graph if necessary, and left clean for the next graph */
+static float analyze_simple_graph_connection(User_Options *user_opts, Analysis_Settings *analysis_settings, Arch_Structs *arch_structs,
+			Routing_Structs *routing_structs, Simple_Graph_Scratch &scratch, bool print_demands, int *source_node_ind, int *sink_node_ind);
+
+/* analyzes each graph of a batch of simple graphs (see the -simple_batch option). graphs are handed out to the analysis threads
+   one at a time, and the result of each graph is appended to the results file as soon as it is known */
+static void analyze_simple_graph_batch(User_Options *user_opts, Analysis_Settings *analysis_settings, Arch_Structs *arch_structs);
+
+/* thread function for analyzing a batch of simple graphs. takes graphs off the batch until there are none left */
+static void* analyze_simple_graphs_from_batch( void *ptr );
+
 /* enumerates paths from test tiles */
 float analyze_test_tile_connections(User_Options *user_opts, Analysis_Settings *analysis_settings, Arch_Structs *arch_structs, 
-			Routing_Structs *routing_structs, e_topological_mode topological_mode);
+			Routing_Structs *routing_structs, const Connection_Plan &connection_plan, e_topological_mode topological_mode);
 
-/* fills an initially-empty vector with the sink indices to which the source at the specified tile coordinate should connect */
-static void get_corresponding_sink_ids(User_Options *user_opts, Analysis_Settings *analysis_settings, Arch_Structs *arch_structs, Routing_Structs *routing_structs,
-		int source_node_ind, Coordinate tile_coord, vector<int> &sink_indices, vector<int> &ss_length, vector<int> &source_conns_at_length);
 
 /* launched the specified number of threads to perform path enumeration */
 void launch_pthreads(t_thread_conn_info &thread_conn_info, t_threads &threads, int num_threads);
@@ -206,11 +377,20 @@ void launch_pthreads(t_thread_conn_info &thread_conn_info, t_threads &threads, i
 /* enumerate paths from specified node at specified tile.  */
 void* enumerate_paths_from_source( void *ptr );
 
+/* called by every analysis thread at the end of a weight epoch. once all threads arrive, they jointly re-freeze node weights
+   and demands, and wait for the new snapshot to be complete before continuing */
+static void advance_weight_epoch(Conn_Info *conn_info);
+
 /* allocates source/sink distance vector for each thread */
 void alloc_thread_ss_distances(t_thread_ss_distances &thread_ss_distances, int num_threads, int num_nodes);
 
-/* allocates node topological traversal info vector for each thread */
-void alloc_thread_node_topo_inf(t_thread_node_topo_inf &thread_node_topo_inf, int num_threads, int max_path_weight_bound, t_rr_node &rr_node, int num_nodes);
+/* allocates node topological traversal info vector for each thread. the node buckets of each thread are placed in one contiguous
+   block of scratch memory (file-backed in out-of-core mode) */
+void alloc_thread_node_topo_inf(t_thread_node_topo_inf &thread_node_topo_inf, t_thread_scratch &thread_bucket_storage, int num_threads,
+				int max_path_weight_bound, t_rr_node &rr_node, int num_nodes);
+
+/* frees the scratch memory blocks of each thread */
+void free_thread_scratch(t_thread_scratch &thread_scratch);
 
 /* allocated any structures needed to keep track of self-congestion effects */
 void alloc_self_congestion_structs(User_Options *user_opts, Routing_Structs *routing_structs, Arch_Structs *arch_structs,
@@ -230,22 +410,71 @@ void alloc_threads( t_threads &threads, int num_threads );
    metrics as necessary */
 static void analyze_connection(int source_node_ind, int sink_node_ind, Analysis_Settings *analysis_settings, Arch_Structs *arch_structs,
 			Routing_Structs *routing_structs, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, int conn_length,
-			int number_conns_at_length, t_nodes_visited &nodes_visited, e_topological_mode topological_mode, User_Options *user_opts);
+			int number_conns_at_length, t_nodes_visited &nodes_visited, e_topological_mode topological_mode, User_Options *user_opts,
+			Conn_Info *conn_info, int plan_conn_ind);
+
+/* repeats path enumeration with node weights frozen from the previous pass until the weights reach a fixed point (or the maximum
+   number of passes is reached). returns the normalized demand after the last pass */
+static float refine_enumerated_demand(User_Options *user_opts, Analysis_Settings *analysis_settings, Arch_Structs *arch_structs,
+			Routing_Structs *routing_structs, const Connection_Plan &connection_plan, float normalized_demand);
+
+/* searches for the demand multiplier at which the routability metric meets the user's target reliability, and sets it in the
+   user options. node demands are left as enumerated under the final multiplier */
+static void search_demand_multiplier(User_Options *user_opts, Analysis_Settings *analysis_settings, Arch_Structs *arch_structs,
+			Routing_Structs *routing_structs, const Connection_Plan &connection_plan);
+
+/* enumerates node demands from scratch under the specified demand multiplier and returns the resulting routability metric */
+static float probe_demand_multiplier(User_Options *user_opts, Analysis_Settings *analysis_settings, Arch_Structs *arch_structs,
+			Routing_Structs *routing_structs, const Connection_Plan &connection_plan, float demand_multiplier);
+
+/* calibrates the maximum path weight of each connection length. a sample of connections of each length is enumerated, and its
+   routing probability estimated, under a range of bounds. the smallest bound from which on the mean errors w.r.t. the largest
+   bound stay within the user's tolerance goes into the path weight table of the analysis settings. node demands are left cleared */
+static void calibrate_path_weight_bounds(User_Options *user_opts, Analysis_Settings *analysis_settings, Arch_Structs *arch_structs,
+			Routing_Structs *routing_structs, const Connection_Plan &connection_plan);
+
+/* predicts the time taken by path enumeration and probability analysis under the user's options from a sample of the planned
+   connections of each length, and estimates the memory taken by each analysis thread. node demands are left cleared */
+static void predict_analysis_cost(User_Options *user_opts, Analysis_Settings *analysis_settings, Arch_Structs *arch_structs,
+			Routing_Structs *routing_structs, const Connection_Plan &connection_plan);
+
+/* captures the workloads of the enumerate and propagate kernels for a sample of the planned connections, under the node values
+   left by the analysis, and writes them to the user's trace file */
+static void capture_traversal_traces(User_Options *user_opts, Analysis_Settings *analysis_settings, Arch_Structs *arch_structs,
+			Routing_Structs *routing_structs, const Connection_Plan &connection_plan);
+
+/* Enumerates paths between specified source/sink nodes. returns false if no paths could be enumerated.
+   if a demand record is specified, the demand contributed to each node is also recorded there */
+bool enumerate_connection_paths(int source_node_ind, int sink_node_ind, Analysis_Settings *analysis_settings, Arch_Structs *arch_structs,
+			Routing_Structs *routing_structs, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, int conn_length,
+			t_nodes_visited &nodes_visited, User_Options *user_opts, float scaling_factor_for_enumerate, t_demand_record *demand_record);
 
-/* Enumerates paths between specified source/sink nodes. */
-void enumerate_connection_paths(int source_node_ind, int sink_node_ind, Analysis_Settings *analysis_settings, Arch_Structs *arch_structs,
+/* enumerates paths between specified source/sink nodes with the tiled engine: demand recorded for an equivalent connection
+   is replayed if possible, otherwise the connection is enumerated and recorded as a new template */
+static void enumerate_connection_paths_tiled(int source_node_ind, int sink_node_ind, Analysis_Settings *analysis_settings, Arch_Structs *arch_structs,
 			Routing_Structs *routing_structs, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, int conn_length,
-			t_nodes_visited &nodes_visited, User_Options *user_opts, float scaling_factor_for_enumerate);
+			t_nodes_visited &nodes_visited, User_Options *user_opts, float scaling_factor_for_enumerate,
+			Enumerate_Template_Cache *template_cache, const t_tile_signatures &tile_signatures);
 
-/* Estimates the likelyhood (based on node demands) that the specified source/sink connection can be routed */
+/* Estimates the likelyhood (based on node demands) that the specified source/sink connection can be routed using the specified
+   probability mode. if a tape is specified, the probability analysis is recorded onto it. the monte carlo mode requires trial lanes,
+   and the exact mode a frontier */
 float estimate_connection_probability(int source_node_ind, int sink_node_ind, Analysis_Settings *analysis_settings, Arch_Structs *arch_structs,
 			Routing_Structs *routing_structs, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, int conn_length,
-			t_nodes_visited &nodes_visited, User_Options *user_opts);
+			t_nodes_visited &nodes_visited, User_Options *user_opts, e_probability_mode probability_mode, Propagate_Tape *tape,
+			Monte_Carlo_Lanes *monte_carlo_lanes, Exact_Frontier *exact_frontier);
+
+/* estimates the probability of the specified connection with the monte carlo mode and with each of the validated analytic modes,
+   and records the error of each analytic mode. node data structures are cleaned before every estimate */
+static void validate_connection_estimators(int source_node_ind, int sink_node_ind, Analysis_Settings *analysis_settings, Arch_Structs *arch_structs,
+			Routing_Structs *routing_structs, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, int conn_length,
+			t_nodes_visited &nodes_visited, User_Options *user_opts, Monte_Carlo_Lanes *monte_carlo_lanes,
+			Exact_Frontier *exact_frontier);
 
 /* fills the t_ss_distances structures according to source & sink distances to intermediate nodes. 
    also returns an adjusted maximum path weight (to be further passed on to path enumeration / probability analysis functions)
    based on the distance from the source to the sink */
-bool get_ss_distances_and_adjust_max_path_weight(int source_node_ind, int sink_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances,
+bool get_ss_distances_and_adjust_max_path_weight(int source_node_ind, int sink_node_ind, t_rr_node &rr_node, const Node_Values &node_values, t_ss_distances &ss_distances,
                                 int max_path_weight, t_nodes_visited &nodes_visited, int *adjusted_max_path_weight, int *source_sink_dist);
 
 /* adjusts maximum path weight based on the minimum distance of the current source/sink pair.
@@ -255,34 +484,32 @@ int adjust_max_path_weight_based_on_ss_dist(int min_dist_sink, int current_max_p
 
 /* traverses graph from 'from_node_ind' and for each node traversed, sets distance to the source/sink node from
    which the traversal started (based on traversal_dir) */
-void set_node_distances(int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances,
+void set_node_distances(int from_node_ind, int to_node_ind, t_rr_node &rr_node, const Node_Values &node_values, t_ss_distances &ss_distances,
 			int max_path_weight, e_traversal_dir traversal_dir, t_nodes_visited &nodes_visited);
 
 /* enqueues nodes belonging to specified edge list onto the bonded priority queue. the weight of the 
    enqueued nodes will be base_weight + their own weight */
 void put_children_on_pq_and_set_ss_distance(int num_edges, int *edge_list, int base_weight, t_ss_distances &ss_distances,
-			int max_path_weight, e_traversal_dir traversal_dir, t_rr_node &rr_node, int to_node_ind, My_Bounded_Priority_Queue<int> *PQ);
+			int max_path_weight, e_traversal_dir traversal_dir, t_rr_node &rr_node, const Node_Values &node_values, int to_node_ind, My_Bounded_Priority_Queue<int> *PQ);
 
 /* returns whether or not the specified node has a chance to reach the specified destination node */
 bool node_has_chance_to_reach_destination(int node_ind, int destx, int desty, int node_path_weight, int max_path_weight, t_rr_node &rr_node);
 
-/* does BFS over legal subraph from the 'from' node to the 'to' node and sets minimum number of hops
-   required to arrive at each legal node from the 'from' node */
-void set_node_hops(int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances,
-			int max_path_weight, e_traversal_dir traversal_dir);
+/* does BFS over the legal subgraph and sets the minimum number of hops required to arrive at each legal node from the source
+   node (along forward edges) and from the sink node (along reverse edges). both searches share one frontier */
+void set_node_hops(int source_node_ind, int sink_node_ind, t_rr_node &rr_node, const Node_Values &node_values, t_ss_distances &ss_distances,
+			int max_path_weight);
 
-/* resets data structures associated with nodes that have been visited during the previous path traversals */
-void clean_node_data_structs(t_nodes_visited &nodes_visited, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, int max_path_weight);
+/* resets data structures associated with nodes that have been visited during the previous path traversals. returns the number
+   of nodes that were reached by topological traversals (the legal subgraph of the traversed connection) */
+int clean_node_data_structs(t_nodes_visited &nodes_visited, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, int max_path_weight);
 
 /* clears ss_distances structure according to nodes that have been visited during graph traversal */
 void clean_ss_distances(t_ss_distances &ss_distances, t_nodes_visited &nodes_visited);
 
-/* clears node_buckets structure according to nodes that have been visited during graph traversal */
-void clean_node_topo_inf(t_node_topo_inf &node_topo_inf, t_nodes_visited &nodes_visited, int max_path_weight);
-
-/* returns the sum of pin probabilities over all the pins that the specified source node represents */
-void get_sum_of_source_probabilities(int source_node_ind, t_rr_node &rr_node, t_prob_list &pin_probs,
-				Physical_Type_Descriptor &fill_block_type, float *sum_probabilities, float *one_pin_prob);
+/* clears node_buckets structure according to nodes that have been visited during graph traversal. returns the number of nodes
+   that were reached by topological traversals */
+int clean_node_topo_inf(t_node_topo_inf &node_topo_inf, t_nodes_visited &nodes_visited, int max_path_weight);
 
 /* returns number of sinks corresponding to the specified super-sink node */
 int get_num_sinks(int sink_node_ind, t_rr_node &rr_node, Physical_Type_Descriptor &fill_block_type);
@@ -296,16 +523,23 @@ void increment_probability_metric(float probability_increment, int connection_le
 static int get_num_routing_nodes(t_rr_node &rr_node);
 /* returns a 'reachability' metric based on routing node demands */
 static float node_demand_metric(User_Options *user_opts, t_rr_node &rr_node);
-/* returns from_x/to_x/from_y/to_y iteration limits of a 'core' FPGA region, according to CORE_OFFSET */
-static void get_prob_analysis_tile_region(User_Options *user_opts, int grid_size_x, int grid_size_y, int *from_x, int *from_y, int *to_x, int *to_y);
-/* currently returns the total number of connections at each connection length <= maximum connection length */
-static void get_conn_length_stats(User_Options *user_opts, Analysis_Settings *analysis_settings, Routing_Structs *routing_structs, 
-                        Arch_Structs *arch_structs, e_pin_type enumerate_type, vector<int> &conns_at_length);
-/* returns number of connections from tile at the specified coordinates at specified length */
-static int conns_at_distance_from_tile(int tile_x, int tile_y, int length, t_grid &grid, 
-				int grid_size_x, int grid_size_y, t_block_type &block_type, int fill_type_ind);
 /* at each length, sums the probabilities of the x% worst possible connections */
 static float analyze_lowest_probs_pqs( vector< t_lowest_probs_pq > &lowest_probs_pqs);
+/* returns a string describing the compile-time analysis settings (these are part of the key under which results are cached) */
+static string get_analysis_signature(Analysis_Settings *analysis_settings);
+/* restores node demands & demand multiplier from a cached result and prints the cached metrics */
+static void apply_cached_result(Cached_Result &cached_result, User_Options *user_opts, Routing_Structs *routing_structs);
+/* records the cutoff values of the worst-connection priority queues (before they are consumed by analyze_lowest_probs_pqs) */
+static void record_worst_probs_cutoffs(vector<t_lowest_probs_pq> &lowest_probs_pqs, vector<float> &cutoffs);
+/* prints 95% confidence intervals of the mean connection probability at each length and of the routability metric, based on
+   the connections analyzed in the monte carlo mode */
+static void print_monte_carlo_confidence(User_Options *user_opts, float routability_metric);
+/* prints the estimated tail sums at each length and the confidence interval of the routability metric as estimated by tail sampling */
+static void print_tail_sampling_confidence(const Tail_Estimate &driver_estimate, const Tail_Estimate &fanout_estimate, float routability_metric);
+/* prints the error of each validated estimator at each connection length */
+static void print_estimator_validation(User_Options *user_opts);
+/* returns a name for the specified analysis phase, for use in printouts */
+static string get_phase_name(e_topological_mode topological_mode, User_Options *user_opts);
 
 
 /************ Function Definitions ************/
@@ -313,6 +547,12 @@ static float analyze_lowest_probs_pqs( vector< t_lowest_probs_pq > &lowest_probs
 void run_analysis(User_Options *user_opts, Analysis_Settings *analysis_settings, Arch_Structs *arch_structs, 
 			Routing_Structs *routing_structs){
 
+	/* kernels can be replayed on captured traces without a routing graph */
+	if (!user_opts->replay_traces_file.empty()){
+		replay_traversal_traces(user_opts->replay_traces_file, user_opts);
+		return;
+	}
+
 	switch( user_opts->rr_structs_mode ){
 		case RR_STRUCTS_VPR:
 			analyze_fpga_architecture(user_opts, analysis_settings, arch_structs, routing_structs);
@@ -323,71 +563,871 @@ void run_analysis(User_Options *user_opts, Analysis_Settings *analysis_settings,
 		default:
 			WTHROW(EX_PATH_ENUM, "Encountered unrecognized rr_structs_mode: " << user_opts->rr_structs_mode); 
 	}
+
+	if (scratch_enabled()){
+		print_scratch_stats();
+	}
 }
 
 /* performs routability analysis on an FPGA architecture */
 static void analyze_fpga_architecture(User_Options *user_opts, Analysis_Settings *analysis_settings, Arch_Structs *arch_structs, 
 			Routing_Structs *routing_structs){
 
+	/* maximum path weights may have been calibrated by an earlier run on the same architecture family */
+	string architecture_family = "";
+	if (!user_opts->path_weight_table_file.empty()){
+		architecture_family = get_architecture_family(arch_structs, routing_structs);
+		if (user_opts->path_weight_tolerance == UNDEFINED &&
+		    read_path_weight_table(user_opts->path_weight_table_file, architecture_family, &analysis_settings->max_path_weight_table)){
+			cout << "Read maximum path weights from " << user_opts->path_weight_table_file << endl;
+		}
+	}
+
+	/* the user may only want to know what an analysis would cost */
+	if (user_opts->profile_graph){
+		print_graph_profile(arch_structs, routing_structs);
+
+		Connection_Plan connection_plan;
+		build_connection_plan(user_opts, analysis_settings, arch_structs, routing_structs, &connection_plan);
+		predict_analysis_cost(user_opts, analysis_settings, arch_structs, routing_structs, connection_plan);
+		return;
+	}
+
+	/* an identical graph may have been analyzed with identical options before -- check the result cache */
+	string cache_key = get_result_cache_key(user_opts, get_analysis_signature(analysis_settings));
+	Cached_Result cached_result;
+	/* a cached result doesn't include the sensitivity map, so the analysis has to be redone if one was asked for. nor can a
+	   calibration be looked up before it is done */
+	if (!cache_key.empty() && !user_opts->cache_bypass && user_opts->sensitivity_map_file.empty() && user_opts->path_weight_tolerance == UNDEFINED){
+		if (lookup_cached_result(user_opts, cache_key, &cached_result)){
+			cout << "Found cached result " << cache_key << " in " << user_opts->cache_dir << endl;
+			apply_cached_result(cached_result, user_opts, routing_structs);
+			update_screen(routing_structs, arch_structs, user_opts);
+			return;
+		}
+	}
+
+	/* the connections to be analyzed are sampled once and shared by all phases */
+	Connection_Plan connection_plan;
+	build_connection_plan(user_opts, analysis_settings, arch_structs, routing_structs, &connection_plan);
+
+	if (user_opts->path_weight_tolerance != UNDEFINED){
+		calibrate_path_weight_bounds(user_opts, analysis_settings, arch_structs, routing_structs, connection_plan);
+		if (!user_opts->path_weight_table_file.empty()){
+			write_path_weight_table(user_opts->path_weight_table_file, architecture_family, user_opts->path_weight_tolerance,
+			                        analysis_settings->max_path_weight_table);
+			cout << "Wrote maximum path weights to " << user_opts->path_weight_table_file << endl << endl;
+		}
+		cache_key = get_result_cache_key(user_opts, get_analysis_signature(analysis_settings));
+	}
+
 	if (user_opts->target_reliability == UNDEFINED){
-		analyze_test_tile_connections(user_opts, analysis_settings, arch_structs, routing_structs, ENUMERATE);
-		analyze_test_tile_connections(user_opts, analysis_settings, arch_structs, routing_structs, PROBABILITY);
+		if (user_opts->demand_iterations > 1){
+			f_demand_refinement.init((int)connection_plan.conns.size());
+		}
+		float normalized_demand = analyze_test_tile_connections(user_opts, analysis_settings, arch_structs, routing_structs, connection_plan, ENUMERATE);
+		if (user_opts->demand_iterations > 1){
+			normalized_demand = refine_enumerated_demand(user_opts, analysis_settings, arch_structs, routing_structs, connection_plan, normalized_demand);
+			f_demand_refinement.clear();
+		}
+		float routability_metric = analyze_test_tile_connections(user_opts, analysis_settings, arch_structs, routing_structs, connection_plan, PROBABILITY);
+
+		cached_result.add_metric("Normalized CHANX/CHANY demand", normalized_demand);
+		cached_result.add_metric("Routability metric", routability_metric);
+
+		if (!user_opts->sensitivity_map_file.empty()){
+			analyze_test_tile_connections(user_opts, analysis_settings, arch_structs, routing_structs, connection_plan, SENSITIVITY);
+			write_sensitivity_map(user_opts, arch_structs, routing_structs, f_analysis_results.node_sensitivity);
+		}
 	} else {
-		//XXX: binary search doesn't actually work right now. Seems to be bugged out right now. Probably some structures aren't being reset.
-		/* perform a binary search to find the demand_multiplier value required to achieve the target level of reliability */
-		int max_tries = 20;
-		float target_tolerance = 0.02;
-		float multiplier_high = 200.0;
-		float multiplier_low = 0.0;
+		search_demand_multiplier(user_opts, analysis_settings, arch_structs, routing_structs, connection_plan);
+		cout << endl;
+		cout << "Required demand multiplier: " << user_opts->demand_multiplier << endl;
+		cout << "Absolute routability metric: " << 1.0/user_opts->demand_multiplier << endl;
+
+		cached_result.add_metric("Required demand multiplier", user_opts->demand_multiplier);
+		cached_result.add_metric("Absolute routability metric", 1.0/user_opts->demand_multiplier);
+	}
+
+	/* save final metrics and node demands so that later runs with the same graph & options can reuse them */
+	if (!cache_key.empty()){
+		t_rr_node &rr_node = routing_structs->rr_node;
+		int num_nodes = routing_structs->get_num_rr_nodes();
+
+		cached_result.demand_multiplier = user_opts->demand_multiplier;
+		cached_result.node_demands.assign(num_nodes, 0.0);
+		for (int inode = 0; inode < num_nodes; inode++){
+			cached_result.node_demands[inode] = rr_node[inode].get_demand(NULL);
+		}
+		store_cached_result(user_opts, cache_key, cached_result);
+	}
+
+	if (user_opts->num_captured_traces != UNDEFINED){
+		capture_traversal_traces(user_opts, analysis_settings, arch_structs, routing_structs, connection_plan);
+	}
+
+	update_screen(routing_structs, arch_structs, user_opts);
+}
+
+/* searches for the demand multiplier at which the routability metric meets the user's target reliability, and sets it in the
+   user options. node demands are left as enumerated under the final multiplier.
+   Early probes only need to tell on which side of the target a multiplier lies, so the search first brackets the target with
+   cheap proxy probes: a plan of connections no longer than the user's proxy length (which is also a much smaller sample),
+   analyzed with the cutline_simple estimator. The proxy's multiplier is biased (it leaves out the longer connections, and its
+   estimator is pessimistic), but the routability metric falls off with the log of the multiplier at a similar rate. So the
+   full-fidelity probes start at the proxy's multiplier and take secant steps in log(multiplier), the first one with the slope
+   of the last two proxy probes. A step that would leave the bracket established by the full probes, or that follows a step which
+   didn't halve the bracket, is replaced by (geometric) bisection */
+static void search_demand_multiplier(User_Options *user_opts, Analysis_Settings *analysis_settings, Arch_Structs *arch_structs,
+			Routing_Structs *routing_structs, const Connection_Plan &connection_plan){
+
+	float target = user_opts->target_reliability;
+	bool use_proxy = (user_opts->search_proxy_length > 0);
+
+	/* bracket the target with proxy probes */
+	float proxy_multiplier = SEARCH_MULTIPLIER_HIGH / 2;
+	float proxy_slope = 0;			/* change of the proxy's metric with log(multiplier) near the proxy's multiplier */
+	int num_proxy_probes = 0;
+	if (use_proxy){
+		User_Options proxy_opts = (*user_opts);
+		proxy_opts.max_connection_length = min(user_opts->max_connection_length, user_opts->search_proxy_length);
+		/* path dependence can only be analyzed by propagating probabilities */
+		if (user_opts->self_congestion_mode != MODE_PATH_DEPENDENCE){
+			proxy_opts.probability_mode = CUTLINE_SIMPLE;
+		}
+
+		Connection_Plan proxy_plan;
+		build_connection_plan(&proxy_opts, analysis_settings, arch_structs, routing_structs, &proxy_plan);
+
+		float low = 0;
+		float high = SEARCH_MULTIPLIER_HIGH;
 		float reliability = -1;
+		float prev_multiplier = UNDEFINED;
+		float prev_reliability = UNDEFINED;
+		while (abs(reliability - target) > SEARCH_TOLERANCE && num_proxy_probes < SEARCH_MAX_PROBES){
+			if (num_proxy_probes > 0){
+				prev_multiplier = proxy_multiplier;
+				prev_reliability = reliability;
+			}
+			proxy_multiplier = (low + high) / 2;
+			reliability = probe_demand_multiplier(&proxy_opts, analysis_settings, arch_structs, routing_structs, proxy_plan, proxy_multiplier);
+			num_proxy_probes++;
+			cout << "Proxy probe " << num_proxy_probes << ": demand multiplier " << proxy_multiplier << ", routability metric " << reliability << endl << endl;
+
+			if (reliability < target){
+				high = proxy_multiplier;
+			} else {
+				low = proxy_multiplier;
+			}
 
-		int try_num = 1;
-		while ( abs(reliability - user_opts->target_reliability) > target_tolerance ){
-			if (try_num > max_tries){
-				cout << "WARNING! Search has taken more than " << max_tries << " tries! Using last multiplier value." << endl;
+			/* the proxy's metric levels off towards either end of the range, and it may level off short of the target (e.g. the
+			   cutline_simple estimator is pessimistic). past that point more proxy probes don't tell anything */
+			if (prev_multiplier != UNDEFINED && abs(reliability - prev_reliability) < SEARCH_TOLERANCE / 4){
 				break;
 			}
+		}
 
-			user_opts->demand_multiplier = (multiplier_high + multiplier_low) / 2;
+		if (prev_multiplier != UNDEFINED && reliability != prev_reliability){
+			proxy_slope = (reliability - prev_reliability) / (log(proxy_multiplier) - log(prev_multiplier));
+		}
+	}
+
+	/* then refine with full-fidelity probes. without proxy probes this is a plain bisection over the whole range */
+	float low = 0;
+	float high = SEARCH_MULTIPLIER_HIGH;
+	float multiplier = proxy_multiplier;
+	float slope = proxy_slope;
+	float prev_multiplier = UNDEFINED;
+	float prev_reliability = UNDEFINED;
+	float prev_width = UNDEFINED;		/* width of the bracket before the last secant step (UNDEFINED if the last step bisected) */
+	int num_full_probes = 0;
+	while (true){
+		if (num_full_probes == SEARCH_MAX_PROBES){
+			cout << "WARNING! Search has taken more than " << SEARCH_MAX_PROBES << " tries! Using last multiplier value." << endl;
+			break;
+		}
 
-			//TODO: ideally, the enumerate part should only be done once, with the demand multiplier then being re-applied to all
-			//      nodes.
-			analyze_test_tile_connections(user_opts, analysis_settings, arch_structs, routing_structs, ENUMERATE);
-			reliability = analyze_test_tile_connections(user_opts, analysis_settings, arch_structs, routing_structs, PROBABILITY);
+		float reliability = probe_demand_multiplier(user_opts, analysis_settings, arch_structs, routing_structs, connection_plan, multiplier);
+		num_full_probes++;
+		cout << "Full probe " << num_full_probes << ": demand multiplier " << multiplier << ", routability metric " << reliability << endl << endl;
+		if (abs(reliability - target) <= SEARCH_TOLERANCE){
+			break;
+		}
 
-			/* perform search and get result... */
+		if (reliability < target){
+			high = multiplier;
+		} else {
+			low = multiplier;
+		}
 
-			if (reliability < user_opts->target_reliability){
-				multiplier_high = user_opts->demand_multiplier;
+		/* secant step in log(multiplier). the metric falls as the multiplier grows, so a slope that doesn't is no use */
+		if (prev_multiplier != UNDEFINED && multiplier != prev_multiplier){
+			slope = (reliability - prev_reliability) / (log(multiplier) - log(prev_multiplier));
+		}
+		prev_multiplier = multiplier;
+		prev_reliability = reliability;
+
+		/* where the metric has levelled off (it must fall by at least the tolerance per e-fold of the multiplier), or where the last
+		   secant step didn't halve the bracket, bisect instead */
+		float width = high - low;
+		float next_multiplier = UNDEFINED;
+		bool secant_stalled = (prev_width != UNDEFINED && width > prev_width / 2);
+		if (use_proxy && slope < -SEARCH_TOLERANCE && !secant_stalled){
+			next_multiplier = multiplier * exp((target - reliability) / slope);
+		}
+		if (next_multiplier == UNDEFINED || next_multiplier <= low || next_multiplier >= high){
+			/* the metric changes with the log of the multiplier, so the bracket is bisected geometrically once it has a lower end */
+			if (use_proxy && low > 0){
+				next_multiplier = sqrt(low * high);
 			} else {
-				multiplier_low = user_opts->demand_multiplier;
+				next_multiplier = (low + high) / 2;
 			}
+			prev_width = UNDEFINED;
+		} else {
+			prev_width = width;
 		}
+		multiplier = next_multiplier;
+	}
 
-		cout << endl;
-		cout << "Required demand multiplier: " << user_opts->demand_multiplier << endl;
-		cout << "Absolute routability metric: " << 1.0/user_opts->demand_multiplier << endl;
+	cout << "Demand multiplier search took " << num_proxy_probes << " proxy probes and " << num_full_probes << " full probes" << endl;
+}
+
+/* enumerates node demands from scratch under the specified demand multiplier and returns the resulting routability metric */
+static float probe_demand_multiplier(User_Options *user_opts, Analysis_Settings *analysis_settings, Arch_Structs *arch_structs,
+			Routing_Structs *routing_structs, const Connection_Plan &connection_plan, float demand_multiplier){
+
+	t_rr_node &rr_node = routing_structs->rr_node;
+	int num_nodes = routing_structs->get_num_rr_nodes();
+
+	/* demand enumerated by an earlier probe must not carry over */
+	user_opts->demand_multiplier = demand_multiplier;
+	for (int inode = 0; inode < num_nodes; inode++){
+		rr_node[inode].clear_demand();
 	}
+	routing_structs->node_values.freeze(rr_node, user_opts, user_opts->num_threads);
+	f_analysis_results = Analysis_Results();
 
-	update_screen(routing_structs, arch_structs, user_opts);
+	analyze_test_tile_connections(user_opts, analysis_settings, arch_structs, routing_structs, connection_plan, ENUMERATE);
+	float reliability = analyze_test_tile_connections(user_opts, analysis_settings, arch_structs, routing_structs, connection_plan, PROBABILITY);
+	return reliability;
+}
+
+/* repeats path enumeration with node weights frozen from the previous pass until the weights reach a fixed point (or the maximum
+   number of passes is reached). returns the normalized demand after the last pass */
+static float refine_enumerated_demand(User_Options *user_opts, Analysis_Settings *analysis_settings, Arch_Structs *arch_structs,
+			Routing_Structs *routing_structs, const Connection_Plan &connection_plan, float normalized_demand){
+
+	t_rr_node &rr_node = routing_structs->rr_node;
+	const Node_Values &node_values = routing_structs->node_values;
+	int num_nodes = routing_structs->get_num_rr_nodes();
+	int num_conns = (int)connection_plan.conns.size();
+	Demand_Refinement &refinement = f_demand_refinement;
+
+	vector<char> weight_changed(num_nodes, 0);
+	vector<double> prev_demand(num_nodes, 0.0);
+	long total_reenumerated = 0;
+	bool converged = false;
+
+	cout << "Refining enumerated demand (at most " << user_opts->demand_iterations << " passes)" << endl;
+	cout << "  pass 1: enumerated all " << num_conns << " connections, normalized CHANX/CHANY demand " << normalized_demand << endl;
+
+	int ipass;
+	for (ipass = 2; ipass <= user_opts->demand_iterations; ipass++){
+		/* the previous pass saw the weights of the current snapshot. compare them against the weights implied by the demand it produced */
+		int num_changed = 0;
+		for (int inode = 0; inode < num_nodes; inode++){
+			weight_changed[inode] = (rr_node[inode].compute_weight(user_opts->demand_multiplier) != node_values.weight[inode]);
+			num_changed += weight_changed[inode];
+			prev_demand[inode] = rr_node[inode].get_demand(NULL);
+		}
+		if (num_changed == 0){
+			converged = true;
+			break;
+		}
+
+		int num_affected = 0;
+		for (int iconn = 0; iconn < num_conns; iconn++){
+			const vector<int> &subgraph = refinement.subgraphs[iconn];
+			char affected = 0;
+			for (int inode = 0; inode < (int)subgraph.size() && !affected; inode++){
+				affected = weight_changed[ subgraph[inode] ];
+			}
+			refinement.conn_affected[iconn] = affected;
+			num_affected += affected;
+		}
+		total_reenumerated += num_affected;
+
+		normalized_demand = analyze_test_tile_connections(user_opts, analysis_settings, arch_structs, routing_structs, connection_plan, REFINE);
+
+		double max_demand_change = 0;
+		for (int inode = 0; inode < num_nodes; inode++){
+			max_demand_change = max(max_demand_change, fabs(rr_node[inode].get_demand(NULL) - prev_demand[inode]));
+		}
+
+		cout << "  pass " << ipass << ": " << num_changed << " node weights changed, re-enumerated " << num_affected << " of " << num_conns <<
+		        " connections, max node demand change " << max_demand_change << ", normalized CHANX/CHANY demand " << normalized_demand << endl;
+	}
+
+	int num_passes = ipass - 1;
+	if (converged){
+		cout << "  node weights reached a fixed point after " << num_passes << " passes" << endl;
+	} else {
+		cout << "  node weights had not reached a fixed point after " << num_passes << " passes" << endl;
+	}
+	if (num_passes > 1){
+		long full_reenumeration = (long)num_conns * (num_passes - 1);
+		cout << "  re-enumerated " << total_reenumerated << " connections instead of " << full_reenumeration << " (" <<
+		        100.0 * (1.0 - (double)total_reenumerated / (double)full_reenumeration) << "% of the work saved)" << endl;
+	}
+	cout << endl;
+
+	return normalized_demand;
+}
+
+/* calibrates the maximum path weight of each connection length. a sample of connections of each length is enumerated, and its
+   routing probability estimated, under a range of bounds. the smallest bound from which on the mean errors w.r.t. the largest
+   bound stay within the user's tolerance goes into the path weight table of the analysis settings. node demands are left cleared */
+static void calibrate_path_weight_bounds(User_Options *user_opts, Analysis_Settings *analysis_settings, Arch_Structs *arch_structs,
+			Routing_Structs *routing_structs, const Connection_Plan &connection_plan){
+
+	t_rr_node &rr_node = routing_structs->rr_node;
+	int num_nodes = routing_structs->get_num_rr_nodes();
+	int max_conn_length = user_opts->max_connection_length;
+	float tolerance = user_opts->path_weight_tolerance;
+
+	/* candidate bounds of each length run from a fraction of the default bound up to a multiple of it */
+	analysis_settings->max_path_weight_table.clear();
+	vector<int> default_bound(max_conn_length+1);
+	vector<int> lowest_bound(max_conn_length+1);
+	vector<int> highest_bound(max_conn_length+1);
+	int largest_bound = 0;
+	for (int ilen = 0; ilen <= max_conn_length; ilen++){
+		default_bound[ilen] = analysis_settings->get_max_path_weight(ilen);
+		lowest_bound[ilen] = max(1, (int)(default_bound[ilen] * CALIBRATION_LOWEST_BOUND_FACTOR));
+		highest_bound[ilen] = (int)(default_bound[ilen] * CALIBRATION_HIGHEST_BOUND_FACTOR);
+		largest_bound = max(largest_bound, highest_bound[ilen]);
+	}
+
+	/* sample connections of each length, spread evenly over the plan */
+	vector< vector< pair<int,int> > > samples(max_conn_length+1);
+	vector< vector< pair<int,int> > > conns_at_length(max_conn_length+1);
+	for (int isource = 0; isource < (int)connection_plan.sources.size(); isource++){
+		const Planned_Source &planned_source = connection_plan.sources[isource];
+		for (int iconn = planned_source.first_conn; iconn < planned_source.first_conn + planned_source.num_conns; iconn++){
+			const Planned_Connection &conn = connection_plan.conns[iconn];
+			conns_at_length[conn.length].push_back( make_pair(planned_source.source_ind, conn.sink_ind) );
+		}
+	}
+	for (int ilen = 0; ilen <= max_conn_length; ilen++){
+		if (PROBS_EQUAL(analysis_settings->length_probabilities[ilen], 0.0)){
+			continue;
+		}
+		int num_conns = (int)conns_at_length[ilen].size();
+		int stride = max(1, num_conns / CALIBRATION_CONNS_PER_LENGTH);
+		for (int iconn = 0; iconn < num_conns && (int)samples[ilen].size() < CALIBRATION_CONNS_PER_LENGTH; iconn += stride){
+			samples[ilen].push_back( conns_at_length[ilen][iconn] );
+		}
+	}
+
+	/* single-threaded traversal structures, sized for the largest candidate bound */
+	t_thread_ss_distances thread_ss_distances;
+	t_thread_node_topo_inf thread_node_topo_inf;
+	t_thread_scratch thread_bucket_storage;
+	t_thread_nodes_visited thread_nodes_visited;
+	alloc_thread_ss_distances(thread_ss_distances, 1, num_nodes);
+	alloc_thread_node_topo_inf(thread_node_topo_inf, thread_bucket_storage, 1, largest_bound * PATH_FLEXIBILITY_FACTOR, rr_node, num_nodes);
+	alloc_thread_nodes_visited(thread_nodes_visited, 1, num_nodes);
+	t_ss_distances &ss_distances = thread_ss_distances[0];
+	t_node_topo_inf &node_topo_inf = thread_node_topo_inf[0];
+	t_nodes_visited &nodes_visited = thread_nodes_visited[0];
+
+	/* [0..max_conn_length][candidate bound - lowest bound] errors summed over the samples of each length */
+	vector< vector<double> > demand_errors(max_conn_length+1);
+	vector< vector<double> > prob_errors(max_conn_length+1);
+	for (int ilen = 0; ilen <= max_conn_length; ilen++){
+		demand_errors[ilen].assign(highest_bound[ilen] - lowest_bound[ilen] + 1, 0.0);
+		prob_errors[ilen].assign(highest_bound[ilen] - lowest_bound[ilen] + 1, 0.0);
+	}
+
+	/* first, the demand enumerated for each sample under each bound, with the weights that path enumeration would see. every
+	   sample is enumerated with a total of one path and its demand is taken back out right away */
+	pthread_mutex_init(&f_analysis_results.thread_mutex, NULL);
+	analysis_settings->max_path_weight_table.assign(max_conn_length+1, UNDEFINED);
+	routing_structs->node_values.freeze(rr_node, user_opts, user_opts->num_threads);
+	vector<double> demand_difference(num_nodes, 0.0);
+	vector<char> node_touched(num_nodes, 0);
+	vector<int> touched_nodes;
+	for (int ilen = 0; ilen <= max_conn_length; ilen++){
+		for (int isample = 0; isample < (int)samples[ilen].size(); isample++){
+			int source_node_ind = samples[ilen][isample].first;
+			int sink_node_ind = samples[ilen][isample].second;
+
+			/* the largest bound is the reference */
+			t_demand_record reference_record;
+			double reference_demand = 0;
+			for (int bound = highest_bound[ilen]; bound >= lowest_bound[ilen]; bound--){
+				analysis_settings->max_path_weight_table[ilen] = bound;
+
+				t_demand_record demand_record;
+				enumerate_connection_paths(source_node_ind, sink_node_ind, analysis_settings, arch_structs, routing_structs, ss_distances,
+				                           node_topo_inf, ilen, nodes_visited, user_opts, 1.0, &demand_record);
+				clean_node_data_structs(nodes_visited, ss_distances, node_topo_inf, bound);
+				for (int ientry = 0; ientry < (int)demand_record.size(); ientry++){
+					rr_node[ demand_record[ientry].first ].increment_demand( -demand_record[ientry].second );
+				}
+
+				if (bound == highest_bound[ilen]){
+					reference_record = demand_record;
+					for (int ientry = 0; ientry < (int)reference_record.size(); ientry++){
+						reference_demand += reference_record[ientry].second;
+					}
+					continue;
+				}
+
+				/* L1 distance between this record and the reference, relative to the total reference demand */
+				for (int ientry = 0; ientry < (int)reference_record.size(); ientry++){
+					int node_ind = reference_record[ientry].first;
+					demand_difference[node_ind] += reference_record[ientry].second;
+					if (!node_touched[node_ind]){
+						node_touched[node_ind] = 1;
+						touched_nodes.push_back(node_ind);
+					}
+				}
+				for (int ientry = 0; ientry < (int)demand_record.size(); ientry++){
+					int node_ind = demand_record[ientry].first;
+					demand_difference[node_ind] -= demand_record[ientry].second;
+					if (!node_touched[node_ind]){
+						node_touched[node_ind] = 1;
+						touched_nodes.push_back(node_ind);
+					}
+				}
+				double distance = 0;
+				for (int inode = 0; inode < (int)touched_nodes.size(); inode++){
+					distance += fabs(demand_difference[ touched_nodes[inode] ]);
+					demand_difference[ touched_nodes[inode] ] = 0;
+					node_touched[ touched_nodes[inode] ] = 0;
+				}
+				touched_nodes.clear();
+
+				double error = (reference_demand > 0 ? distance / reference_demand : (distance > 0 ? 1.0 : 0.0));
+				demand_errors[ilen][bound - lowest_bound[ilen]] += error;
+			}
+		}
+	}
+	pthread_mutex_destroy(&f_analysis_results.thread_mutex);
+
+	/* then the probability of each sample under each bound, given the demand that the default bounds produce */
+	analysis_settings->max_path_weight_table.clear();
+	for (int inode = 0; inode < num_nodes; inode++){
+		rr_node[inode].clear_demand();
+	}
+	f_analysis_results = Analysis_Results();
+	analyze_test_tile_connections(user_opts, analysis_settings, arch_structs, routing_structs, connection_plan, ENUMERATE);
+
+	pthread_mutex_init(&f_analysis_results.thread_mutex, NULL);
+	analysis_settings->max_path_weight_table.assign(max_conn_length+1, UNDEFINED);
+	routing_structs->node_values.freeze(rr_node, user_opts, user_opts->num_threads);
+	for (int ilen = 0; ilen <= max_conn_length; ilen++){
+		for (int isample = 0; isample < (int)samples[ilen].size(); isample++){
+			int source_node_ind = samples[ilen][isample].first;
+			int sink_node_ind = samples[ilen][isample].second;
+
+			float reference_prob = UNDEFINED;
+			for (int bound = highest_bound[ilen]; bound >= lowest_bound[ilen]; bound--){
+				analysis_settings->max_path_weight_table[ilen] = bound;
+
+				float prob = estimate_connection_probability(source_node_ind, sink_node_ind, analysis_settings, arch_structs, routing_structs,
+				                                             ss_distances, node_topo_inf, ilen, nodes_visited, user_opts, PROPAGATE, NULL, NULL, NULL);
+				clean_node_data_structs(nodes_visited, ss_distances, node_topo_inf, bound);
+
+				if (bound == highest_bound[ilen]){
+					reference_prob = prob;
+				} else {
+					prob_errors[ilen][bound - lowest_bound[ilen]] += fabs(prob - reference_prob);
+				}
+			}
+		}
+	}
+	pthread_mutex_destroy(&f_analysis_results.thread_mutex);
+	free_thread_scratch(thread_bucket_storage);
+
+	/* pick the smallest bound from which on the mean errors stay within tolerance */
+	cout << endl << "Calibrating maximum path weights to a tolerance of " << tolerance << endl;
+	for (int ilen = 0; ilen <= max_conn_length; ilen++){
+		int num_samples = (int)samples[ilen].size();
+		analysis_settings->max_path_weight_table[ilen] = UNDEFINED;
+		if (num_samples == 0){
+			continue;
+		}
+
+		cout << "  length " << ilen << " (" << num_samples << " sample connections, default bound " << default_bound[ilen] << "):" << endl;
+
+		int chosen_bound = highest_bound[ilen];
+		bool within_tolerance = true;
+		for (int bound = highest_bound[ilen]; bound >= lowest_bound[ilen]; bound--){
+			double mean_demand_error = demand_errors[ilen][bound - lowest_bound[ilen]] / num_samples;
+			double mean_prob_error = prob_errors[ilen][bound - lowest_bound[ilen]] / num_samples;
+			cout << "    bound " << bound << ": mean probability error " << mean_prob_error << ", mean demand error " << mean_demand_error << endl;
+
+			if (within_tolerance && mean_demand_error <= tolerance && mean_prob_error <= tolerance){
+				chosen_bound = bound;
+			} else {
+				within_tolerance = false;
+			}
+		}
+		analysis_settings->max_path_weight_table[ilen] = chosen_bound;
+		cout << "    chosen bound: " << chosen_bound << endl;
+	}
+	cout << endl;
+
+	/* the actual analysis starts from scratch */
+	for (int inode = 0; inode < num_nodes; inode++){
+		rr_node[inode].clear_demand();
+	}
+	routing_structs->node_values.freeze(rr_node, user_opts, user_opts->num_threads);
+	f_analysis_results = Analysis_Results();
+}
+
+/* predicts the time taken by path enumeration and probability analysis under the user's options from a sample of the planned
+   connections of each length, and estimates the memory taken by each analysis thread. node demands are left cleared.
+   The sample connections are analyzed one after the other on a single thread, with all node demands at zero. That is what path
+   enumeration sees (unless weights are re-snapshotted during the phase). Probability analysis runs on the enumerated demands,
+   which only raise node weights and so shrink legal subgraphs -- the prediction for it is an upper bound */
+static void predict_analysis_cost(User_Options *user_opts, Analysis_Settings *analysis_settings, Arch_Structs *arch_structs,
+			Routing_Structs *routing_structs, const Connection_Plan &connection_plan){
+
+	t_rr_node &rr_node = routing_structs->rr_node;
+	int num_nodes = routing_structs->get_num_rr_nodes();
+	int max_conn_length = user_opts->max_connection_length;
+	int num_threads = user_opts->num_threads;
+
+	/* the connections analyzed by each phase, and a sample of each length spread evenly over the plan */
+	vector<int> enumerate_conns(max_conn_length+1, 0);
+	vector<int> probability_conns(max_conn_length+1, 0);
+	vector< vector<int> > samples(max_conn_length+1);		/* indices of planned connections */
+	vector< vector<int> > sample_sources(max_conn_length+1);
+	vector< vector<int> > conns_at_length(max_conn_length+1);
+	vector< vector<int> > sources_at_length(max_conn_length+1);
+	for (int isource = 0; isource < (int)connection_plan.sources.size(); isource++){
+		const Planned_Source &planned_source = connection_plan.sources[isource];
+		for (int iconn = planned_source.first_conn; iconn < planned_source.first_conn + planned_source.num_conns; iconn++){
+			int conn_length = connection_plan.conns[iconn].length;
+			if (PROBS_EQUAL(analysis_settings->length_probabilities[conn_length], 0.0)){
+				continue;
+			}
+			enumerate_conns[conn_length]++;
+			if (connection_plan.tile_in_prob_region[planned_source.tile_ind]){
+				probability_conns[conn_length]++;
+			}
+			conns_at_length[conn_length].push_back(iconn);
+			sources_at_length[conn_length].push_back(planned_source.source_ind);
+		}
+	}
+	for (int ilen = 0; ilen <= max_conn_length; ilen++){
+		int num_conns = (int)conns_at_length[ilen].size();
+		int stride = max(1, num_conns / PREDICTION_CONNS_PER_LENGTH);
+		for (int iconn = 0; iconn < num_conns && (int)samples[ilen].size() < PREDICTION_CONNS_PER_LENGTH; iconn += stride){
+			samples[ilen].push_back( conns_at_length[ilen][iconn] );
+			sample_sources[ilen].push_back( sources_at_length[ilen][iconn] );
+		}
+	}
+
+	/* single-threaded analysis structures, as they would be allocated for each thread */
+	int max_path_weight_bound = analysis_settings->get_largest_max_path_weight( max_conn_length ) * PATH_FLEXIBILITY_FACTOR;
+	t_thread_ss_distances thread_ss_distances;
+	t_thread_node_topo_inf thread_node_topo_inf;
+	t_thread_scratch thread_bucket_storage;
+	t_thread_nodes_visited thread_nodes_visited;
+	alloc_thread_ss_distances(thread_ss_distances, 1, num_nodes);
+	alloc_thread_node_topo_inf(thread_node_topo_inf, thread_bucket_storage, 1, max_path_weight_bound, rr_node, num_nodes);
+	alloc_self_congestion_structs(user_opts, routing_structs, arch_structs, thread_node_topo_inf, 1, max_path_weight_bound, num_nodes);
+	alloc_thread_nodes_visited(thread_nodes_visited, 1, num_nodes);
+	t_ss_distances &ss_distances = thread_ss_distances[0];
+	t_node_topo_inf &node_topo_inf = thread_node_topo_inf[0];
+	t_nodes_visited &nodes_visited = thread_nodes_visited[0];
+
+	int num_buckets = thread_node_topo_inf[0][0].buckets.get_num_source_buckets();
+	Monte_Carlo_Lanes monte_carlo_lanes;
+	Exact_Frontier exact_frontier;
+	bool use_monte_carlo = (user_opts->probability_mode == MONTE_CARLO);
+	bool use_exact = (user_opts->probability_mode == EXACT);
+	if (use_monte_carlo){
+		monte_carlo_lanes.init(num_nodes, num_buckets, user_opts->monte_carlo_trials, user_opts->seed);
+	}
+	if (use_exact){
+		exact_frontier.init(num_nodes, user_opts->exact_frontier_limit);
+	}
+
+	/* time each sample connection in both phases. demand enumerated for the samples doesn't affect the other samples, since node
+	   values are only snapshotted once */
+	vector<double> enumerate_seconds(max_conn_length+1, 0.0);
+	vector<double> probability_seconds(max_conn_length+1, 0.0);
+	vector<double> subgraph_sum(max_conn_length+1, 0.0);
+	int max_subgraph_size = 0;
+	pthread_mutex_init(&f_analysis_results.thread_mutex, NULL);
+	routing_structs->node_values.freeze(rr_node, user_opts, num_threads);
+	for (int ilen = 0; ilen <= max_conn_length; ilen++){
+		int max_path_weight = analysis_settings->get_max_path_weight(ilen);
+		for (int isample = 0; isample < (int)samples[ilen].size(); isample++){
+			const Planned_Connection &conn = connection_plan.conns[ samples[ilen][isample] ];
+			int source_node_ind = sample_sources[ilen][isample];
+
+			/* searches that can't reach the sink are skipped (see analyze_connection) */
+			if (conn.min_weight != UNDEFINED && conn.min_weight > max_path_weight){
+				continue;
+			}
+
+			double start_time = get_wall_seconds();
+			enumerate_connection_paths(source_node_ind, conn.sink_ind, analysis_settings, arch_structs, routing_structs, ss_distances,
+			                           node_topo_inf, ilen, nodes_visited, user_opts, 1.0, NULL);
+			int subgraph_size = clean_node_data_structs(nodes_visited, ss_distances, node_topo_inf, max_path_weight);
+			enumerate_seconds[ilen] += get_wall_seconds() - start_time;
+
+			start_time = get_wall_seconds();
+			estimate_connection_probability(source_node_ind, conn.sink_ind, analysis_settings, arch_structs, routing_structs, ss_distances,
+			                                node_topo_inf, ilen, nodes_visited, user_opts, user_opts->probability_mode, NULL,
+			                                (use_monte_carlo ? &monte_carlo_lanes : NULL), (use_exact ? &exact_frontier : NULL));
+			clean_node_data_structs(nodes_visited, ss_distances, node_topo_inf, max_path_weight);
+			probability_seconds[ilen] += get_wall_seconds() - start_time;
+
+			subgraph_sum[ilen] += subgraph_size;
+			max_subgraph_size = max(max_subgraph_size, subgraph_size);
+		}
+	}
+	pthread_mutex_destroy(&f_analysis_results.thread_mutex);
+	free_thread_scratch(thread_bucket_storage);
+
+	/* extrapolate from the average cost of a sample connection at each length */
+	cout << endl << "Predicted analysis cost (" << g_probability_mode_string[user_opts->probability_mode] << " probability mode, " <<
+	        num_threads << " threads):" << endl;
+	double total_enumerate_seconds = 0;
+	double total_probability_seconds = 0;
+	for (int ilen = 0; ilen <= max_conn_length; ilen++){
+		int num_samples = (int)samples[ilen].size();
+		if (num_samples == 0){
+			continue;
+		}
+		double enumerate_usec = 1e6 * enumerate_seconds[ilen] / num_samples;
+		double probability_usec = 1e6 * probability_seconds[ilen] / num_samples;
+		total_enumerate_seconds += enumerate_seconds[ilen] / num_samples * enumerate_conns[ilen];
+		total_probability_seconds += probability_seconds[ilen] / num_samples * probability_conns[ilen];
+
+		cout << "  length " << ilen << " (" << num_samples << " sample connections): avg legal subgraph " << subgraph_sum[ilen] / num_samples <<
+		        " nodes, " << enumerate_usec << " us to enumerate x " << enumerate_conns[ilen] << " conns, " << probability_usec <<
+		        " us to estimate x " << probability_conns[ilen] << " conns" << endl;
+	}
+	if (user_opts->tail_sampling_budget != UNDEFINED){
+		total_probability_seconds *= user_opts->tail_sampling_budget;
+	}
+
+	/* assuming that the threads scale linearly */
+	cout << "  path enumeration: " << total_enumerate_seconds / num_threads << " s";
+	if (user_opts->enumerate_engine == ENGINE_TILED){
+		cout << " (less with the tiled engine, which replays equivalent connections)";
+	}
+	cout << endl;
+	if (user_opts->demand_iterations > 1){
+		cout << "  demand refinement: up to " << user_opts->demand_iterations-1 << " more passes of at most the above" << endl;
+	}
+	cout << "  probability analysis: at most " << total_probability_seconds / num_threads << " s" << endl;
+	if (user_opts->target_reliability != UNDEFINED){
+		cout << "  the demand multiplier search runs both phases once per probe (up to " << SEARCH_MAX_PROBES << " full probes)" << endl;
+	}
+
+	/* memory allocated by each analysis thread (see analyze_test_tile_connections) */
+	double mb = 1024.0 * 1024.0;
+	double ss_distances_bytes = (double)num_nodes * sizeof(SS_Distances);
+	double topo_inf_bytes = (double)num_nodes * sizeof(Node_Topological_Info);
+	double bucket_bytes = (double)num_nodes * 2 * num_buckets * sizeof(double);
+	double visited_bytes = (double)num_nodes * sizeof(int);
+	double thread_bytes = ss_distances_bytes + topo_inf_bytes + bucket_bytes + visited_bytes;
+	cout << "  memory per thread: " << thread_bytes / mb << " MB (node buckets " << bucket_bytes / mb << " MB, node info " <<
+	        (topo_inf_bytes + ss_distances_bytes) / mb << " MB)" << endl;
+	if (user_opts->self_congestion_mode == MODE_PATH_DEPENDENCE){
+		cout << "    plus " << (double)num_nodes * num_buckets * sizeof(double) / mb << " MB of demand discounts per thread and as much again" <<
+		        " for the path dependence of each node" << endl;
+	}
+	if (use_monte_carlo || user_opts->validate_estimators){
+		int num_words = (user_opts->monte_carlo_trials + 63) / 64;
+		double lanes_bytes = (double)max_subgraph_size * num_buckets * num_words * sizeof(unsigned long long) + (double)num_nodes * sizeof(int);
+		cout << "    plus about " << lanes_bytes / mb << " MB of monte carlo trial lanes per thread (for the largest sampled subgraph)" << endl;
+	}
+
+	/* nothing of the samples is kept */
+	for (int inode = 0; inode < num_nodes; inode++){
+		rr_node[inode].clear_demand();
+	}
+	routing_structs->node_values.freeze(rr_node, user_opts, num_threads);
+	f_analysis_results = Analysis_Results();
+}
+
+/* captures the workloads of the enumerate and propagate kernels for a sample of the planned connections, under the node values
+   left by the analysis, and writes them to the user's trace file.
+   The sample is spread evenly over the connections that the probability phase analyzes. Each connection is enumerated with a
+   scaling factor of 1 (it is the kernel's work that is captured, not the connection's share of demand), and the demand that
+   this adds to the nodes is taken back out afterwards */
+static void capture_traversal_traces(User_Options *user_opts, Analysis_Settings *analysis_settings, Arch_Structs *arch_structs,
+			Routing_Structs *routing_structs, const Connection_Plan &connection_plan){
+
+	t_rr_node &rr_node = routing_structs->rr_node;
+	int num_nodes = routing_structs->get_num_rr_nodes();
+	int max_conn_length = user_opts->max_connection_length;
+
+	/* the connections analyzed by the probability phase */
+	vector<int> candidate_conns;		/* indices of planned connections */
+	vector<int> candidate_sources;
+	for (int isource = 0; isource < (int)connection_plan.sources.size(); isource++){
+		const Planned_Source &planned_source = connection_plan.sources[isource];
+		if (!connection_plan.tile_in_prob_region[planned_source.tile_ind]){
+			continue;
+		}
+		for (int iconn = planned_source.first_conn; iconn < planned_source.first_conn + planned_source.num_conns; iconn++){
+			const Planned_Connection &conn = connection_plan.conns[iconn];
+			if (PROBS_EQUAL(analysis_settings->length_probabilities[conn.length], 0.0)){
+				continue;
+			}
+			/* searches that can't reach the sink are skipped (see analyze_connection) */
+			if (conn.min_weight != UNDEFINED && conn.min_weight > analysis_settings->get_max_path_weight(conn.length)){
+				continue;
+			}
+			candidate_conns.push_back(iconn);
+			candidate_sources.push_back(planned_source.source_ind);
+		}
+	}
+
+	/* single-threaded analysis structures, as they would be allocated for each thread */
+	int max_path_weight_bound = analysis_settings->get_largest_max_path_weight( max_conn_length ) * PATH_FLEXIBILITY_FACTOR;
+	t_thread_ss_distances thread_ss_distances;
+	t_thread_node_topo_inf thread_node_topo_inf;
+	t_thread_scratch thread_bucket_storage;
+	t_thread_nodes_visited thread_nodes_visited;
+	alloc_thread_ss_distances(thread_ss_distances, 1, num_nodes);
+	alloc_thread_node_topo_inf(thread_node_topo_inf, thread_bucket_storage, 1, max_path_weight_bound, rr_node, num_nodes);
+	alloc_thread_nodes_visited(thread_nodes_visited, 1, num_nodes);
+	t_ss_distances &ss_distances = thread_ss_distances[0];
+	t_node_topo_inf &node_topo_inf = thread_node_topo_inf[0];
+	t_nodes_visited &nodes_visited = thread_nodes_visited[0];
+	int num_buckets = node_topo_inf[0].buckets.get_num_source_buckets();
+
+	/* the node values seen by the last pass of the probability phase */
+	routing_structs->node_values.freeze(rr_node, user_opts, user_opts->num_threads);
+	const Node_Values &node_values = routing_structs->node_values;
+
+	int num_candidates = (int)candidate_conns.size();
+	int stride = max(1, num_candidates / user_opts->num_captured_traces);
+	t_traversal_traces traces;
+	vector<int> subgraph_nodes;
+	vector<double> saved_demands;
+	for (int icand = 0; icand < num_candidates && (int)traces.size() < user_opts->num_captured_traces; icand += stride){
+		const Planned_Connection &conn = connection_plan.conns[ candidate_conns[icand] ];
+		int source_node_ind = candidate_sources[icand];
+		int sink_node_ind = conn.sink_ind;
+
+		int max_path_weight = analysis_settings->get_max_path_weight(conn.length);
+		int min_dist = UNDEFINED;
+		if (!get_ss_distances_and_adjust_max_path_weight(source_node_ind, sink_node_ind, rr_node, node_values, ss_distances, max_path_weight,
+		                                                 nodes_visited, &max_path_weight, &min_dist) || max_path_weight <= 0 || min_dist <= 0){
+			clean_node_data_structs(nodes_visited, ss_distances, node_topo_inf, max_path_weight);
+			continue;
+		}
+
+		traces.push_back( Traversal_Trace() );
+		Traversal_Trace &trace = traces.back();
+		capture_trace_subgraph(source_node_ind, sink_node_ind, rr_node, node_values, ss_distances, nodes_visited, max_path_weight,
+		                       &trace, subgraph_nodes);
+		trace.conn_length = conn.length;
+		trace.num_buckets = num_buckets;
+		trace.scaling_factor = 1.0;
+
+		saved_demands.assign(subgraph_nodes.size(), 0.0);
+		for (int inode = 0; inode < (int)subgraph_nodes.size(); inode++){
+			saved_demands[inode] = rr_node[ subgraph_nodes[inode] ].get_demand(NULL);
+		}
+
+		/* the enumerate kernel. its demand record is translated to subgraph indices */
+		enumerate_subgraph_paths(source_node_ind, sink_node_ind, rr_node, node_values, ss_distances, node_topo_inf, max_path_weight, user_opts,
+		                         trace.scaling_factor, &trace.demand_record);
+		for (int ientry = 0; ientry < (int)trace.demand_record.size(); ientry++){
+			int node_ind = trace.demand_record[ientry].first;
+			trace.demand_record[ientry].first = (int)(lower_bound(subgraph_nodes.begin(), subgraph_nodes.end(), node_ind) - subgraph_nodes.begin());
+		}
+		clean_node_topo_inf(node_topo_inf, nodes_visited, max_path_weight);
+
+		/* the propagate kernel */
+		trace.prob_routable = propagate_subgraph_probability(source_node_ind, sink_node_ind, rr_node, node_values, ss_distances, node_topo_inf,
+		                                                     max_path_weight, user_opts, NULL, NULL);
+		const double *sink_buckets = node_topo_inf[sink_node_ind].buckets.source_buckets;
+		trace.sink_buckets.assign(sink_buckets, sink_buckets + num_buckets);
+		clean_node_data_structs(nodes_visited, ss_distances, node_topo_inf, max_path_weight);
+
+		for (int inode = 0; inode < (int)subgraph_nodes.size(); inode++){
+			rr_node[ subgraph_nodes[inode] ].clear_demand();
+			rr_node[ subgraph_nodes[inode] ].increment_demand( saved_demands[inode] );
+		}
+	}
+	free_thread_scratch(thread_bucket_storage);
+
+	write_traversal_traces(user_opts->trace_file, traces);
+
+	long long total_nodes = 0;
+	long long total_edges = 0;
+	for (int itrace = 0; itrace < (int)traces.size(); itrace++){
+		total_nodes += traces[itrace].get_num_nodes();
+		total_edges += (long long)traces[itrace].out_edges.size();
+	}
+	cout << endl << "Captured " << traces.size() << " traversal traces (" << total_nodes << " subgraph nodes, " << total_edges <<
+	        " subgraph edges) to " << user_opts->trace_file << endl;
 }
 
 /* performs routability analysis on a simple one-source/one-sink graph */
 static void analyze_simple_graph(User_Options *user_opts, Analysis_Settings *analysis_settings, Arch_Structs *arch_structs, 
 			Routing_Structs *routing_structs){
 
+	if (!user_opts->simple_batch_results_file.empty()){
+		analyze_simple_graph_batch(user_opts, analysis_settings, arch_structs);
+		return;
+	}
+
+	check_simple_graph_settings(user_opts);
+
+	Simple_Graph_Scratch scratch;
+	int source_node_ind, sink_node_ind;
+	float connection_probability = analyze_simple_graph_connection(user_opts, analysis_settings, arch_structs, routing_structs, scratch, true,
+	                                                               &source_node_ind, &sink_node_ind);
+
+	/* print connection probability */
+	cout << "Connection probability: " << connection_probability << endl;
+}
+
+/* throws an exception if the user options ask for something that simple graph analysis doesn't support */
+static void check_simple_graph_settings(User_Options *user_opts){
 	if (user_opts->target_reliability != UNDEFINED){
 		WTHROW(EX_OTHER, "Not implemented!");
 	}
 
+	/* deal with self-congestion */
+	if (user_opts->self_congestion_mode == MODE_PATH_DEPENDENCE){
+		//Can't be implemented well. The issue is with dynamic weights. When weights update dynamically, it can happen that
+		//demand discounts due to the path dependence method get placed in the incorrect bucket (e.g. demand discounts are set at the parent,
+		//then paths are enumerated through the child node and the child node changes weight; during probability analysis the demand discount
+		//bucket may thus not line up with the correct source probability bucket). In the case of large FPGAs this isn't a big deal -- we'll
+		//misplace a minority of demand discounts into incorrect buckets, but on the whole most should line up correctly.
+		WTHROW(EX_INIT, "Path dependence will not work with simple graph!!");
+	} else if (user_opts->self_congestion_mode == MODE_RADIUS){
+		WTHROW(EX_INIT, "Not implemented!!!");
+	}
+}
+
+/* enumerates paths between the source and the sink of a simple graph and returns the probability of routing from one to the other.
+   the node structures of 'scratch' are grown to the size of the graph if necessary, and left clean for the next graph */
+static float analyze_simple_graph_connection(User_Options *user_opts, Analysis_Settings *analysis_settings, Arch_Structs *arch_structs,
+			Routing_Structs *routing_structs, Simple_Graph_Scratch &scratch, bool print_demands, int *source_node_ind, int *sink_node_ind){
+
 	t_rr_node &rr_node = routing_structs->rr_node;
 	int num_rr_nodes = routing_structs->get_num_rr_nodes();
 
-	int source_node_ind = UNDEFINED;
-	int sink_node_ind = UNDEFINED;
-
-	int large_connection_length = 10;
-	int large_max_path_weight = 10;
+	(*source_node_ind) = UNDEFINED;
+	(*sink_node_ind) = UNDEFINED;
 
 	/* figure out which node is the source and which node is the sink */
 	for (int inode = 0; inode < num_rr_nodes; inode++){
@@ -401,14 +1441,14 @@ static void analyze_simple_graph(User_Options *user_opts, Analysis_Settings *ana
 		   currently only one source and one sink node is allowed for this 'simple graph' analysis, so if 
 		   more than one source or sink exists, throw exception */
 		if (node_type == SOURCE){
-			if (source_node_ind == UNDEFINED){
-				source_node_ind = inode;
+			if ((*source_node_ind) == UNDEFINED){
+				(*source_node_ind) = inode;
 			} else {
 				WTHROW(EX_PATH_ENUM, "Expected to only find one source node");
 			}
 		} else if (node_type == SINK){
-			if (sink_node_ind == UNDEFINED){
-				sink_node_ind = inode;
+			if ((*sink_node_ind) == UNDEFINED){
+				(*sink_node_ind) = inode;
 			} else {
 				WTHROW(EX_PATH_ENUM, "Expected to only find one sink node");
 			}
@@ -416,61 +1456,192 @@ static void analyze_simple_graph(User_Options *user_opts, Analysis_Settings *ana
 			/* nothing */
 		}
 	}
-
-	/* allocate structures for getting source/sink distances */
-	t_nodes_visited nodes_visited;
-	nodes_visited.reserve(num_rr_nodes);
-	t_ss_distances ss_distances;
-	ss_distances.assign(num_rr_nodes, SS_Distances());
-
-	/* allocate structures for topological traversal */
-	t_node_topo_inf node_topo_inf;
-	node_topo_inf.assign(num_rr_nodes, Node_Topological_Info());
-	for (int inode = 0; inode < num_rr_nodes; inode++){
-		node_topo_inf[inode].buckets.alloc_source_sink_buckets(large_max_path_weight+1, large_max_path_weight+1);
-		node_topo_inf[inode].demand_discounts.assign(large_max_path_weight+1, 0.0);
-		rr_node[inode].alloc_child_demand_contributions(large_max_path_weight+1);
-	}
-
-	/* allocate structures to deal with self-congestion */
-	if (user_opts->self_congestion_mode == MODE_PATH_DEPENDENCE){
-		//for (int inode = 0; inode < num_rr_nodes; inode++){
-		//	node_topo_inf[inode].demand_discounts.assign(large_max_path_weight+1, 0.0);
-		//	rr_node[inode].alloc_child_demand_contributions(large_max_path_weight+1);
-		//}
-		//Can't be implemented well. The issue is with dynamic weights. When weights update dynamically, it can happen that
-		//demand discounts due to the path dependence method get placed in the incorrect bucket (e.g. demand discounts are set at the parent,
-		//then paths are enumerated through the child node and the child node changes weight; during probability analysis the demand discount
-		//bucket may thus not line up with the correct source probability bucket). In the case of large FPGAs this isn't a big deal -- we'll
-		//misplace a minority of demand discounts into incorrect buckets, but on the whole most should line up correctly.
-		WTHROW(EX_INIT, "Path dependence will not work with simple graph!!");
-	} else if (user_opts->self_congestion_mode == MODE_RADIUS){
-		WTHROW(EX_INIT, "Not implemented!!!");
+	if ((*source_node_ind) == UNDEFINED || (*sink_node_ind) == UNDEFINED){
+		WTHROW(EX_PATH_ENUM, "Expected to find a source node and a sink node");
 	}
 
+	/* structures for getting source/sink distances and for topological traversal */
+	scratch.reserve(num_rr_nodes);
+	t_ss_distances &ss_distances = scratch.ss_distances;
+	t_node_topo_inf &node_topo_inf = scratch.node_topo_inf;
+	t_nodes_visited &nodes_visited = scratch.nodes_visited;
 
 	/* perform path enumeration */
-	enumerate_connection_paths(source_node_ind, sink_node_ind, analysis_settings, arch_structs, routing_structs, ss_distances,
-	                     node_topo_inf, large_connection_length, nodes_visited, user_opts, (float)UNDEFINED);
+	routing_structs->node_values.freeze(rr_node, user_opts, 1);
+	enumerate_connection_paths((*source_node_ind), (*sink_node_ind), analysis_settings, arch_structs, routing_structs, ss_distances,
+	                     node_topo_inf, SIMPLE_GRAPH_CONNECTION_LENGTH, nodes_visited, user_opts, (float)UNDEFINED, NULL);
 
 	/* print how many paths run through each node */
-	cout << "Node demands: " << endl;
-	for (int inode = 0; inode < num_rr_nodes; inode++){
+	if (print_demands){
+		cout << "Node demands: " << endl;
+		for (int inode = 0; inode < num_rr_nodes; inode++){
 
-		cout << inode << ": demand " << rr_node[inode].get_demand(user_opts) << endl;
+			cout << inode << ": demand " << rr_node[inode].get_demand(user_opts) << endl;
+		}
 	}
 
 	/* clean structures in preparation for probability estimation */
-	clean_node_data_structs(nodes_visited, ss_distances, node_topo_inf, large_max_path_weight);
+	clean_node_data_structs(nodes_visited, ss_distances, node_topo_inf, SIMPLE_GRAPH_MAX_PATH_WEIGHT);
 
 	/* estimate probability of routing from source to sink */
-	float connection_probability = estimate_connection_probability(source_node_ind, sink_node_ind, analysis_settings, arch_structs,
-	                                                   routing_structs, ss_distances, node_topo_inf, large_connection_length,
-							   nodes_visited, user_opts);
+	routing_structs->node_values.freeze(rr_node, user_opts, 1);
+	if (user_opts->probability_mode == MONTE_CARLO){
+		scratch.monte_carlo_lanes.init(num_rr_nodes, SIMPLE_GRAPH_MAX_PATH_WEIGHT+1, user_opts->monte_carlo_trials, user_opts->seed);
+	} else if (user_opts->probability_mode == EXACT){
+		scratch.exact_frontier.init(num_rr_nodes, user_opts->exact_frontier_limit);
+	}
+	float connection_probability = estimate_connection_probability((*source_node_ind), (*sink_node_ind), analysis_settings, arch_structs,
+	                                                   routing_structs, ss_distances, node_topo_inf, SIMPLE_GRAPH_CONNECTION_LENGTH,
+							   nodes_visited, user_opts, user_opts->probability_mode, NULL, &scratch.monte_carlo_lanes, &scratch.exact_frontier);
+	clean_node_data_structs(nodes_visited, ss_distances, node_topo_inf, SIMPLE_GRAPH_MAX_PATH_WEIGHT);
 
-	/* print connection probability */
-	cout << "Connection probability: " << connection_probability << endl;
+	return connection_probability;
+}
+
+/* analyzes each graph of a batch of simple graphs (see the -simple_batch option). graphs are handed out to the analysis threads
+   one at a time, and the result of each graph is appended to the results file as soon as it is known */
+static void analyze_simple_graph_batch(User_Options *user_opts, Analysis_Settings *analysis_settings, Arch_Structs *arch_structs){
+
+	check_simple_graph_settings(user_opts);
+
+	vector<Simple_Graph_Location> graphs;
+	find_simple_graphs(user_opts->rr_structs_file, &graphs);
+
+	ofstream results_file(user_opts->simple_batch_results_file.c_str());
+	if (!results_file.is_open()){
+		WTHROW(EX_OTHER, "Could not open simple batch results file " << user_opts->simple_batch_results_file << " for writing");
+	}
+	results_file << "graph,file,section,num_nodes,source_node,sink_node,connection_probability,error" << endl;
+
+	int num_threads = max(1, min(user_opts->num_threads, (int)graphs.size()));
+	cout << "Analyzing a batch of " << graphs.size() << " simple graphs from " << user_opts->rr_structs_file << " on " << num_threads << " threads" << endl;
+
+	Simple_Batch batch;
+	batch.graphs = &graphs;
+	batch.user_opts = user_opts;
+	batch.analysis_settings = analysis_settings;
+	batch.arch_structs = arch_structs;
+	batch.next_graph = 0;
+	batch.num_failed = 0;
+	batch.results_file = &results_file;
+	pthread_mutex_init(&batch.mutex, NULL);
+
+	/* path enumeration counts the connections it enumerated */
+	pthread_mutex_init(&f_analysis_results.thread_mutex, NULL);
+
+	t_threads threads;
+	alloc_threads(threads, num_threads);
+	for (int ithread = 0; ithread < num_threads; ithread++){
+		int result = pthread_create(&threads[ithread], NULL, analyze_simple_graphs_from_batch, (void*) &batch);
+		if (result != 0){
+			WTHROW(EX_PATH_ENUM, "Failed to create thread!");
+		}
+	}
+	for (int ithread = 0; ithread < num_threads; ithread++){
+		int result = pthread_join(threads[ithread], NULL);
+		if (result != 0){
+			WTHROW(EX_PATH_ENUM, "Failed to join thread!");
+		}
+	}
+	pthread_mutex_destroy(&batch.mutex);
+	pthread_mutex_destroy(&f_analysis_results.thread_mutex);
+
+	cout << "Wrote results of " << graphs.size() << " graphs to " << user_opts->simple_batch_results_file;
+	if (batch.num_failed > 0){
+		cout << " (" << batch.num_failed << " could not be analyzed)";
+	}
+	cout << endl;
+}
+
+/* thread function for analyzing a batch of simple graphs. takes graphs off the batch until there are none left */
+static void* analyze_simple_graphs_from_batch( void *ptr ){
+	Simple_Batch *batch = (Simple_Batch*)ptr;
+	const vector<Simple_Graph_Location> &graphs = (*batch->graphs);
+
+	/* traversal structures are reused from graph to graph */
+	Simple_Graph_Scratch scratch;
+
+	while (true){
+		pthread_mutex_lock(&batch->mutex);
+		int igraph = batch->next_graph;
+		batch->next_graph++;
+		pthread_mutex_unlock(&batch->mutex);
+		if (igraph >= (int)graphs.size()){
+			break;
+		}
+		const Simple_Graph_Location &location = graphs[igraph];
+
+		stringstream row;
+		row << igraph << "," << location.file << "," << location.section << ",";
+
+		bool failed = false;
+		Routing_Structs routing_structs;
+		try{
+			init_simple_graph(location, batch->user_opts, &routing_structs);
+
+			int source_node_ind, sink_node_ind;
+			float connection_probability = analyze_simple_graph_connection(batch->user_opts, batch->analysis_settings, batch->arch_structs,
+			                                                               &routing_structs, scratch, false, &source_node_ind, &sink_node_ind);
+			row << routing_structs.get_num_rr_nodes() << "," << source_node_ind << "," << sink_node_ind << "," << connection_probability << ",";
+		} catch (Wotan_Exception &e){
+			/* a malformed graph doesn't stop the batch. whatever was visited before the exception is cleaned up for the next graph */
+			failed = true;
+			clean_node_data_structs(scratch.nodes_visited, scratch.ss_distances, scratch.node_topo_inf, SIMPLE_GRAPH_MAX_PATH_WEIGHT);
+
+			string message = e.message;
+			replace(message.begin(), message.end(), ',', ';');
+			replace(message.begin(), message.end(), '\n', ' ');
+			row << routing_structs.get_num_rr_nodes() << ",,,," << message;
+		}
+
+		pthread_mutex_lock(&batch->mutex);
+		(*batch->results_file) << row.str() << endl;
+		if (failed){
+			batch->num_failed++;
+		}
+		pthread_mutex_unlock(&batch->mutex);
+	}
+
+	return (void*) NULL;
+}
+
+
+/*==== Simple_Graph_Scratch Class ====*/
+Simple_Graph_Scratch::Simple_Graph_Scratch(){
+	this->num_nodes = 0;
+}
+
+Simple_Graph_Scratch::~Simple_Graph_Scratch(){
+	free_thread_scratch(this->bucket_storage);
+}
+
+/* grows the node structures to accommodate a graph with the specified number of nodes. structures are grown to at least
+   twice their previous size so that a batch of slowly growing graphs doesn't reallocate for every graph */
+void Simple_Graph_Scratch::reserve(int num_graph_nodes){
+	if (num_graph_nodes <= this->num_nodes){
+		return;
+	}
+	int new_num_nodes = max(num_graph_nodes, 2*this->num_nodes);
+
+	this->ss_distances.assign(new_num_nodes, SS_Distances());
+	this->node_topo_inf.assign(new_num_nodes, Node_Topological_Info());
+	this->nodes_visited.reserve(new_num_nodes);
+
+	/* source and sink buckets of all nodes come out of one block */
+	int num_buckets = SIMPLE_GRAPH_MAX_PATH_WEIGHT+1;
+	size_t node_stride = 2 * (size_t)num_buckets;
+	free_thread_scratch(this->bucket_storage);
+	Scratch_Region *storage = new Scratch_Region( node_stride * (size_t)new_num_nodes * sizeof(double) );
+	this->bucket_storage.push_back(storage);
+
+	double *buckets = (double*)storage->get_base();
+	for (int inode = 0; inode < new_num_nodes; inode++){
+		this->node_topo_inf[inode].buckets.assign_source_sink_buckets(buckets + node_stride*inode, num_buckets);
+	}
+
+	this->num_nodes = new_num_nodes;
 }
+/*==== END Simple_Graph_Scratch Class ====*/
 
 /* enumerates paths from test tiles. typically path eneumeration would involve enumerating paths from		//TODO: outdated comment
    sources to sinks, but there are a few caveats that can't be easily intuited. specifically:
@@ -491,29 +1662,31 @@ static void analyze_simple_graph(User_Options *user_opts, Analysis_Settings *ana
 	  they would not fit into the pin-track-class scheme used by the rr node indices structure. So routing
 	  from ipins is actually a bit of a hack. */
 float analyze_test_tile_connections(User_Options *user_opts, Analysis_Settings *analysis_settings, Arch_Structs *arch_structs, 
-			Routing_Structs *routing_structs, e_topological_mode topological_mode){
+			Routing_Structs *routing_structs, const Connection_Plan &connection_plan, e_topological_mode topological_mode){
 
 	float result = UNDEFINED;
 
 	//quick error check
-	if (PROBABILITY_MODE != PROPAGATE && user_opts->self_congestion_mode == MODE_PATH_DEPENDENCE){
+	if (user_opts->probability_mode != PROPAGATE && user_opts->self_congestion_mode == MODE_PATH_DEPENDENCE){
 		WTHROW(EX_INIT, "path dependence self-congestion mode cannot be used if routing probability is analyzed by propagating node probabilities.");
 	}
+	if (topological_mode == SENSITIVITY && user_opts->probability_mode != PROPAGATE){
+		WTHROW(EX_INIT, "sensitivities to node demands can only be computed if routing probability is analyzed by propagating node probabilities.");
+	}
 
 	int fill_type_ind = arch_structs->get_fill_type_index();
 	Physical_Type_Descriptor *fill_type = &arch_structs->block_type[fill_type_ind];
-	int grid_size_x, grid_size_y;
-	arch_structs->get_grid_size(&grid_size_x, &grid_size_y);
 
 	string fill_type_name = fill_type->get_name();
 
 	cout << "Enumerating paths for physical block type named '" << fill_type->get_name() << "'" << endl;
 
 	/* allocate appropriate data structures for each thread */
-	int max_path_weight_bound = analysis_settings->get_max_path_weight( user_opts->max_connection_length ) * PATH_FLEXIBILITY_FACTOR;
+	int max_path_weight_bound = analysis_settings->get_largest_max_path_weight( user_opts->max_connection_length ) * PATH_FLEXIBILITY_FACTOR;
 	int num_threads = user_opts->num_threads;
 	t_thread_ss_distances thread_ss_distances;
 	t_thread_node_topo_inf thread_node_topo_inf;
+	t_thread_scratch thread_bucket_storage;
 	t_thread_nodes_visited thread_nodes_visited;
 	t_thread_conn_info thread_conn_info;
 	t_threads threads;
@@ -521,12 +1694,68 @@ float analyze_test_tile_connections(User_Options *user_opts, Analysis_Settings *
 	cout << "absolute max possible path weight is: " << max_path_weight_bound << endl;
 
 	alloc_thread_ss_distances(thread_ss_distances, num_threads, (int)routing_structs->get_num_rr_nodes());
-	alloc_thread_node_topo_inf(thread_node_topo_inf, num_threads, max_path_weight_bound, routing_structs->rr_node, (int)routing_structs->get_num_rr_nodes());
+	alloc_thread_node_topo_inf(thread_node_topo_inf, thread_bucket_storage, num_threads, max_path_weight_bound, routing_structs->rr_node,
+	                           (int)routing_structs->get_num_rr_nodes());
 	alloc_self_congestion_structs(user_opts, routing_structs, arch_structs, thread_node_topo_inf, num_threads, max_path_weight_bound, (int)routing_structs->get_num_rr_nodes());
 	alloc_thread_nodes_visited(thread_nodes_visited, num_threads, (int)routing_structs->get_num_rr_nodes());
 	alloc_thread_conn_info(thread_conn_info, num_threads);
 	alloc_threads(threads, num_threads);
 
+	/* the tiled enumerate engine keeps templates for each thread, and compares tile signatures computed from this phase's weights */
+	t_thread_template_caches thread_template_caches;
+	t_tile_signatures tile_signatures;
+	bool use_templates = (topological_mode == ENUMERATE && user_opts->enumerate_engine != ENGINE_TRAVERSE);
+	if (use_templates){
+		thread_template_caches.assign(num_threads, Enumerate_Template_Cache());
+	}
+
+	/* in the sensitivity phase every thread records its connections onto its own tape */
+	t_thread_tapes thread_tapes;
+	if (topological_mode == SENSITIVITY){
+		int num_buckets = thread_node_topo_inf[0][0].buckets.get_num_source_buckets();
+		thread_tapes.assign(num_threads, Propagate_Tape());
+		for (int ithread = 0; ithread < num_threads; ithread++){
+			thread_tapes[ithread].init((int)routing_structs->get_num_rr_nodes(), num_buckets);
+		}
+	}
+
+	/* the monte carlo mode (and validation of the other modes against it) needs trial storage for each thread */
+	t_thread_monte_carlo_lanes thread_monte_carlo_lanes;
+	bool use_monte_carlo = (topological_mode == PROBABILITY && (user_opts->probability_mode == MONTE_CARLO || user_opts->validate_estimators));
+	if (use_monte_carlo){
+		int num_buckets = thread_node_topo_inf[0][0].buckets.get_num_source_buckets();
+		thread_monte_carlo_lanes.assign(num_threads, Monte_Carlo_Lanes());
+		for (int ithread = 0; ithread < num_threads; ithread++){
+			thread_monte_carlo_lanes[ithread].init((int)routing_structs->get_num_rr_nodes(), num_buckets, user_opts->monte_carlo_trials, user_opts->seed);
+		}
+	}
+
+	/* as does the exact mode */
+	t_thread_exact_frontiers thread_exact_frontiers;
+	bool use_exact = (topological_mode == PROBABILITY && (user_opts->probability_mode == EXACT || user_opts->validate_estimators));
+	if (use_exact){
+		thread_exact_frontiers.assign(num_threads, Exact_Frontier());
+		for (int ithread = 0; ithread < num_threads; ithread++){
+			thread_exact_frontiers[ithread].init((int)routing_structs->get_num_rr_nodes(), user_opts->exact_frontier_limit);
+		}
+	}
+
+	/* connections' demand contributions are kept if demand is to be refined over several passes */
+	bool use_refinement = ((topological_mode == ENUMERATE || topological_mode == REFINE) && user_opts->demand_iterations > 1);
+
+	/* only a sample of the connections is evaluated during probability analysis if the user asked for tail sampling */
+	bool use_tail_sampling = (topological_mode == PROBABILITY && user_opts->tail_sampling_budget != UNDEFINED);
+
+	/* every thread profiles the connections it analyzes if the user asked for connection profiles */
+	t_thread_conn_profiles thread_conn_profiles;
+	bool use_conn_profiles = (user_opts->profile_conns_listed != UNDEFINED);
+	if (use_conn_profiles){
+		thread_conn_profiles.assign(num_threads, Conn_Profile());
+		for (int ithread = 0; ithread < num_threads; ithread++){
+			thread_conn_profiles[ithread].init(user_opts->max_connection_length, user_opts->profile_conns_listed);
+		}
+	}
+
 	/* set parameters that will not change for each thread */
 	for (int ithread = 0; ithread < num_threads; ithread++){
 		thread_conn_info[ithread].user_opts = user_opts;
@@ -537,97 +1766,46 @@ float analyze_test_tile_connections(User_Options *user_opts, Analysis_Settings *
 		thread_conn_info[ithread].node_topo_inf = &thread_node_topo_inf[ithread];
 		thread_conn_info[ithread].nodes_visited = &thread_nodes_visited[ithread];
 		thread_conn_info[ithread].topological_mode = topological_mode;
+		thread_conn_info[ithread].tape = (topological_mode == SENSITIVITY ? &thread_tapes[ithread] : NULL);
+		thread_conn_info[ithread].template_cache = (use_templates ? &thread_template_caches[ithread] : NULL);
+		thread_conn_info[ithread].tile_signatures = &tile_signatures;
+		thread_conn_info[ithread].monte_carlo_lanes = (use_monte_carlo ? &thread_monte_carlo_lanes[ithread] : NULL);
+		thread_conn_info[ithread].exact_frontier = (use_exact ? &thread_exact_frontiers[ithread] : NULL);
+		thread_conn_info[ithread].demand_refinement = (use_refinement ? &f_demand_refinement : NULL);
+		thread_conn_info[ithread].tail_sampler = (use_tail_sampling ? &f_tail_sampler : NULL);
+		thread_conn_info[ithread].conn_profile = (use_conn_profiles ? &thread_conn_profiles[ithread] : NULL);
+		thread_conn_info[ithread].thread_ind = ithread;
+		thread_conn_info[ithread].num_threads = num_threads;
+		thread_conn_info[ithread].connection_plan = &connection_plan;
+		thread_conn_info[ithread].plan_sources.clear();
+		thread_conn_info[ithread].num_conns = 0;
 	}
 
+	/* hand out the planned sources to threads round-robin. driver sources and the virtual sources used for fanout are distributed
+	   separately so that both kinds of work are spread over all threads */
 	int ithread_source = 0;
 	int ithread_sink = 0;
-	/* for each test tile */
-	vector< Coordinate >::const_iterator it;
-	for (it = analysis_settings->test_tile_coords.begin(); it != analysis_settings->test_tile_coords.end(); it++){
-
-		Coordinate tile_coord = (*it);
+	for (int isource = 0; isource < (int)connection_plan.sources.size(); isource++){
+		const Planned_Source &planned_source = connection_plan.sources[isource];
 
 		/* the user may have specified that only the core region of the FPGA is to be used for probability analysis. in that case
 		   probability analysis will be performed for all tiles that are within the region that is CORE_OFFSET tiles from the FPGA perimeter */
-		if (user_opts->analyze_core){
-			if (topological_mode == PROBABILITY){
-				int from_x, to_x, from_y, to_y;
-				get_prob_analysis_tile_region(user_opts, grid_size_x, grid_size_y, &from_x, &from_y, &to_x, &to_y);
-
-				if (tile_coord.x < from_x || tile_coord.x > to_x || tile_coord.y < from_y || tile_coord.y > to_y){
-					continue;
-				}
-			}
+		if (topological_mode != ENUMERATE && topological_mode != REFINE && !connection_plan.tile_in_prob_region[planned_source.tile_ind]){
+			continue;
 		}
 
+		int *ithread = &ithread_source;
+		if (planned_source.pin_type == RECEIVER){
+			ithread = &ithread_sink;
+		}
 
-		Grid_Tile *test_tile = &arch_structs->grid[tile_coord.x][tile_coord.y];
-		Physical_Type_Descriptor *tile_type= &arch_structs->block_type[ test_tile->get_type_index() ];
-
-		/* for each source of the test tile */
-		for (int iclass = 0; iclass < (int)tile_type->class_inf.size(); iclass++){
-			Pin_Class *pin_class = &tile_type->class_inf[iclass];
-
-			if (pin_class->get_pin_type() == DRIVER){
-				/* enumerating from opins basically involves enumerating from the corresponding
-				   source */
-
-				int source_node_index = routing_structs->rr_node_index[SOURCE][tile_coord.x][tile_coord.y][iclass];
-
-				vector<int> sink_indices;
-				vector<int> ss_length;
-				vector<int> source_conns_at_length;
-				get_corresponding_sink_ids(user_opts, analysis_settings, arch_structs, routing_structs, source_node_index, tile_coord, sink_indices,
-								ss_length, source_conns_at_length);
-
-				for (int isink = 0; isink < (int)sink_indices.size(); isink++){
-					Source_Sink_Pair ss_pair;
-					ss_pair.source_ind = source_node_index;
-					ss_pair.sink_ind = sink_indices[isink];
-					ss_pair.ss_length = ss_length[isink];
-					ss_pair.source_conns_at_length = source_conns_at_length[isink];
-					
-					thread_conn_info[ithread_source].source_sink_pairs.push_back(ss_pair);
-				}
-
-				ithread_source++;	
-				if (ithread_source == num_threads){
-					ithread_source = 0;
-				}
-
-			} else if (pin_class->get_pin_type() == RECEIVER){
-				/* enumerating from ipins is Wotan's way of accounting for fanout and this is slightly trickier.
-				   in wotan_init.cxx virtual sources were created for every sink and attached into the wires 
-				   that connect into the sink's ipins. these virtual sources are used to enumerate fanout paths */
-
-				int sink_node_index = routing_structs->rr_node_index[SOURCE][tile_coord.x][tile_coord.y][iclass];
-				int virtual_source_ind = routing_structs->rr_node[sink_node_index].get_virtual_source_node_ind();
-
-				if (virtual_source_ind != UNDEFINED){
-					vector<int> sink_indices;
-					vector<int> ss_length;
-					vector<int> source_conns_at_length;
-					get_corresponding_sink_ids(user_opts, analysis_settings, arch_structs, routing_structs, virtual_source_ind, tile_coord, sink_indices,
-									ss_length, source_conns_at_length);
-
-					for (int isink = 0; isink < (int)sink_indices.size(); isink++){
-						Source_Sink_Pair ss_pair;
-						ss_pair.source_ind = virtual_source_ind;
-						ss_pair.sink_ind = sink_indices[isink];
-						ss_pair.ss_length = ss_length[isink];
-						ss_pair.source_conns_at_length = source_conns_at_length[isink];
-
-						thread_conn_info[ithread_sink].source_sink_pairs.push_back(ss_pair);
-					}
+		thread_conn_info[*ithread].plan_sources.push_back(isource);
+		thread_conn_info[*ithread].num_conns += planned_source.num_conns;
+		f_analysis_results.desired_conns += planned_source.num_conns;
 
-					ithread_sink++;
-					if (ithread_sink == num_threads){
-						ithread_sink = 0;
-					}
-				}
-			} else {
-				WTHROW(EX_PATH_ENUM, "Unexpected pin type: " << pin_class->get_pin_type());
-			}
+		(*ithread)++;
+		if ((*ithread) == num_threads){
+			(*ithread) = 0;
 		}
 	}
 
@@ -635,14 +1813,17 @@ float analyze_test_tile_connections(User_Options *user_opts, Analysis_Settings *
 	if (topological_mode == PROBABILITY){
 		f_analysis_results = Analysis_Results();
 
-		vector<int> driver_conns_at_length;
-		vector<int> receiver_conns_at_length;
+		const vector<int> &driver_conns_at_length = connection_plan.driver_conns_at_length;
+		const vector<int> &receiver_conns_at_length = connection_plan.receiver_conns_at_length;
 
 		/* create the lowest probability priority queues (for pessimistic routability analysis of some percentile of worst connections at each length) */
 		f_analysis_results.lowest_probs_pqs_drivers.assign( user_opts->max_connection_length+1, t_lowest_probs_pq() );
 		f_analysis_results.lowest_probs_pqs_fanout.assign( user_opts->max_connection_length+1, t_lowest_probs_pq() );
-		get_conn_length_stats(user_opts, analysis_settings, routing_structs, arch_structs, DRIVER, driver_conns_at_length);	//for paths enumerated *from* sources
-		get_conn_length_stats(user_opts, analysis_settings, routing_structs, arch_structs, RECEIVER, receiver_conns_at_length);	//for paths enumerated *from* sinks (for fanout stuff)
+		if (user_opts->validate_estimators){
+			f_analysis_results.estimator_errors.assign( NUM_VALIDATED_MODES, vector<Estimator_Error>(user_opts->max_connection_length+1) );
+		}
+		vector<int> driver_entries_limits(user_opts->max_connection_length+1, UNDEFINED);
+		vector<int> receiver_entries_limits(user_opts->max_connection_length+1, UNDEFINED);
 		for(int ilen = 0; ilen < user_opts->max_connection_length+1; ilen++){
 			/* set the bounded priority queue entries limit w.r.t. to the "..._conns_at_length" stats */
 			if (driver_conns_at_length[ilen] > 0){
@@ -650,12 +1831,20 @@ float analyze_test_tile_connections(User_Options *user_opts, Analysis_Settings *
 				int driver_entries_limit = driver_conns_at_length[ilen] * WORST_ROUTABILITY_PERCENTILE_DRIVERS * user_opts->length_probabilities[ilen] * FRACTION_CONNS;
 				cout << "len" << ilen << " entries " << driver_entries_limit << endl;
 				f_analysis_results.lowest_probs_pqs_drivers[ilen].set_properties( driver_entries_limit );
+				driver_entries_limits[ilen] = driver_entries_limit;
 			}
 			if (receiver_conns_at_length[ilen] > 0){
 				int receiver_entries_limit = receiver_conns_at_length[ilen] * WORST_ROUTABILITY_PERCENTILE_FANOUT;
 				f_analysis_results.lowest_probs_pqs_fanout[ilen].set_properties( receiver_entries_limit );
+				receiver_entries_limits[ilen] = receiver_entries_limit;
 			}
 		}
+
+		if (use_tail_sampling){
+			f_tail_sampler.init(user_opts, analysis_settings, arch_structs, routing_structs, connection_plan, user_opts->tail_sampling_budget);
+			f_tail_sampler.set_entries_limit(DRIVER, driver_entries_limits);
+			f_tail_sampler.set_entries_limit(RECEIVER, receiver_entries_limits);
+		}
 	}
 
 
@@ -665,9 +1854,56 @@ float analyze_test_tile_connections(User_Options *user_opts, Analysis_Settings *
 	/* initialize thread semaphore */
 	pthread_barrier_init(&f_analysis_results.thread_barrier, 0, f_analysis_results.active_threads);
 
+	/* snapshot node weights and effective demands for this phase. traversals only read the snapshot, so demand that is
+	   enumerated during this phase doesn't feed back into the weights seen by other connections of the same phase (unless
+	   the user asked for the snapshot to be refreshed every so many connections during path enumeration) */
+	routing_structs->node_values.freeze(routing_structs->rr_node, user_opts, num_threads);
+	int snapshots_at_phase_start = routing_structs->node_values.num_snapshots;
+	if (use_templates){
+		build_tile_signatures(arch_structs, routing_structs, tile_signatures);
+	}
+
+	int max_thread_conns = 0;
+	for (int ithread = 0; ithread < num_threads; ithread++){
+		max_thread_conns = max(max_thread_conns, thread_conn_info[ithread].num_conns);
+	}
+	int conns_per_epoch = max(1, max_thread_conns);
+	if (topological_mode == ENUMERATE && user_opts->weight_epoch_conns > 0){
+		conns_per_epoch = max(1, user_opts->weight_epoch_conns / num_threads);
+	}
+	int num_epochs = max(1, (max_thread_conns + conns_per_epoch - 1) / conns_per_epoch);
+	for (int ithread = 0; ithread < num_threads; ithread++){
+		thread_conn_info[ithread].conns_per_epoch = conns_per_epoch;
+		thread_conn_info[ithread].num_epochs = num_epochs;
+	}
+
 	/* launch the threads */
 	launch_pthreads(thread_conn_info, threads, num_threads);
 
+	/* with tail sampling, the first pass over the plan was the pilot stage. a second pass evaluates the focused stage */
+	if (use_tail_sampling){
+		f_tail_sampler.plan_focused_stage(user_opts->seed);
+		launch_pthreads(thread_conn_info, threads, num_threads);
+	}
+
+	/* node buckets are no longer needed */
+	free_thread_scratch(thread_bucket_storage);
+
+	if (use_templates){
+		print_enumerate_template_stats(user_opts, thread_template_caches);
+	}
+
+	if (use_conn_profiles){
+		for (int ithread = 1; ithread < num_threads; ithread++){
+			thread_conn_profiles[0].merge(thread_conn_profiles[ithread]);
+		}
+		thread_conn_profiles[0].print( get_phase_name(topological_mode, user_opts) );
+	}
+
+	if (num_epochs > 1){
+		cout << "Node weight snapshots taken during this phase: " << routing_structs->node_values.num_snapshots - snapshots_at_phase_start << endl;
+	}
+
 	pthread_mutex_destroy(&f_analysis_results.thread_mutex);
 	pthread_barrier_destroy(&f_analysis_results.thread_barrier);
 
@@ -703,6 +1939,7 @@ float analyze_test_tile_connections(User_Options *user_opts, Analysis_Settings *
 	if (topological_mode == ENUMERATE){
 		cout << "desired conns: " << f_analysis_results.desired_conns << endl;
 		cout << "enumerated: " << f_analysis_results.num_conns << endl;
+		cout << "searches skipped (sink out of reach): " << f_analysis_results.num_skipped_searches << endl;
 
 		float normalized_demand = node_demand_metric(user_opts, routing_structs->rr_node);
 		cout << "fraction enumerated: " << (float)f_analysis_results.num_conns / (float)f_analysis_results.desired_conns << endl;
@@ -716,6 +1953,18 @@ float analyze_test_tile_connections(User_Options *user_opts, Analysis_Settings *
 		cout << endl;
 
 		result = normalized_demand;
+	} else if (topological_mode == REFINE){
+		/* the trajectory of refinement passes is reported by the caller */
+		result = node_demand_metric(user_opts, routing_structs->rr_node);
+	} else if (topological_mode == SENSITIVITY){
+		/* sum up the per-thread sensitivities (in thread order so that the result doesn't depend on timing) */
+		f_analysis_results.node_sensitivity.assign(num_nodes, 0.0);
+		for (int ithread = 0; ithread < num_threads; ithread++){
+			const vector<double> &thread_sensitivity = thread_tapes[ithread].node_sensitivity;
+			for (int inode = 0; inode < num_nodes; inode++){
+				f_analysis_results.node_sensitivity[inode] += thread_sensitivity[inode];
+			}
+		}
 	} else {
 		float opin_prob = user_opts->opin_probability;
 		float ipin_prob = user_opts->ipin_probability;
@@ -730,18 +1979,6 @@ float analyze_test_tile_connections(User_Options *user_opts, Analysis_Settings *
 		float worst_probabilities_fanout = 0;
 		float driver_prob_metric = 0;
 		float fanout_prob_metric = 0;
-		if (opin_prob != 0){
-			worst_probabilities_driver = analyze_lowest_probs_pqs( f_analysis_results.lowest_probs_pqs_drivers );
-			driver_prob_metric = worst_probabilities_driver / (f_analysis_results.max_possible_total_prob_drivers * WORST_ROUTABILITY_PERCENTILE_DRIVERS);
-		}
-
-		if (ipin_prob != 0){
-			worst_probabilities_fanout = analyze_lowest_probs_pqs( f_analysis_results.lowest_probs_pqs_fanout );
-			fanout_prob_metric = worst_probabilities_fanout / (f_analysis_results.max_possible_total_prob_fanout * WORST_ROUTABILITY_PERCENTILE_FANOUT);
-		}
-
-		cout << "Driver metric: " << driver_prob_metric << endl;
-		cout << "Fanout metric: " << fanout_prob_metric << endl;
 
 		/* combine the two parts of the routability metric into a single number */
 		float driver_prob_weight = 1;
@@ -750,140 +1987,75 @@ float analyze_test_tile_connections(User_Options *user_opts, Analysis_Settings *
 			driver_prob_weight = DRIVER_PROB_WEIGHT;
 			fanout_prob_weight = FANOUT_PROB_WEIGHT;
 		}
-		
-		float routability_metric = (driver_prob_weight * driver_prob_metric) + (fanout_prob_weight * fanout_prob_metric);
-
-		cout << "Routability metric: " << routability_metric << endl;
-
-		result = routability_metric;
-	}
-
-	malloc_trim(0);
-
-	return result;
-}
-
-
-/* fills an initially-empty vector with the sink indices to which the source at the specified tile coordinate should connect */
-static void get_corresponding_sink_ids(User_Options *user_opts, Analysis_Settings *analysis_settings, Arch_Structs *arch_structs, Routing_Structs *routing_structs,
-		int source_node_ind, Coordinate tile_coord, vector<int> &sink_indices, vector<int> &ss_length, vector<int> &source_conns_at_length){
 
-	if (sink_indices.size() != 0){
-		WTHROW(EX_PATH_ENUM, "Sink indices vector must initially be empty");
-	}
-
-	t_grid &grid = arch_structs->grid;
-	t_block_type &block_type = arch_structs->block_type;
-	int grid_size_x, grid_size_y;
-	arch_structs->get_grid_size(&grid_size_x, &grid_size_y);
-
-	Grid_Tile *test_tile = &grid[tile_coord.x][tile_coord.y];
-
-	Physical_Type_Descriptor *test_tile_type = &block_type[test_tile->get_type_index()];
-
-	/* get pin and length probabilities */
-	t_prob_list &length_prob = analysis_settings->length_probabilities;
-
-	/* check probability of source node. if it's 0, then no point in enumerating from it */
-	float sum_of_source_probabilities;
-	get_sum_of_source_probabilities(source_node_ind, routing_structs->rr_node, analysis_settings->pin_probabilities, *test_tile_type,
-				&sum_of_source_probabilities, NULL);
-	if (sum_of_source_probabilities == 0){
-		return;
-	}
-
-	/* make sure specified tile is of 'fill' type */
-	int fill_type_ind = arch_structs->get_fill_type_index();
-	if (fill_type_ind != test_tile->get_type_index()){
-		WTHROW(EX_PATH_ENUM, "Attempting to analyze source in a block that's not of fill type.");
-	}
-	
-	/* make sure the current grid tile is not at an offset */
-	if (test_tile->get_width_offset() != 0 || test_tile->get_height_offset() != 0){
-		WTHROW(EX_PATH_ENUM, "Fill type block with name '" << test_tile_type->get_name() << "' has non-zero width/height offset. " <<
-				"This sort of logic block is not currently allowed.");
-	}
-
-	/* make sure the test tile has blocks at each possible connection length away from it. the furthest block from the test tile
-	   is basically the distance to the farthest legal corner of the FPGA */
-	int max_conn_length = user_opts->max_connection_length;
-	/* offset from perimeter because we don't want I/O blocks */
-	int max_block_dist = max( tile_coord.get_dx_plus_dy(1,1), tile_coord.get_dx_plus_dy(1, grid_size_y-2) );
-	max_block_dist = max( max_block_dist, tile_coord.get_dx_plus_dy(grid_size_x-2, grid_size_y-2) );
-	max_block_dist = max( max_block_dist, tile_coord.get_dx_plus_dy(grid_size_x-2, 1) );
-
-	if (max_block_dist < max_conn_length){
-		WTHROW(EX_PATH_ENUM, "It is not possible to connect test tile at coordinate " << tile_coord << 
-				     " to any blocks a manhattan distance " << max_conn_length << " away");
-	}
-
-
-	/* get sinks at neighboring tiles */
-	for (int ilen = 1; ilen <= max_conn_length; ilen++){
-		if (length_prob[ilen] == 0){
-			continue;
+		/* with tail sampling, the worst-connection queues are empty and their contents are estimated from the sample instead */
+		Tail_Estimate driver_estimate, fanout_estimate;
+		if (use_tail_sampling){
+			driver_estimate = f_tail_sampler.estimate(DRIVER);
+			fanout_estimate = f_tail_sampler.estimate(RECEIVER);
 		}
 
-		int num_conns_at_length = conns_at_distance_from_tile(tile_coord.x, tile_coord.y, ilen, grid,
-					      grid_size_x, grid_size_y, block_type, fill_type_ind);
-
-		/* traverse a list of blocks that is a distance 'ilen' away from the test tile.
-		   here we want to consider each combination of dx and dy who's (individually absolute) sum adds up
-		   to ilen */
-		for (int idx = -ilen; idx <= ilen; idx++){
-			int y_distance = ilen - abs(idx);
-			for (int idy = -y_distance; idy <= y_distance; idy += max(2*y_distance, 1)){	//max() in case y_distance=0
-				int dest_x = tile_coord.x + idx;
-				int dest_y = tile_coord.y + idy;
-				
-
-				/* check if this block is within grid bounds */
-				if ( (dest_x > 0 && dest_x < grid_size_x-1) &&
-				     (dest_y > 0 && dest_y < grid_size_y-1) ){
-
-					Grid_Tile *dest_tile = &grid[dest_x][dest_y];
-					int dest_type_ind = dest_tile->get_type_index();
+		/* the sensitivity phase needs to know which connections made it into the metric, and with what weight */
+		if (use_tail_sampling){
+			f_analysis_results.worst_probs_cutoff_drivers = driver_estimate.cutoff;
+			f_analysis_results.worst_probs_cutoff_fanout = fanout_estimate.cutoff;
+		} else {
+			record_worst_probs_cutoffs(f_analysis_results.lowest_probs_pqs_drivers, f_analysis_results.worst_probs_cutoff_drivers);
+			record_worst_probs_cutoffs(f_analysis_results.lowest_probs_pqs_fanout, f_analysis_results.worst_probs_cutoff_fanout);
+		}
+		if (opin_prob != 0 && f_analysis_results.max_possible_total_prob_drivers > 0){
+			f_analysis_results.driver_metric_scale = driver_prob_weight / (f_analysis_results.max_possible_total_prob_drivers * WORST_ROUTABILITY_PERCENTILE_DRIVERS);
+		}
+		if (ipin_prob != 0 && f_analysis_results.max_possible_total_prob_fanout > 0){
+			f_analysis_results.fanout_metric_scale = fanout_prob_weight / (f_analysis_results.max_possible_total_prob_fanout * WORST_ROUTABILITY_PERCENTILE_FANOUT);
+		}
 
+		if (use_tail_sampling){
+			if (opin_prob != 0 && f_analysis_results.max_possible_total_prob_drivers > 0){
+				driver_prob_metric = driver_estimate.total_tail_sum / (f_analysis_results.max_possible_total_prob_drivers * WORST_ROUTABILITY_PERCENTILE_DRIVERS);
+			}
+			if (ipin_prob != 0 && f_analysis_results.max_possible_total_prob_fanout > 0){
+				fanout_prob_metric = fanout_estimate.total_tail_sum / (f_analysis_results.max_possible_total_prob_fanout * WORST_ROUTABILITY_PERCENTILE_FANOUT);
+			}
+		} else {
+			if (opin_prob != 0){
+				worst_probabilities_driver = analyze_lowest_probs_pqs( f_analysis_results.lowest_probs_pqs_drivers );
+				driver_prob_metric = worst_probabilities_driver / (f_analysis_results.max_possible_total_prob_drivers * WORST_ROUTABILITY_PERCENTILE_DRIVERS);
+			}
 
-					Physical_Type_Descriptor *dest_type = &block_type[dest_type_ind];
+			if (ipin_prob != 0){
+				worst_probabilities_fanout = analyze_lowest_probs_pqs( f_analysis_results.lowest_probs_pqs_fanout );
+				fanout_prob_metric = worst_probabilities_fanout / (f_analysis_results.max_possible_total_prob_fanout * WORST_ROUTABILITY_PERCENTILE_FANOUT);
+			}
+		}
 
-					/* iterate over each pin class*/
-					for (int iclass = 0; iclass < (int)dest_type->class_inf.size(); iclass++){
-						Pin_Class *pin_class = &dest_type->class_inf[iclass];
-						
-						/* only want classes that represent receiver pins. also must actually have pins */
-						if (pin_class->get_pin_type() != RECEIVER || pin_class->get_num_pins() == 0){
-							continue;
-						}
+		cout << "Driver metric: " << driver_prob_metric << endl;
+		cout << "Fanout metric: " << fanout_prob_metric << endl;
 
-						/* do not want global pins */
-						int sample_pin = pin_class->pinlist[0];
-						if (dest_type->is_global_pin[sample_pin]){
-							continue;
-						}
+		float routability_metric = (driver_prob_weight * driver_prob_metric) + (fanout_prob_weight * fanout_prob_metric);
 
-						/* get node corresponding to this sink */	
-						int sink_node_ind = routing_structs->rr_node_index[SINK][dest_x][dest_y][iclass];
+		cout << "Routability metric: " << routability_metric << endl;
+		cout << "Searches skipped (sink out of reach): " << f_analysis_results.num_skipped_searches << endl;
 
-						//XXX
-						double rand_value = (double)rand() / (double)(RAND_MAX);
-						//if (rand_value > FRACTION_CONNS){
-						if (rand_value > user_opts->length_probabilities[ilen] * FRACTION_CONNS){
-							continue;
-						}
+		if (user_opts->probability_mode == MONTE_CARLO){
+			print_monte_carlo_confidence(user_opts, routability_metric);
+		}
+		if (use_tail_sampling){
+			print_tail_sampling_confidence(driver_estimate, fanout_estimate, routability_metric);
+		}
+		if (use_exact){
+			print_exact_stats(thread_exact_frontiers);
+		}
+		if (user_opts->validate_estimators){
+			print_estimator_validation(user_opts);
+		}
 
-						sink_indices.push_back( sink_node_ind );
-						ss_length.push_back( ilen );
+		result = routability_metric;
+	}
 
-						//XXX
-						source_conns_at_length.push_back( num_conns_at_length /** user_opts->length_probabilities[ilen] * FRACTION_CONNS*/);
+	malloc_trim(0);
 
-						f_analysis_results.desired_conns++;
-					}
-				}
-			}
-		}
-	}
+	return result;
 }
 
 
@@ -970,7 +2142,7 @@ void* enumerate_paths_from_source( void *ptr ){
 
 	Conn_Info *conn_info = (Conn_Info*)ptr;
 	
-	vector<Source_Sink_Pair> &source_sink_pairs = conn_info->source_sink_pairs;
+	const Connection_Plan &connection_plan = (*conn_info->connection_plan);
 	User_Options *user_opts = conn_info->user_opts;
 	Analysis_Settings *analysis_settings = conn_info->analysis_settings;
 	Arch_Structs *arch_structs = conn_info->arch_structs;
@@ -981,20 +2153,36 @@ void* enumerate_paths_from_source( void *ptr ){
 	e_topological_mode topological_mode = conn_info->topological_mode;
 
 	try{
-		//can try randomly shuffling the order of the source/sink pairs being enumerated. I didn't see much improvement with this
-		//random_shuffle(source_sink_pairs.begin(), source_sink_pairs.end());
-
-		for (int ipair = 0; ipair < (int)source_sink_pairs.size(); ipair++){
-			Source_Sink_Pair ss_pair = source_sink_pairs[ipair];
-			int source_node_ind = ss_pair.source_ind;
-			int sink_node_ind = ss_pair.sink_ind;
-			int ss_length = ss_pair.ss_length;
-			int source_conns_at_length = ss_pair.source_conns_at_length;
+		/* connections are analyzed in weight epochs. all threads go through the same number of epochs (possibly with no connections
+		   in the later ones) and node weights are only re-snapshotted between epochs */
+		int iepoch = 0;
+		int conns_analyzed = 0;
+		for (int isource = 0; isource < (int)conn_info->plan_sources.size(); isource++){
+			const Planned_Source &planned_source = connection_plan.sources[ conn_info->plan_sources[isource] ];
+			int source_node_ind = planned_source.source_ind;
+
+			for (int iconn = planned_source.first_conn; iconn < planned_source.first_conn + planned_source.num_conns; iconn++){
+				const Planned_Connection &conn = connection_plan.conns[iconn];
+				int ss_length = conn.length;
+				int source_conns_at_length = connection_plan.get_tile_conns_at_length(planned_source.tile_ind, ss_length);
+
+				/* analyze this source/sink connection */
+				analyze_connection(source_node_ind, conn.sink_ind, analysis_settings, arch_structs, 
+							routing_structs, ss_distances, node_topo_inf, ss_length, 
+							source_conns_at_length, nodes_visited, topological_mode, user_opts, conn_info, iconn);
+
+				conns_analyzed++;
+				if (conns_analyzed % conn_info->conns_per_epoch == 0 && iepoch < conn_info->num_epochs-1){
+					advance_weight_epoch(conn_info);
+					iepoch++;
+				}
+			}
+		}
 
-			/* analyze this source/sink connection */
-			analyze_connection(source_node_ind, sink_node_ind, analysis_settings, arch_structs, 
-						routing_structs, ss_distances, node_topo_inf, ss_length, 
-						source_conns_at_length, nodes_visited, topological_mode, user_opts);
+		/* threads that ran out of connections still have to take part in the remaining snapshots */
+		while (iepoch < conn_info->num_epochs-1){
+			advance_weight_epoch(conn_info);
+			iepoch++;
 		}
 
 	} catch (Wotan_Exception &e){
@@ -1008,8 +2196,31 @@ void* enumerate_paths_from_source( void *ptr ){
 }
 
 
+/* called by every analysis thread at the end of a weight epoch. once all threads arrive, they jointly re-freeze node weights
+   and demands, and wait for the new snapshot to be complete before continuing */
+static void advance_weight_epoch(Conn_Info *conn_info){
+	Routing_Structs *routing_structs = conn_info->routing_structs;
+	Node_Values &node_values = routing_structs->node_values;
+	int num_nodes = routing_structs->get_num_rr_nodes();
+
+	/* once everyone is here, nobody is reading the snapshot or incrementing demands */
+	int result = pthread_barrier_wait(&f_analysis_results.thread_barrier);
+
+	int nodes_per_thread = (num_nodes + conn_info->num_threads - 1) / conn_info->num_threads;
+	int from_node = min(num_nodes, conn_info->thread_ind * nodes_per_thread);
+	int to_node = min(num_nodes, from_node + nodes_per_thread);
+	node_values.freeze_range(routing_structs->rr_node, conn_info->user_opts, from_node, to_node);
+	if (result == PTHREAD_BARRIER_SERIAL_THREAD){
+		node_values.num_snapshots++;
+	}
+
+	/* the new snapshot becomes visible to all threads at once */
+	pthread_barrier_wait(&f_analysis_results.thread_barrier);
+}
+
+
 /* returns from_x/to_x/from_y/to_y iteration limits (inclusive) of a 'core' FPGA region that is CORE_OFFSET tiles away from the FPGA perimeter */
-static void get_prob_analysis_tile_region(User_Options *user_opts, int grid_size_x, int grid_size_y, int *from_x, int *from_y, int *to_x, int *to_y){
+void get_prob_analysis_tile_region(User_Options *user_opts, int grid_size_x, int grid_size_y, int *from_x, int *from_y, int *to_x, int *to_y){
 
 	if (user_opts->analyze_core){
 		*from_x = CORE_OFFSET;
@@ -1023,114 +2234,17 @@ static void get_prob_analysis_tile_region(User_Options *user_opts, int grid_size
 		*from_y = 1;
 		*to_y = grid_size_y-2; 
 	}
-}
-
-
-/* currently returns the total number of connections at each connection length <= maximum connection length */
-static void get_conn_length_stats(User_Options *user_opts, Analysis_Settings *analysis_settings, Routing_Structs *routing_structs, 
-                        Arch_Structs *arch_structs, e_pin_type enumerate_type, vector<int> &conns_at_length){
-
-	int max_conn_length = user_opts->max_connection_length;
-	t_grid &grid = arch_structs->grid;
-	t_block_type &block_type = arch_structs->block_type;
-
-	int grid_size_x, grid_size_y;
-	arch_structs->get_grid_size(&grid_size_x, &grid_size_y);
-
-	int fill_type_ind = arch_structs->get_fill_type_index();
-	Physical_Type_Descriptor *fill_type = &block_type[fill_type_ind];
-
-	/* 0..max_conn_length possible connection lengths */
-	conns_at_length.assign(max_conn_length + 1, 0);
-
-	/* determine the iteration limits for the region of the FPGA which we want to analyze */
-	int from_x, to_x, from_y, to_y;
-	get_prob_analysis_tile_region(user_opts, grid_size_x, grid_size_y, &from_x, &from_y, &to_x, &to_y);
-
-	/* calculate number of sources in a tile of fill type */
-	int num_tile_pins = fill_type->get_num_pins();
-	int num_tile_sources = 0;
-	for (int ipin = 0; ipin < num_tile_pins; ipin++){
-		/* skip global pins */
-		if (fill_type->is_global_pin[ipin]){
-			continue;
-		}
-
-		/* get type of this pin */
-		int pin_class_ind = fill_type->pin_class[ipin];
-		e_pin_type pin_type = fill_type->class_inf[pin_class_ind].get_pin_type();
-
-		if (pin_type == enumerate_type){
-			/* get probabiity of this pin being used as a source */
-			float pin_prob = analysis_settings->pin_probabilities[ipin];
-			if (pin_prob > 0){
-				num_tile_sources++;
-			}
-		}
-	}
-
-	/* iterate over the FPGA tiles as per 'get_prob_analysis_tile_region' */
-	for (int ix = from_x; ix <= to_x; ix++){
-		for (int iy = from_y; iy <= to_y; iy++){
-			int block_type_ind = grid[ix][iy].get_type_index();
-			int width_offset = grid[ix][iy].get_width_offset();
-			int height_offset = grid[ix][iy].get_height_offset();
-
-			/* error checks */
-			if (block_type_ind != fill_type_ind){
-				WTHROW(EX_PATH_ENUM, "Expected logic block type");
-			}
-			if (width_offset > 0 || height_offset > 0){
-				WTHROW(EX_PATH_ENUM, "Didn't expect logic block to have > 0 width/height offset");
-			}
 
-			/* for each legal length */
-			for (int ilen = 1; ilen <= max_conn_length; ilen++){
-				conns_at_length[ilen] += num_tile_sources * conns_at_distance_from_tile(ix, iy, ilen, grid, grid_size_x, grid_size_y,
-				                                                                       block_type, fill_type_ind);
-			}
-		}
+	/* only tiles inside the user-specified analysis window are analyzed */
+	if (user_opts->use_window){
+		*from_x = max(*from_x, user_opts->window_xlow);
+		*to_x = min(*to_x, user_opts->window_xhigh);
+		*from_y = max(*from_y, user_opts->window_ylow);
+		*to_y = min(*to_y, user_opts->window_yhigh);
 	}
 }
 
 
-/* returns number of connections from tile at the specified coordinates at specified length.
-   this is basically a sum of the number of input pins for each tile 'length' away from this one */
-static int conns_at_distance_from_tile(int tile_x, int tile_y, int length, t_grid &grid, 
-				int grid_size_x, int grid_size_y, t_block_type &block_type, int fill_type_ind){
-
-	int num_conns = 0;
-
-	/* traverse a list of blocks that is a distance 'length' away from the test tile.
-	   here we want to consider each combination of dx and dy who's (individually absolute) sum adds up
-	   to length */
-	for (int idx = -length; idx <= length; idx++){
-		int y_distance = length - abs(idx);
-		for (int idy = -y_distance; idy <= y_distance; idy += max(2*y_distance, 1)){	//max() in case y_distance=0
-			int dest_x = tile_x + idx;
-			int dest_y = tile_y + idy;
-
-			/* check if this block is within grid bounds */
-			if ( (dest_x > 0 && dest_x < grid_size_x-1) &&
-			     (dest_y > 0 && dest_y < grid_size_y-1) ){
-
-				Grid_Tile *dest_tile = &grid[dest_x][dest_y];
-				int dest_type_ind = dest_tile->get_type_index();
-
-				if (dest_type_ind != fill_type_ind){
-					WTHROW(EX_PATH_ENUM, "Encountered block that isn't of fill type (i.e. not a logic block)");
-				}
-
-				int num_input_pins = block_type[dest_type_ind].get_num_receivers();
-
-				num_conns += num_input_pins;
-			}
-		}
-	}
-
-	return num_conns;
-}
-
 
 /* allocates source/sink distance vector for each thread */
 void alloc_thread_ss_distances(t_thread_ss_distances &thread_ss_distances, int num_threads, int num_nodes){
@@ -1138,20 +2252,40 @@ void alloc_thread_ss_distances(t_thread_ss_distances &thread_ss_distances, int n
 }
 
 
-/* allocates node topological traversal info vector for each thread */
-void alloc_thread_node_topo_inf(t_thread_node_topo_inf &thread_node_topo_inf, int num_threads, int max_path_weight_bound, t_rr_node &rr_node, int num_nodes){
+/* allocates node topological traversal info vector for each thread. the node buckets of each thread are placed in one contiguous
+   block of scratch memory (file-backed in out-of-core mode) */
+void alloc_thread_node_topo_inf(t_thread_node_topo_inf &thread_node_topo_inf, t_thread_scratch &thread_bucket_storage, int num_threads,
+				int max_path_weight_bound, t_rr_node &rr_node, int num_nodes){
 	thread_node_topo_inf.assign(num_threads, t_node_topo_inf(num_nodes, Node_Topological_Info()));
 
 	//giving a bit of extra leeway
 	max_path_weight_bound *= 3;
 
-	for (int inode = 0; inode < num_nodes; inode++){
-		for (int ithread = 0; ithread < num_threads; ithread++){
-			thread_node_topo_inf[ithread][inode].buckets.alloc_source_sink_buckets(max_path_weight_bound+1, max_path_weight_bound+1);
+	/* source and sink buckets of a node are adjacent, and nodes are laid out by index. connections are analyzed in spatial order,
+	   and rr nodes are numbered roughly spatially, so in out-of-core mode paging of this block is mostly local */
+	int num_buckets = max_path_weight_bound+1;
+	size_t node_stride = 2 * (size_t)num_buckets;
+
+	free_thread_scratch(thread_bucket_storage);
+	for (int ithread = 0; ithread < num_threads; ithread++){
+		Scratch_Region *storage = new Scratch_Region( node_stride * (size_t)num_nodes * sizeof(double) );
+		thread_bucket_storage.push_back(storage);
+
+		double *thread_buckets = (double*)storage->get_base();
+		for (int inode = 0; inode < num_nodes; inode++){
+			thread_node_topo_inf[ithread][inode].buckets.assign_source_sink_buckets(thread_buckets + node_stride*inode, num_buckets);
 		}
 	}
 }
 
+/* frees the scratch memory blocks of each thread */
+void free_thread_scratch(t_thread_scratch &thread_scratch){
+	for (int ithread = 0; ithread < (int)thread_scratch.size(); ithread++){
+		delete thread_scratch[ithread];
+	}
+	thread_scratch.clear();
+}
+
 /* allocated any structures needed to keep track of self-congestion effects */
 void alloc_self_congestion_structs(User_Options *user_opts, Routing_Structs *routing_structs, Arch_Structs *arch_structs,
                                 t_thread_node_topo_inf &thread_node_topo_inf, int num_threads, int max_path_weight_bound, int num_nodes){
@@ -1207,7 +2341,8 @@ void alloc_threads( t_threads &threads, int num_threads ){
    metrics as necessary */
 static void analyze_connection(int source_node_ind, int sink_node_ind, Analysis_Settings *analysis_settings, Arch_Structs *arch_structs,
 			Routing_Structs *routing_structs, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, int conn_length,
-			int number_conns_at_length, t_nodes_visited &nodes_visited, e_topological_mode topological_mode, User_Options *user_opts){
+			int number_conns_at_length, t_nodes_visited &nodes_visited, e_topological_mode topological_mode, User_Options *user_opts,
+			Conn_Info *conn_info, int plan_conn_ind){
 
 	t_rr_node &rr_node = routing_structs->rr_node;
 
@@ -1221,6 +2356,25 @@ static void analyze_connection(int source_node_ind, int sink_node_ind, Analysis_
 		return;
 	}
 
+	/* with tail sampling, each connection is evaluated in at most one stage (or not at all). the pilot stage still goes over
+	   every connection to account for its ideal probability, which doesn't require a search */
+	bool sampled_out = false;
+	if (topological_mode == PROBABILITY && conn_info->tail_sampler != NULL && !conn_info->tail_sampler->evaluate_now(plan_conn_ind)){
+		if (conn_info->tail_sampler->current_stage != TAIL_STAGE_PILOT){
+			return;
+		}
+		sampled_out = true;
+	}
+
+	/* the connection's cost is measured from here on if the user asked for a profile */
+	bool profile_conn = (conn_info->conn_profile != NULL && !sampled_out);
+	double start_seconds = 0;
+	long long start_traversal_pops = 0;
+	if (profile_conn){
+		start_seconds = get_wall_seconds();
+		start_traversal_pops = get_thread_traversal_pops();
+	}
+
 	/* get the fill type descriptor (the most common block in the architecture) */
 	int fill_type_ind = arch_structs->get_fill_type_index();
 	Physical_Type_Descriptor &fill_block_type = arch_structs->block_type[fill_type_ind];
@@ -1241,15 +2395,71 @@ static void analyze_connection(int source_node_ind, int sink_node_ind, Analysis_
 	//	source_probability = one_pin_prob;
 	//}
 
+	/* a connection whose sink is out of reach of the maximum path weight even at zero node demand (see Reach_Labels) has no paths
+	   to enumerate and a routing probability of 0. its searches are skipped */
+	short min_weight = conn_info->connection_plan->conns[plan_conn_ind].min_weight;
+	bool skip_search = (min_weight != UNDEFINED && min_weight > analysis_settings->get_max_path_weight(conn_length));
+	if (skip_search && topological_mode != REFINE){
+		int checked_max_path_weight, checked_dist;
+		WCHECK(2, !get_ss_distances_and_adjust_max_path_weight(source_node_ind, sink_node_ind, rr_node, routing_structs->node_values, ss_distances,
+		                                                       analysis_settings->get_max_path_weight(conn_length), nodes_visited,
+		                                                       &checked_max_path_weight, &checked_dist),
+		       EX_PATH_ENUM, "Sink " << sink_node_ind << " was labeled out of reach of source " << source_node_ind << " but was reached");
+
+		pthread_mutex_lock(&f_analysis_results.thread_mutex);
+		f_analysis_results.num_skipped_searches++;
+		pthread_mutex_unlock(&f_analysis_results.thread_mutex);
+	}
+
 
 	if (topological_mode == ENUMERATE){
 		/* enumerate connection paths */
 
 		float scaling_factor_for_enumerate = (float)num_sinks * source_probability * length_prob / (float)number_conns_at_length;
-		enumerate_connection_paths(source_node_ind, sink_node_ind, analysis_settings, arch_structs, 
+		if (skip_search){
+			/* nothing to enumerate. an empty subgraph keeps the connection out of demand refinement */
+			if (conn_info->demand_refinement != NULL){
+				conn_info->demand_refinement->subgraphs[plan_conn_ind].clear();
+			}
+		} else if (conn_info->demand_refinement != NULL){
+			/* keep the connection's contributions in case it has to be re-enumerated later */
+			Demand_Refinement *refinement = conn_info->demand_refinement;
+			enumerate_connection_paths(source_node_ind, sink_node_ind, analysis_settings, arch_structs, 
+							routing_structs, ss_distances, node_topo_inf, conn_length, 
+							nodes_visited, user_opts,
+							scaling_factor_for_enumerate, &refinement->demand_records[plan_conn_ind]);
+			refinement->subgraphs[plan_conn_ind] = nodes_visited;
+		} else if (conn_info->template_cache != NULL){
+			enumerate_connection_paths_tiled(source_node_ind, sink_node_ind, analysis_settings, arch_structs, 
+							routing_structs, ss_distances, node_topo_inf, conn_length, 
+							nodes_visited, user_opts, scaling_factor_for_enumerate,
+							conn_info->template_cache, *conn_info->tile_signatures);
+		} else {
+			enumerate_connection_paths(source_node_ind, sink_node_ind, analysis_settings, arch_structs, 
 							routing_structs, ss_distances, node_topo_inf, conn_length, 
 							nodes_visited, user_opts,
-							scaling_factor_for_enumerate);
+							scaling_factor_for_enumerate, NULL);
+		}
+
+	} else if (topological_mode == REFINE){
+		/* replace the connection's previous demand contributions if the weight of any node that it visited has changed */
+		Demand_Refinement *refinement = conn_info->demand_refinement;
+		if (!refinement->conn_affected[plan_conn_ind]){
+			return;
+		}
+
+		t_demand_record &demand_record = refinement->demand_records[plan_conn_ind];
+		for (int ientry = 0; ientry < (int)demand_record.size(); ientry++){
+			rr_node[ demand_record[ientry].first ].increment_demand( -demand_record[ientry].second );
+		}
+		demand_record.clear();
+
+		float scaling_factor_for_enumerate = (float)num_sinks * source_probability * length_prob / (float)number_conns_at_length;
+		enumerate_connection_paths(source_node_ind, sink_node_ind, analysis_settings, arch_structs, 
+						routing_structs, ss_distances, node_topo_inf, conn_length, 
+						nodes_visited, user_opts,
+						scaling_factor_for_enumerate, &demand_record);
+		refinement->subgraphs[plan_conn_ind] = nodes_visited;
 
 	} else if (topological_mode == PROBABILITY){
 		/* check whether this source node corresponds to pins of 'driver' or 'receiver' type to figure out which part of the reachability
@@ -1259,56 +2469,143 @@ static void analyze_connection(int source_node_ind, int sink_node_ind, Analysis_
 		e_pin_type source_pin_type = source_pin_class.get_pin_type();
 
 		/* estimate probability of connection being routable and increment the probability metric */
-		float probability_connection_routable = estimate_connection_probability(source_node_ind, sink_node_ind, analysis_settings, arch_structs, 
-							routing_structs, ss_distances, node_topo_inf, conn_length, 
-							nodes_visited, user_opts);
+		float probability_connection_routable = 0.0;
+		if (!skip_search && !sampled_out){
+			probability_connection_routable = estimate_connection_probability(source_node_ind, sink_node_ind, analysis_settings, arch_structs, 
+								routing_structs, ss_distances, node_topo_inf, conn_length, 
+								nodes_visited, user_opts, user_opts->probability_mode, NULL, conn_info->monte_carlo_lanes,
+								conn_info->exact_frontier);
+		}
 
 		/* increment the probability metric */
 		if (probability_connection_routable >= 0){
 			float scaling_factor = (float)num_sinks * source_probability * length_prob / (float)number_conns_at_length;
 			float probability_increment = scaling_factor * probability_connection_routable;
 
-			/* increment probability metric */
+			/* increment probability metric. with tail sampling, the worst connections are instead estimated once all sampled
+			   connections are in */
 			int num_subsources = num_sources;
 			int num_subsinks = num_sinks;
-			increment_probability_metric(probability_increment, conn_length, source_node_ind, sink_node_ind, num_subsources, num_subsinks, source_pin_type);
-
-			/* add this connection's ideal probability to the running total (for normalizing later) */
-			pthread_mutex_lock(&f_analysis_results.thread_mutex);
-			if (source_pin_type == DRIVER){
-				f_analysis_results.max_possible_total_prob_drivers += scaling_factor * 1.0;	//1.0 because that's the max probability a connection can have
-			} else if (source_pin_type == RECEIVER){
-				f_analysis_results.max_possible_total_prob_fanout += scaling_factor * 1.0;
-				//cout << probability_connection_routable << " " << probability_increment << endl;
+			if (conn_info->tail_sampler != NULL){
+				if (!sampled_out){
+					int num_pushes = num_subsources * num_subsinks;
+					conn_info->tail_sampler->record(plan_conn_ind, probability_increment / (float)num_pushes, num_pushes);
+				}
 			} else {
-				WTHROW(EX_PATH_ENUM, "Unexpected source pin type: " << source_pin_type);
+				increment_probability_metric(probability_increment, conn_length, source_node_ind, sink_node_ind, num_subsources, num_subsinks, source_pin_type);
+			}
+
+			/* remember the sampling variance of this connection's contribution for the confidence intervals */
+			if (user_opts->probability_mode == MONTE_CARLO){
+				double prob = probability_connection_routable;
+				Monte_Carlo_Sample sample;
+				sample.length = conn_length;
+				sample.pin_type = source_pin_type;
+				sample.prob = probability_connection_routable;
+				sample.num_pushes = num_subsources * num_subsinks;
+				sample.push_value = probability_increment / (float)sample.num_pushes;
+				sample.increment_variance = (double)scaling_factor * scaling_factor * prob * (1 - prob) / (double)user_opts->monte_carlo_trials;
+
+				pthread_mutex_lock(&f_analysis_results.thread_mutex);
+				f_analysis_results.monte_carlo_samples.push_back(sample);
+				pthread_mutex_unlock(&f_analysis_results.thread_mutex);
+			}
+
+			/* add this connection's ideal probability to the running total (for normalizing later). with tail sampling, the pilot
+			   stage already went over every connection */
+			bool count_ideal_probability = (conn_info->tail_sampler == NULL || conn_info->tail_sampler->current_stage == TAIL_STAGE_PILOT);
+			if (count_ideal_probability){
+				pthread_mutex_lock(&f_analysis_results.thread_mutex);
+				if (source_pin_type == DRIVER){
+					f_analysis_results.max_possible_total_prob_drivers += scaling_factor * 1.0;	//1.0 because that's the max probability a connection can have
+				} else if (source_pin_type == RECEIVER){
+					f_analysis_results.max_possible_total_prob_fanout += scaling_factor * 1.0;
+					//cout << probability_connection_routable << " " << probability_increment << endl;
+				} else {
+					WTHROW(EX_PATH_ENUM, "Unexpected source pin type: " << source_pin_type);
+				}
+				pthread_mutex_unlock(&f_analysis_results.thread_mutex);
 			}
-			pthread_mutex_unlock(&f_analysis_results.thread_mutex);
 		} else {
 			WTHROW(EX_PATH_ENUM, "Got negative connection probability: " << probability_connection_routable);
 		}
+
+		if (user_opts->validate_estimators && !skip_search){
+			validate_connection_estimators(source_node_ind, sink_node_ind, analysis_settings, arch_structs, routing_structs, ss_distances,
+			                               node_topo_inf, conn_length, nodes_visited, user_opts, conn_info->monte_carlo_lanes,
+			                               conn_info->exact_frontier);
+		}
+	} else if (topological_mode == SENSITIVITY){
+		int source_ptc = rr_node[source_node_ind].get_ptc_num();
+		e_pin_type source_pin_type = fill_block_type.class_inf[source_ptc].get_pin_type();
+
+		/* redo the probability analysis of this connection, recording it onto the tape */
+		float probability_connection_routable = 0.0;
+		if (!skip_search){
+			probability_connection_routable = estimate_connection_probability(source_node_ind, sink_node_ind, analysis_settings, arch_structs, 
+								routing_structs, ss_distances, node_topo_inf, conn_length, 
+								nodes_visited, user_opts, PROPAGATE, conn_info->tape, NULL, NULL);
+		}
+
+		/* the connection only influences the routability metric if it was among the worst connections at its length. node demands
+		   haven't changed since probability analysis, so the value computed here is the same as the one that was pushed then */
+		float scaling_factor = (float)num_sinks * source_probability * length_prob / (float)number_conns_at_length;
+		float probability_increment = scaling_factor * probability_connection_routable;
+		float push_value = probability_increment / (float)(num_sources * num_sinks);
+
+		float cutoff;
+		double metric_scale;
+		if (source_pin_type == DRIVER){
+			cutoff = f_analysis_results.worst_probs_cutoff_drivers[conn_length];
+			metric_scale = f_analysis_results.driver_metric_scale;
+		} else {
+			cutoff = f_analysis_results.worst_probs_cutoff_fanout[conn_length];
+			metric_scale = f_analysis_results.fanout_metric_scale;
+		}
+
+		if (cutoff != UNDEFINED && push_value <= cutoff){
+			conn_info->tape->backpropagate(metric_scale * scaling_factor);
+		} else {
+			conn_info->tape->clear();
+		}
 	}
 
 	int max_path_weight = analysis_settings->get_max_path_weight(conn_length);
-	clean_node_data_structs(nodes_visited, ss_distances, node_topo_inf, max_path_weight);
+	int num_searched = (int)nodes_visited.size();
+	int subgraph_size = clean_node_data_structs(nodes_visited, ss_distances, node_topo_inf, max_path_weight);
+
+	if (profile_conn){
+		/* every node popped by the distance searches was added to the list of visited nodes */
+		Conn_Cost conn_cost;
+		conn_cost.source_ind = source_node_ind;
+		conn_cost.sink_ind = sink_node_ind;
+		conn_cost.length = conn_length;
+		conn_cost.pin_type = fill_block_type.class_inf[ rr_node[source_node_ind].get_ptc_num() ].get_pin_type();
+		conn_cost.cost[CONN_COST_MICROSECONDS] = 1e6 * (get_wall_seconds() - start_seconds);
+		conn_cost.cost[CONN_COST_SUBGRAPH] = subgraph_size;
+		conn_cost.cost[CONN_COST_NODES_POPPED] = num_searched + (get_thread_traversal_pops() - start_traversal_pops);
+		conn_info->conn_profile->record(conn_cost);
+	}
 }
 
 
-/* Enumerates paths between specified source/sink nodes. */
-void enumerate_connection_paths(int source_node_ind, int sink_node_ind, Analysis_Settings *analysis_settings, Arch_Structs *arch_structs,
+/* Enumerates paths between specified source/sink nodes. returns false if no paths could be enumerated.
+   if a demand record is specified, the demand contributed to each node is also recorded there */
+bool enumerate_connection_paths(int source_node_ind, int sink_node_ind, Analysis_Settings *analysis_settings, Arch_Structs *arch_structs,
 			Routing_Structs *routing_structs, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, int conn_length,
 			t_nodes_visited &nodes_visited, User_Options *user_opts,
-			float scaling_factor_for_enumerate){
+			float scaling_factor_for_enumerate, t_demand_record *demand_record){
 
 	t_rr_node &rr_node = routing_structs->rr_node;
+	const Node_Values &node_values = routing_structs->node_values;
 	/* get maximum allowable path weight of this connection */
 	int max_path_weight = analysis_settings->get_max_path_weight(conn_length);
 	int min_dist = UNDEFINED;
 
-	if (!get_ss_distances_and_adjust_max_path_weight(source_node_ind, sink_node_ind, rr_node, ss_distances, max_path_weight,
+	if (!get_ss_distances_and_adjust_max_path_weight(source_node_ind, sink_node_ind, rr_node, node_values, ss_distances, max_path_weight,
 					nodes_visited, &max_path_weight, &min_dist)){
 		//could not reach source or sink
-		return;
+		return false;
 	}
 
 	
@@ -1318,65 +2615,156 @@ void enumerate_connection_paths(int source_node_ind, int sink_node_ind, Analysis
 
 	/* perform path enumeration */
 	if (max_path_weight > 0 && min_dist > 0){
-
-		Enumerate_Structs enumerate_structs;
-		enumerate_structs.mode = BY_PATH_WEIGHT;
-
-		/* enumerate paths from sink */
-		node_topo_inf[sink_node_ind].buckets.sink_buckets[0] = 1;
-		do_topological_traversal(sink_node_ind, source_node_ind, rr_node, ss_distances, node_topo_inf, BACKWARD_TRAVERSAL,
-					max_path_weight, user_opts, (void*)&enumerate_structs,
-					enumerate_node_popped_func,
-					enumerate_child_iterated_func,
-					enumerate_traversal_done_func);
-
-		/* compute the number of paths to be enumerated from source (which accounts for the scaling factor) */
-		int source_node_weight = rr_node[source_node_ind].get_weight();
-		node_topo_inf[source_node_ind].buckets.source_buckets[0] = 1;
-		float num_enumerated = node_topo_inf[source_node_ind].buckets.get_num_paths(source_node_weight, 0, max_path_weight);
-
-		float scaled_starting_source_paths;
-		if (num_enumerated > 0){
-			if (scaling_factor_for_enumerate != UNDEFINED){
-				scaled_starting_source_paths = scaling_factor_for_enumerate / num_enumerated;
-			} else {
-				scaled_starting_source_paths = 1;
-			}
-		} else {
-			scaled_starting_source_paths = 0;
-		}
-
-		/* enumerate paths from source */
-		enumerate_structs.num_routing_nodes_in_subgraph = 0;
-		node_topo_inf[source_node_ind].buckets.source_buckets[0] = scaled_starting_source_paths;
-		do_topological_traversal(source_node_ind, sink_node_ind, rr_node, ss_distances, node_topo_inf, FORWARD_TRAVERSAL,
-					max_path_weight, user_opts, (void*)&enumerate_structs,
-					enumerate_node_popped_func,
-					enumerate_child_iterated_func,
-					enumerate_traversal_done_func);
+		enumerate_subgraph_paths(source_node_ind, sink_node_ind, rr_node, node_values, ss_distances, node_topo_inf, max_path_weight, user_opts,
+		                         scaling_factor_for_enumerate, demand_record);
 
 		/* increment number of connections for which paths have so far been enumerated */
 		pthread_mutex_lock(&f_analysis_results.thread_mutex);
 		f_analysis_results.num_conns++;
 		pthread_mutex_unlock(&f_analysis_results.thread_mutex);
+
+		return true;
+	}
+
+	return false;
+}
+
+
+/* the enumerate kernel: enumerates paths between the specified source/sink nodes over the legal subgraph that is given by the
+   source/sink distances (which must already be set) and the maximum path weight. paths are counted back from the sink, and then
+   forward from the source, where the demand they contribute is added to the traversed nodes (and to the demand record, if
+   one is specified) */
+void enumerate_subgraph_paths(int source_node_ind, int sink_node_ind, t_rr_node &rr_node, const Node_Values &node_values, t_ss_distances &ss_distances,
+			t_node_topo_inf &node_topo_inf, int max_path_weight, User_Options *user_opts, float scaling_factor_for_enumerate,
+			t_demand_record *demand_record){
+
+	Enumerate_Structs enumerate_structs;
+	enumerate_structs.mode = BY_PATH_WEIGHT;
+	enumerate_structs.demand_record = demand_record;
+	enumerate_structs.bucket_kernel = select_bucket_kernel(max_path_weight);
+
+	/* enumerate paths from sink */
+	node_topo_inf[sink_node_ind].buckets.sink_buckets[0] = 1;
+	do_topological_traversal(sink_node_ind, source_node_ind, rr_node, node_values, ss_distances, node_topo_inf, BACKWARD_TRAVERSAL,
+				max_path_weight, user_opts, (void*)&enumerate_structs,
+				enumerate_node_popped_func,
+				enumerate_child_iterated_func,
+				enumerate_traversal_done_func);
+
+	/* compute the number of paths to be enumerated from source (which accounts for the scaling factor) */
+	int source_node_weight = node_values.weight[source_node_ind];
+	node_topo_inf[source_node_ind].buckets.source_buckets[0] = 1;
+	float num_enumerated = node_topo_inf[source_node_ind].buckets.get_num_paths(source_node_weight, 0, max_path_weight);
+
+	float scaled_starting_source_paths;
+	if (num_enumerated > 0){
+		if (scaling_factor_for_enumerate != UNDEFINED){
+			scaled_starting_source_paths = scaling_factor_for_enumerate / num_enumerated;
+		} else {
+			scaled_starting_source_paths = 1;
+		}
+	} else {
+		scaled_starting_source_paths = 0;
+	}
+
+	/* enumerate paths from source */
+	enumerate_structs.num_routing_nodes_in_subgraph = 0;
+	node_topo_inf[source_node_ind].buckets.source_buckets[0] = scaled_starting_source_paths;
+	do_topological_traversal(source_node_ind, sink_node_ind, rr_node, node_values, ss_distances, node_topo_inf, FORWARD_TRAVERSAL,
+				max_path_weight, user_opts, (void*)&enumerate_structs,
+				enumerate_node_popped_func,
+				enumerate_child_iterated_func,
+				enumerate_traversal_done_func);
+}
+
+/* the propagate kernel: propagates the probability of reaching each node from the source over the legal subgraph that is given
+   by the source/sink distances (which must already be set) and the maximum path weight. returns the probability of reaching
+   the sink. if a tape is specified, the traversal is recorded onto it */
+float propagate_subgraph_probability(int source_node_ind, int sink_node_ind, t_rr_node &rr_node, const Node_Values &node_values, t_ss_distances &ss_distances,
+			t_node_topo_inf &node_topo_inf, int max_path_weight, User_Options *user_opts, Physical_Type_Descriptor *fill_type,
+			Propagate_Tape *tape){
+
+	node_topo_inf[source_node_ind].buckets.source_buckets[0] = 1;
+
+	Propagate_Structs propagate_structs;
+	propagate_structs.fill_type = fill_type;
+	propagate_structs.tape = tape;
+	propagate_structs.bucket_kernel = select_bucket_kernel(max_path_weight);
+	do_topological_traversal(source_node_ind, sink_node_ind, rr_node, node_values, ss_distances, node_topo_inf, FORWARD_TRAVERSAL,
+				max_path_weight, user_opts, (void*)&propagate_structs,
+				propagate_node_popped_func,
+				propagate_child_iterated_func,
+				propagate_traversal_done_func);
+
+	return propagate_structs.prob_routable;
+}
+
+/* enumerates paths between specified source/sink nodes with the tiled engine: demand recorded for an equivalent connection
+   is replayed if possible, otherwise the connection is enumerated and recorded as a new template */
+static void enumerate_connection_paths_tiled(int source_node_ind, int sink_node_ind, Analysis_Settings *analysis_settings, Arch_Structs *arch_structs,
+			Routing_Structs *routing_structs, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, int conn_length,
+			t_nodes_visited &nodes_visited, User_Options *user_opts, float scaling_factor_for_enumerate,
+			Enumerate_Template_Cache *template_cache, const t_tile_signatures &tile_signatures){
+
+	double start_time = get_wall_seconds();
+
+	if (user_opts->enumerate_engine == ENGINE_TILED){
+		const Enumerate_Template *enum_template = replay_enumerate_template(source_node_ind, sink_node_ind, scaling_factor_for_enumerate, true,
+		                                                                  routing_structs, tile_signatures, template_cache);
+		if (enum_template != NULL){
+			if (enum_template->enumerated){
+				pthread_mutex_lock(&f_analysis_results.thread_mutex);
+				f_analysis_results.num_conns++;
+				pthread_mutex_unlock(&f_analysis_results.thread_mutex);
+			}
+
+			template_cache->num_replayed++;
+			template_cache->replay_seconds += get_wall_seconds() - start_time;
+			return;
+		}
 	}
+
+	/* no template could be replayed -- traverse */
+	t_demand_record demand_record;
+	bool enumerated = enumerate_connection_paths(source_node_ind, sink_node_ind, analysis_settings, arch_structs, routing_structs, ss_distances,
+	                                             node_topo_inf, conn_length, nodes_visited, user_opts, scaling_factor_for_enumerate, &demand_record);
+
+	const Enumerate_Template *enum_template = NULL;
+	if (user_opts->enumerate_engine == ENGINE_VERIFY){
+		enum_template = replay_enumerate_template(source_node_ind, sink_node_ind, scaling_factor_for_enumerate, false,
+		                                          routing_structs, tile_signatures, template_cache);
+		if (enum_template != NULL){
+			verify_enumerate_template(*enum_template, source_node_ind, scaling_factor_for_enumerate, demand_record, routing_structs, template_cache);
+		}
+	}
+	if (enum_template == NULL){
+		record_enumerate_template(source_node_ind, sink_node_ind, scaling_factor_for_enumerate, enumerated, demand_record, nodes_visited,
+		                          routing_structs, tile_signatures, template_cache);
+	}
+
+	template_cache->num_traversed++;
+	template_cache->traverse_seconds += get_wall_seconds() - start_time;
 }
 
 
-/* Estimates the likelyhood (based on node demands) that the specified source/sink connection can be routed */
+/* Estimates the likelyhood (based on node demands) that the specified source/sink connection can be routed using the specified
+   probability mode. if a tape is specified, the probability analysis is recorded onto it. the monte carlo mode requires trial lanes,
+   and the exact mode a frontier */
 float estimate_connection_probability(int source_node_ind, int sink_node_ind, Analysis_Settings *analysis_settings, Arch_Structs *arch_structs,
 			Routing_Structs *routing_structs, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, int conn_length,
-			t_nodes_visited &nodes_visited, User_Options *user_opts){
+			t_nodes_visited &nodes_visited, User_Options *user_opts, e_probability_mode probability_mode, Propagate_Tape *tape,
+			Monte_Carlo_Lanes *monte_carlo_lanes, Exact_Frontier *exact_frontier){
 	
 	//float probability_sink_reachable = UNDEFINED;	//some sources/sinks just have no chance of connecting within specified max_path_weight. in that case want to return 0
 	float probability_sink_reachable = 0;
 
 	t_rr_node &rr_node = routing_structs->rr_node;
+	const Node_Values &node_values = routing_structs->node_values;
 	/* get maximum allowable path weight of this connection */
 	int max_path_weight = analysis_settings->get_max_path_weight(conn_length);
 	int min_dist = UNDEFINED;
 
-	if (!get_ss_distances_and_adjust_max_path_weight(source_node_ind, sink_node_ind, rr_node, ss_distances, max_path_weight,
+	if (!get_ss_distances_and_adjust_max_path_weight(source_node_ind, sink_node_ind, rr_node, node_values, ss_distances, max_path_weight,
 					nodes_visited, &max_path_weight, &min_dist)){
 		//could not reach source or sink
 		return 0.0;
@@ -1402,12 +2790,38 @@ float estimate_connection_probability(int source_node_ind, int sink_node_ind, An
 		   connection being routable. If any scaling to probabilities is desired, it should be done outside this
 		   function */
 
-		if ( PROBABILITY_MODE == CUTLINE ){
+		if ( probability_mode == EXACT ){
+			if (exact_frontier == NULL){
+				WTHROW(EX_PATH_ENUM, "Probability mode was set to EXACT but no frontier was allocated");
+			}
+			exact_frontier->start(source_node_ind);
+
+			Exact_Structs exact_structs;
+			exact_structs.fill_type = fill_type;
+			exact_structs.frontier = exact_frontier;
+			do_topological_traversal(source_node_ind, sink_node_ind, rr_node, node_values, ss_distances, node_topo_inf, FORWARD_TRAVERSAL,
+						max_path_weight, user_opts, (void*)&exact_structs,
+						exact_node_popped_func,
+						exact_child_iterated_func,
+						exact_traversal_done_func);
+
+			if (!exact_frontier->failed){
+				probability_sink_reachable = exact_structs.prob_routable;
+			} else {
+				/* the frontier grew too wide -- fall back to the propagate method */
+				clean_node_topo_inf(node_topo_inf, nodes_visited, max_path_weight);
+				probability_mode = PROPAGATE;
+			}
+		}
+
+		if ( probability_mode == EXACT ){
+			/* done above */
+		} else if ( probability_mode == CUTLINE ){
 			node_topo_inf[source_node_ind].set_level( 0 );
 
 			Cutline_Structs cutline_structs;
 			cutline_structs.fill_type = fill_type;
-			do_topological_traversal(source_node_ind, sink_node_ind, rr_node, ss_distances, node_topo_inf, FORWARD_TRAVERSAL,
+			do_topological_traversal(source_node_ind, sink_node_ind, rr_node, node_values, ss_distances, node_topo_inf, FORWARD_TRAVERSAL,
 						max_path_weight, user_opts, (void*)&cutline_structs,
 						cutline_node_popped_func,
 						cutline_child_iterated_func,
@@ -1415,9 +2829,8 @@ float estimate_connection_probability(int source_node_ind, int sink_node_ind, An
 
 			probability_sink_reachable = cutline_structs.prob_routable;
 
-		} else if ( PROBABILITY_MODE == CUTLINE_SIMPLE ){
-			set_node_hops(source_node_ind, sink_node_ind, rr_node, ss_distances, max_path_weight, FORWARD_TRAVERSAL);
-			set_node_hops(sink_node_ind, source_node_ind, rr_node, ss_distances, max_path_weight, BACKWARD_TRAVERSAL);
+		} else if ( probability_mode == CUTLINE_SIMPLE ){
+			set_node_hops(source_node_ind, sink_node_ind, rr_node, node_values, ss_distances, max_path_weight);
 
 			/* get hops from source to sink; size the cutline prob struct vector based on that */
 			int source_sink_hops = ss_distances[source_node_ind].get_sink_hops();	//hops from sink
@@ -1426,7 +2839,7 @@ float estimate_connection_probability(int source_node_ind, int sink_node_ind, An
 			cutline_simple_structs.cutline_simple_prob_struct.assign(source_sink_hops-1, vector<int>());
 			cutline_simple_structs.fill_type = fill_type;
 			
-			do_topological_traversal(source_node_ind, sink_node_ind, rr_node, ss_distances, node_topo_inf, FORWARD_TRAVERSAL,
+			do_topological_traversal(source_node_ind, sink_node_ind, rr_node, node_values, ss_distances, node_topo_inf, FORWARD_TRAVERSAL,
 						max_path_weight, user_opts, (void*)&cutline_simple_structs,
 						cutline_simple_node_popped_func,
 						cutline_simple_child_iterated_func,
@@ -1434,9 +2847,8 @@ float estimate_connection_probability(int source_node_ind, int sink_node_ind, An
 
 			probability_sink_reachable = cutline_simple_structs.prob_routable;
 
-		} else if ( PROBABILITY_MODE == CUTLINE_RECURSIVE ){
-			set_node_hops(source_node_ind, sink_node_ind, rr_node, ss_distances, max_path_weight, FORWARD_TRAVERSAL);
-			set_node_hops(sink_node_ind, source_node_ind, rr_node, ss_distances, max_path_weight, BACKWARD_TRAVERSAL);
+		} else if ( probability_mode == CUTLINE_RECURSIVE ){
+			set_node_hops(source_node_ind, sink_node_ind, rr_node, node_values, ss_distances, max_path_weight);
 
 			Cutline_Recursive_Structs cutline_rec_structs;
 
@@ -1448,7 +2860,7 @@ float estimate_connection_probability(int source_node_ind, int sink_node_ind, An
 			cutline_rec_structs.sink_ind = sink_node_ind;
 			cutline_rec_structs.fill_type = fill_type;
 
-			do_topological_traversal(source_node_ind, sink_node_ind, rr_node, ss_distances, node_topo_inf, FORWARD_TRAVERSAL,
+			do_topological_traversal(source_node_ind, sink_node_ind, rr_node, node_values, ss_distances, node_topo_inf, FORWARD_TRAVERSAL,
 						max_path_weight, user_opts, (void*)&cutline_rec_structs,
 						cutline_recursive_node_popped_func,
 						cutline_recursive_child_iterated_func,
@@ -1456,35 +2868,25 @@ float estimate_connection_probability(int source_node_ind, int sink_node_ind, An
 
 			probability_sink_reachable = cutline_rec_structs.prob_routable;
 
-		} else if ( PROBABILITY_MODE == PROPAGATE ){
-			node_topo_inf[source_node_ind].buckets.source_buckets[0] = 1;
-
-			Propagate_Structs propagate_structs;
-			propagate_structs.fill_type = fill_type;
-			do_topological_traversal(source_node_ind, sink_node_ind, rr_node, ss_distances, node_topo_inf, FORWARD_TRAVERSAL,
-						max_path_weight, user_opts, (void*)&propagate_structs,
-						propagate_node_popped_func,
-						propagate_child_iterated_func,
-						propagate_traversal_done_func);
-			
-
-			probability_sink_reachable = propagate_structs.prob_routable;
+		} else if ( probability_mode == PROPAGATE ){
+			probability_sink_reachable = propagate_subgraph_probability(source_node_ind, sink_node_ind, rr_node, node_values, ss_distances,
+			                                                            node_topo_inf, max_path_weight, user_opts, fill_type, tape);
 
-		} else if ( PROBABILITY_MODE == RELIABILITY_POLYNOMIAL ){
+		} else if ( probability_mode == RELIABILITY_POLYNOMIAL ){
 			if (user_opts->use_routing_node_demand == UNDEFINED){
 				WTHROW(EX_PATH_ENUM, "Probability mode was set to RELIABILITY_POLYNOMIAL. But user_opts->use_routing_node_demand was not set!");
 			}
 
-			set_node_hops(source_node_ind, sink_node_ind, rr_node, ss_distances, max_path_weight, FORWARD_TRAVERSAL);
-			set_node_hops(sink_node_ind, source_node_ind, rr_node, ss_distances, max_path_weight, BACKWARD_TRAVERSAL);
+			set_node_hops(source_node_ind, sink_node_ind, rr_node, node_values, ss_distances, max_path_weight);
 
 			/* enumerate paths from source */
 			/* note -- this increments node demands a second time. but since we will be ignoring node demands completely, this is fine */
 			Enumerate_Structs enumerate_structs;
 			enumerate_structs.mode = BY_PATH_HOPS;
+			enumerate_structs.bucket_kernel = select_bucket_kernel(max_path_weight + 3);	//hop buckets reach up to max_path_weight+3
 
 			node_topo_inf[source_node_ind].buckets.source_buckets[0] = 1;	//one path at bucket 0 -- gotta start with something
-			do_topological_traversal(source_node_ind, sink_node_ind, rr_node, ss_distances, node_topo_inf, FORWARD_TRAVERSAL,
+			do_topological_traversal(source_node_ind, sink_node_ind, rr_node, node_values, ss_distances, node_topo_inf, FORWARD_TRAVERSAL,
 						max_path_weight, user_opts, (void*)&enumerate_structs,
 						enumerate_node_popped_func,
 						enumerate_child_iterated_func,
@@ -1497,8 +2899,24 @@ float estimate_connection_probability(int source_node_ind, int sink_node_ind, An
 
 			probability_sink_reachable = analyze_reliability_polynomial(source_sink_hops, source_buckets, num_source_buckets,
 									enumerate_structs.num_routing_nodes_in_subgraph, 1-user_opts->use_routing_node_demand);
+		} else if ( probability_mode == MONTE_CARLO ){
+			if (monte_carlo_lanes == NULL){
+				WTHROW(EX_PATH_ENUM, "Probability mode was set to MONTE_CARLO but no trial lanes were allocated");
+			}
+			monte_carlo_lanes->start(source_node_ind);
+
+			Monte_Carlo_Structs monte_carlo_structs;
+			monte_carlo_structs.fill_type = fill_type;
+			monte_carlo_structs.lanes = monte_carlo_lanes;
+			do_topological_traversal(source_node_ind, sink_node_ind, rr_node, node_values, ss_distances, node_topo_inf, FORWARD_TRAVERSAL,
+						max_path_weight, user_opts, (void*)&monte_carlo_structs,
+						monte_carlo_node_popped_func,
+						monte_carlo_child_iterated_func,
+						monte_carlo_traversal_done_func);
+
+			probability_sink_reachable = monte_carlo_structs.prob_routable;
 		} else {
-			WTHROW(EX_PATH_ENUM, "Unknown probability mode: " << PROBABILITY_MODE);
+			WTHROW(EX_PATH_ENUM, "Unknown probability mode: " << probability_mode);
 		}
 
 		if (probability_sink_reachable > 1){
@@ -1512,10 +2930,64 @@ float estimate_connection_probability(int source_node_ind, int sink_node_ind, An
 }
 
 
+/* estimates the probability of the specified connection with the monte carlo mode and with each of the validated analytic modes,
+   and records the error of each analytic mode. node data structures are cleaned before every estimate */
+static void validate_connection_estimators(int source_node_ind, int sink_node_ind, Analysis_Settings *analysis_settings, Arch_Structs *arch_structs,
+			Routing_Structs *routing_structs, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, int conn_length,
+			t_nodes_visited &nodes_visited, User_Options *user_opts, Monte_Carlo_Lanes *monte_carlo_lanes,
+			Exact_Frontier *exact_frontier){
+
+	int max_path_weight = analysis_settings->get_max_path_weight(conn_length);
+
+	/* the monte carlo estimate serves as the reference */
+	clean_node_data_structs(nodes_visited, ss_distances, node_topo_inf, max_path_weight);
+	float monte_carlo_prob = estimate_connection_probability(source_node_ind, sink_node_ind, analysis_settings, arch_structs, routing_structs,
+	                                                         ss_distances, node_topo_inf, conn_length, nodes_visited, user_opts, MONTE_CARLO,
+	                                                         NULL, monte_carlo_lanes, NULL);
+
+	/* half-width of the 95% confidence interval of the monte carlo estimate. half a trial is added so that the interval doesn't
+	   vanish where the estimate is exactly 0 or 1 */
+	double num_trials = (double)user_opts->monte_carlo_trials;
+	double interval = 1.96 * sqrt( monte_carlo_prob * (1.0 - monte_carlo_prob) / num_trials ) + 0.5 / num_trials;
+
+	float estimates[NUM_VALIDATED_MODES];
+	bool applied[NUM_VALIDATED_MODES];
+	for (int imode = 0; imode < NUM_VALIDATED_MODES; imode++){
+		int num_abandoned = exact_frontier->num_attempted - exact_frontier->num_applied;
+
+		clean_node_data_structs(nodes_visited, ss_distances, node_topo_inf, max_path_weight);
+		estimates[imode] = estimate_connection_probability(source_node_ind, sink_node_ind, analysis_settings, arch_structs, routing_structs,
+		                                                   ss_distances, node_topo_inf, conn_length, nodes_visited, user_opts, f_validated_modes[imode],
+		                                                   NULL, NULL, exact_frontier);
+
+		/* the exact mode didn't apply if it fell back to the propagate mode */
+		applied[imode] = (exact_frontier->num_attempted - exact_frontier->num_applied == num_abandoned);
+	}
+
+	pthread_mutex_lock(&f_analysis_results.thread_mutex);
+	for (int imode = 0; imode < NUM_VALIDATED_MODES; imode++){
+		if (!applied[imode]){
+			continue;
+		}
+		double error = (double)estimates[imode] - (double)monte_carlo_prob;
+
+		Estimator_Error &estimator_error = f_analysis_results.estimator_errors[imode][conn_length];
+		estimator_error.num_conns++;
+		estimator_error.sum_error += error;
+		estimator_error.sum_abs_error += fabs(error);
+		estimator_error.sum_squared_error += error * error;
+		if (fabs(error) > interval){
+			estimator_error.num_outside_interval++;
+		}
+	}
+	pthread_mutex_unlock(&f_analysis_results.thread_mutex);
+}
+
+
 /* fills the t_ss_distances structures according to source & sink distances to intermediate nodes. 
    also returns an adjusted maximum path weight (to be further passed on to path enumeration / probability analysis functions)
    based on the distance from the source to the sink */
-bool get_ss_distances_and_adjust_max_path_weight(int source_node_ind, int sink_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances,
+bool get_ss_distances_and_adjust_max_path_weight(int source_node_ind, int sink_node_ind, t_rr_node &rr_node, const Node_Values &node_values, t_ss_distances &ss_distances,
                                 int max_path_weight, t_nodes_visited &nodes_visited, int *adjusted_max_path_weight, int *source_sink_dist){
 	
 	/* 
@@ -1527,10 +2999,18 @@ bool get_ss_distances_and_adjust_max_path_weight(int source_node_ind, int sink_n
 
 		is there a solution here to improve consistency?
 			- i've moved the BACKWARD_TRAVERSAL set_node_distances call *after* adjusting max path weight. will see how this affects things
+
+	NOTE: the forward traversal can't simply be bounded by the adjusted max_path_weight from the start (e.g. by first finding the
+		source-sink distance with a bidirectional search). node_has_chance_to_reach_destination measures the remaining distance
+		in tiles, which isn't a lower bound on the remaining path weight (a long wire can cover several tiles at a weight of 1).
+		the part of the forward traversal that runs before the sink is reached therefore keeps nodes, under the initial bound,
+		that later end up on legal paths -- tightening it changed the legal subgraph of about a third of the connections.
+		bounding only the remainder of the forward traversal by each node's distance to the sink is exact, but the backward
+		search needed for those distances visits more nodes than it saves
 	*/
 
 	/* set node distances for potentially relevant portion of graph */
-	set_node_distances(source_node_ind, sink_node_ind, rr_node, ss_distances, max_path_weight, FORWARD_TRAVERSAL, nodes_visited);
+	set_node_distances(source_node_ind, sink_node_ind, rr_node, node_values, ss_distances, max_path_weight, FORWARD_TRAVERSAL, nodes_visited);
 
 	/* adjust maximum allowable path weight based on minimum distance. FIXME. this may not work well for multiple wirelengths */
 	int min_dist_sink = ss_distances[sink_node_ind].get_source_distance();
@@ -1542,7 +3022,7 @@ bool get_ss_distances_and_adjust_max_path_weight(int source_node_ind, int sink_n
 	max_path_weight = adjust_max_path_weight_based_on_ss_dist(min_dist_sink, max_path_weight);
 
 
-	set_node_distances(sink_node_ind, source_node_ind, rr_node, ss_distances, max_path_weight, BACKWARD_TRAVERSAL, nodes_visited);
+	set_node_distances(sink_node_ind, source_node_ind, rr_node, node_values, ss_distances, max_path_weight, BACKWARD_TRAVERSAL, nodes_visited);
 	int min_dist_source = ss_distances[source_node_ind].get_sink_distance();
 	if (min_dist_sink != min_dist_source){
 		//commented because this can throw when we use dynamic node weights (in RR_Node::set_weight)
@@ -1574,11 +3054,14 @@ int adjust_max_path_weight_based_on_ss_dist(int min_dist_sink, int current_max_p
 
 /* traverses graph from 'from_node_ind' and for each node traversed, sets distance to the source/sink node from
    which the traversal started (based on traversal_dir) */
-void set_node_distances(int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances,
+void set_node_distances(int from_node_ind, int to_node_ind, t_rr_node &rr_node, const Node_Values &node_values, t_ss_distances &ss_distances,
 			int max_path_weight, e_traversal_dir traversal_dir, t_nodes_visited &nodes_visited){
 	
-	/* define a bounded-height priority queue in which to store nodes during traversal */
-	My_Bounded_Priority_Queue< int > PQ( max_path_weight*6 );
+	/* a bounded-height priority queue in which to store nodes during traversal. each thread keeps its own queue across calls
+	   so that the bucket and entry storage is only allocated once */
+	static thread_local My_Bounded_Priority_Queue< int > PQ;
+	PQ.clear();
+	PQ.set_max_weight( max_path_weight*6 );
 	int *edge_list;
 	int num_children;
 
@@ -1617,7 +3100,7 @@ void set_node_distances(int from_node_ind, int to_node_ind, t_rr_node &rr_node,
 
 		/* now iterate over children of this node and selectively push them onto the queue */
 		put_children_on_pq_and_set_ss_distance(num_children, edge_list, node_path_weight, ss_distances, max_path_weight, 
-						traversal_dir, rr_node, to_node_ind, &PQ);
+						traversal_dir, rr_node, node_values, to_node_ind, &PQ);
 
 		nodes_visited.push_back( node_ind );
 	}
@@ -1627,7 +3110,7 @@ void set_node_distances(int from_node_ind, int to_node_ind, t_rr_node &rr_node,
    enqueued nodes will be base_weight + their own weight.
    also... TODO */
 void put_children_on_pq_and_set_ss_distance(int num_edges, int *edge_list, int base_weight, t_ss_distances &ss_distances,
-		int max_path_weight, e_traversal_dir traversal_dir, t_rr_node &rr_node, int to_node_ind, My_Bounded_Priority_Queue<int> *PQ){
+		int max_path_weight, e_traversal_dir traversal_dir, t_rr_node &rr_node, const Node_Values &node_values, int to_node_ind, My_Bounded_Priority_Queue<int> *PQ){
 
 	int dest_xlow, dest_xhigh, dest_ylow, dest_yhigh;
 	
@@ -1659,7 +3142,7 @@ void put_children_on_pq_and_set_ss_distance(int num_edges, int *edge_list, int b
 			}
 		}
 		
-		int node_weight = rr_node[node_ind].get_weight();
+		int node_weight = node_values.weight[node_ind];
 		int path_weight = base_weight + node_weight;
 
 		/* mark node as visited */
@@ -1764,31 +3247,34 @@ bool node_has_chance_to_reach_destination(int node_ind, int destx, int desty, in
 }
 
 
-/* does BFS over legal subraph from the 'from' node to the 'to' node and sets minimum number of hops
-   required to arrive at each legal node from the 'from' node (along either the forward or reverse edges
-   as determined by traversal_dir) */
-void set_node_hops(int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances,
-			int max_path_weight, e_traversal_dir traversal_dir){
+/* does BFS over the legal subgraph and sets the minimum number of hops required to arrive at each legal node from the source
+   node (along forward edges) and from the sink node (along reverse edges).
+   both searches share one FIFO frontier. it starts out with the source and the sink at 0 hops and every node put on it is one hop
+   further than the node being expanded, so the frontier holds nodes in non-decreasing order of hops regardless of direction and
+   each direction gets the same hop counts as a separate BFS would give it */
+void set_node_hops(int source_node_ind, int sink_node_ind, t_rr_node &rr_node, const Node_Values &node_values, t_ss_distances &ss_distances,
+			int max_path_weight){
 
-	queue<int> Q;
-	Q.push( from_node_ind );
+	/* entries are node indices shifted left by one, with the lowest bit set for the backward (from sink) direction.
+	   each thread keeps its frontier across calls */
+	static thread_local vector<int> frontier;
+	frontier.clear();
 
-	if (traversal_dir == FORWARD_TRAVERSAL){
-		ss_distances[from_node_ind].set_source_hops(0);
-	} else {
-		ss_distances[from_node_ind].set_sink_hops(0);
-	}
+	ss_distances[source_node_ind].set_source_hops(0);
+	frontier.push_back( source_node_ind << 1 );
+	ss_distances[sink_node_ind].set_sink_hops(0);
+	frontier.push_back( (sink_node_ind << 1) | 1 );
 
-	while( !Q.empty() ){
-		int node_ind = Q.front();
-		Q.pop();
+	for (int ientry = 0; ientry < (int)frontier.size(); ientry++){
+		int node_ind = frontier[ientry] >> 1;
+		bool backward = (frontier[ientry] & 1);
 
 		int *edge_list;
 		int num_children;
 		int node_hops;
 
 		/* get edges over which to expand and mark the current node as done */
-		if (traversal_dir == FORWARD_TRAVERSAL){
+		if (!backward){
 			edge_list = rr_node[node_ind].out_edges;
 			num_children = rr_node[node_ind].get_num_out_edges();
 			ss_distances[node_ind].set_visited_from_source_hops(true);
@@ -1800,49 +3286,51 @@ void set_node_hops(int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_
 			node_hops = ss_distances[node_ind].get_sink_hops();
 		}
 
-
 		/* expand over edges */
 		for (int iedge = 0; iedge < num_children; iedge++){
 			int child_ind = edge_list[iedge];
-			int child_weight = rr_node[child_ind].get_weight();
-
-			/* check that child is legal */
-			if (!ss_distances[child_ind].is_legal(child_weight, max_path_weight)){
-				continue;
-			}
+			SS_Distances &child_distances = ss_distances[child_ind];
 
 			/* check that child node hasn't already been visited */
-			bool already_visited = false;
-			if (traversal_dir == FORWARD_TRAVERSAL){
-				already_visited = ss_distances[child_ind].get_visited_from_source_hops();
+			bool already_visited;
+			if (!backward){
+				already_visited = child_distances.get_visited_from_source_hops();
 			} else {
-				already_visited = ss_distances[child_ind].get_visited_from_sink_hops();
+				already_visited = child_distances.get_visited_from_sink_hops();
 			}
 			if (already_visited){
 				continue;
 			}
 
-			/* set # hops from 'from_node_ind' node and add child to expansion queue */
-			if (traversal_dir == FORWARD_TRAVERSAL){
-				ss_distances[child_ind].set_visited_from_source_hops(true);
-				ss_distances[child_ind].set_source_hops(node_hops + 1);
+			/* check that child is legal */
+			if (!child_distances.is_legal(node_values.weight[child_ind], max_path_weight)){
+				continue;
+			}
+
+			/* set # hops from the source/sink node and add child to the frontier */
+			if (!backward){
+				child_distances.set_visited_from_source_hops(true);
+				child_distances.set_source_hops(node_hops + 1);
 			} else {
-				ss_distances[child_ind].set_sink_hops(node_hops + 1);
-				ss_distances[child_ind].set_visited_from_sink_hops(true);
+				child_distances.set_sink_hops(node_hops + 1);
+				child_distances.set_visited_from_sink_hops(true);
 			}
-			Q.push( child_ind );
+			frontier.push_back( (child_ind << 1) | (int)backward );
 		}
 	}
 }
 
 
-/* resets data structures associated with nodes that have been visited during the previous path traversals */
-void clean_node_data_structs(t_nodes_visited &nodes_visited, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, int max_path_weight){
+/* resets data structures associated with nodes that have been visited during the previous path traversals. returns the number
+   of nodes that were reached by topological traversals (the legal subgraph of the traversed connection) */
+int clean_node_data_structs(t_nodes_visited &nodes_visited, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, int max_path_weight){
 
 	clean_ss_distances(ss_distances, nodes_visited);
-	clean_node_topo_inf(node_topo_inf, nodes_visited, max_path_weight);
+	int num_traversed = clean_node_topo_inf(node_topo_inf, nodes_visited, max_path_weight);
 
 	nodes_visited.clear();
+
+	return num_traversed;
 }
 
 /* clears ss_distances structure according to nodes that have been visited during graph traversal */
@@ -1860,9 +3348,11 @@ void clean_ss_distances(t_ss_distances &ss_distances, t_nodes_visited &nodes_vis
 	}
 }
 
-/* clears node_buckets structure according to nodes that have been visited during graph traversal */
-void clean_node_topo_inf(t_node_topo_inf &node_topo_inf, t_nodes_visited &nodes_visited, int max_path_weight){
+/* clears node_buckets structure according to nodes that have been visited during graph traversal. returns the number of nodes
+   that were reached by topological traversals */
+int clean_node_topo_inf(t_node_topo_inf &node_topo_inf, t_nodes_visited &nodes_visited, int max_path_weight){
 	int num_nodes_visited = (int)nodes_visited.size();
+	int num_traversed = 0;
 
 	for (int inode = 0; inode < num_nodes_visited; inode++){
 		int node_ind = nodes_visited[inode];
@@ -1871,8 +3361,11 @@ void clean_node_topo_inf(t_node_topo_inf &node_topo_inf, t_nodes_visited &nodes_
 		if (node_topo_inf[node_ind].get_was_visited()){
 			//node_topo_inf[node_ind].buckets.clear_up_to(max_path_weight);
 			node_topo_inf[node_ind].clear();
+			num_traversed++;
 		} 
 	}
+
+	return num_traversed;
 }
 
 /* returns the sum of pin probabilities over all the pins that the specified source node represents */
@@ -1982,6 +3475,130 @@ void increment_probability_metric(float probability_increment, int connection_le
 }
 
 
+/* records the cutoff values of the worst-connection priority queues (before they are consumed by analyze_lowest_probs_pqs) */
+static void record_worst_probs_cutoffs(vector<t_lowest_probs_pq> &lowest_probs_pqs, vector<float> &cutoffs){
+	int num_lengths = (int)lowest_probs_pqs.size();
+	cutoffs.assign(num_lengths, UNDEFINED);
+	for (int ilen = 0; ilen < num_lengths; ilen++){
+		if (lowest_probs_pqs[ilen].size() > 0){
+			cutoffs[ilen] = lowest_probs_pqs[ilen].top();
+		}
+	}
+}
+
+/* prints 95% confidence intervals of the mean connection probability at each length and of the routability metric, based on
+   the connections analyzed in the monte carlo mode */
+static void print_monte_carlo_confidence(User_Options *user_opts, float routability_metric){
+	const vector<Monte_Carlo_Sample> &samples = f_analysis_results.monte_carlo_samples;
+	int num_lengths = user_opts->max_connection_length + 1;
+
+	vector<int> num_conns(num_lengths, 0);
+	vector<double> sum_prob(num_lengths, 0.0);
+	vector<double> sum_prob_variance(num_lengths, 0.0);
+	double metric_variance = 0;
+	double num_trials = (double)user_opts->monte_carlo_trials;
+
+	for (int isample = 0; isample < (int)samples.size(); isample++){
+		const Monte_Carlo_Sample &sample = samples[isample];
+		num_conns[sample.length]++;
+		sum_prob[sample.length] += sample.prob;
+		sum_prob_variance[sample.length] += sample.prob * (1.0 - sample.prob) / num_trials;
+
+		/* the set of worst connections at each length is treated as fixed (as in the sensitivity phase) */
+		float cutoff;
+		double metric_scale;
+		if (sample.pin_type == DRIVER){
+			cutoff = f_analysis_results.worst_probs_cutoff_drivers[sample.length];
+			metric_scale = f_analysis_results.driver_metric_scale;
+		} else {
+			cutoff = f_analysis_results.worst_probs_cutoff_fanout[sample.length];
+			metric_scale = f_analysis_results.fanout_metric_scale;
+		}
+		if (cutoff != UNDEFINED && sample.push_value <= cutoff){
+			metric_variance += metric_scale * metric_scale * sample.increment_variance;
+		}
+	}
+
+	cout << "Monte carlo 95% confidence intervals (" << user_opts->monte_carlo_trials << " trials per connection):" << endl;
+	for (int ilen = 1; ilen < num_lengths; ilen++){
+		if (num_conns[ilen] == 0){
+			continue;
+		}
+		double mean_prob = sum_prob[ilen] / (double)num_conns[ilen];
+		double interval = 1.96 * sqrt(sum_prob_variance[ilen]) / (double)num_conns[ilen];
+		cout << "  len" << ilen << " mean connection probability: " << mean_prob << " +- " << interval << " (" << num_conns[ilen] << " conns)" << endl;
+	}
+	cout << "  Routability metric: " << routability_metric << " +- " << 1.96 * sqrt(metric_variance) << endl;
+}
+
+/* prints the estimated tail sums at each length and the confidence interval of the routability metric as estimated by tail sampling */
+static void print_tail_sampling_confidence(const Tail_Estimate &driver_estimate, const Tail_Estimate &fanout_estimate, float routability_metric){
+	cout << "Tail sampling 95% confidence intervals (" << f_tail_sampler.get_num_evaluated() << " of " << f_tail_sampler.num_eligible <<
+	        " connections evaluated):" << endl;
+	for (int itype = DRIVER; itype <= RECEIVER; itype++){
+		const Tail_Estimate &estimate = (itype == DRIVER ? driver_estimate : fanout_estimate);
+		for (int ilen = 1; ilen < (int)estimate.tail_sum.size(); ilen++){
+			if (estimate.num_conns[ilen] == 0){
+				continue;
+			}
+			cout << "  " << (itype == DRIVER ? "driver" : "fanout") << " len" << ilen << " tail sum: " << estimate.tail_sum[ilen] <<
+			        " +- " << 1.96 * sqrt(estimate.tail_sum_variance[ilen]) << " (" << estimate.num_evaluated[ilen] << " of " <<
+			        estimate.num_conns[ilen] << " conns)" << endl;
+		}
+	}
+
+	/* connections are sampled independently of each other, and the normalization of the metric is known exactly (every connection's
+	   ideal probability is accounted for during the pilot stage) */
+	double driver_scale = f_analysis_results.driver_metric_scale;
+	double fanout_scale = f_analysis_results.fanout_metric_scale;
+	double metric_variance = driver_scale * driver_scale * driver_estimate.total_variance + fanout_scale * fanout_scale * fanout_estimate.total_variance;
+	cout << "  Routability metric: " << routability_metric << " +- " << 1.96 * sqrt(metric_variance) << endl;
+}
+
+/* returns a name for the specified analysis phase, for use in printouts */
+static string get_phase_name(e_topological_mode topological_mode, User_Options *user_opts){
+	string phase_name;
+	switch (topological_mode){
+		case ENUMERATE:
+			phase_name = "path enumeration";
+			break;
+		case REFINE:
+			phase_name = "demand refinement";
+			break;
+		case PROBABILITY:
+			phase_name = "probability analysis (" + g_probability_mode_string[user_opts->probability_mode] + ")";
+			break;
+		case SENSITIVITY:
+			phase_name = "sensitivity analysis";
+			break;
+		default:
+			WTHROW(EX_PATH_ENUM, "Unexpected topological mode: " << topological_mode);
+			break;
+	}
+	return phase_name;
+}
+
+/* prints the error of each validated estimator at each connection length */
+static void print_estimator_validation(User_Options *user_opts){
+	cout << "Estimator errors w.r.t. monte carlo (" << user_opts->monte_carlo_trials << " trials per connection):" << endl;
+	for (int imode = 0; imode < NUM_VALIDATED_MODES; imode++){
+		cout << "  " << g_probability_mode_string[ f_validated_modes[imode] ] << ":" << endl;
+
+		const vector<Estimator_Error> &errors = f_analysis_results.estimator_errors[imode];
+		for (int ilen = 1; ilen < (int)errors.size(); ilen++){
+			const Estimator_Error &error = errors[ilen];
+			if (error.num_conns == 0){
+				continue;
+			}
+			double num_conns = (double)error.num_conns;
+			cout << "    len" << ilen << ": " << error.num_conns << " conns, mean error " << error.sum_error / num_conns
+			     << ", mean abs error " << error.sum_abs_error / num_conns
+			     << ", rms error " << sqrt(error.sum_squared_error / num_conns)
+			     << ", outside 95% interval " << 100.0 * error.num_outside_interval / num_conns << "%" << endl;
+		}
+	}
+}
+
 /* at each length, sums the probabilities of the x% worst possible connections */
 static float analyze_lowest_probs_pqs(vector<t_lowest_probs_pq> &lowest_probs_pqs){
 	float result = 0;
@@ -2008,10 +3625,10 @@ static float analyze_lowest_probs_pqs(vector<t_lowest_probs_pq> &lowest_probs_pq
 
 /* returns a node's demand, less the demand of the specified source/sink connection. if node didn't keep
    history of path counts due to this source/sink connection, or if 'fill_type' is specified as NULL, then node demand is unmodified */
-float get_node_demand_adjusted_for_path_history(int node_ind, t_rr_node &rr_node, int source_ind, int sink_ind, Physical_Type_Descriptor *fill_type,
+float get_node_demand_adjusted_for_path_history(int node_ind, t_rr_node &rr_node, const Node_Values &node_values, int source_ind, int sink_ind, Physical_Type_Descriptor *fill_type,
                                                        User_Options *user_opts){
 
-	float adjusted_node_demand = rr_node[node_ind].get_demand(user_opts);
+	float adjusted_node_demand = node_values.demand[node_ind];
 
 	if (fill_type != NULL && user_opts->self_congestion_mode == MODE_RADIUS){
 		RR_Node &source_node = rr_node[ source_ind ];
@@ -2036,3 +3653,55 @@ float get_node_demand_adjusted_for_path_history(int node_ind, t_rr_node &rr_node
 	return adjusted_node_demand;
 }
 
+
+/* returns a string describing the compile-time analysis settings (these are part of the key under which results are cached) */
+static string get_analysis_signature(Analysis_Settings *analysis_settings){
+	stringstream signature;
+	signature << "flexibility " << PATH_FLEXIBILITY_FACTOR
+	          << " core_offset " << CORE_OFFSET
+	          << " worst_drivers " << WORST_ROUTABILITY_PERCENTILE_DRIVERS
+	          << " worst_fanout " << WORST_ROUTABILITY_PERCENTILE_FANOUT
+	          << " driver_weight " << DRIVER_PROB_WEIGHT
+	          << " fanout_weight " << FANOUT_PROB_WEIGHT
+	          << " fraction_conns " << FRACTION_CONNS;
+	if (!analysis_settings->max_path_weight_table.empty()){
+		signature << " max_path_weights";
+		for (int ilen = 0; ilen < (int)analysis_settings->max_path_weight_table.size(); ilen++){
+			signature << " " << analysis_settings->max_path_weight_table[ilen];
+		}
+	}
+	return signature.str();
+}
+
+/* restores node demands & demand multiplier from a cached result and prints the cached metrics */
+static void apply_cached_result(Cached_Result &cached_result, User_Options *user_opts, Routing_Structs *routing_structs){
+	t_rr_node &rr_node = routing_structs->rr_node;
+	int num_nodes = routing_structs->get_num_rr_nodes();
+
+	if ((int)cached_result.node_demands.size() != num_nodes){
+		WTHROW(EX_OTHER, "Cached result has demands for " << cached_result.node_demands.size() << " nodes but the graph has " << num_nodes << " nodes");
+	}
+
+	user_opts->demand_multiplier = cached_result.demand_multiplier;
+
+	/* restore demands, then node weights */
+	for (int inode = 0; inode < num_nodes; inode++){
+		rr_node[inode].clear_demand();
+		rr_node[inode].increment_demand(cached_result.node_demands[inode]);
+	}
+	routing_structs->node_values.freeze(rr_node, user_opts, user_opts->num_threads);
+
+	for (int imetric = 0; imetric < (int)cached_result.metrics.size(); imetric++){
+		cout << cached_result.metrics[imetric].first << ": " << cached_result.metrics[imetric].second << endl;
+	}
+}
+
+
+/* returns the number of tiles around the analysis window for which the routing graph must still be loaded: paths of connections
+   from window tiles may run up to max_connection_length tiles away, plus some slack for paths that wander further than the
+   shortest path (see PATH_FLEXIBILITY_FACTOR) */
+int get_analysis_window_halo(User_Options *user_opts){
+	int max_len = user_opts->max_connection_length;
+	int halo = max_len + (int)ceil( (PATH_FLEXIBILITY_FACTOR - 1.0) * (double)max_len ) + 1;
+	return halo;
+}
@@ -2,15 +2,42 @@
 #define ANALYSIS_MAIN_H
 
 #include "wotan_types.h"
+#include "enumerate.h"
+#include "analysis_propagate.h"
 
 /**** Function Declarations ****/
 /* the entry function to performing routability analysis */
 void run_analysis(User_Options *user_opts, Analysis_Settings *analysis_settings, Arch_Structs *arch_structs, 
 			Routing_Structs *routing_structs);
 
+/* the enumerate kernel: enumerates paths between the specified source/sink nodes over the legal subgraph that is given by the
+   source/sink distances (which must already be set) and the maximum path weight. paths are counted back from the sink, and then
+   forward from the source, where the demand they contribute is added to the traversed nodes (and to the demand record, if
+   one is specified) */
+void enumerate_subgraph_paths(int source_node_ind, int sink_node_ind, t_rr_node &rr_node, const Node_Values &node_values, t_ss_distances &ss_distances,
+			t_node_topo_inf &node_topo_inf, int max_path_weight, User_Options *user_opts, float scaling_factor_for_enumerate,
+			t_demand_record *demand_record);
+
+/* the propagate kernel: propagates the probability of reaching each node from the source over the legal subgraph that is given
+   by the source/sink distances (which must already be set) and the maximum path weight. returns the probability of reaching
+   the sink. if a tape is specified, the traversal is recorded onto it */
+float propagate_subgraph_probability(int source_node_ind, int sink_node_ind, t_rr_node &rr_node, const Node_Values &node_values, t_ss_distances &ss_distances,
+			t_node_topo_inf &node_topo_inf, int max_path_weight, User_Options *user_opts, Physical_Type_Descriptor *fill_type,
+			Propagate_Tape *tape);
+
 /* returns a node's demand, less the demand of the specified source/sink connection. if node didn't keep
    history of path counts due to this source/sink connection, then node demand is unmodified */
-float get_node_demand_adjusted_for_path_history(int node_ind, t_rr_node &rr_node, int source_ind, int sink_ind, Physical_Type_Descriptor *fill_type,
+float get_node_demand_adjusted_for_path_history(int node_ind, t_rr_node &rr_node, const Node_Values &node_values, int source_ind, int sink_ind, Physical_Type_Descriptor *fill_type,
                                                        User_Options *user_opts);
 
+/* returns the sum of pin probabilities over all the pins that the specified source node represents */
+void get_sum_of_source_probabilities(int source_node_ind, t_rr_node &rr_node, t_prob_list &pin_probs,
+				Physical_Type_Descriptor &fill_block_type, float *sum_probabilities, float *one_pin_prob);
+
+/* returns from_x/to_x/from_y/to_y iteration limits (inclusive) of the FPGA region for which probability analysis is performed */
+void get_prob_analysis_tile_region(User_Options *user_opts, int grid_size_x, int grid_size_y, int *from_x, int *from_y, int *to_x, int *to_y);
+
+/* returns the number of tiles around the analysis window for which the routing graph must still be loaded */
+int get_analysis_window_halo(User_Options *user_opts);
+
 #endif
@@ -0,0 +1,236 @@
+/*
+	The 'monte carlo' method of analyzing reachability in a graph is invoked after paths have been enumerated
+through the routing resource graph.
+
+	Every node is taken to be blocked (unavailable for routing) with probability equal to its demand, independently of
+other nodes. Availability of all nodes in the legal subgraph of a connection is sampled for many trials at once, with each
+trial occupying one bit of a word, and reachability is propagated through the subgraph in the same topological order (and
+with the same path weight buckets) as the 'propagate' method -- only with AND/OR over trial words instead of products of
+probabilities. Unlike the 'propagate' method this makes no assumption that different paths are independent, so the
+fraction of trials in which the sink is reached is an unbiased estimate of the connection's routing probability. This
+makes it a reference against which the other methods can be compared.
+
+	The 'monte carlo' method of reachability analysis builds on top of a topological traversal of the subraph. Hence
+the constituent functions are meant to be passed-in to a topological traversal function (see topological_traversal.h)
+
+*/
+
+#include "analysis_main.h"
+#include "analysis_monte_carlo.h"
+#include "exception.h"
+#include "wotan_util.h"
+
+using namespace std;
+
+
+
+/**** Function Declarations ****/
+/* mixes the specified value into the specified random state */
+static unsigned long long mix_random_state(unsigned long long state, unsigned long long value);
+/* returns the next pseudo-random number of the specified state */
+static unsigned long long next_random(unsigned long long *state);
+/* samples the availability of a node with the specified probability of being blocked into the specified words (one bit per trial) */
+static void sample_node_availability(float prob_blocked, unsigned long long random_state, int num_words, unsigned long long *available);
+
+
+
+/**** Function Definitions ****/
+/*==== Monte_Carlo_Lanes Class ====*/
+Monte_Carlo_Lanes::Monte_Carlo_Lanes(){
+	this->num_words = 0;
+	this->num_buckets = 0;
+	this->seed = 0;
+}
+
+void Monte_Carlo_Lanes::init(int num_nodes, int set_num_buckets, int num_trials, unsigned int set_seed){
+	this->num_words = (num_trials + TRIALS_PER_WORD - 1) / TRIALS_PER_WORD;
+	this->num_buckets = set_num_buckets;
+	this->seed = set_seed;
+	this->node_slot.assign(num_nodes, UNDEFINED);
+	this->slot_node.clear();
+	this->reachable.clear();
+}
+
+/* returns the slot of the specified node, allocating one if the node hasn't been touched during this traversal */
+int Monte_Carlo_Lanes::get_slot(int node_ind){
+	int slot = this->node_slot[node_ind];
+	if (slot == UNDEFINED){
+		slot = (int)this->slot_node.size();
+		this->node_slot[node_ind] = slot;
+		this->slot_node.push_back(node_ind);
+
+		size_t new_size = (size_t)(slot+1) * this->num_buckets * this->num_words;
+		this->reachable.resize(new_size, 0);
+	}
+	return slot;
+}
+
+/* returns the trial words of the specified bucket of the specified slot */
+unsigned long long *Monte_Carlo_Lanes::get_words(int slot, int ibucket){
+	return &this->reachable[ ((size_t)slot*this->num_buckets + ibucket) * this->num_words ];
+}
+
+/* forgets the current traversal and marks the specified node as reachable (via a path of weight 0) in every trial */
+void Monte_Carlo_Lanes::start(int start_node_ind){
+	for (int islot = 0; islot < (int)this->slot_node.size(); islot++){
+		this->node_slot[ this->slot_node[islot] ] = UNDEFINED;
+	}
+	this->slot_node.clear();
+	this->reachable.clear();
+
+	int slot = this->get_slot(start_node_ind);
+	unsigned long long *words = this->get_words(slot, 0);
+	for (int iword = 0; iword < this->num_words; iword++){
+		words[iword] = ~0ULL;
+	}
+}
+
+
+/*==== Monte_Carlo_Structs Class ====*/
+Monte_Carlo_Structs::Monte_Carlo_Structs(){
+	this->prob_routable = UNDEFINED;
+	this->prob_variance = UNDEFINED;
+	this->fill_type = NULL;
+	this->lanes = NULL;
+}
+
+
+/* Called when node is popped from expansion queue during topological traversal */
+void monte_carlo_node_popped_func(int popped_node, int from_node_ind, int to_node_ind, t_rr_node &rr_node, const Node_Values &node_values, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
+                          e_traversal_dir traversal_dir, int max_path_weight, User_Options *user_opts, void *user_data){
+
+	Monte_Carlo_Structs *monte_carlo_structs = (Monte_Carlo_Structs*)user_data;
+	Monte_Carlo_Lanes *lanes = monte_carlo_structs->lanes;
+	int num_words = lanes->num_words;
+
+	/* the reachability of this node has been propagated from upstream nodes, but whether *this* node is available
+	   has not yet been factored in. it is sampled now -- the same node is sampled once per trial no matter how many
+	   paths run through it. the random state depends only on the connection and the node, so that results don't depend
+	   on the order in which threads analyze connections */
+	float node_demand = get_node_demand_adjusted_for_path_history(popped_node, rr_node, node_values, from_node_ind, to_node_ind, monte_carlo_structs->fill_type, user_opts);
+	float prob_blocked = max(0.0F, min(1.0F, node_demand));
+
+	unsigned long long random_state = mix_random_state(lanes->seed, (unsigned long long)from_node_ind);
+	random_state = mix_random_state(random_state, (unsigned long long)to_node_ind);
+	random_state = mix_random_state(random_state, (unsigned long long)popped_node);
+
+	vector<unsigned long long> available(num_words);
+	sample_node_availability(prob_blocked, random_state, num_words, &available[0]);
+
+	int slot = lanes->get_slot(popped_node);
+	for (int ibucket = 0; ibucket < lanes->num_buckets; ibucket++){
+		unsigned long long *words = lanes->get_words(slot, ibucket);
+		for (int iword = 0; iword < num_words; iword++){
+			words[iword] &= available[iword];
+		}
+	}
+}
+
+/* Called when topological traversal is iterateing over a node's children */
+bool monte_carlo_child_iterated_func(int parent_ind, int parent_edge_ind, int node_ind, t_rr_node &rr_node, const Node_Values &node_values, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
+                          e_traversal_dir traversal_dir, int max_path_weight, int from_node_ind, int to_node_ind, User_Options *user_opts, void *user_data){
+
+	Monte_Carlo_Structs *monte_carlo_structs = (Monte_Carlo_Structs*)user_data;
+	Monte_Carlo_Lanes *lanes = monte_carlo_structs->lanes;
+	int num_words = lanes->num_words;
+	bool ignore_node = false;
+
+	if (traversal_dir != FORWARD_TRAVERSAL){
+		WTHROW(EX_PATH_ENUM, "The monte carlo method only supports forward traversal");
+	}
+
+	int child_weight = node_values.weight[node_ind];
+	/* the weight of the minimum-weight path from child to the destination node (includes weight of child node) */
+	int child_path_weight_to_dest = ss_distances[node_ind].get_sink_distance();
+
+	/* get slots first -- allocating a slot may move the storage */
+	int parent_slot = lanes->get_slot(parent_ind);
+	int child_slot = lanes->get_slot(node_ind);
+
+	/* trials in which the parent is reached via a path of weight ibucket reach the child via a path of weight ibucket+child_weight.
+	   same bucket bounds as in the 'propagate' method */
+	for (int ibucket = 0; ibucket < lanes->num_buckets; ibucket++){
+		if (ibucket + child_path_weight_to_dest > max_path_weight){
+			break;
+		}
+		int target_bucket = ibucket + child_weight;
+		if (target_bucket >= lanes->num_buckets){
+			break;
+		}
+
+		const unsigned long long *parent_words = lanes->get_words(parent_slot, ibucket);
+		unsigned long long *child_words = lanes->get_words(child_slot, target_bucket);
+		for (int iword = 0; iword < num_words; iword++){
+			child_words[iword] |= parent_words[iword];
+		}
+	}
+
+	return ignore_node;
+}
+
+/* Called once topological traversal is complete.
+   Calculates probability of a source/sink connection being routable */
+void monte_carlo_traversal_done_func(int from_node_ind, int to_node_ind, t_rr_node &rr_node, const Node_Values &node_values, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
+                          e_traversal_dir traversal_dir, int max_path_weight, User_Options *user_opts, void *user_data){
+
+	Monte_Carlo_Structs *monte_carlo_structs = (Monte_Carlo_Structs*)user_data;
+	Monte_Carlo_Lanes *lanes = monte_carlo_structs->lanes;
+	int num_words = lanes->num_words;
+
+	/* a trial routes the connection if the destination is reached via a path of any (legal) weight */
+	int slot = lanes->get_slot(to_node_ind);
+	int num_routed = 0;
+	for (int iword = 0; iword < num_words; iword++){
+		unsigned long long routed = 0;
+		for (int ibucket = 0; ibucket < lanes->num_buckets; ibucket++){
+			routed |= lanes->get_words(slot, ibucket)[iword];
+		}
+		num_routed += __builtin_popcountll(routed);
+	}
+
+	int num_trials = num_words * TRIALS_PER_WORD;
+	float prob = (float)num_routed / (float)num_trials;
+	monte_carlo_structs->prob_routable = prob;
+	monte_carlo_structs->prob_variance = prob * (1 - prob) / (float)num_trials;
+}
+
+
+/* mixes the specified value into the specified random state */
+static unsigned long long mix_random_state(unsigned long long state, unsigned long long value){
+	unsigned long long z = state ^ (value + 0x9e3779b97f4a7c15ULL + (state << 6) + (state >> 2));
+	return next_random(&z);
+}
+
+/* returns the next pseudo-random number of the specified state (splitmix64) */
+static unsigned long long next_random(unsigned long long *state){
+	(*state) += 0x9e3779b97f4a7c15ULL;
+	unsigned long long z = (*state);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	return z ^ (z >> 31);
+}
+
+/* samples the availability of a node with the specified probability of being blocked into the specified words (one bit per trial) */
+static void sample_node_availability(float prob_blocked, unsigned long long random_state, int num_words, unsigned long long *available){
+	/* most nodes are either never or always blocked (e.g. zero demand) */
+	if (prob_blocked <= 0.0F || prob_blocked >= 1.0F){
+		unsigned long long word = (prob_blocked <= 0.0F ? ~0ULL : 0ULL);
+		for (int iword = 0; iword < num_words; iword++){
+			available[iword] = word;
+		}
+		return;
+	}
+
+	/* a trial's bit is set if a uniform 53-bit random number lies above the blocking threshold */
+	unsigned long long threshold = (unsigned long long)( (double)prob_blocked * (double)(1ULL << 53) );
+	for (int iword = 0; iword < num_words; iword++){
+		unsigned long long word = 0;
+		for (int ibit = 0; ibit < TRIALS_PER_WORD; ibit++){
+			unsigned long long sample = next_random(&random_state) >> 11;
+			if (sample >= threshold){
+				word |= (1ULL << ibit);
+			}
+		}
+		available[iword] = word;
+	}
+}
@@ -0,0 +1,66 @@
+#ifndef ANALYSIS_MONTE_CARLO_H
+#define ANALYSIS_MONTE_CARLO_H
+
+#include <vector>
+#include "wotan_types.h"
+
+
+/**** Defines ****/
+/* number of Monte Carlo trials packed into one word */
+#define TRIALS_PER_WORD 64
+
+
+/**** Classes ****/
+/* Per-thread storage for the 'monte carlo' method. For every node touched by the current traversal and every path weight
+   bucket, a set of words holds one bit per trial -- whether the node can be reached in that trial via available nodes along
+   a path of that weight. Storage is kept across connections so that it doesn't have to be reallocated */
+class Monte_Carlo_Lanes{
+public:
+	int num_words;				/* trials are packed TRIALS_PER_WORD to a word */
+	int num_buckets;
+	unsigned long long seed;
+
+	std::vector<int> node_slot;		/* [0..num_nodes-1] the slot of each node touched by the current traversal. UNDEFINED if not touched */
+	std::vector<int> slot_node;		/* node index of each slot */
+	std::vector<unsigned long long> reachable;	/* [(slot*num_buckets + ibucket)*num_words + iword] */
+
+	Monte_Carlo_Lanes();
+	void init(int num_nodes, int set_num_buckets, int num_trials, unsigned int set_seed);
+
+	/* returns the slot of the specified node, allocating one if the node hasn't been touched during this traversal */
+	int get_slot(int node_ind);
+	/* returns the trial words of the specified bucket of the specified slot */
+	unsigned long long *get_words(int slot, int ibucket);
+	/* forgets the current traversal and marks the specified node as reachable (via a path of weight 0) in every trial */
+	void start(int start_node_ind);
+};
+
+/* A class used to lump together all data structures specific to the monte carlo analysis method that
+   need to be passed around during topological traversal */
+class Monte_Carlo_Structs{
+public:
+	float prob_routable;
+	float prob_variance;			/* variance of the prob_routable estimate */
+	Physical_Type_Descriptor *fill_type;
+	Monte_Carlo_Lanes *lanes;
+
+	Monte_Carlo_Structs();
+};
+
+
+/**** Function Declarations ****/
+/* Called when node is popped from expansion queue during topological traversal */
+void monte_carlo_node_popped_func(int popped_node, int from_node_ind, int to_node_ind, t_rr_node &rr_node, const Node_Values &node_values, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
+                          e_traversal_dir traversal_dir, int max_path_weight, User_Options *user_opts, void *user_data);
+
+/* Called when topological traversal is iterateing over a node's children */
+bool monte_carlo_child_iterated_func(int parent_ind, int parent_edge_ind, int node_ind, t_rr_node &rr_node, const Node_Values &node_values, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
+                          e_traversal_dir traversal_dir, int max_path_weight, int from_node_ind, int to_node_ind, User_Options *user_opts, void *user_data);
+
+/* Called once topological traversal is complete.
+   Calculates probability of a source/sink connection being routable */
+void monte_carlo_traversal_done_func(int from_node_ind, int to_node_ind, t_rr_node &rr_node, const Node_Values &node_values, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
+                          e_traversal_dir traversal_dir, int max_path_weight, User_Options *user_opts, void *user_data);
+
+
+#endif
@@ -22,62 +22,266 @@ using namespace std;
 
 
 /**** Function Declarations ****/
-static void account_for_current_node_probability(int node_ind, int node_weight, float node_demand, t_node_topo_inf &node_topo_inf, t_rr_node &rr_node,
-                                                 e_self_congestion_mode self_congestion_mode, double demand_multiplier);
+static void account_for_current_node_probability(int node_ind, int node_weight, float node_demand, bool demand_saturated, t_node_topo_inf &node_topo_inf, t_rr_node &rr_node,
+                                                 e_self_congestion_mode self_congestion_mode, double demand_multiplier, Propagate_Tape *tape,
+                                                 int max_path_weight, e_bucket_kernel bucket_kernel);
 /* propagates path probabilities stored in the bucket structure of the parent node to the bucket structure of the child node */
-static void propagate_probabilities(int parent_ind, int parent_edge_ind, int child_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
-			e_traversal_dir traversal_dir, int max_path_weight, e_self_congestion_mode self_congestion_mode);
+static void propagate_probabilities(int parent_ind, int parent_edge_ind, int child_ind, t_rr_node &rr_node, const Node_Values &node_values, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
+			e_traversal_dir traversal_dir, int max_path_weight, e_self_congestion_mode self_congestion_mode, Propagate_Tape *tape,
+			e_bucket_kernel bucket_kernel);
+/* returns the derivative of 1 - (1-x_1)(1-x_2)...(1-x_n) w.r.t. x, given that 'num_ones' of the x's are 1 and that the
+   product of (1-x_i) over the remaining x's is 'product' */
+static double get_or_derivative(double x, int num_ones, double product);
 /* probability that node with specified buckets is reachable from source */
 static float get_prob_reachable( double *source_buckets, int num_source_buckets);
 
 
 
 /**** Function Definitions ****/
+/*==== Propagate_Structs Class ====*/
+Propagate_Structs::Propagate_Structs(){
+	this->prob_routable = UNDEFINED;
+	this->fill_type = NULL;
+	this->tape = NULL;
+	this->bucket_kernel = BUCKET_KERNEL_GENERIC;
+}
+
+
+/*==== Propagate_Tape Class ====*/
+Propagate_Tape::Propagate_Tape(){
+	this->num_buckets = 0;
+	this->dest_slot = UNDEFINED;
+}
+
+void Propagate_Tape::init(int num_nodes, int set_num_buckets){
+	this->num_buckets = set_num_buckets;
+	this->node_slot.assign(num_nodes, UNDEFINED);
+	this->node_sensitivity.assign(num_nodes, 0.0);
+	this->clear();
+}
+
+/* returns the slot of the specified node, allocating one if the node hasn't been touched during this traversal */
+int Propagate_Tape::get_slot(int node_ind){
+	int slot = this->node_slot[node_ind];
+	if (slot == UNDEFINED){
+		slot = (int)this->slot_node.size();
+		this->node_slot[node_ind] = slot;
+		this->slot_node.push_back(node_ind);
+		this->slot_popped.push_back(false);
+
+		size_t new_size = (size_t)(slot+1) * this->num_buckets;
+		this->values.resize(new_size, UNDEFINED);
+		this->factors.resize(new_size, 1.0);
+		this->demand_dependent.resize(new_size, false);
+	}
+	return slot;
+}
+
+/* forgets the current traversal (accumulated sensitivities are kept) */
+void Propagate_Tape::clear(){
+	for (int islot = 0; islot < (int)this->slot_node.size(); islot++){
+		this->node_slot[ this->slot_node[islot] ] = UNDEFINED;
+	}
+	this->slot_node.clear();
+	this->slot_popped.clear();
+	this->values.clear();
+	this->factors.clear();
+	this->demand_dependent.clear();
+	this->events.clear();
+	this->dest_slot = UNDEFINED;
+}
+
+/* back-propagates the probability of the recorded connection to the demands of the traversed nodes and accumulates
+   the derivatives, multiplied by 'scale', into node_sensitivity. clears the recording */
+void Propagate_Tape::backpropagate(double scale){
+	if (this->dest_slot == UNDEFINED || scale == 0){
+		this->clear();
+		return;
+	}
+
+	int nb = this->num_buckets;
+	size_t num_entries = this->slot_node.size() * (size_t)nb;
+
+	/* value of bucket [slot*nb + ibucket] after the slot's node was popped, i.e. the value that was propagated to its children */
+	vector<double> propagated(num_entries, UNDEFINED);
+	for (size_t ient = 0; ient < num_entries; ient++){
+		if (this->values[ient] != UNDEFINED){
+			propagated[ient] = this->values[ient] * this->factors[ient];
+		}
+	}
+
+	/* every child bucket is an OR over the parent buckets propagated into it. to get the derivative w.r.t. one parent bucket,
+	   the product of (1-x) over all the other parent buckets is needed. incoming values of exactly 1 are counted separately
+	   so that they don't have to be divided out */
+	vector<int> or_ones(num_entries, 0);
+	vector<double> or_product(num_entries, 1.0);
+	for (int ievent = 0; ievent < (int)this->events.size(); ievent++){
+		const Tape_Event &event = this->events[ievent];
+		if (event.child_slot == UNDEFINED){
+			continue;
+		}
+
+		size_t parent_base = (size_t)event.parent_slot * nb;
+		size_t child_base = (size_t)event.child_slot * nb + event.child_weight;
+		for (int ibucket = 0; ibucket < event.num_buckets; ibucket++){
+			double x = propagated[parent_base + ibucket];
+			if (x == UNDEFINED){
+				continue;
+			}
+			if (x >= 1){
+				or_ones[child_base + ibucket]++;
+			} else {
+				or_product[child_base + ibucket] *= (1 - x);
+			}
+		}
+	}
+
+	/* the connection probability is the OR over the destination's buckets */
+	vector<double> grad_values(num_entries, 0.0);		/* d(connection probability) / d(values) */
+	vector<double> grad_propagated(num_entries, 0.0);	/* d(connection probability) / d(propagated) */
+	size_t dest_base = (size_t)this->dest_slot * nb;
+	int dest_ones = 0;
+	double dest_product = 1;
+	for (int ibucket = 0; ibucket < nb; ibucket++){
+		double x = this->values[dest_base + ibucket];
+		if (x == UNDEFINED){
+			continue;
+		}
+		if (x >= 1){
+			dest_ones++;
+		} else {
+			dest_product *= (1 - x);
+		}
+	}
+	for (int ibucket = 0; ibucket < nb; ibucket++){
+		double x = this->values[dest_base + ibucket];
+		if (x != UNDEFINED){
+			grad_values[dest_base + ibucket] = get_or_derivative(x, dest_ones, dest_product);
+		}
+	}
+
+	/* now walk the tape backwards */
+	for (int ievent = (int)this->events.size()-1; ievent >= 0; ievent--){
+		const Tape_Event &event = this->events[ievent];
+		size_t parent_base = (size_t)event.parent_slot * nb;
+
+		if (event.child_slot == UNDEFINED){
+			/* node pop: propagated = values * (1 - demand) */
+			int node_ind = this->slot_node[event.parent_slot];
+			double node_grad = 0;
+			for (int ibucket = 0; ibucket < event.num_buckets; ibucket++){
+				size_t ient = parent_base + ibucket;
+				double grad = grad_propagated[ient];
+				if (grad == 0 || this->values[ient] == UNDEFINED){
+					continue;
+				}
+				grad_values[ient] = grad * this->factors[ient];
+				if (this->demand_dependent[ient]){
+					node_grad -= grad * this->values[ient];
+				}
+			}
+			this->node_sensitivity[node_ind] += scale * node_grad;
+		} else {
+			/* propagation: child values are an OR over the propagated parent values */
+			size_t child_base = (size_t)event.child_slot * nb + event.child_weight;
+			for (int ibucket = 0; ibucket < event.num_buckets; ibucket++){
+				double x = propagated[parent_base + ibucket];
+				double child_grad = grad_values[child_base + ibucket];
+				if (x == UNDEFINED || child_grad == 0){
+					continue;
+				}
+				grad_propagated[parent_base + ibucket] += child_grad * get_or_derivative(x, or_ones[child_base + ibucket], or_product[child_base + ibucket]);
+			}
+		}
+	}
+
+	this->clear();
+}
+
+
 /* Called when node is popped from expansion queue during topological traversal */
-void propagate_node_popped_func(int popped_node, int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, 
+void propagate_node_popped_func(int popped_node, int from_node_ind, int to_node_ind, t_rr_node &rr_node, const Node_Values &node_values, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, 
                           e_traversal_dir traversal_dir, int max_path_weight, User_Options *user_opts, void *user_data){
 
 	Propagate_Structs *propagate_structs = (Propagate_Structs*)user_data;
 
 	/* the path probabilities have been propagated from upstream nodes to this node, but
 	   the probability of *this* node has not yet been factored in. this is done now */
-	int node_weight = rr_node[popped_node].get_weight();
-	float node_demand = get_node_demand_adjusted_for_path_history(popped_node, rr_node, from_node_ind, to_node_ind, propagate_structs->fill_type, user_opts);
+	int node_weight = node_values.weight[popped_node];
+	float node_demand = get_node_demand_adjusted_for_path_history(popped_node, rr_node, node_values, from_node_ind, to_node_ind, propagate_structs->fill_type, user_opts);
 	float adjusted_demand = min(1.0F, node_demand);
+	bool demand_saturated = (node_demand >= 1.0F);
 
-	account_for_current_node_probability(popped_node, node_weight, adjusted_demand, node_topo_inf, rr_node, user_opts->self_congestion_mode, user_opts->demand_multiplier);
+	account_for_current_node_probability(popped_node, node_weight, adjusted_demand, demand_saturated, node_topo_inf, rr_node, user_opts->self_congestion_mode,
+	                                     user_opts->demand_multiplier, propagate_structs->tape, max_path_weight, propagate_structs->bucket_kernel);
 }
 
 /* Called when topological traversal is iterateing over a node's children */
-bool propagate_child_iterated_func(int parent_ind, int parent_edge_ind, int node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
+bool propagate_child_iterated_func(int parent_ind, int parent_edge_ind, int node_ind, t_rr_node &rr_node, const Node_Values &node_values, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
                           e_traversal_dir traversal_dir, int max_path_weight, int from_node_ind, int to_node_ind, User_Options *user_opts, void *user_data){
+	Propagate_Structs *propagate_structs = (Propagate_Structs*)user_data;
 	bool ignore_node = false;
 
 	/* propagate the node probabilities (stores in the bucket structure) of the parent node to this node */
-	propagate_probabilities(parent_ind, parent_edge_ind, node_ind, rr_node, ss_distances, node_topo_inf, traversal_dir, max_path_weight,
-	                        user_opts->self_congestion_mode);
+	propagate_probabilities(parent_ind, parent_edge_ind, node_ind, rr_node, node_values, ss_distances, node_topo_inf, traversal_dir, max_path_weight,
+	                        user_opts->self_congestion_mode, propagate_structs->tape, propagate_structs->bucket_kernel);
 
 	return ignore_node;
 }
 
 /* Called once topological traversal is complete.
    Calculates probability of a source/sink connection being routable */
-void propagate_traversal_done_func(int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, 
+void propagate_traversal_done_func(int from_node_ind, int to_node_ind, t_rr_node &rr_node, const Node_Values &node_values, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, 
                           e_traversal_dir traversal_dir, int max_path_weight, User_Options *user_opts, void *user_data){
 	Propagate_Structs *propagate_structs = (Propagate_Structs*)user_data;
 
 	double *source_buckets = node_topo_inf[to_node_ind].buckets.source_buckets;
 	int num_source_buckets = node_topo_inf[to_node_ind].buckets.get_num_source_buckets();
 	propagate_structs->prob_routable = get_prob_reachable(source_buckets, num_source_buckets);
+
+	/* record the final bucket values of the destination node; the reverse pass starts from these */
+	Propagate_Tape *tape = propagate_structs->tape;
+	if (tape != NULL){
+		int slot = tape->get_slot(to_node_ind);
+		for (int ibucket = 0; ibucket < num_source_buckets; ibucket++){
+			tape->values[(size_t)slot*tape->num_buckets + ibucket] = source_buckets[ibucket];
+		}
+		tape->dest_slot = slot;
+	}
 }
 
 /* Probability of a path successfully traversing through a given node is the probability that the path can reach the node AND'ed with the
    probability that the node is uncongested */
-static void account_for_current_node_probability(int node_ind, int node_weight, float node_demand, t_node_topo_inf &node_topo_inf, t_rr_node &rr_node,
-                                                 e_self_congestion_mode self_congestion_mode, double demand_multiplier){
+static void account_for_current_node_probability(int node_ind, int node_weight, float node_demand, bool demand_saturated, t_node_topo_inf &node_topo_inf, t_rr_node &rr_node,
+                                                 e_self_congestion_mode self_congestion_mode, double demand_multiplier, Propagate_Tape *tape,
+                                                 int max_path_weight, e_bucket_kernel bucket_kernel){
 	double *source_buckets = node_topo_inf[node_ind].buckets.source_buckets;
 	int num_source_buckets = node_topo_inf[node_ind].buckets.get_num_source_buckets();
 
+	if (tape == NULL && self_congestion_mode != MODE_PATH_DEPENDENCE){
+		/* every bucket sees the same clamped demand. paths heavier than the max path weight are never propagated, so the
+		   buckets past it are empty */
+		WCHECK(2, get_prob_reachable(source_buckets + min(num_source_buckets, max_path_weight+1), max(0, num_source_buckets - max_path_weight-1)) == 0,
+		       EX_PATH_ENUM, "Node " << node_ind << " has paths heavier than the max path weight of " << max_path_weight);
+		float adjusted_node_demand = min(1.0F, max(0.0F, node_demand));
+		scale_bucket_probabilities(bucket_kernel, source_buckets, num_source_buckets, max_path_weight, (double)(1 - adjusted_node_demand));
+		return;
+	}
+
+	size_t tape_base = 0;
+	if (tape != NULL){
+		int slot = tape->get_slot(node_ind);
+		tape->slot_popped[slot] = true;
+		tape_base = (size_t)slot * tape->num_buckets;
+
+		Tape_Event event;
+		event.parent_slot = slot;
+		event.child_slot = UNDEFINED;
+		event.child_weight = 0;
+		event.num_buckets = num_source_buckets;
+		tape->events.push_back(event);
+	}
+
 	//Need to know:
 	//	1) The demand contributed by each parent
 	//	2) Which parents are valid in the current s-t connection
@@ -117,6 +321,12 @@ static void account_for_current_node_probability(int node_ind, int node_weight,
 		}
 
 		if (source_buckets[ibucket] != UNDEFINED){
+			if (tape != NULL){
+				/* the demand discount is treated as a constant. where the demand gets clamped, it has no influence on the bucket */
+				tape->values[tape_base + ibucket] = source_buckets[ibucket];
+				tape->demand_dependent[tape_base + ibucket] = (!demand_saturated && adjusted_node_demand >= 0.0F && adjusted_node_demand < 1.0F);
+			}
+
 			/* constrain the node demand into the [0,1] range */
 			adjusted_node_demand = max(0.0F, adjusted_node_demand);
 			adjusted_node_demand = min(1.0F, adjusted_node_demand);
@@ -127,19 +337,24 @@ static void account_for_current_node_probability(int node_ind, int node_weight,
 			//probability that the node in question is available
 			source_buckets[ibucket] = source_buckets[ibucket] * (1 - adjusted_node_demand);		//reachability
 
+			if (tape != NULL){
+				tape->factors[tape_base + ibucket] = (1 - adjusted_node_demand);
+			}
+
 		}
 	}
 }
 
 
 /* propagates path probabilities stored in the bucket structure of the parent node to the bucket structure of the child node */
-static void propagate_probabilities(int parent_ind, int parent_edge_ind, int child_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
-			e_traversal_dir traversal_dir, int max_path_weight, e_self_congestion_mode self_congestion_mode){
+static void propagate_probabilities(int parent_ind, int parent_edge_ind, int child_ind, t_rr_node &rr_node, const Node_Values &node_values, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
+			e_traversal_dir traversal_dir, int max_path_weight, e_self_congestion_mode self_congestion_mode, Propagate_Tape *tape,
+			e_bucket_kernel bucket_kernel){
 
 	double *parent_buckets;
 	double *child_buckets;
 	int num_buckets;
-	int child_weight = rr_node[child_ind].get_weight();
+	int child_weight = node_values.weight[child_ind];
 	int child_path_weight_to_dest;		//the weight of the minimum-weight path from child to the destination node
 	int parent_path_weight_to_start;	//the weight of the minimum-weight path from parent to the starting node
 
@@ -164,37 +379,52 @@ static void propagate_probabilities(int parent_ind, int parent_edge_ind, int chi
 		parent_path_weight_to_start = ss_distances[parent_ind].get_sink_distance();
 	}
 
-	/* now propagate path probabilities. the assumption is that every single path is independent (perhaps not a very good assumption)
-	   TODO. add better description */
-	//for (int ibucket = parent_path_weight_to_start; ibucket < num_buckets; ibucket++){	//parent cannot carry paths of weight smaller than itself
-	for (int ibucket = 0; ibucket < num_buckets; ibucket++){	//XXX but weight has possibly changed due to dynamic weights.......
-		/* we're done if this set of paths cannot possibly reach the target node 
-		   in under the minimum allowable path weight */
-		if (ibucket + child_path_weight_to_dest > max_path_weight){
-			break;
-		}
-
-		/* bucket into which to propagate probabilities */
-		int target_bucket = ibucket + child_weight;
-
-		/* propagate routing probability of paths */
-		if (child_buckets[target_bucket] == UNDEFINED){
-			if (parent_buckets[ibucket] != UNDEFINED){
-				child_buckets[target_bucket] = parent_buckets[ibucket];
+	if (self_congestion_mode != MODE_PATH_DEPENDENCE){
+		/* no per-bucket demand discounts to track -- OR the parent buckets that can still reach the destination into the child */
+		int last_bucket = min(num_buckets-1, max_path_weight - child_path_weight_to_dest);
+		or_bucket_probabilities(bucket_kernel, parent_buckets, child_buckets, num_buckets, last_bucket, child_weight);
+	} else {
+		/* now propagate path probabilities. the assumption is that every single path is independent (perhaps not a very good assumption)
+		   TODO. add better description */
+		//for (int ibucket = parent_path_weight_to_start; ibucket < num_buckets; ibucket++){	//parent cannot carry paths of weight smaller than itself
+		for (int ibucket = 0; ibucket < num_buckets; ibucket++){	//XXX but weight has possibly changed due to dynamic weights.......
+			/* we're done if this set of paths cannot possibly reach the target node 
+			   in under the minimum allowable path weight */
+			if (ibucket + child_path_weight_to_dest > max_path_weight){
+				break;
 			}
-		} else {
-			if (parent_buckets[ibucket] != UNDEFINED){
-				//child_buckets[target_bucket] *= parent_buckets[ibucket];	//unreachability
-				child_buckets[target_bucket] = or_two_probs(child_buckets[target_bucket], parent_buckets[ibucket]);	//reachability
+
+			/* bucket into which to propagate probabilities */
+			int target_bucket = ibucket + child_weight;
+
+			/* propagate routing probability of paths */
+			if (child_buckets[target_bucket] == UNDEFINED){
+				if (parent_buckets[ibucket] != UNDEFINED){
+					child_buckets[target_bucket] = parent_buckets[ibucket];
+				}
+			} else {
+				if (parent_buckets[ibucket] != UNDEFINED){
+					//child_buckets[target_bucket] *= parent_buckets[ibucket];	//unreachability
+					child_buckets[target_bucket] = or_two_probs(child_buckets[target_bucket], parent_buckets[ibucket]);	//reachability
+				}
 			}
-		}
 
-		if (self_congestion_mode == MODE_PATH_DEPENDENCE){
-			if (traversal_dir == FORWARD_TRAVERSAL){
-				node_topo_inf[child_ind].demand_discounts[target_bucket] += rr_node[parent_ind].child_demand_contributions[parent_edge_ind][ibucket];
+			if (self_congestion_mode == MODE_PATH_DEPENDENCE){
+				if (traversal_dir == FORWARD_TRAVERSAL){
+					node_topo_inf[child_ind].demand_discounts[target_bucket] += rr_node[parent_ind].child_demand_contributions[parent_edge_ind][ibucket];
+				}
 			}
 		}
 	}
+
+	if (tape != NULL){
+		Tape_Event event;
+		event.parent_slot = tape->get_slot(parent_ind);
+		event.child_slot = tape->get_slot(child_ind);
+		event.child_weight = child_weight;
+		event.num_buckets = max(0, min(num_buckets, max_path_weight - child_path_weight_to_dest + 1));
+		tape->events.push_back(event);
+	}
 }
 
 /* probability that node with specified buckets is reachable from source */
@@ -211,3 +441,15 @@ static float get_prob_reachable( double *source_buckets, int num_source_buckets)
 	return running_total;
 }
 
+/* returns the derivative of 1 - (1-x_1)(1-x_2)...(1-x_n) w.r.t. x, given that 'num_ones' of the x's are 1 and that the
+   product of (1-x_i) over the remaining x's is 'product' */
+static double get_or_derivative(double x, int num_ones, double product){
+	double result;
+	if (x >= 1){
+		/* x itself is one of the ones */
+		result = (num_ones == 1 ? product : 0);
+	} else {
+		result = (num_ones > 0 ? 0 : product / (1 - x));
+	}
+	return result;
+}
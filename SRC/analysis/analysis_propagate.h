@@ -3,31 +3,80 @@
 
 #include <vector>
 #include "wotan_types.h"
+#include "bucket_kernels.h"
 
 
 /**** Typedefs ****/
 
 /**** Classes ****/
+/* an operation recorded on the propagate tape */
+class Tape_Event{
+public:
+	int parent_slot;	/* slot of the popped node, or of the parent whose buckets were propagated to the child */
+	int child_slot;		/* slot of the child for propagation events. UNDEFINED for node pops */
+	int child_weight;	/* parent bucket i was propagated into child bucket i+child_weight */
+	int num_buckets;	/* number of parent buckets that were propagated */
+};
+
+/* Records the operations of one 'propagate' traversal. Every operation of the propagate method is either a product (a node's
+   buckets are scaled by the probability that the node is available) or an OR (parent buckets are OR'ed into child buckets),
+   so a reverse pass over the recording gives the derivative of the connection probability w.r.t. the demand of every
+   traversed node. Derivatives, scaled by the weight of the connection in the routability metric, are accumulated
+   per node over all connections recorded on the tape */
+class Propagate_Tape{
+public:
+	int num_buckets;
+	std::vector<int> node_slot;		/* [0..num_nodes-1] the slot of each node touched by the current traversal. UNDEFINED if not touched */
+	std::vector<int> slot_node;		/* node index of each slot */
+	std::vector<bool> slot_popped;		/* whether the node of each slot was popped (i.e. had its own probability factored in) */
+
+	/* [slot*num_buckets + ibucket] */
+	std::vector<double> values;		/* bucket values of each popped node before its availability was factored in, and the final bucket values of the destination */
+	std::vector<double> factors;		/* the factor by which each bucket was scaled when the node was popped (1 - adjusted node demand) */
+	std::vector<bool> demand_dependent;	/* whether that factor changes with node demand (it doesn't where the demand was clamped into [0,1]) */
+
+	std::vector<Tape_Event> events;
+	int dest_slot;
+
+	std::vector<double> node_sensitivity;	/* [0..num_nodes-1] accumulated derivative of the (scaled) connection probabilities w.r.t. node demand */
+
+	Propagate_Tape();
+	void init(int num_nodes, int set_num_buckets);
+
+	/* returns the slot of the specified node, allocating one if the node hasn't been touched during this traversal */
+	int get_slot(int node_ind);
+	/* forgets the current traversal (accumulated sensitivities are kept) */
+	void clear();
+
+	/* back-propagates the probability of the recorded connection to the demands of the traversed nodes and accumulates
+	   the derivatives, multiplied by 'scale', into node_sensitivity. clears the recording */
+	void backpropagate(double scale);
+};
+
 /* A class used to lump together all data structures specific to the propagate analysis method that
    need to be passed around during topological traversal */
 class Propagate_Structs{
 public:
 	float prob_routable;
 	Physical_Type_Descriptor *fill_type;
+	Propagate_Tape *tape;			/* if not NULL, the traversal is recorded onto this tape */
+	e_bucket_kernel bucket_kernel;		/* kernel used for the bucket loops; picked per connection from the max path weight */
+
+	Propagate_Structs();
 };
 
 
 /**** Function Declarations ****/
 /* Called when node is popped from expansion queue during topological traversal */
-void propagate_node_popped_func(int popped_node, int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, 
+void propagate_node_popped_func(int popped_node, int from_node_ind, int to_node_ind, t_rr_node &rr_node, const Node_Values &node_values, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, 
                           e_traversal_dir traversal_dir, int max_path_weight, User_Options *user_opts, void *user_data);
 
 /* Called when topological traversal is iterateing over a node's children */
-bool propagate_child_iterated_func(int parent_ind, int parent_edge_ind, int node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
+bool propagate_child_iterated_func(int parent_ind, int parent_edge_ind, int node_ind, t_rr_node &rr_node, const Node_Values &node_values, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
                           e_traversal_dir traversal_dir, int max_path_weight, int from_node_ind, int to_node_ind, User_Options *user_opts, void *user_data);
 
 /* Called once topological traversal is complete */
-void propagate_traversal_done_func(int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, 
+void propagate_traversal_done_func(int from_node_ind, int to_node_ind, t_rr_node &rr_node, const Node_Values &node_values, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, 
                           e_traversal_dir traversal_dir, int max_path_weight, User_Options *user_opts, void *user_data);
 
 
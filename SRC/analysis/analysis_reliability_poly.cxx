@@ -1,5 +1,6 @@
 
 #include <cmath>
+#include <algorithm>
 #include "exception.h"
 #include "analysis_reliability_poly.h"
 
@@ -68,20 +69,18 @@ double analyze_reliability_polynomial(int source_sink_hops, 		// # hops (edges)
 				     float routing_node_probability){	// probability (of operation) to be used for each routing node
 	double probability = 0;
 
-	if (routing_node_probability < 0){
-		WTHROW(EX_PATH_ENUM, "Computing the reliability polynomial requires node probabilities to be >= 0. Got: " << routing_node_probability);
-	}
-	if (source_sink_hops < MIN_POSSIBLE_HOPS){
-		WTHROW(EX_PATH_ENUM, "There should always be at least four hops from source to sink. Got a connection with " << source_sink_hops);
-	}
+	WCHECK(1, routing_node_probability >= 0, EX_PATH_ENUM, "Computing the reliability polynomial requires node probabilities to be >= 0. Got: " << routing_node_probability);
+	WCHECK(1, source_sink_hops >= MIN_POSSIBLE_HOPS, EX_PATH_ENUM, "There should always be at least four hops from source to sink. Got a connection with " << source_sink_hops);
 
-	/* sanity check -- make sure there are no paths of length < source_sink_hops. TODO: get rid of this later */
-	for (int ilength = 0; ilength < num_path_count_entries; ilength++){
-		if (path_counts[ilength] > 0 && ilength < source_sink_hops){
+#if WOTAN_CHECK_LEVEL >= 2
+	/* sanity check -- make sure there are no paths of length < source_sink_hops */
+	for (int ilength = 0; ilength < min(num_path_count_entries, source_sink_hops); ilength++){
+		if (path_counts[ilength] > 0){
 			WTHROW(EX_PATH_ENUM, "number of hops (edges) from source to sink is " << source_sink_hops << ", but got path count of " << path_counts[ilength] <<
 						" corresponding to " << ilength << " hops");
 		}
 	}
+#endif
 
 	/* a vector to hold the reliability polynomial coefficients */
 	vector< Poly_Coeff > rel_poly;
@@ -0,0 +1,224 @@
+/*
+	Per-connection cost profiles of the analysis phases.
+
+	A single total runtime doesn't show where the time of a phase goes. Each analysis thread records the wall time, legal
+subgraph size and number of popped nodes of every connection it analyzes into histograms keyed by the kind of source and the
+connection length. The histograms have logarithmically spaced buckets, so that they take constant space and can be merged
+by adding up counts, and percentiles read off them are accurate to within a bucket. The most expensive connections are listed
+by source and sink node, so that pathological cases can be reproduced.
+*/
+
+#include <cmath>
+#include <iostream>
+#include <algorithm>
+#include <iomanip>
+#include "conn_profile.h"
+#include "exception.h"
+
+using namespace std;
+
+
+/**** Function Declarations ****/
+/* returns the histogram bucket of the specified value */
+static int get_cost_bucket(double value);
+/* returns the upper edge of the specified histogram bucket */
+static double get_cost_bucket_upper_edge(int ibucket);
+/* used to keep the most expensive connections on a heap with the cheapest of them on top */
+static bool more_expensive(const Conn_Cost &conn_cost1, const Conn_Cost &conn_cost2);
+
+
+
+/**** Function Definitions ****/
+/* returns the histogram bucket of the specified value */
+static int get_cost_bucket(double value){
+	int ibucket;
+	if (value < 1){
+		ibucket = 0;
+	} else {
+		ibucket = 1 + (int)(log2(value) * COST_HISTOGRAM_STEPS_PER_OCTAVE);
+		ibucket = min(ibucket, COST_HISTOGRAM_OCTAVES * COST_HISTOGRAM_STEPS_PER_OCTAVE);
+	}
+	return ibucket;
+}
+
+/* returns the upper edge of the specified histogram bucket */
+static double get_cost_bucket_upper_edge(int ibucket){
+	return exp2((double)ibucket / (double)COST_HISTOGRAM_STEPS_PER_OCTAVE);
+}
+
+/* used to keep the most expensive connections on a heap with the cheapest of them on top */
+static bool more_expensive(const Conn_Cost &conn_cost1, const Conn_Cost &conn_cost2){
+	return conn_cost1.cost[CONN_COST_MICROSECONDS] > conn_cost2.cost[CONN_COST_MICROSECONDS];
+}
+
+
+/*==== Cost_Histogram Class ====*/
+Cost_Histogram::Cost_Histogram(){
+	this->counts.assign(COST_HISTOGRAM_OCTAVES * COST_HISTOGRAM_STEPS_PER_OCTAVE + 1, 0);
+	this->num_values = 0;
+	this->max_value = 0;
+}
+
+/* adds a value to the histogram */
+void Cost_Histogram::add(double value){
+	this->counts[ get_cost_bucket(value) ]++;
+	this->num_values++;
+	this->max_value = max(this->max_value, value);
+}
+
+/* adds the values of another histogram to this one */
+void Cost_Histogram::merge(const Cost_Histogram &other){
+	for (int ibucket = 0; ibucket < (int)this->counts.size(); ibucket++){
+		this->counts[ibucket] += other.counts[ibucket];
+	}
+	this->num_values += other.num_values;
+	this->max_value = max(this->max_value, other.max_value);
+}
+
+/* returns the specified percentile (in [0,100]) of the added values. the result is the upper edge of the bucket in which the
+   percentile falls (but no more than the largest value), so it overestimates by less than one bucket */
+double Cost_Histogram::get_percentile(double percentile) const{
+	if (this->num_values == 0){
+		return 0;
+	}
+
+	/* the rank of the percentile value among the added values (1-based) */
+	long long rank = (long long)ceil(percentile / 100.0 * (double)this->num_values);
+	rank = max(rank, 1LL);
+
+	long long num_seen = 0;
+	int ibucket;
+	for (ibucket = 0; ibucket < (int)this->counts.size()-1; ibucket++){
+		num_seen += this->counts[ibucket];
+		if (num_seen >= rank){
+			break;
+		}
+	}
+
+	return min(get_cost_bucket_upper_edge(ibucket), this->max_value);
+}
+/*==== END Cost_Histogram Class ====*/
+
+
+/*==== Conn_Cost Class ====*/
+Conn_Cost::Conn_Cost(){
+	this->source_ind = UNDEFINED;
+	this->sink_ind = UNDEFINED;
+	this->length = UNDEFINED;
+	this->pin_type = OPEN;
+	for (int icost = 0; icost < NUM_CONN_COSTS; icost++){
+		this->cost[icost] = 0;
+	}
+}
+/*==== END Conn_Cost Class ====*/
+
+
+/*==== Conn_Profile Class ====*/
+Conn_Profile::Conn_Profile(){
+	this->num_listed = 0;
+}
+
+/* sets up the histograms for connections of up to the specified length */
+void Conn_Profile::init(int max_conn_length, int set_num_listed){
+	for (int itype = DRIVER; itype <= RECEIVER; itype++){
+		for (int icost = 0; icost < NUM_CONN_COSTS; icost++){
+			this->histograms[itype][icost].assign(max_conn_length+1, Cost_Histogram());
+		}
+	}
+	this->most_expensive.clear();
+	this->num_listed = set_num_listed;
+}
+
+/* records the costs of an analyzed connection */
+void Conn_Profile::record(const Conn_Cost &conn_cost){
+	if (conn_cost.pin_type != DRIVER && conn_cost.pin_type != RECEIVER){
+		WTHROW(EX_PATH_ENUM, "Unexpected source pin type: " << conn_cost.pin_type);
+	}
+
+	for (int icost = 0; icost < NUM_CONN_COSTS; icost++){
+		this->histograms[conn_cost.pin_type][icost][conn_cost.length].add(conn_cost.cost[icost]);
+	}
+
+	this->record_most_expensive(conn_cost);
+}
+
+/* keeps the specified connection if it's among the most expensive ones so far */
+void Conn_Profile::record_most_expensive(const Conn_Cost &conn_cost){
+	if ((int)this->most_expensive.size() < this->num_listed){
+		this->most_expensive.push_back(conn_cost);
+		push_heap(this->most_expensive.begin(), this->most_expensive.end(), more_expensive);
+	} else if (this->num_listed > 0 && more_expensive(conn_cost, this->most_expensive.front())){
+		pop_heap(this->most_expensive.begin(), this->most_expensive.end(), more_expensive);
+		this->most_expensive.back() = conn_cost;
+		push_heap(this->most_expensive.begin(), this->most_expensive.end(), more_expensive);
+	}
+}
+
+/* adds the connections recorded by another profile to this one */
+void Conn_Profile::merge(const Conn_Profile &other){
+	for (int itype = DRIVER; itype <= RECEIVER; itype++){
+		for (int icost = 0; icost < NUM_CONN_COSTS; icost++){
+			for (int ilen = 0; ilen < (int)this->histograms[itype][icost].size(); ilen++){
+				this->histograms[itype][icost][ilen].merge( other.histograms[itype][icost][ilen] );
+			}
+		}
+	}
+
+	for (int iconn = 0; iconn < (int)other.most_expensive.size(); iconn++){
+		this->record_most_expensive(other.most_expensive[iconn]);
+	}
+}
+
+/* prints cost percentiles for every kind of source and connection length, followed by the most expensive connections */
+void Conn_Profile::print(const string &phase_name) const{
+	const char *cost_names[NUM_CONN_COSTS] = {"time (us)", "subgraph nodes", "nodes popped"};
+
+	long long num_conns = 0;
+	for (int itype = DRIVER; itype <= RECEIVER; itype++){
+		for (int ilen = 0; ilen < (int)this->histograms[itype][CONN_COST_MICROSECONDS].size(); ilen++){
+			num_conns += this->histograms[itype][CONN_COST_MICROSECONDS][ilen].num_values;
+		}
+	}
+
+	cout << "Connection costs during " << phase_name << " (" << num_conns << " connections):" << endl;
+	for (int itype = DRIVER; itype <= RECEIVER; itype++){
+		for (int ilen = 0; ilen < (int)this->histograms[itype][CONN_COST_MICROSECONDS].size(); ilen++){
+			long long num_at_length = this->histograms[itype][CONN_COST_MICROSECONDS][ilen].num_values;
+			if (num_at_length == 0){
+				continue;
+			}
+
+			cout << "  " << (itype == DRIVER ? "driver" : "fanout") << " len" << ilen << " (" << num_at_length << " conns)" << endl;
+			for (int icost = 0; icost < NUM_CONN_COSTS; icost++){
+				const Cost_Histogram &histogram = this->histograms[itype][icost][ilen];
+				double percentiles[4] = {histogram.get_percentile(50), histogram.get_percentile(90), histogram.get_percentile(99), histogram.max_value};
+				if (icost != CONN_COST_MICROSECONDS){
+					/* node counts are whole numbers, so a bucket's upper edge can be rounded down */
+					for (int ipercentile = 0; ipercentile < 4; ipercentile++){
+						percentiles[ipercentile] = floor(percentiles[ipercentile]);
+					}
+				}
+				cout << "    " << left << setw(16) << cost_names[icost] << right <<
+				        " p50 " << setw(10) << percentiles[0] <<
+				        " p90 " << setw(10) << percentiles[1] <<
+				        " p99 " << setw(10) << percentiles[2] <<
+				        " max " << setw(10) << percentiles[3] << endl;
+			}
+		}
+	}
+
+	if (!this->most_expensive.empty()){
+		vector<Conn_Cost> sorted_conns = this->most_expensive;
+		sort(sorted_conns.begin(), sorted_conns.end(), more_expensive);
+
+		cout << "  Most expensive connections:" << endl;
+		for (int iconn = 0; iconn < (int)sorted_conns.size(); iconn++){
+			const Conn_Cost &conn_cost = sorted_conns[iconn];
+			cout << "    source " << conn_cost.source_ind << " -> sink " << conn_cost.sink_ind << " (" <<
+			        (conn_cost.pin_type == DRIVER ? "driver" : "fanout") << " len" << conn_cost.length << "): " <<
+			        conn_cost.cost[CONN_COST_MICROSECONDS] << " us, " << conn_cost.cost[CONN_COST_SUBGRAPH] << " subgraph nodes, " <<
+			        conn_cost.cost[CONN_COST_NODES_POPPED] << " nodes popped" << endl;
+		}
+	}
+}
+/*==== END Conn_Profile Class ====*/
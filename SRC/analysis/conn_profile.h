@@ -0,0 +1,82 @@
+#ifndef CONN_PROFILE_H
+#define CONN_PROFILE_H
+
+#include <vector>
+#include <string>
+#include "wotan_types.h"
+
+
+/**** Defines ****/
+/* number of histogram buckets per doubling of the recorded value (a bucket spans about 9% of its value) */
+#define COST_HISTOGRAM_STEPS_PER_OCTAVE 8
+/* values of up to 2^COST_HISTOGRAM_OCTAVES are bucketed. larger values go into the last bucket */
+#define COST_HISTOGRAM_OCTAVES 40
+
+
+/**** Enums ****/
+/* the costs recorded for every analyzed connection */
+enum e_conn_cost{
+	CONN_COST_MICROSECONDS = 0,	/* wall time spent on the connection */
+	CONN_COST_SUBGRAPH,		/* number of nodes reached by the connection's topological traversals (its legal subgraph) */
+	CONN_COST_NODES_POPPED,		/* number of nodes popped off the expansion queues of the connection's distance searches and traversals */
+	NUM_CONN_COSTS
+};
+
+
+/**** Classes ****/
+/* a histogram of non-negative values with logarithmically spaced buckets. values below 1 share the first bucket */
+class Cost_Histogram{
+public:
+	std::vector<long long> counts;		/* [0..num buckets-1] */
+	long long num_values;
+	double max_value;
+
+	Cost_Histogram();
+
+	/* adds a value to the histogram */
+	void add(double value);
+	/* adds the values of another histogram to this one */
+	void merge(const Cost_Histogram &other);
+	/* returns the specified percentile (in [0,100]) of the added values. the result is the upper edge of the bucket in which the
+	   percentile falls (but no more than the largest value), so it overestimates by less than one bucket */
+	double get_percentile(double percentile) const;
+};
+
+/* what one connection cost */
+class Conn_Cost{
+public:
+	int source_ind;
+	int sink_ind;
+	int length;
+	e_pin_type pin_type;			/* DRIVER for connections from drivers, RECEIVER for fanout */
+	double cost[NUM_CONN_COSTS];
+
+	Conn_Cost();
+};
+
+/* Per-connection costs of one analysis phase. Each analysis thread records the connections it analyzes into its own profile,
+   keyed by the kind of source (driver/fanout) and connection length. The thread profiles are merged once the phase is done */
+class Conn_Profile{
+public:
+	/* [DRIVER/RECEIVER][0..NUM_CONN_COSTS-1][0..max_conn_length] */
+	std::vector<Cost_Histogram> histograms[2][NUM_CONN_COSTS];
+	/* the connections that took the longest. kept as a heap with the cheapest of them on top */
+	std::vector<Conn_Cost> most_expensive;
+	int num_listed;				/* number of most expensive connections to keep */
+
+	Conn_Profile();
+
+	/* sets up the histograms for connections of up to the specified length */
+	void init(int max_conn_length, int set_num_listed);
+	/* records the costs of an analyzed connection */
+	void record(const Conn_Cost &conn_cost);
+	/* keeps the specified connection if it's among the most expensive ones so far */
+	void record_most_expensive(const Conn_Cost &conn_cost);
+	/* adds the connections recorded by another profile to this one */
+	void merge(const Conn_Profile &other);
+	/* prints cost percentiles for every kind of source and connection length, followed by the most expensive connections */
+	void print(const std::string &phase_name) const;
+};
+
+
+#endif
@@ -0,0 +1,628 @@
+/*
+	The connection plan: which source/sink connections are analyzed.
+
+	For each source of each test tile, a random fraction of the sinks at each connection length is selected for analysis
+(the fraction is FRACTION_CONNS scaled by the user's length probabilities). Sinks at a given length lie on a 'ring' of tiles
+a fixed manhattan distance from the source's tile; the tile offsets that make up each ring are computed once and shared by
+all tiles.
+
+	Previously the connections were re-sampled in every analysis phase, which meant that probability analysis and each step
+of a demand multiplier search generally looked at a different set of connections than path enumeration did. The plan is now
+built once per run and replayed by every phase.
+
+	Each planned connection also carries a lower bound on the weight of any path from its source to its sink (its 'reach label').
+The bound is the source-sink distance with all node demands at zero -- wires have a weight of 1 and other nodes a weight of 0 --
+and node demand can only raise weights above that. A connection whose bound exceeds the maximum path weight at its length can't
+be routed, so its path searches are skipped during analysis. Rather than searching from every source, labels are computed once
+per pin class, per tile position relative to the wire staggering (tile coordinates modulo the least common multiple of the wire
+spans), and per (dx,dy) offset and pin class of the sink. The labels are computed for two tiles at each position and discarded
+if they differ, and they are only applied to tiles that are far enough from the perimeter for all their sinks to be covered.
+*/
+
+#include <cstdlib>
+#include <algorithm>
+#include <set>
+#include "connection_plan.h"
+#include "analysis_main.h"
+#include "exception.h"
+
+using namespace std;
+
+
+/**** Function Declarations ****/
+/* fills in the tile offsets at each manhattan distance from a tile */
+static void set_ring_offsets(Connection_Plan *plan);
+/* returns number of connections from tile at the specified coordinates at specified length */
+static int conns_at_distance_from_tile(Connection_Plan *plan, int tile_x, int tile_y, int length, Arch_Structs *arch_structs);
+/* samples the sinks to which the specified source at the specified test tile should connect, and appends the source and its
+   connections to the plan */
+static void plan_source_connections(User_Options *user_opts, Analysis_Settings *analysis_settings, Arch_Structs *arch_structs,
+			Routing_Structs *routing_structs, int source_node_ind, int source_class, e_pin_type pin_type, int tile_ind, Connection_Plan *plan);
+/* computes the reach labels of the plan (see Reach_Labels) */
+static void set_reach_labels(Analysis_Settings *analysis_settings, Arch_Structs *arch_structs, Routing_Structs *routing_structs,
+			Connection_Plan *plan);
+/* computes the reach labels of all sources of the specified tile into 'min_weight' (indexed as the labels of the plan) */
+static void label_tile_sources(Arch_Structs *arch_structs, Routing_Structs *routing_structs, const vector<short> &zero_weight,
+			int tile_x, int tile_y, const Reach_Labels &labels, vector<short> &min_weight);
+/* returns the node from which paths of the specified pin class of the tile at the specified coordinates are enumerated: the
+   class' source for drivers, or the virtual source of the class' sink for receivers (UNDEFINED if there is none) */
+static int get_tile_source_node(Routing_Structs *routing_structs, Pin_Class *pin_class, int tile_x, int tile_y, int iclass);
+/* sets the total number of connections at each connection length <= maximum connection length over the probability analysis region */
+static void set_conn_length_stats(User_Options *user_opts, Analysis_Settings *analysis_settings, Arch_Structs *arch_structs,
+			e_pin_type enumerate_type, Connection_Plan *plan, vector<int> &conns_at_length);
+
+
+/**** Function Definitions ****/
+/*==== Reach_Labels Class ====*/
+Reach_Labels::Reach_Labels(){
+	this->period = UNDEFINED;
+	this->max_conn_length = UNDEFINED;
+	this->num_classes = UNDEFINED;
+	this->search_bound = UNDEFINED;
+	this->from_x = this->to_x = UNDEFINED;
+	this->from_y = this->to_y = UNDEFINED;
+}
+
+/* returns the index of the label for the specified source class at the specified tile and the specified sink class at the
+   specified (dx,dy) offset from it */
+int Reach_Labels::get_label_ind(int source_class, int tile_x, int tile_y, int dx, int dy, int sink_class) const{
+	int width = 2*this->max_conn_length + 1;
+	int ind = source_class;
+	ind = ind*this->period + (tile_x % this->period);
+	ind = ind*this->period + (tile_y % this->period);
+	ind = ind*width + (dx + this->max_conn_length);
+	ind = ind*width + (dy + this->max_conn_length);
+	ind = ind*this->num_classes + sink_class;
+	return ind;
+}
+
+/* returns a lower bound on the weight of any path from the specified source class at the specified tile to the specified sink class
+   at the specified offset. returns UNDEFINED if no label applies */
+short Reach_Labels::get_min_weight(int source_class, int tile_x, int tile_y, int dx, int dy, int sink_class) const{
+	if (this->period == UNDEFINED || tile_x < this->from_x || tile_x > this->to_x || tile_y < this->from_y || tile_y > this->to_y){
+		return UNDEFINED;
+	}
+	return this->min_weight[ this->get_label_ind(source_class, tile_x, tile_y, dx, dy, sink_class) ];
+}
+/*==== END Reach_Labels Class ====*/
+
+
+/*==== Connection_Plan Class ====*/
+Connection_Plan::Connection_Plan(){
+	this->max_conn_length = UNDEFINED;
+}
+
+/* returns the number of possible connections from the specified test tile at the specified length */
+int Connection_Plan::get_tile_conns_at_length(int tile_ind, int length) const{
+	return this->tile_conns_at_length[ tile_ind*(this->max_conn_length+1) + length ];
+}
+/*==== END Connection_Plan Class ====*/
+
+
+/* samples the connections to be analyzed from each test tile and records them in the specified plan */
+void build_connection_plan(User_Options *user_opts, Analysis_Settings *analysis_settings, Arch_Structs *arch_structs,
+			Routing_Structs *routing_structs, Connection_Plan *plan){
+
+	(*plan) = Connection_Plan();
+	plan->max_conn_length = user_opts->max_connection_length;
+	set_ring_offsets(plan);
+
+	int grid_size_x, grid_size_y;
+	arch_structs->get_grid_size(&grid_size_x, &grid_size_y);
+
+	int from_x, to_x, from_y, to_y;
+	get_prob_analysis_tile_region(user_opts, grid_size_x, grid_size_y, &from_x, &from_y, &to_x, &to_y);
+
+	set_reach_labels(analysis_settings, arch_structs, routing_structs, plan);
+
+	/* for each test tile */
+	vector< Coordinate >::const_iterator it;
+	for (it = analysis_settings->test_tile_coords.begin(); it != analysis_settings->test_tile_coords.end(); it++){
+		Coordinate tile_coord = (*it);
+
+		int tile_ind = (int)plan->tiles.size();
+		plan->tiles.push_back(tile_coord);
+		plan->tile_in_prob_region.push_back( tile_coord.x >= from_x && tile_coord.x <= to_x && tile_coord.y >= from_y && tile_coord.y <= to_y );
+		for (int ilen = 0; ilen <= plan->max_conn_length; ilen++){
+			int num_conns = 0;
+			if (ilen > 0){
+				num_conns = conns_at_distance_from_tile(plan, tile_coord.x, tile_coord.y, ilen, arch_structs);
+			}
+			plan->tile_conns_at_length.push_back(num_conns);
+		}
+
+		Grid_Tile *test_tile = &arch_structs->grid[tile_coord.x][tile_coord.y];
+		Physical_Type_Descriptor *tile_type = &arch_structs->block_type[ test_tile->get_type_index() ];
+
+		/* for each source of the test tile */
+		for (int iclass = 0; iclass < (int)tile_type->class_inf.size(); iclass++){
+			Pin_Class *pin_class = &tile_type->class_inf[iclass];
+
+			if (pin_class->get_pin_type() == DRIVER){
+				/* enumerating from opins basically involves enumerating from the corresponding source */
+				int source_node_index = routing_structs->rr_node_index[SOURCE][tile_coord.x][tile_coord.y][iclass];
+
+				plan_source_connections(user_opts, analysis_settings, arch_structs, routing_structs, source_node_index, iclass, DRIVER, tile_ind, plan);
+
+			} else if (pin_class->get_pin_type() == RECEIVER){
+				/* enumerating from ipins is Wotan's way of accounting for fanout. in wotan_init.cxx virtual sources were
+				   created for every sink and attached into the wires that connect into the sink's ipins. these virtual
+				   sources are used to enumerate fanout paths */
+				int sink_node_index = routing_structs->rr_node_index[SOURCE][tile_coord.x][tile_coord.y][iclass];
+				int virtual_source_ind = routing_structs->rr_node[sink_node_index].get_virtual_source_node_ind();
+
+				if (virtual_source_ind != UNDEFINED){
+					plan_source_connections(user_opts, analysis_settings, arch_structs, routing_structs, virtual_source_ind, iclass, RECEIVER, tile_ind, plan);
+				}
+			} else {
+				WTHROW(EX_PATH_ENUM, "Unexpected pin type: " << pin_class->get_pin_type());
+			}
+		}
+	}
+
+	set_conn_length_stats(user_opts, analysis_settings, arch_structs, DRIVER, plan, plan->driver_conns_at_length);	//for paths enumerated *from* sources
+	set_conn_length_stats(user_opts, analysis_settings, arch_structs, RECEIVER, plan, plan->receiver_conns_at_length);	//for paths enumerated *from* sinks (for fanout stuff)
+
+	cout << "Connection plan: " << plan->conns.size() << " connections from " << plan->sources.size() << " sources in " <<
+	        plan->tiles.size() << " test tiles" << endl;
+
+	/* connections that can't be routed under the current maximum path weights. the bounds may still change (e.g. through
+	   calibration), so the connections are kept in the plan and checked again when they are analyzed */
+	if (plan->reach_labels.period != UNDEFINED){
+		int num_labeled = 0;
+		int num_out_of_reach = 0;
+		for (int iconn = 0; iconn < (int)plan->conns.size(); iconn++){
+			const Planned_Connection &conn = plan->conns[iconn];
+			if (conn.min_weight == UNDEFINED){
+				continue;
+			}
+			num_labeled++;
+			if (conn.min_weight > analysis_settings->get_max_path_weight(conn.length)){
+				num_out_of_reach++;
+			}
+		}
+		cout << "  " << num_labeled << " connections labeled with a lower bound on their path weight, " << num_out_of_reach <<
+		        " of them out of reach of the maximum path weight" << endl;
+	}
+}
+
+
+/* fills in the tile offsets at each manhattan distance from a tile */
+static void set_ring_offsets(Connection_Plan *plan){
+	plan->ring_offsets.assign(plan->max_conn_length+1, vector<Coordinate>());
+
+	/* each combination of dx and dy whose (individually absolute) sum adds up to the length. the order here determines
+	   the order in which sinks are sampled */
+	for (int ilen = 1; ilen <= plan->max_conn_length; ilen++){
+		for (int idx = -ilen; idx <= ilen; idx++){
+			int y_distance = ilen - abs(idx);
+			for (int idy = -y_distance; idy <= y_distance; idy += max(2*y_distance, 1)){	//max() in case y_distance=0
+				plan->ring_offsets[ilen].push_back( Coordinate(idx, idy) );
+			}
+		}
+	}
+}
+
+/* returns number of connections from tile at the specified coordinates at specified length */
+static int conns_at_distance_from_tile(Connection_Plan *plan, int tile_x, int tile_y, int length, Arch_Structs *arch_structs){
+	t_grid &grid = arch_structs->grid;
+	t_block_type &block_type = arch_structs->block_type;
+	int fill_type_ind = arch_structs->get_fill_type_index();
+	int grid_size_x, grid_size_y;
+	arch_structs->get_grid_size(&grid_size_x, &grid_size_y);
+
+	int num_conns = 0;
+
+	vector<Coordinate> &ring = plan->ring_offsets[length];
+	for (int ioffset = 0; ioffset < (int)ring.size(); ioffset++){
+		int dest_x = tile_x + ring[ioffset].x;
+		int dest_y = tile_y + ring[ioffset].y;
+
+		/* check if this block is within grid bounds */
+		if ( (dest_x > 0 && dest_x < grid_size_x-1) &&
+		     (dest_y > 0 && dest_y < grid_size_y-1) ){
+
+			int dest_type_ind = grid[dest_x][dest_y].get_type_index();
+
+			if (dest_type_ind != fill_type_ind){
+				WTHROW(EX_PATH_ENUM, "Encountered block that isn't of fill type (i.e. not a logic block)");
+			}
+
+			num_conns += block_type[dest_type_ind].get_num_receivers();
+		}
+	}
+
+	return num_conns;
+}
+
+/* samples the sinks to which the specified source at the specified test tile should connect, and appends the source and its
+   connections to the plan */
+static void plan_source_connections(User_Options *user_opts, Analysis_Settings *analysis_settings, Arch_Structs *arch_structs,
+			Routing_Structs *routing_structs, int source_node_ind, int source_class, e_pin_type pin_type, int tile_ind, Connection_Plan *plan){
+
+	Planned_Source planned_source;
+	planned_source.source_ind = source_node_ind;
+	planned_source.pin_type = pin_type;
+	planned_source.tile_ind = tile_ind;
+	planned_source.first_conn = (int)plan->conns.size();
+	planned_source.num_conns = 0;
+
+	Coordinate tile_coord = plan->tiles[tile_ind];
+
+	t_grid &grid = arch_structs->grid;
+	t_block_type &block_type = arch_structs->block_type;
+	int grid_size_x, grid_size_y;
+	arch_structs->get_grid_size(&grid_size_x, &grid_size_y);
+
+	Grid_Tile *test_tile = &grid[tile_coord.x][tile_coord.y];
+	Physical_Type_Descriptor *test_tile_type = &block_type[test_tile->get_type_index()];
+
+	/* get pin and length probabilities */
+	t_prob_list &length_prob = analysis_settings->length_probabilities;
+
+	/* check probability of source node. if it's 0, then no point in enumerating from it */
+	float sum_of_source_probabilities;
+	get_sum_of_source_probabilities(source_node_ind, routing_structs->rr_node, analysis_settings->pin_probabilities, *test_tile_type,
+				&sum_of_source_probabilities, NULL);
+	if (sum_of_source_probabilities == 0){
+		plan->sources.push_back(planned_source);
+		return;
+	}
+
+	/* make sure specified tile is of 'fill' type */
+	int fill_type_ind = arch_structs->get_fill_type_index();
+	if (fill_type_ind != test_tile->get_type_index()){
+		WTHROW(EX_PATH_ENUM, "Attempting to analyze source in a block that's not of fill type.");
+	}
+
+	/* make sure the current grid tile is not at an offset */
+	if (test_tile->get_width_offset() != 0 || test_tile->get_height_offset() != 0){
+		WTHROW(EX_PATH_ENUM, "Fill type block with name '" << test_tile_type->get_name() << "' has non-zero width/height offset. " <<
+				"This sort of logic block is not currently allowed.");
+	}
+
+	/* make sure the test tile has blocks at each possible connection length away from it. the furthest block from the test tile
+	   is basically the distance to the farthest legal corner of the FPGA */
+	int max_conn_length = plan->max_conn_length;
+	/* offset from perimeter because we don't want I/O blocks */
+	int max_block_dist = max( tile_coord.get_dx_plus_dy(1,1), tile_coord.get_dx_plus_dy(1, grid_size_y-2) );
+	max_block_dist = max( max_block_dist, tile_coord.get_dx_plus_dy(grid_size_x-2, grid_size_y-2) );
+	max_block_dist = max( max_block_dist, tile_coord.get_dx_plus_dy(grid_size_x-2, 1) );
+
+	if (max_block_dist < max_conn_length){
+		WTHROW(EX_PATH_ENUM, "It is not possible to connect test tile at coordinate " << tile_coord <<
+				     " to any blocks a manhattan distance " << max_conn_length << " away");
+	}
+
+	/* get sinks at neighboring tiles */
+	for (int ilen = 1; ilen <= max_conn_length; ilen++){
+		if (length_prob[ilen] == 0){
+			continue;
+		}
+
+		vector<Coordinate> &ring = plan->ring_offsets[ilen];
+		for (int ioffset = 0; ioffset < (int)ring.size(); ioffset++){
+			int dest_x = tile_coord.x + ring[ioffset].x;
+			int dest_y = tile_coord.y + ring[ioffset].y;
+
+			/* check if this block is within grid bounds */
+			if ( !((dest_x > 0 && dest_x < grid_size_x-1) &&
+			       (dest_y > 0 && dest_y < grid_size_y-1)) ){
+				continue;
+			}
+
+			Physical_Type_Descriptor *dest_type = &block_type[ grid[dest_x][dest_y].get_type_index() ];
+
+			/* iterate over each pin class*/
+			for (int iclass = 0; iclass < (int)dest_type->class_inf.size(); iclass++){
+				Pin_Class *pin_class = &dest_type->class_inf[iclass];
+
+				/* only want classes that represent receiver pins. also must actually have pins */
+				if (pin_class->get_pin_type() != RECEIVER || pin_class->get_num_pins() == 0){
+					continue;
+				}
+
+				/* do not want global pins */
+				int sample_pin = pin_class->pinlist[0];
+				if (dest_type->is_global_pin[sample_pin]){
+					continue;
+				}
+
+				/* get node corresponding to this sink */
+				int sink_node_ind = routing_structs->rr_node_index[SINK][dest_x][dest_y][iclass];
+
+				double rand_value = (double)rand() / (double)(RAND_MAX);
+				if (rand_value > user_opts->length_probabilities[ilen] * FRACTION_CONNS){
+					continue;
+				}
+
+				Planned_Connection conn;
+				conn.sink_ind = sink_node_ind;
+				conn.length = (short)ilen;
+				conn.min_weight = plan->reach_labels.get_min_weight(source_class, tile_coord.x, tile_coord.y, ring[ioffset].x, ring[ioffset].y, iclass);
+				plan->conns.push_back(conn);
+				planned_source.num_conns++;
+			}
+		}
+	}
+
+	plan->sources.push_back(planned_source);
+}
+
+/* sets the total number of connections at each connection length <= maximum connection length over the probability analysis region */
+static void set_conn_length_stats(User_Options *user_opts, Analysis_Settings *analysis_settings, Arch_Structs *arch_structs,
+			e_pin_type enumerate_type, Connection_Plan *plan, vector<int> &conns_at_length){
+
+	int max_conn_length = plan->max_conn_length;
+	t_grid &grid = arch_structs->grid;
+	t_block_type &block_type = arch_structs->block_type;
+
+	int grid_size_x, grid_size_y;
+	arch_structs->get_grid_size(&grid_size_x, &grid_size_y);
+
+	int fill_type_ind = arch_structs->get_fill_type_index();
+	Physical_Type_Descriptor *fill_type = &block_type[fill_type_ind];
+
+	/* 0..max_conn_length possible connection lengths */
+	conns_at_length.assign(max_conn_length + 1, 0);
+
+	/* determine the iteration limits for the region of the FPGA which we want to analyze */
+	int from_x, to_x, from_y, to_y;
+	get_prob_analysis_tile_region(user_opts, grid_size_x, grid_size_y, &from_x, &from_y, &to_x, &to_y);
+
+	/* calculate number of sources in a tile of fill type */
+	int num_tile_pins = fill_type->get_num_pins();
+	int num_tile_sources = 0;
+	for (int ipin = 0; ipin < num_tile_pins; ipin++){
+		/* skip global pins */
+		if (fill_type->is_global_pin[ipin]){
+			continue;
+		}
+
+		/* get type of this pin */
+		int pin_class_ind = fill_type->pin_class[ipin];
+		e_pin_type pin_type = fill_type->class_inf[pin_class_ind].get_pin_type();
+
+		if (pin_type == enumerate_type){
+			/* get probabiity of this pin being used as a source */
+			float pin_prob = analysis_settings->pin_probabilities[ipin];
+			if (pin_prob > 0){
+				num_tile_sources++;
+			}
+		}
+	}
+
+	/* iterate over the FPGA tiles as per 'get_prob_analysis_tile_region' */
+	for (int ix = from_x; ix <= to_x; ix++){
+		for (int iy = from_y; iy <= to_y; iy++){
+			int block_type_ind = grid[ix][iy].get_type_index();
+			int width_offset = grid[ix][iy].get_width_offset();
+			int height_offset = grid[ix][iy].get_height_offset();
+
+			/* error checks */
+			if (block_type_ind != fill_type_ind){
+				WTHROW(EX_PATH_ENUM, "Expected logic block type");
+			}
+			if (width_offset > 0 || height_offset > 0){
+				WTHROW(EX_PATH_ENUM, "Didn't expect logic block to have > 0 width/height offset");
+			}
+
+			/* for each legal length */
+			for (int ilen = 1; ilen <= max_conn_length; ilen++){
+				conns_at_length[ilen] += num_tile_sources * conns_at_distance_from_tile(plan, ix, iy, ilen, arch_structs);
+			}
+		}
+	}
+}
+
+/* computes the reach labels of the plan (see Reach_Labels) */
+static void set_reach_labels(Analysis_Settings *analysis_settings, Arch_Structs *arch_structs, Routing_Structs *routing_structs,
+			Connection_Plan *plan){
+
+	Reach_Labels &labels = plan->reach_labels;
+	labels = Reach_Labels();
+
+	t_rr_node &rr_node = routing_structs->rr_node;
+	int num_nodes = routing_structs->get_num_rr_nodes();
+	int max_conn_length = plan->max_conn_length;
+	int grid_size_x, grid_size_y;
+	arch_structs->get_grid_size(&grid_size_x, &grid_size_y);
+
+	/* the wire staggering repeats every lcm(wire spans) tiles. wires that are clipped by the perimeter don't count */
+	set<int> spans;
+	for (int inode = 0; inode < num_nodes; inode++){
+		e_rr_type type = rr_node[inode].get_rr_type();
+		if (type == CHANX && rr_node[inode].get_xlow() > 1 && rr_node[inode].get_xhigh() < grid_size_x-2){
+			spans.insert(rr_node[inode].get_span());
+		} else if (type == CHANY && rr_node[inode].get_ylow() > 1 && rr_node[inode].get_yhigh() < grid_size_y-2){
+			spans.insert(rr_node[inode].get_span());
+		}
+	}
+	if (spans.empty()){
+		return;
+	}
+	int period = 1;
+	for (set<int>::iterator it = spans.begin(); it != spans.end(); it++){
+		int a = period;
+		int b = (*it);
+		while (b != 0){
+			int remainder = a % b;
+			a = b;
+			b = remainder;
+		}
+		period = period / a * (*it);
+		if (period > MAX_REACH_LABEL_PERIOD){
+			cout << "Reach labels: wire staggering repeats over more than " << MAX_REACH_LABEL_PERIOD << " tiles -- no labels computed" << endl;
+			return;
+		}
+	}
+
+	/* labels apply to tiles whose sinks at every connection length lie inside the perimeter. two tiles at each position
+	   relative to the wire staggering have to fit into that region */
+	int from_x = 1 + max_conn_length;
+	int to_x = grid_size_x-2 - max_conn_length;
+	int from_y = 1 + max_conn_length;
+	int to_y = grid_size_y-2 - max_conn_length;
+	if (to_x - from_x + 1 < 2*period || to_y - from_y + 1 < 2*period){
+		cout << "Reach labels: FPGA is too small for the maximum connection length -- no labels computed" << endl;
+		return;
+	}
+
+	Physical_Type_Descriptor &fill_type = arch_structs->block_type[ arch_structs->get_fill_type_index() ];
+
+	labels.period = period;
+	labels.max_conn_length = max_conn_length;
+	labels.num_classes = (int)fill_type.class_inf.size();
+	labels.from_x = from_x;
+	labels.to_x = to_x;
+	labels.from_y = from_y;
+	labels.to_y = to_y;
+	labels.search_bound = 0;
+	for (int ilen = 1; ilen <= max_conn_length; ilen++){
+		labels.search_bound = max(labels.search_bound, analysis_settings->get_max_path_weight(ilen));
+	}
+
+	int width = 2*max_conn_length + 1;
+	labels.min_weight.assign(labels.num_classes * period*period * width*width * labels.num_classes, UNDEFINED);
+	vector<short> check_min_weight(labels.min_weight.size(), UNDEFINED);
+
+	/* node weights with all node demands at zero */
+	vector<short> zero_weight(num_nodes);
+	for (int inode = 0; inode < num_nodes; inode++){
+		zero_weight[inode] = rr_node[inode].compute_weight(0.0);
+	}
+
+	/* label one tile at each position, and check the labels against a tile one period further along both axes */
+	for (int ix = 0; ix < period; ix++){
+		for (int iy = 0; iy < period; iy++){
+			int tile_x = from_x + (ix - from_x % period + period) % period;
+			int tile_y = from_y + (iy - from_y % period + period) % period;
+
+			label_tile_sources(arch_structs, routing_structs, zero_weight, tile_x, tile_y, labels, labels.min_weight);
+			label_tile_sources(arch_structs, routing_structs, zero_weight, tile_x + period, tile_y + period, labels, check_min_weight);
+		}
+	}
+
+	if (labels.min_weight != check_min_weight){
+		cout << "Reach labels: labels differ between tiles at the same position relative to the wire staggering -- labels not used" << endl;
+		labels = Reach_Labels();
+		return;
+	}
+
+	cout << "Reach labels: computed for " << period*period << " tile positions (wire staggering repeats every " << period << " tiles)" << endl;
+}
+
+/* computes the reach labels of all sources of the specified tile into 'min_weight' (indexed as the labels of the plan) */
+static void label_tile_sources(Arch_Structs *arch_structs, Routing_Structs *routing_structs, const vector<short> &zero_weight,
+			int tile_x, int tile_y, const Reach_Labels &labels, vector<short> &min_weight){
+
+	t_rr_node &rr_node = routing_structs->rr_node;
+	int num_nodes = routing_structs->get_num_rr_nodes();
+	t_grid &grid = arch_structs->grid;
+	t_block_type &block_type = arch_structs->block_type;
+	Physical_Type_Descriptor *tile_type = &block_type[ grid[tile_x][tile_y].get_type_index() ];
+
+	/* the sinks around the tile, chosen as when connections are planned */
+	vector<int> target_nodes;
+	vector<Coordinate> target_offsets;
+	vector<int> target_classes;
+	vector<char> is_target(num_nodes, 0);
+	for (int idx = -labels.max_conn_length; idx <= labels.max_conn_length; idx++){
+		int y_distance = labels.max_conn_length - abs(idx);
+		for (int idy = -y_distance; idy <= y_distance; idy++){
+			if (idx == 0 && idy == 0){
+				continue;
+			}
+			int dest_x = tile_x + idx;
+			int dest_y = tile_y + idy;
+			Physical_Type_Descriptor *dest_type = &block_type[ grid[dest_x][dest_y].get_type_index() ];
+
+			for (int iclass = 0; iclass < (int)dest_type->class_inf.size(); iclass++){
+				Pin_Class *pin_class = &dest_type->class_inf[iclass];
+				if (pin_class->get_pin_type() != RECEIVER || pin_class->get_num_pins() == 0){
+					continue;
+				}
+				if (dest_type->is_global_pin[ pin_class->pinlist[0] ]){
+					continue;
+				}
+
+				int sink_node_ind = routing_structs->rr_node_index[SINK][dest_x][dest_y][iclass];
+				target_nodes.push_back(sink_node_ind);
+				target_offsets.push_back( Coordinate(idx, idy) );
+				target_classes.push_back(iclass);
+				is_target[sink_node_ind] = 1;
+			}
+		}
+	}
+	int num_targets = (int)target_nodes.size();
+
+	/* dijkstra from each source until all sinks are reached or the search bound is exceeded */
+	My_Bounded_Priority_Queue<int> PQ;
+	vector<short> distance(num_nodes, UNDEFINED);
+	vector<int> nodes_reached;
+	for (int iclass = 0; iclass < (int)tile_type->class_inf.size(); iclass++){
+		int source_node_ind = get_tile_source_node(routing_structs, &tile_type->class_inf[iclass], tile_x, tile_y, iclass);
+		if (source_node_ind == UNDEFINED){
+			continue;
+		}
+
+		PQ.clear();
+		PQ.set_max_weight(labels.search_bound);
+		PQ.push(source_node_ind, 0);
+		distance[source_node_ind] = 0;
+		nodes_reached.push_back(source_node_ind);
+
+		int targets_left = num_targets;
+		while (PQ.size() != 0 && targets_left > 0){
+			int node_ind = PQ.top();
+			int node_path_weight = PQ.top_weight();
+			PQ.pop();
+
+			if (is_target[node_ind]){
+				targets_left--;
+			}
+
+			int *edge_list = rr_node[node_ind].out_edges;
+			int num_children = rr_node[node_ind].get_num_out_edges();
+			for (int iedge = 0; iedge < num_children; iedge++){
+				int child_ind = edge_list[iedge];
+				int path_weight = node_path_weight + zero_weight[child_ind];
+				if (distance[child_ind] != UNDEFINED || path_weight > labels.search_bound){
+					continue;
+				}
+				distance[child_ind] = path_weight;
+				nodes_reached.push_back(child_ind);
+				PQ.push(child_ind, path_weight);
+			}
+		}
+
+		for (int itarget = 0; itarget < num_targets; itarget++){
+			short target_distance = distance[ target_nodes[itarget] ];
+			if (target_distance == UNDEFINED){
+				target_distance = labels.search_bound + 1;
+			}
+			Coordinate offset = target_offsets[itarget];
+			min_weight[ labels.get_label_ind(iclass, tile_x, tile_y, offset.x, offset.y, target_classes[itarget]) ] = target_distance;
+		}
+
+		for (int inode = 0; inode < (int)nodes_reached.size(); inode++){
+			distance[ nodes_reached[inode] ] = UNDEFINED;
+		}
+		nodes_reached.clear();
+	}
+}
+
+/* returns the node from which paths of the specified pin class of the tile at the specified coordinates are enumerated: the
+   class' source for drivers, or the virtual source of the class' sink for receivers (UNDEFINED if there is none) */
+static int get_tile_source_node(Routing_Structs *routing_structs, Pin_Class *pin_class, int tile_x, int tile_y, int iclass){
+	int source_node_ind = UNDEFINED;
+
+	int class_node_ind = routing_structs->rr_node_index[SOURCE][tile_x][tile_y][iclass];
+	if (pin_class->get_pin_type() == DRIVER){
+		source_node_ind = class_node_ind;
+	} else if (pin_class->get_pin_type() == RECEIVER){
+		source_node_ind = routing_structs->rr_node[class_node_ind].get_virtual_source_node_ind();
+	}
+
+	return source_node_ind;
+}
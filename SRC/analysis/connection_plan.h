@@ -0,0 +1,101 @@
+#ifndef CONNECTION_PLAN_H
+#define CONNECTION_PLAN_H
+
+#include <vector>
+#include "wotan_types.h"
+#include "wotan_util.h"
+
+
+/**** Defines ****/
+/* fraction of the possible connections at each length (further scaled by the user's length probabilities) that is
+   sampled for analysis */
+#define FRACTION_CONNS 0.1
+
+/* reach labels are not computed if the wire staggering repeats over more tiles than this */
+#define MAX_REACH_LABEL_PERIOD 12
+
+
+/**** Classes ****/
+/* a connection planned from some source. the source is implied by the Planned_Source that owns the connection */
+class Planned_Connection{
+public:
+	int sink_ind;
+	short length;			/* manhattan distance (in tiles) between the source's and the sink's tile */
+	short min_weight;		/* lower bound on the weight of any path from the source to the sink (UNDEFINED if not known) */
+};
+
+/* a source node of a test tile together with the range of connections planned from it */
+class Planned_Source{
+public:
+	int source_ind;
+	e_pin_type pin_type;		/* DRIVER for regular sources. RECEIVER for the virtual sources used to account for fanout */
+	int tile_ind;			/* index of the source's test tile in the plan */
+	int first_conn;			/* connections of this source are [first_conn, first_conn+num_conns) in the plan's connection list */
+	int num_conns;
+};
+
+/* Lower bounds on the weight of any path from each source of a fill-type tile to each sink around it. The bounds are the path weights
+   with all node demands at zero, which no amount of demand can lower. They are computed for one tile at each position relative to the
+   wire staggering and shared by all tiles at the same position (see connection_plan.cxx) */
+class Reach_Labels{
+public:
+	int period;			/* tiles whose coordinates agree modulo the period share labels. UNDEFINED if there are no labels */
+	int max_conn_length;
+	int num_classes;		/* number of pin classes of the fill type */
+	int search_bound;		/* sinks that weren't reached within this weight are labeled with search_bound+1 */
+	int from_x, to_x, from_y, to_y;	/* region of source tiles to which the labels apply */
+
+	/* [source class][x mod period][y mod period][dx][dy][sink class] */
+	std::vector<short> min_weight;
+
+	Reach_Labels();
+
+	/* returns the index of the label for the specified source class at the specified tile and the specified sink class at the
+	   specified (dx,dy) offset from it */
+	int get_label_ind(int source_class, int tile_x, int tile_y, int dx, int dy, int sink_class) const;
+	/* returns a lower bound on the weight of any path from the specified source class at the specified tile to the specified sink class
+	   at the specified offset. returns UNDEFINED if no label applies */
+	short get_min_weight(int source_class, int tile_x, int tile_y, int dx, int dy, int sink_class) const;
+};
+
+/* The set of source/sink connections to be analyzed. Connections are sampled once, when the plan is built, and every analysis
+   phase (path enumeration, probability analysis, and each iteration of a search over the demand multiplier) replays the same
+   plan. Sources are listed in test tile order, with the connections of each source stored contiguously */
+class Connection_Plan{
+public:
+	int max_conn_length;
+
+	/* [1..max_conn_length] the (dx,dy) offsets of all tiles at each manhattan distance from a tile */
+	std::vector< std::vector<Coordinate> > ring_offsets;
+
+	/* the test tiles, in the order in which they were planned */
+	std::vector<Coordinate> tiles;
+	/* whether each test tile lies inside the region for which probability analysis is performed */
+	std::vector<bool> tile_in_prob_region;
+	/* [itile*(max_conn_length+1) + length] number of possible connections from a test tile at each length */
+	std::vector<int> tile_conns_at_length;
+
+	std::vector<Planned_Source> sources;
+	std::vector<Planned_Connection> conns;
+
+	/* lower bounds on the path weight of each source/sink pair, used to skip connections that can't be routed at all */
+	Reach_Labels reach_labels;
+
+	/* [0..max_conn_length] total number of possible connections at each length over the probability analysis region,
+	   for paths enumerated from drivers and receivers (fanout) respectively */
+	std::vector<int> driver_conns_at_length;
+	std::vector<int> receiver_conns_at_length;
+
+	Connection_Plan();
+
+	/* returns the number of possible connections from the specified test tile at the specified length */
+	int get_tile_conns_at_length(int tile_ind, int length) const;
+};
+
+
+/**** Function Declarations ****/
+/* samples the connections to be analyzed from each test tile and records them in the specified plan */
+void build_connection_plan(User_Options *user_opts, Analysis_Settings *analysis_settings, Arch_Structs *arch_structs,
+			Routing_Structs *routing_structs, Connection_Plan *plan);
+
+#endif
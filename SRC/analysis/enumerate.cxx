@@ -22,13 +22,14 @@ using namespace std;
 
 /**** Function Declarations ****/
 /* propagates path counts stored in the bucket structure of the parent node to the bucket structure of the child node */
-static void propagate_path_counts(int parent_ind, int parent_edge_ind, int child_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
-			e_traversal_dir traversal_dir, int max_path_weight, e_bucket_mode enumerate_mode, e_self_congestion_mode self_congestion_mode);
+static void propagate_path_counts(int parent_ind, int parent_edge_ind, int child_ind, t_rr_node &rr_node, const Node_Values &node_values, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
+			e_traversal_dir traversal_dir, int max_path_weight, e_bucket_mode enumerate_mode, e_self_congestion_mode self_congestion_mode,
+			e_bucket_kernel bucket_kernel);
 
 
 /**** Function Definitions ****/
 /* Called when node is popped from expansion queue during topological traversal */
-void enumerate_node_popped_func(int popped_node, int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, 
+void enumerate_node_popped_func(int popped_node, int from_node_ind, int to_node_ind, t_rr_node &rr_node, const Node_Values &node_values, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, 
                           e_traversal_dir traversal_dir, int max_path_weight, User_Options *user_opts, void *user_data){
 
 	/* increment node demand during forward traversal only */
@@ -39,7 +40,7 @@ void enumerate_node_popped_func(int popped_node, int from_node_ind, int to_node_
 		//Note: I added OPIN and IPIN checks below because otherwise high opin demand skews comparisons (I think) unfairly
 		//	away from opin-equivalent architectures. (see commit 8392b21)
 		if (node_type != SOURCE && node_type != SINK && node_type != OPIN /*&& node_type != IPIN*/){
-			int node_weight = rr_node[popped_node].get_weight();
+			int node_weight = node_values.weight[popped_node];
 			int dist_to_source = ss_distances[popped_node].get_source_distance();
 			float demand_contribution = node_topo_inf[popped_node].buckets.get_num_paths(node_weight, dist_to_source, max_path_weight);
 
@@ -48,7 +49,12 @@ void enumerate_node_popped_func(int popped_node, int from_node_ind, int to_node_
 			//if (node_type != OPIN /*&& node_type != IPIN*/){
 			//	demand_contribution *= user_opts->demand_multiplier;
 			//}
-			rr_node[popped_node].increment_demand( demand_contribution, user_opts->demand_multiplier);
+			rr_node[popped_node].increment_demand( demand_contribution );
+
+			Enumerate_Structs *enumerate_structs = (Enumerate_Structs *)user_data;
+			if (enumerate_structs->demand_record != NULL && demand_contribution != 0){
+				enumerate_structs->demand_record->push_back( make_pair(popped_node, demand_contribution) );
+			}
 
 			/* It is possible to keep a history of how many paths there are connecting each source/sink with the
 			   nearby nodes. This path count history can be used to later subtract the demand due to a source/sink pair
@@ -70,7 +76,7 @@ void enumerate_node_popped_func(int popped_node, int from_node_ind, int to_node_
 		/* add to existing count of the number of routing nodes (CHANX/CHANY/IPIN/OPIN) in the legal subgraph
 		   (this is used for reliability polynomial computations) */
 		Enumerate_Structs *enumerate_structs = (Enumerate_Structs *)user_data;
-		int popped_node_weight = rr_node[popped_node].get_weight();
+		int popped_node_weight = node_values.weight[popped_node];
 		if ( ss_distances[popped_node].is_legal(popped_node_weight, max_path_weight) ){
 			if (node_type == CHANX || node_type == CHANY || node_type == IPIN || node_type == OPIN){
 				enumerate_structs->num_routing_nodes_in_subgraph++;
@@ -80,7 +86,7 @@ void enumerate_node_popped_func(int popped_node, int from_node_ind, int to_node_
 }
 
 /* Called when topological traversal is iterateing over a node's children */
-bool enumerate_child_iterated_func(int parent_ind, int parent_edge_ind, int node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
+bool enumerate_child_iterated_func(int parent_ind, int parent_edge_ind, int node_ind, t_rr_node &rr_node, const Node_Values &node_values, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
                           e_traversal_dir traversal_dir, int max_path_weight, int from_node_ind, int to_node_ind, User_Options *user_opts, void *user_data){
 	bool ignore_node = false;
 
@@ -91,8 +97,8 @@ bool enumerate_child_iterated_func(int parent_ind, int parent_edge_ind, int node
 	//	cout << "from: " << from_node_ind << "  to: " << to_node_ind << endl;
 	//	cout << "child: " << node_ind << "  parent: " << parent_ind << endl;
 	//}
-	propagate_path_counts(parent_ind, parent_edge_ind, node_ind, rr_node, ss_distances, node_topo_inf, traversal_dir, max_path_weight, enumerate_structs->mode,
-	                      user_opts->self_congestion_mode);
+	propagate_path_counts(parent_ind, parent_edge_ind, node_ind, rr_node, node_values, ss_distances, node_topo_inf, traversal_dir, max_path_weight, enumerate_structs->mode,
+	                      user_opts->self_congestion_mode, enumerate_structs->bucket_kernel);
 
 	//if (from_node_ind == 5784 && to_node_ind == 6950){
 	//	cout << parent_ind << " to " << node_ind << endl;
@@ -102,7 +108,7 @@ bool enumerate_child_iterated_func(int parent_ind, int parent_edge_ind, int node
 }
 
 /* Called once topological traversal is complete. */
-void enumerate_traversal_done_func(int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, 
+void enumerate_traversal_done_func(int from_node_ind, int to_node_ind, t_rr_node &rr_node, const Node_Values &node_values, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, 
                           e_traversal_dir traversal_dir, int max_path_weight, User_Options *user_opts, void *user_data){
 	
 	/* nothing to be done */
@@ -110,8 +116,9 @@ void enumerate_traversal_done_func(int from_node_ind, int to_node_ind, t_rr_node
 
 
 /* propagates path counts stored in the bucket structure of the parent node to the bucket structure of the child node */
-static void propagate_path_counts(int parent_ind, int parent_edge_ind, int child_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
-			e_traversal_dir traversal_dir, int max_path_weight, e_bucket_mode enumerate_mode, e_self_congestion_mode self_congestion_mode){
+static void propagate_path_counts(int parent_ind, int parent_edge_ind, int child_ind, t_rr_node &rr_node, const Node_Values &node_values, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
+			e_traversal_dir traversal_dir, int max_path_weight, e_bucket_mode enumerate_mode, e_self_congestion_mode self_congestion_mode,
+			e_bucket_kernel bucket_kernel){
 
 	if (enumerate_mode != BY_PATH_WEIGHT && enumerate_mode != BY_PATH_HOPS){
 		WTHROW(EX_PATH_ENUM, "Unknown enumeration mode: " << enumerate_mode);
@@ -124,7 +131,7 @@ static void propagate_path_counts(int parent_ind, int parent_edge_ind, int child
 	int parent_dist_to_start = UNDEFINED;	//minimum distance from parent to start node
 
 	int max_dist = max_path_weight;
-	int child_weight = rr_node[child_ind].get_weight();
+	int child_weight = node_values.weight[child_ind];
 	if (enumerate_mode == BY_PATH_HOPS){
 		child_weight = 1;
 		max_dist += 3;
@@ -162,8 +169,15 @@ static void propagate_path_counts(int parent_ind, int parent_edge_ind, int child
 		}
 	}
 	
-	if (parent_dist_to_start < 0){
-		WTHROW(EX_PATH_ENUM, "Parent node has distance to start node of < 0: " << parent_dist_to_start);
+	WCHECK(1, parent_dist_to_start >= 0, EX_PATH_ENUM, "Parent node has distance to start node of < 0: " << parent_dist_to_start);
+
+	if (self_congestion_mode != MODE_PATH_DEPENDENCE){
+		/* nothing to keep track of per bucket -- hand the whole window to the connection's bucket kernel */
+		int last_bucket = min(num_buckets-1, max_dist - child_dist_to_target);
+		WCHECK(2, last_bucket < parent_dist_to_start || last_bucket + child_weight < num_buckets, EX_PATH_ENUM,
+		       "Out of bounds: target bucket " << last_bucket + child_weight << " num_buckets: " << num_buckets);
+		add_bucket_path_counts(bucket_kernel, parent_buckets, child_buckets, num_buckets, parent_dist_to_start, last_bucket, child_weight);
+		return;
 	}
 
 	/* now propagate parent path counts to the child */
@@ -182,6 +196,7 @@ static void propagate_path_counts(int parent_ind, int parent_edge_ind, int child
 
 		/* bucket into which to propagate probabilities */
 		int target_bucket = ibucket + child_weight;
+		WCHECK(2, target_bucket < num_buckets, EX_PATH_ENUM, "Out of bounds: target bucket " << target_bucket << " num_buckets: " << num_buckets);
 
 		/* propagate the parent path counts to child */
 		if (child_buckets[target_bucket] == UNDEFINED){
@@ -1,7 +1,15 @@
 #ifndef ENUMERATE_H
 #define ENUMERATE_H
 
+#include <vector>
+#include <utility>
 #include "wotan_types.h"
+#include "bucket_kernels.h"
+
+
+/**** Typedefs ****/
+/* a list of (node index, demand contribution) pairs */
+typedef std::vector< std::pair<int, float> > t_demand_record;
 
 
 /**** Classes ****/
@@ -11,24 +19,30 @@ public:
 	   path enumeration */
 	int num_routing_nodes_in_subgraph;
 	e_bucket_mode mode;
+	/* if not NULL, the demand contributed to each node is also recorded here */
+	t_demand_record *demand_record;
+	/* kernel used to propagate path counts; picked per connection from the largest bucket the traversal can reach */
+	e_bucket_kernel bucket_kernel;
 
 	Enumerate_Structs(){
 		this->num_routing_nodes_in_subgraph = 0;
+		this->demand_record = NULL;
+		this->bucket_kernel = BUCKET_KERNEL_GENERIC;
 	}
 };
 
 
 /**** Function Declarations ****/
 /* Called when node is popped from expansion queue during topological traversal */
-void enumerate_node_popped_func(int popped_node, int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, 
+void enumerate_node_popped_func(int popped_node, int from_node_ind, int to_node_ind, t_rr_node &rr_node, const Node_Values &node_values, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, 
                           e_traversal_dir traversal_dir, int max_path_weight, User_Options *user_opts, void *user_data);
 
 /* Called when topological traversal is iterateing over a node's children */
-bool enumerate_child_iterated_func(int parent_ind, int parent_edge_ind, int node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
+bool enumerate_child_iterated_func(int parent_ind, int parent_edge_ind, int node_ind, t_rr_node &rr_node, const Node_Values &node_values, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
                           e_traversal_dir traversal_dir, int max_path_weight, int from_node_ind, int to_node_ind, User_Options *user_opts, void *user_data);
 
 /* Called once topological traversal is complete */
-void enumerate_traversal_done_func(int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, 
+void enumerate_traversal_done_func(int from_node_ind, int to_node_ind, t_rr_node &rr_node, const Node_Values &node_values, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, 
                           e_traversal_dir traversal_dir, int max_path_weight, User_Options *user_opts, void *user_data);
 
 
@@ -0,0 +1,331 @@
+/*
+	The 'tiled' path enumeration engine.
+
+	In a uniform fabric every tile has the same switch-block / connection-block structure, so the demand that path enumeration
+contributes for a connection only depends on the tiles the connection's paths can pass through, not on where in the fabric
+the connection lies. This engine traverses a connection once, records the demand it contributed to each node relative to
+the source tile (a 'template'), and replays the template, translated, for later connections with the same source/sink classes
+and source-to-sink offset.
+
+	A template may only be replayed if the neighbourhood of the new connection is identical to that of the recorded one. Each
+tile gets a signature from the nodes anchored in it (type, ptc, span, current weight) and from the nodes each of them connects
+to (in edge order, relative to the tile). The traversals that make up path enumeration only ever look at nodes that they reach
+over such edges, so if every tile that anchors a node touched by the recorded connection has a matching signature at the
+translated location, the new connection's traversals touch the translated nodes and compute the same path counts. Tiles
+near the fabric perimeter, or near a change in the fabric, simply get templates of their own (or are traversed).
+
+	Signatures depend on node weights, so they are rebuilt for every enumeration phase.
+*/
+
+#include <map>
+#include <algorithm>
+#include "enumerate_tiled.h"
+#include <cmath>
+#include "exception.h"
+
+using namespace std;
+
+
+/**** Function Declarations ****/
+/* mixes the specified value into the specified hash */
+static unsigned long long mix_hash(unsigned long long hash, long long value);
+/* returns a hash describing the specified node and the nodes it connects to, relative to the specified tile */
+static unsigned long long get_node_signature(int node_ind, int tile_x, int tile_y, t_rr_node &rr_node, const Node_Values &node_values);
+/* returns the index of the node described by the specified template node, translated to the specified source tile. returns
+   UNDEFINED if there is no such node */
+static int get_translated_node(const Template_Node &template_node, int source_x, int source_y, Routing_Structs *routing_structs);
+/* returns the key identifying connections that may share templates with the specified connection */
+static Template_Key get_template_key(int source_node_ind, int sink_node_ind, t_rr_node &rr_node);
+
+
+/**** Function Definitions ****/
+/*==== Template_Key Class ====*/
+bool Template_Key::operator < (const Template_Key &obj) const{
+	if (this->virtual_source != obj.virtual_source){
+		return this->virtual_source < obj.virtual_source;
+	}
+	if (this->source_ptc != obj.source_ptc){
+		return this->source_ptc < obj.source_ptc;
+	}
+	if (this->sink_ptc != obj.sink_ptc){
+		return this->sink_ptc < obj.sink_ptc;
+	}
+	if (this->dx != obj.dx){
+		return this->dx < obj.dx;
+	}
+	return this->dy < obj.dy;
+}
+/*==== END Template_Key Class ====*/
+
+
+/*==== Enumerate_Template_Cache Class ====*/
+Enumerate_Template_Cache::Enumerate_Template_Cache(){
+	this->num_templates = 0;
+	this->num_traversed = 0;
+	this->num_replayed = 0;
+	this->traverse_seconds = 0;
+	this->replay_seconds = 0;
+	this->num_verified = 0;
+	this->max_verify_error = 0;
+}
+/*==== END Enumerate_Template_Cache Class ====*/
+
+
+/* computes a signature of every tile from the nodes anchored at the tile (i.e. whose low corner lies in the tile), their current
+   weights, and the nodes they connect to. two tiles with the same signature look the same to path enumeration */
+void build_tile_signatures(Arch_Structs *arch_structs, Routing_Structs *routing_structs, t_tile_signatures &tile_signatures){
+	t_rr_node &rr_node = routing_structs->rr_node;
+	const Node_Values &node_values = routing_structs->node_values;
+	int num_nodes = routing_structs->get_num_rr_nodes();
+
+	int grid_size_x, grid_size_y;
+	arch_structs->get_grid_size(&grid_size_x, &grid_size_y);
+	tile_signatures.assign(grid_size_x, vector<unsigned long long>(grid_size_y, 0));
+
+	/* nodes are combined in index order. within a tile, the nodes of a uniform fabric are numbered in the same order everywhere */
+	for (int inode = 0; inode < num_nodes; inode++){
+		int tile_x = rr_node[inode].get_xlow();
+		int tile_y = rr_node[inode].get_ylow();
+		if (tile_x < 0 || tile_x >= grid_size_x || tile_y < 0 || tile_y >= grid_size_y){
+			WTHROW(EX_PATH_ENUM, "Node " << inode << " is anchored outside of the grid at (" << tile_x << "," << tile_y << ")");
+		}
+
+		unsigned long long &signature = tile_signatures[tile_x][tile_y];
+		signature = mix_hash(signature, (long long)get_node_signature(inode, tile_x, tile_y, rr_node, node_values));
+	}
+}
+
+/* looks for a template recorded for a connection equivalent to the specified one. if one is found and 'apply' is set, the template's
+   demand, scaled by the specified enumeration scaling factor, is added to the translated nodes. returns the template (or NULL) */
+const Enumerate_Template *replay_enumerate_template(int source_node_ind, int sink_node_ind, float scaling_factor, bool apply,
+			Routing_Structs *routing_structs, const t_tile_signatures &tile_signatures, Enumerate_Template_Cache *cache){
+	t_rr_node &rr_node = routing_structs->rr_node;
+
+	map< Template_Key, vector<Enumerate_Template> >::const_iterator it = cache->templates.find( get_template_key(source_node_ind, sink_node_ind, rr_node) );
+	if (it == cache->templates.end()){
+		return NULL;
+	}
+
+	int source_x = rr_node[source_node_ind].get_xlow();
+	int source_y = rr_node[source_node_ind].get_ylow();
+	int grid_size_x = (int)tile_signatures.size();
+	int grid_size_y = (int)tile_signatures[0].size();
+
+	/* find a template whose neighbourhood matches the neighbourhood of this connection */
+	const Enumerate_Template *match = NULL;
+	const vector<Enumerate_Template> &key_templates = it->second;
+	for (int itemplate = 0; itemplate < (int)key_templates.size() && match == NULL; itemplate++){
+		const Enumerate_Template &enum_template = key_templates[itemplate];
+
+		bool matches = true;
+		for (int itile = 0; itile < (int)enum_template.tile_offsets.size(); itile++){
+			int tile_x = source_x + enum_template.tile_offsets[itile].x;
+			int tile_y = source_y + enum_template.tile_offsets[itile].y;
+			if (tile_x < 0 || tile_x >= grid_size_x || tile_y < 0 || tile_y >= grid_size_y ||
+			    tile_signatures[tile_x][tile_y] != enum_template.tile_signatures[itile]){
+				matches = false;
+				break;
+			}
+		}
+
+		if (matches){
+			match = &enum_template;
+		}
+	}
+
+	if (match != NULL && apply){
+		for (int inode = 0; inode < (int)match->nodes.size(); inode++){
+			int node_ind = get_translated_node(match->nodes[inode], source_x, source_y, routing_structs);
+			if (node_ind == UNDEFINED){
+				WTHROW(EX_PATH_ENUM, "Template node could not be translated even though the neighbourhood signatures matched");
+			}
+			rr_node[node_ind].increment_demand( (double)match->nodes[inode].unit_demand * scaling_factor );
+		}
+	}
+
+	return match;
+}
+
+/* records the connection that was just enumerated (the demand it contributed and the nodes it visited) as a new template */
+void record_enumerate_template(int source_node_ind, int sink_node_ind, float scaling_factor, bool enumerated,
+			const t_demand_record &demand_record, const vector<int> &nodes_visited, Routing_Structs *routing_structs,
+			const t_tile_signatures &tile_signatures, Enumerate_Template_Cache *cache){
+	t_rr_node &rr_node = routing_structs->rr_node;
+
+	vector<Enumerate_Template> &key_templates = cache->templates[ get_template_key(source_node_ind, sink_node_ind, rr_node) ];
+	if ((int)key_templates.size() >= MAX_TEMPLATES_PER_KEY || scaling_factor <= 0){
+		return;
+	}
+
+	int source_x = rr_node[source_node_ind].get_xlow();
+	int source_y = rr_node[source_node_ind].get_ylow();
+
+	Enumerate_Template enum_template;
+	enum_template.enumerated = enumerated;
+
+	/* the tiles anchoring visited nodes make up the neighbourhood of the connection */
+	vector<Coordinate> tiles;
+	tiles.reserve(nodes_visited.size());
+	for (int inode = 0; inode < (int)nodes_visited.size(); inode++){
+		RR_Node &node = rr_node[ nodes_visited[inode] ];
+		tiles.push_back( Coordinate(node.get_xlow(), node.get_ylow()) );
+	}
+	sort(tiles.begin(), tiles.end());
+	tiles.erase( unique(tiles.begin(), tiles.end()), tiles.end() );
+	for (int itile = 0; itile < (int)tiles.size(); itile++){
+		enum_template.tile_offsets.push_back( Coordinate(tiles[itile].x - source_x, tiles[itile].y - source_y) );
+		enum_template.tile_signatures.push_back( tile_signatures[tiles[itile].x][tiles[itile].y] );
+	}
+
+	for (int irec = 0; irec < (int)demand_record.size(); irec++){
+		RR_Node &node = rr_node[ demand_record[irec].first ];
+
+		Template_Node template_node;
+		template_node.type = node.get_rr_type();
+		template_node.dx = node.get_xlow() - source_x;
+		template_node.dy = node.get_ylow() - source_y;
+		template_node.ptc = node.get_ptc_num();
+		template_node.unit_demand = demand_record[irec].second / scaling_factor;
+		enum_template.nodes.push_back(template_node);
+	}
+
+	key_templates.push_back(enum_template);
+	cache->num_templates++;
+}
+
+/* compares the demand contributed by a traversed connection against the demand the specified template would have contributed,
+   and records the difference in the cache's verification statistics */
+void verify_enumerate_template(const Enumerate_Template &enum_template, int source_node_ind, float scaling_factor,
+			const t_demand_record &demand_record, Routing_Structs *routing_structs, Enumerate_Template_Cache *cache){
+	t_rr_node &rr_node = routing_structs->rr_node;
+	int source_x = rr_node[source_node_ind].get_xlow();
+	int source_y = rr_node[source_node_ind].get_ylow();
+
+	/* difference in demand of every node touched by either the traversal or the template */
+	map<int, double> demand_difference;
+	double max_demand = 0;
+	for (int irec = 0; irec < (int)demand_record.size(); irec++){
+		demand_difference[ demand_record[irec].first ] += demand_record[irec].second;
+		max_demand = max(max_demand, (double)demand_record[irec].second);
+	}
+	for (int inode = 0; inode < (int)enum_template.nodes.size(); inode++){
+		int node_ind = get_translated_node(enum_template.nodes[inode], source_x, source_y, routing_structs);
+		demand_difference[node_ind] -= (double)enum_template.nodes[inode].unit_demand * scaling_factor;
+	}
+
+	double max_difference = 0;
+	for (map<int, double>::const_iterator it = demand_difference.begin(); it != demand_difference.end(); it++){
+		max_difference = max(max_difference, fabs(it->second));
+	}
+
+	cache->num_verified++;
+	if (max_demand > 0){
+		cache->max_verify_error = max(cache->max_verify_error, max_difference / max_demand);
+	}
+}
+
+/* prints usage statistics summed over the template caches of all threads */
+void print_enumerate_template_stats(User_Options *user_opts, const vector<Enumerate_Template_Cache> &caches){
+	Enumerate_Template_Cache total;
+	for (int icache = 0; icache < (int)caches.size(); icache++){
+		total.num_templates += caches[icache].num_templates;
+		total.num_traversed += caches[icache].num_traversed;
+		total.num_replayed += caches[icache].num_replayed;
+		total.traverse_seconds += caches[icache].traverse_seconds;
+		total.replay_seconds += caches[icache].replay_seconds;
+		total.num_verified += caches[icache].num_verified;
+		total.max_verify_error = max(total.max_verify_error, caches[icache].max_verify_error);
+	}
+
+	int num_conns = total.num_traversed + total.num_replayed;
+	cout << "Tiled enumeration: " << total.num_templates << " templates recorded, " << total.num_replayed << " of " << num_conns
+	     << " connections replayed" << endl;
+
+	if (total.num_traversed > 0){
+		double traverse_usec = 1e6 * total.traverse_seconds / (double)total.num_traversed;
+		cout << "  avg time per traversed connection: " << traverse_usec << " us" << endl;
+		if (total.num_replayed > 0){
+			double replay_usec = 1e6 * total.replay_seconds / (double)total.num_replayed;
+			cout << "  avg time per replayed connection: " << replay_usec << " us (" << traverse_usec / max(replay_usec, 1e-3) << "x faster)" << endl;
+		}
+	}
+
+	if (user_opts->enumerate_engine == ENGINE_VERIFY){
+		cout << "  connections checked against a template: " << total.num_verified << endl;
+		cout << "  max demand difference (relative to largest node demand of the connection): " << total.max_verify_error << endl;
+	}
+}
+
+
+/* mixes the specified value into the specified hash */
+static unsigned long long mix_hash(unsigned long long hash, long long value){
+	/* splitmix64 finalizer over the combination */
+	unsigned long long z = hash ^ ((unsigned long long)value + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2));
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	return z ^ (z >> 31);
+}
+
+/* returns a hash describing the specified node and the nodes it connects to, relative to the specified tile */
+static unsigned long long get_node_signature(int node_ind, int tile_x, int tile_y, t_rr_node &rr_node, const Node_Values &node_values){
+	RR_Node &node = rr_node[node_ind];
+
+	unsigned long long signature = 0;
+	signature = mix_hash(signature, node.get_rr_type());
+	signature = mix_hash(signature, node.get_ptc_num());
+	signature = mix_hash(signature, node.get_xhigh() - tile_x);
+	signature = mix_hash(signature, node.get_yhigh() - tile_y);
+	signature = mix_hash(signature, node_values.weight[node_ind]);
+
+	/* the nodes this node connects to, in both directions */
+	int *edge_lists[2] = {node.out_edges, node.in_edges};
+	int num_edges[2] = {node.get_num_out_edges(), node.get_num_in_edges()};
+	for (int idir = 0; idir < 2; idir++){
+		signature = mix_hash(signature, num_edges[idir]);
+		for (int iedge = 0; iedge < num_edges[idir]; iedge++){
+			int other_ind = edge_lists[idir][iedge];
+			RR_Node &other = rr_node[other_ind];
+			signature = mix_hash(signature, other.get_rr_type());
+			signature = mix_hash(signature, other.get_ptc_num());
+			signature = mix_hash(signature, other.get_xlow() - tile_x);
+			signature = mix_hash(signature, other.get_ylow() - tile_y);
+			signature = mix_hash(signature, other.get_xhigh() - tile_x);
+			signature = mix_hash(signature, other.get_yhigh() - tile_y);
+			signature = mix_hash(signature, node_values.weight[other_ind]);
+		}
+	}
+
+	return signature;
+}
+
+/* returns the index of the node described by the specified template node, translated to the specified source tile. returns
+   UNDEFINED if there is no such node */
+static int get_translated_node(const Template_Node &template_node, int source_x, int source_y, Routing_Structs *routing_structs){
+	const t_rr_node_index &rr_node_index = routing_structs->rr_node_index;
+
+	int x = source_x + template_node.dx;
+	int y = source_y + template_node.dy;
+	if (x < 0 || x >= (int)rr_node_index[template_node.type].size() || y < 0 || y >= (int)rr_node_index[template_node.type][x].size()){
+		return UNDEFINED;
+	}
+
+	const vector<int> &ptc_nodes = rr_node_index[template_node.type][x][y];
+	if (template_node.ptc < 0 || template_node.ptc >= (int)ptc_nodes.size()){
+		return UNDEFINED;
+	}
+	return ptc_nodes[template_node.ptc];
+}
+
+/* returns the key identifying connections that may share templates with the specified connection */
+static Template_Key get_template_key(int source_node_ind, int sink_node_ind, t_rr_node &rr_node){
+	RR_Node &source_node = rr_node[source_node_ind];
+	RR_Node &sink_node = rr_node[sink_node_ind];
+
+	Template_Key key;
+	key.virtual_source = source_node.get_is_virtual_source();
+	key.source_ptc = source_node.get_ptc_num();
+	key.sink_ptc = sink_node.get_ptc_num();
+	key.dx = sink_node.get_xlow() - source_node.get_xlow();
+	key.dy = sink_node.get_ylow() - source_node.get_ylow();
+	return key;
+}
@@ -0,0 +1,99 @@
+#ifndef ENUMERATE_TILED_H
+#define ENUMERATE_TILED_H
+
+#include <vector>
+#include <map>
+#include "wotan_types.h"
+#include "wotan_util.h"
+#include "enumerate.h"
+
+
+/**** Defines ****/
+/* maximum number of templates kept for each source class / sink class / offset combination (e.g. one for each phase of
+   staggered wire segments). connections that match none of them are simply traversed */
+#define MAX_TEMPLATES_PER_KEY 8
+
+
+/**** Typedefs ****/
+/* [0..grid_size_x-1][0..grid_size_y-1] a signature of each tile (see build_tile_signatures) */
+typedef std::vector< std::vector<unsigned long long> > t_tile_signatures;
+
+
+/**** Classes ****/
+/* a node touched by a template connection. the node is identified by its type, its ptc number, and the offset of its
+   low corner from the template's source tile */
+class Template_Node{
+public:
+	e_rr_type type;
+	short dx;
+	short dy;
+	int ptc;
+	float unit_demand;		/* demand contributed to the node, per unit of the connection's enumeration scaling factor */
+};
+
+/* the demand contributed to all nodes by one enumerated connection, recorded relative to the connection's source tile */
+class Enumerate_Template{
+public:
+	/* the tiles in which nodes touched by the connection are anchored (relative to the source tile), and the signature each of
+	   these tiles had. a connection from another tile can replay this template if all the corresponding tiles match */
+	std::vector<Coordinate> tile_offsets;
+	std::vector<unsigned long long> tile_signatures;
+
+	std::vector<Template_Node> nodes;
+	bool enumerated;		/* false if no paths could be enumerated for the connection */
+};
+
+/* identifies connections that may share templates */
+class Template_Key{
+public:
+	bool virtual_source;
+	int source_ptc;
+	int sink_ptc;
+	int dx;
+	int dy;
+
+	bool operator < (const Template_Key &obj) const;
+};
+
+/* Templates of connections enumerated by one analysis thread, together with statistics on how often they were used */
+class Enumerate_Template_Cache{
+public:
+	std::map< Template_Key, std::vector<Enumerate_Template> > templates;
+
+	int num_templates;
+	int num_traversed;		/* connections that were enumerated by traversing the graph */
+	int num_replayed;		/* connections whose demand was replayed from a template */
+	double traverse_seconds;	/* time spent on traversed and on replayed connections */
+	double replay_seconds;
+
+	int num_verified;		/* in ENGINE_VERIFY mode: connections compared against a matching template */
+	double max_verify_error;	/* largest difference between replayed and traversed demand, relative to the connection's largest node demand */
+
+	Enumerate_Template_Cache();
+};
+
+
+/**** Function Declarations ****/
+/* computes a signature of every tile from the nodes anchored at the tile (i.e. whose low corner lies in the tile), their current
+   weights, and the nodes they connect to. two tiles with the same signature look the same to path enumeration */
+void build_tile_signatures(Arch_Structs *arch_structs, Routing_Structs *routing_structs, t_tile_signatures &tile_signatures);
+
+/* looks for a template recorded for a connection equivalent to the specified one. if one is found and 'apply' is set, the template's
+   demand, scaled by the specified enumeration scaling factor, is added to the translated nodes. returns the template (or NULL) */
+const Enumerate_Template *replay_enumerate_template(int source_node_ind, int sink_node_ind, float scaling_factor, bool apply,
+			Routing_Structs *routing_structs, const t_tile_signatures &tile_signatures, Enumerate_Template_Cache *cache);
+
+/* records the connection that was just enumerated (the demand it contributed and the nodes it visited) as a new template */
+void record_enumerate_template(int source_node_ind, int sink_node_ind, float scaling_factor, bool enumerated,
+			const t_demand_record &demand_record, const std::vector<int> &nodes_visited, Routing_Structs *routing_structs,
+			const t_tile_signatures &tile_signatures, Enumerate_Template_Cache *cache);
+
+/* compares the demand contributed by a traversed connection against the demand the specified template would have contributed,
+   and records the difference in the cache's verification statistics */
+void verify_enumerate_template(const Enumerate_Template &enum_template, int source_node_ind, float scaling_factor,
+			const t_demand_record &demand_record, Routing_Structs *routing_structs, Enumerate_Template_Cache *cache);
+
+/* prints usage statistics summed over the template caches of all threads */
+void print_enumerate_template_stats(User_Options *user_opts, const std::vector<Enumerate_Template_Cache> &caches);
+
+#endif
@@ -0,0 +1,235 @@
+/*
+	Structural profile of the loaded routing graph, printed by the -profile_graph option before any analysis is done.
+
+	Strongly connected components are found with an iterative version of Tarjan's algorithm (the graph can have millions of
+nodes, too many for recursion). Only wires lie on cycles: sources, sinks and pins are components of their own. The wires of an
+island-style FPGA form one large component, or several equal ones if the switch pattern keeps wire tracks in separate planes
+(as the disjoint pattern does). A wire that lies on no cycle points at a broken or truncated graph.
+*/
+
+#include <iostream>
+#include <algorithm>
+#include <utility>
+#include <functional>
+#include "graph_profile.h"
+#include "exception.h"
+
+using namespace std;
+
+
+/**** Defines ****/
+/* number of the largest strongly connected components whose sizes are printed */
+#define GRAPH_PROFILE_COMPONENTS_LISTED 8
+
+
+/**** Function Declarations ****/
+/* prints the min/p50/p90/max/average of the specified degrees (which are sorted in the process) */
+static void print_degree_distribution(string name, vector<int> &degrees);
+/* finds the strongly connected components of the routing graph. sets the component of each node and returns the number of components */
+static int find_strongly_connected_components(t_rr_node &rr_node, int num_nodes, vector<int> &node_component);
+/* prints the min/average/max of the nonzero entries of the specified channel widths */
+static void print_chanwidth_stats(string name, const t_chanwidth &chanwidth);
+
+
+
+/**** Function Definitions ****/
+/* prints node and edge counts by node type, the fan-in and fan-out distributions of each node type, the strongly connected
+   components of the routing graph, and the channel widths of the architecture */
+void print_graph_profile(Arch_Structs *arch_structs, Routing_Structs *routing_structs){
+	t_rr_node &rr_node = routing_structs->rr_node;
+	int num_nodes = routing_structs->get_num_rr_nodes();
+
+	int grid_size_x, grid_size_y;
+	arch_structs->get_grid_size(&grid_size_x, &grid_size_y);
+
+	cout << endl << "Routing graph profile (" << grid_size_x << "x" << grid_size_y << " grid):" << endl;
+
+	/* node counts and degrees by node type. edges are counted by the types of the nodes at both ends */
+	vector<int> nodes_of_type(NUM_RR_TYPES, 0);
+	vector< vector<long long> > edges_between_types(NUM_RR_TYPES, vector<long long>(NUM_RR_TYPES, 0));
+	vector< vector<int> > out_degrees(NUM_RR_TYPES);
+	vector< vector<int> > in_degrees(NUM_RR_TYPES);
+	long long num_edges = 0;
+	for (int inode = 0; inode < num_nodes; inode++){
+		e_rr_type node_type = rr_node[inode].get_rr_type();
+		/* nodes without edges may have their edge counts UNDEFINED */
+		int num_out_edges = max(0, (int)rr_node[inode].get_num_out_edges());
+		int num_in_edges = max(0, (int)rr_node[inode].get_num_in_edges());
+
+		nodes_of_type[node_type]++;
+		out_degrees[node_type].push_back(num_out_edges);
+		in_degrees[node_type].push_back(num_in_edges);
+
+		for (int iedge = 0; iedge < num_out_edges; iedge++){
+			int child_ind = rr_node[inode].out_edges[iedge];
+			edges_between_types[node_type][ rr_node[child_ind].get_rr_type() ]++;
+		}
+		num_edges += num_out_edges;
+	}
+
+	cout << "  " << num_nodes << " nodes, " << num_edges << " edges" << endl;
+	for (int itype = 0; itype < NUM_RR_TYPES; itype++){
+		if (nodes_of_type[itype] == 0){
+			continue;
+		}
+		cout << "  " << g_rr_type_string[itype] << ": " << nodes_of_type[itype] << " nodes" << endl;
+		print_degree_distribution("fan-out", out_degrees[itype]);
+		print_degree_distribution("fan-in", in_degrees[itype]);
+	}
+
+	cout << "  edges by node type:" << endl;
+	for (int ifrom = 0; ifrom < NUM_RR_TYPES; ifrom++){
+		for (int ito = 0; ito < NUM_RR_TYPES; ito++){
+			if (edges_between_types[ifrom][ito] > 0){
+				cout << "    " << g_rr_type_string[ifrom] << " -> " << g_rr_type_string[ito] << ": " << edges_between_types[ifrom][ito] << endl;
+			}
+		}
+	}
+
+	/* strongly connected components */
+	vector<int> node_component;
+	int num_components = find_strongly_connected_components(rr_node, num_nodes, node_component);
+	vector<int> component_size(num_components, 0);
+	for (int inode = 0; inode < num_nodes; inode++){
+		component_size[ node_component[inode] ]++;
+	}
+	vector<int> nontrivial_sizes;
+	for (int icomp = 0; icomp < num_components; icomp++){
+		if (component_size[icomp] > 1){
+			nontrivial_sizes.push_back(component_size[icomp]);
+		}
+	}
+	sort(nontrivial_sizes.begin(), nontrivial_sizes.end(), greater<int>());
+
+	/* wires that lie on no cycle */
+	int num_acyclic_wires = 0;
+	for (int inode = 0; inode < num_nodes; inode++){
+		e_rr_type node_type = rr_node[inode].get_rr_type();
+		if ((node_type == CHANX || node_type == CHANY) && component_size[ node_component[inode] ] == 1){
+			num_acyclic_wires++;
+		}
+	}
+
+	cout << "  strongly connected components: " << num_components << " (" << nontrivial_sizes.size() << " with more than one node)" << endl;
+	if (!nontrivial_sizes.empty()){
+		cout << "    largest:";
+		for (int icomp = 0; icomp < min((int)nontrivial_sizes.size(), GRAPH_PROFILE_COMPONENTS_LISTED); icomp++){
+			cout << " " << nontrivial_sizes[icomp];
+		}
+		cout << " nodes" << endl;
+	}
+	cout << "    wires on no cycle: " << num_acyclic_wires << endl;
+
+	/* channel widths as counted by Arch_Structs::set_chanwidth */
+	print_chanwidth_stats("x-directed channel width", arch_structs->chanwidth_x);
+	print_chanwidth_stats("y-directed channel width", arch_structs->chanwidth_y);
+}
+
+/* prints the min/p50/p90/max/average of the specified degrees (which are sorted in the process) */
+static void print_degree_distribution(string name, vector<int> &degrees){
+	if (degrees.empty()){
+		return;
+	}
+
+	sort(degrees.begin(), degrees.end());
+	int num_degrees = (int)degrees.size();
+	long long sum = 0;
+	for (int ideg = 0; ideg < num_degrees; ideg++){
+		sum += degrees[ideg];
+	}
+
+	cout << "    " << name << ": min " << degrees[0] << ", p50 " << degrees[num_degrees / 2] << ", p90 " << degrees[(num_degrees * 9) / 10] <<
+	        ", max " << degrees[num_degrees-1] << ", avg " << (double)sum / (double)num_degrees << endl;
+}
+
+/* finds the strongly connected components of the routing graph. sets the component of each node and returns the number of components */
+static int find_strongly_connected_components(t_rr_node &rr_node, int num_nodes, vector<int> &node_component){
+	node_component.assign(num_nodes, UNDEFINED);
+
+	vector<int> node_index(num_nodes, UNDEFINED);	/* order in which nodes were first reached */
+	vector<int> lowlink(num_nodes, UNDEFINED);
+	vector<char> on_stack(num_nodes, 0);
+	vector<int> component_stack;
+	/* the depth-first search: a node and the next of its out-edges to be followed */
+	vector< pair<int,int> > dfs_stack;
+
+	int next_index = 0;
+	int num_components = 0;
+	for (int iroot = 0; iroot < num_nodes; iroot++){
+		if (node_index[iroot] != UNDEFINED){
+			continue;
+		}
+
+		dfs_stack.push_back( make_pair(iroot, 0) );
+		node_index[iroot] = lowlink[iroot] = next_index++;
+		component_stack.push_back(iroot);
+		on_stack[iroot] = 1;
+
+		while (!dfs_stack.empty()){
+			int node_ind = dfs_stack.back().first;
+			int iedge = dfs_stack.back().second;
+
+			if (iedge < rr_node[node_ind].get_num_out_edges()){
+				dfs_stack.back().second++;
+
+				int child_ind = rr_node[node_ind].out_edges[iedge];
+				if (node_index[child_ind] == UNDEFINED){
+					/* descend into the child */
+					node_index[child_ind] = lowlink[child_ind] = next_index++;
+					component_stack.push_back(child_ind);
+					on_stack[child_ind] = 1;
+					dfs_stack.push_back( make_pair(child_ind, 0) );
+				} else if (on_stack[child_ind]){
+					lowlink[node_ind] = min(lowlink[node_ind], node_index[child_ind]);
+				}
+				continue;
+			}
+
+			/* all children are done. a node whose lowlink is its own index is the root of a component */
+			dfs_stack.pop_back();
+			if (lowlink[node_ind] == node_index[node_ind]){
+				int member_ind;
+				do {
+					member_ind = component_stack.back();
+					component_stack.pop_back();
+					on_stack[member_ind] = 0;
+					node_component[member_ind] = num_components;
+				} while (member_ind != node_ind);
+				num_components++;
+			}
+			if (!dfs_stack.empty()){
+				int parent_ind = dfs_stack.back().first;
+				lowlink[parent_ind] = min(lowlink[parent_ind], lowlink[node_ind]);
+			}
+		}
+	}
+
+	return num_components;
+}
+
+/* prints the min/average/max of the nonzero entries of the specified channel widths */
+static void print_chanwidth_stats(string name, const t_chanwidth &chanwidth){
+	int min_width = UNDEFINED;
+	int max_width = 0;
+	long long sum = 0;
+	int num_channels = 0;
+	for (int ix = 0; ix < (int)chanwidth.size(); ix++){
+		for (int iy = 0; iy < (int)chanwidth[ix].size(); iy++){
+			int width = chanwidth[ix][iy];
+			if (width == 0){
+				continue;
+			}
+			min_width = (min_width == UNDEFINED ? width : min(min_width, width));
+			max_width = max(max_width, width);
+			sum += width;
+			num_channels++;
+		}
+	}
+
+	if (num_channels == 0){
+		cout << "  " << name << ": no channels" << endl;
+	} else {
+		cout << "  " << name << ": min " << min_width << ", avg " << (double)sum / (double)num_channels << ", max " << max_width <<
+		        " (over " << num_channels << " channel segments)" << endl;
+	}
+}
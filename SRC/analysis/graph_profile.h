@@ -0,0 +1,12 @@
+#ifndef GRAPH_PROFILE_H
+#define GRAPH_PROFILE_H
+
+#include "wotan_types.h"
+
+
+/**** Function Declarations ****/
+/* prints node and edge counts by node type, the fan-in and fan-out distributions of each node type, the strongly connected
+   components of the routing graph, and the channel widths of the architecture */
+void print_graph_profile(Arch_Structs *arch_structs, Routing_Structs *routing_structs);
+
+#endif
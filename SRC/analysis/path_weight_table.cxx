@@ -0,0 +1,126 @@
+/*
+	A table of maximum path weights per connection length, as picked by path weight calibration. The table is stored in a
+small text file together with the architecture family it was calibrated for:
+
+	# <comment>
+	family <architecture family>
+	tolerance <error tolerance>
+	length <connection length> <max path weight>
+	...
+*/
+
+#include <fstream>
+#include <sstream>
+#include <set>
+#include <algorithm>
+#include "path_weight_table.h"
+#include "exception.h"
+
+using namespace std;
+
+
+/**** Function Definitions ****/
+/* returns a string identifying the architecture family of the loaded graph: the fill block type, its pins, the channel widths,
+   switch types and wire spans. the size of the FPGA does not enter into it, so that a table calibrated on a small device can be
+   reused for larger devices of the same family */
+string get_architecture_family(Arch_Structs *arch_structs, Routing_Structs *routing_structs){
+	Physical_Type_Descriptor &fill_type = arch_structs->block_type[ arch_structs->get_fill_type_index() ];
+
+	int max_chanwidth_x = 0;
+	int max_chanwidth_y = 0;
+	for (int ix = 0; ix < (int)arch_structs->chanwidth_x.size(); ix++){
+		for (int iy = 0; iy < (int)arch_structs->chanwidth_x[ix].size(); iy++){
+			max_chanwidth_x = max(max_chanwidth_x, arch_structs->chanwidth_x[ix][iy]);
+		}
+	}
+	for (int ix = 0; ix < (int)arch_structs->chanwidth_y.size(); ix++){
+		for (int iy = 0; iy < (int)arch_structs->chanwidth_y[ix].size(); iy++){
+			max_chanwidth_y = max(max_chanwidth_y, arch_structs->chanwidth_y[ix][iy]);
+		}
+	}
+
+	/* wire spans present in the graph */
+	set<int> spans;
+	t_rr_node &rr_node = routing_structs->rr_node;
+	for (int inode = 0; inode < routing_structs->get_num_rr_nodes(); inode++){
+		e_rr_type type = rr_node[inode].get_rr_type();
+		if (type == CHANX || type == CHANY){
+			spans.insert(rr_node[inode].get_span());
+		}
+	}
+
+	stringstream family;
+	family << fill_type.get_name() << "_pins" << fill_type.get_num_pins() << "_drivers" << fill_type.get_num_drivers()
+	       << "_receivers" << fill_type.get_num_receivers() << "_chanx" << max_chanwidth_x << "_chany" << max_chanwidth_y
+	       << "_switches" << routing_structs->rr_switch_inf.size() << "_spans";
+	for (set<int>::iterator it = spans.begin(); it != spans.end(); it++){
+		family << "-" << (*it);
+	}
+	return family.str();
+}
+
+/* reads a per-length table of maximum path weights from the specified file into 'table' (UNDEFINED for lengths not in the file).
+   returns false, leaving 'table' untouched, if the file doesn't exist or was calibrated for a different architecture family */
+bool read_path_weight_table(string file_path, string architecture_family, vector<int> *table){
+	ifstream table_file(file_path.c_str());
+	if (!table_file.is_open()){
+		return false;
+	}
+
+	vector<int> read_table;
+	string family = "";
+	string line;
+	while (getline(table_file, line)){
+		if (line.empty() || line[0] == '#'){
+			continue;
+		}
+
+		stringstream line_ss(line);
+		string keyword;
+		line_ss >> keyword;
+		if (keyword == "family"){
+			line_ss >> family;
+		} else if (keyword == "tolerance"){
+			/* informational */
+		} else if (keyword == "length"){
+			int length = UNDEFINED;
+			int max_path_weight = UNDEFINED;
+			line_ss >> length >> max_path_weight;
+			if (line_ss.fail() || length < 0 || max_path_weight <= 0){
+				WTHROW(EX_INIT, "Malformed line in path weight table " << file_path << ": " << line);
+			}
+			if (length >= (int)read_table.size()){
+				read_table.resize(length+1, UNDEFINED);
+			}
+			read_table[length] = max_path_weight;
+		} else {
+			WTHROW(EX_INIT, "Unrecognized line in path weight table " << file_path << ": " << line);
+		}
+	}
+
+	if (family != architecture_family){
+		cout << "WARNING: ignoring path weight table " << file_path << " -- it was calibrated for architecture family '" << family <<
+		        "' but the current architecture family is '" << architecture_family << "'" << endl;
+		return false;
+	}
+
+	(*table) = read_table;
+	return true;
+}
+
+/* writes the specified per-length table of maximum path weights, calibrated to the specified error tolerance, to the specified file */
+void write_path_weight_table(string file_path, string architecture_family, float tolerance, const vector<int> &table){
+	ofstream table_file(file_path.c_str());
+	if (!table_file.is_open()){
+		WTHROW(EX_OTHER, "Could not open path weight table " << file_path << " for writing");
+	}
+
+	table_file << "# maximum path weight per connection length, calibrated by wotan" << endl;
+	table_file << "family " << architecture_family << endl;
+	table_file << "tolerance " << tolerance << endl;
+	for (int ilen = 0; ilen < (int)table.size(); ilen++){
+		if (table[ilen] != UNDEFINED){
+			table_file << "length " << ilen << " " << table[ilen] << endl;
+		}
+	}
+}
@@ -0,0 +1,22 @@
+#ifndef PATH_WEIGHT_TABLE_H
+#define PATH_WEIGHT_TABLE_H
+
+#include <string>
+#include <vector>
+#include "wotan_types.h"
+
+
+/**** Function Declarations ****/
+/* returns a string identifying the architecture family of the loaded graph: the fill block type, its pins, the channel widths,
+   switch types and wire spans. the size of the FPGA does not enter into it, so that a table calibrated on a small device can be
+   reused for larger devices of the same family */
+std::string get_architecture_family(Arch_Structs *arch_structs, Routing_Structs *routing_structs);
+
+/* reads a per-length table of maximum path weights from the specified file into 'table' (UNDEFINED for lengths not in the file).
+   returns false, leaving 'table' untouched, if the file doesn't exist or was calibrated for a different architecture family */
+bool read_path_weight_table(std::string file_path, std::string architecture_family, std::vector<int> *table);
+
+/* writes the specified per-length table of maximum path weights, calibrated to the specified error tolerance, to the specified file */
+void write_path_weight_table(std::string file_path, std::string architecture_family, float tolerance, const std::vector<int> &table);
+
+#endif
@@ -0,0 +1,105 @@
+/*
+	The sensitivity map: how much the routability metric would change if the demand of each node changed.
+
+	The sensitivities are computed by a reverse pass over the recorded probability analysis of each connection (see
+Propagate_Tape). They are reported as criticalities -- the negated derivative of the routability metric w.r.t. node demand --
+so that a larger value marks a node (or tile) where relieving congestion, e.g. by adding tracks or switches, would help the
+metric most. The derivatives are local: the set of worst connections that make up the metric is held fixed.
+*/
+
+#include <fstream>
+#include <algorithm>
+#include <utility>
+#include <functional>
+#include "sensitivity_map.h"
+#include "exception.h"
+#include "wotan_util.h"
+
+using namespace std;
+
+
+/**** Function Definitions ****/
+/* writes the criticality (the negated derivative of the routability metric w.r.t. node demand) of every node with a nonzero
+   sensitivity to the file specified by the user, followed by the criticality of each tile. a node's criticality is split evenly
+   between the tiles that it spans. the most critical tiles are also printed */
+void write_sensitivity_map(User_Options *user_opts, Arch_Structs *arch_structs, Routing_Structs *routing_structs,
+			const vector<double> &node_sensitivity){
+
+	t_rr_node &rr_node = routing_structs->rr_node;
+	int num_nodes = routing_structs->get_num_rr_nodes();
+	if ((int)node_sensitivity.size() != num_nodes){
+		WTHROW(EX_PATH_ENUM, "Expected a sensitivity for each of the " << num_nodes << " rr nodes. Got " << node_sensitivity.size());
+	}
+
+	int grid_size_x, grid_size_y;
+	arch_structs->get_grid_size(&grid_size_x, &grid_size_y);
+	vector< vector<double> > tile_criticality(grid_size_x, vector<double>(grid_size_y, 0.0));
+
+	ofstream map_file(user_opts->sensitivity_map_file.c_str());
+	if (!map_file.is_open()){
+		WTHROW(EX_OTHER, "Could not open sensitivity map file " << user_opts->sensitivity_map_file << " for writing");
+	}
+	map_file.precision(8);
+
+	int num_critical_nodes = 0;
+	for (int inode = 0; inode < num_nodes; inode++){
+		if (node_sensitivity[inode] != 0){
+			num_critical_nodes++;
+		}
+	}
+
+	map_file << "# criticality = -d(routability metric)/d(node demand) at demand multiplier " << user_opts->demand_multiplier << endl;
+	map_file << "# node <node index> <type> <xlow> <ylow> <xhigh> <yhigh> <criticality>" << endl;
+	map_file << "nodes " << num_critical_nodes << endl;
+
+	double total_criticality = 0;
+	for (int inode = 0; inode < num_nodes; inode++){
+		if (node_sensitivity[inode] == 0){
+			continue;
+		}
+		RR_Node &node = rr_node[inode];
+		double criticality = -node_sensitivity[inode];
+		total_criticality += criticality;
+
+		map_file << "node " << inode << " " << node.get_rr_type_string() << " " << node.get_xlow() << " " << node.get_ylow() << " "
+		         << node.get_xhigh() << " " << node.get_yhigh() << " " << criticality << endl;
+
+		/* split the node's criticality between the tiles it spans */
+		int num_tiles = (node.get_xhigh() - node.get_xlow() + 1) * (node.get_yhigh() - node.get_ylow() + 1);
+		for (int ix = node.get_xlow(); ix <= node.get_xhigh(); ix++){
+			for (int iy = node.get_ylow(); iy <= node.get_yhigh(); iy++){
+				if (ix >= 0 && ix < grid_size_x && iy >= 0 && iy < grid_size_y){
+					tile_criticality[ix][iy] += criticality / (double)num_tiles;
+				}
+			}
+		}
+	}
+
+	map_file << "# tile <x> <y> <criticality>" << endl;
+	map_file << "tiles " << grid_size_x * grid_size_y << endl;
+	vector< pair<double, Coordinate> > critical_tiles;
+	for (int ix = 0; ix < grid_size_x; ix++){
+		for (int iy = 0; iy < grid_size_y; iy++){
+			map_file << "tile " << ix << " " << iy << " " << tile_criticality[ix][iy] << endl;
+			if (tile_criticality[ix][iy] > 0){
+				critical_tiles.push_back( make_pair(tile_criticality[ix][iy], Coordinate(ix, iy)) );
+			}
+		}
+	}
+
+	if (map_file.fail()){
+		WTHROW(EX_OTHER, "Failed writing sensitivity map file " << user_opts->sensitivity_map_file);
+	}
+	map_file.close();
+
+	/* print the most critical tiles (ties broken by tile coordinates) */
+	sort(critical_tiles.begin(), critical_tiles.end(), greater< pair<double, Coordinate> >());
+
+	cout << "Sensitivity map written to " << user_opts->sensitivity_map_file << " (" << num_critical_nodes << " nodes)" << endl;
+	cout << "Total node criticality: " << total_criticality << endl;
+	cout << "Most critical tiles:" << endl;
+	for (int itile = 0; itile < min(NUM_CRITICAL_TILES_PRINTED, (int)critical_tiles.size()); itile++){
+		cout << "  (" << critical_tiles[itile].second.x << "," << critical_tiles[itile].second.y << "): " << critical_tiles[itile].first << endl;
+	}
+	cout << endl;
+}
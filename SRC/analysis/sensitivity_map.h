@@ -0,0 +1,20 @@
+#ifndef SENSITIVITY_MAP_H
+#define SENSITIVITY_MAP_H
+
+#include <vector>
+#include "wotan_types.h"
+
+
+/**** Defines ****/
+/* number of most critical tiles printed after the sensitivity map is written */
+#define NUM_CRITICAL_TILES_PRINTED 10
+
+
+/**** Function Declarations ****/
+/* writes the criticality (the negated derivative of the routability metric w.r.t. node demand) of every node with a nonzero
+   sensitivity to the file specified by the user, followed by the criticality of each tile. a node's criticality is split evenly
+   between the tiles that it spans. the most critical tiles are also printed */
+void write_sensitivity_map(User_Options *user_opts, Arch_Structs *arch_structs, Routing_Structs *routing_structs,
+			const std::vector<double> &node_sensitivity);
+
+#endif
@@ -0,0 +1,391 @@
+/*
+	Two-stage importance sampling of the connections analyzed during probability analysis.
+
+	The routability metric sums the probabilities of the worst connections at each length (a fixed number K of worst-connection
+queue entries per length), normalized by the sum of the scaling factors of all connections. With a uniform sample of the plan,
+most evaluations go to connections that never make it into that tail.
+
+	The planned connections are split into strata of structurally similar connections. The pilot stage evaluates every
+connection with probability f. From the pilot outcomes, the cutoff below which a queue entry belongs to the tail is estimated
+at each length, and with it the fraction t_s of each stratum's pilot connections that fall into the tail (shrunk towards the
+fraction of the whole length, since many strata only have a handful of pilot connections). The focused stage then evaluates
+every connection that the pilot left out with probability q_s = min(1, lambda * t_s), with lambda picked so that the expected
+number of evaluations over both stages matches the budget. A connection is therefore evaluated with probability
+pi = f + (1-f) q_s. Connections whose sink is out of reach (see Reach_Labels) cost nothing and are always evaluated.
+
+	An evaluated connection stands for 1/pi connections of the plan. The tail sum at each length is estimated by sorting the
+evaluated connections by their queue value and accumulating their weighted queue entries up to K. The normalization of the
+metric doesn't need to be estimated: it only depends on each connection's scaling factor, which the pilot pass accounts for
+without searching. The variance of the tail sums is estimated with the Horvitz-Thompson variance estimator for Poisson sampling,
+applied to the linearized tail sum: a connection in the tail with queue value v and m entries contributes m*(v - cutoff) (the
+cutoff absorbs the fixed number of entries). Since the focused rates depend on the pilot outcomes, the estimates are unbiased
+given the chosen rates rather than exactly unbiased overall.
+*/
+
+#include <cmath>
+#include <map>
+#include <algorithm>
+#include "tail_sampling.h"
+#include "exception.h"
+
+using namespace std;
+
+
+/**** Function Declarations ****/
+/* returns a pseudo-random number in [0,1) that only depends on the seed, the connection and the stage (so that the sample doesn't
+   depend on the order in which threads analyze connections) */
+static double get_conn_random(unsigned int seed, int conn_ind, int stage_ind);
+/* returns the index of the stratum with the specified key, adding a new stratum if there is none */
+static int get_stratum_ind(map<long long, int> &strata, long long key);
+
+
+
+/**** Function Definitions ****/
+/*==== Tail_Estimate Class ====*/
+Tail_Estimate::Tail_Estimate(){
+	this->total_tail_sum = 0;
+	this->total_variance = 0;
+}
+
+
+/*==== Tail_Sampler Class ====*/
+Tail_Sampler::Tail_Sampler(){
+	this->clear();
+}
+
+/* forgets everything */
+void Tail_Sampler::clear(){
+	this->num_eligible = 0;
+	this->budget = 1.0;
+	this->pilot_rate = 1.0;
+	this->current_stage = TAIL_STAGE_NONE;
+
+	this->eligible.clear();
+	this->out_of_reach.clear();
+	this->stage.clear();
+	this->stratum.clear();
+	this->pin_type.clear();
+	this->length.clear();
+	this->inclusion_prob.clear();
+	this->evaluated.clear();
+	this->push_value.clear();
+	this->num_pushes.clear();
+	this->entries_limit[DRIVER].clear();
+	this->entries_limit[RECEIVER].clear();
+}
+
+/* assigns the connections of the plan to strata and picks the ones that are evaluated during the pilot stage. 'budget' is the
+   fraction of the connections to be evaluated over both stages */
+void Tail_Sampler::init(User_Options *user_opts, Analysis_Settings *analysis_settings, Arch_Structs *arch_structs, Routing_Structs *routing_structs,
+                        const Connection_Plan &connection_plan, double set_budget){
+	this->clear();
+
+	t_rr_node &rr_node = routing_structs->rr_node;
+	int num_conns = (int)connection_plan.conns.size();
+	int grid_size_x, grid_size_y;
+	arch_structs->get_grid_size(&grid_size_x, &grid_size_y);
+
+	this->budget = set_budget;
+	this->pilot_rate = (set_budget >= 1.0 ? 1.0 : set_budget * TAIL_SAMPLING_PILOT_SHARE);
+	this->current_stage = TAIL_STAGE_PILOT;
+
+	this->eligible.assign(num_conns, 0);
+	this->out_of_reach.assign(num_conns, 0);
+	this->stage.assign(num_conns, TAIL_STAGE_NONE);
+	this->stratum.assign(num_conns, UNDEFINED);
+	this->pin_type.assign(num_conns, OPEN);
+	this->length.assign(num_conns, 0);
+	this->inclusion_prob.assign(num_conns, 0.0F);
+	this->evaluated.assign(num_conns, 0);
+	this->push_value.assign(num_conns, 0.0F);
+	this->num_pushes.assign(num_conns, 0);
+	this->entries_limit[DRIVER].assign(connection_plan.max_conn_length+1, UNDEFINED);
+	this->entries_limit[RECEIVER].assign(connection_plan.max_conn_length+1, UNDEFINED);
+
+	map<long long, int> strata;
+	for (int isource = 0; isource < (int)connection_plan.sources.size(); isource++){
+		const Planned_Source &planned_source = connection_plan.sources[isource];
+		if (!connection_plan.tile_in_prob_region[planned_source.tile_ind]){
+			continue;
+		}
+
+		Coordinate tile_coord = connection_plan.tiles[planned_source.tile_ind];
+		int edge_dist = min( min(tile_coord.x - 1, tile_coord.y - 1), min(grid_size_x - 2 - tile_coord.x, grid_size_y - 2 - tile_coord.y) );
+		int source_class = rr_node[planned_source.source_ind].get_ptc_num();
+
+		for (int iconn = planned_source.first_conn; iconn < planned_source.first_conn + planned_source.num_conns; iconn++){
+			const Planned_Connection &conn = connection_plan.conns[iconn];
+			if (PROBS_EQUAL(analysis_settings->length_probabilities[conn.length], 0.0)){
+				continue;
+			}
+
+			RR_Node &sink_node = rr_node[conn.sink_ind];
+			int dx = sink_node.get_xlow() - tile_coord.x;
+			int dy = sink_node.get_ylow() - tile_coord.y;
+			bool near_edge = (edge_dist < conn.length);
+
+			long long key = planned_source.pin_type;
+			key = key*256 + conn.length;
+			key = key*1024 + source_class;
+			key = key*1024 + sink_node.get_ptc_num();
+			key = key*256 + (dx + 128);
+			key = key*256 + (dy + 128);
+			key = key*2 + (near_edge ? 1 : 0);
+
+			this->eligible[iconn] = 1;
+			this->out_of_reach[iconn] = (conn.min_weight != UNDEFINED && conn.min_weight > analysis_settings->get_max_path_weight(conn.length));
+			this->stratum[iconn] = get_stratum_ind(strata, key);
+			this->pin_type[iconn] = planned_source.pin_type;
+			this->length[iconn] = conn.length;
+			this->num_eligible++;
+
+			/* the pilot is a uniform sample. connections that are out of reach cost nothing and are always evaluated */
+			if (this->out_of_reach[iconn]){
+				this->stage[iconn] = TAIL_STAGE_PILOT;
+				this->inclusion_prob[iconn] = 1.0F;
+			} else if (get_conn_random(user_opts->seed, iconn, TAIL_STAGE_PILOT) < this->pilot_rate){
+				this->stage[iconn] = TAIL_STAGE_PILOT;
+				this->inclusion_prob[iconn] = (float)this->pilot_rate;
+			} else {
+				this->inclusion_prob[iconn] = (float)this->pilot_rate;
+			}
+		}
+	}
+}
+
+/* sets the number of entries of the worst-connection queue of the specified kind of source at each length */
+void Tail_Sampler::set_entries_limit(e_pin_type source_pin_type, const vector<int> &limits){
+	this->entries_limit[source_pin_type] = limits;
+}
+
+/* returns whether the specified planned connection is to be evaluated during the current stage */
+bool Tail_Sampler::evaluate_now(int conn_ind) const{
+	return this->stage[conn_ind] == this->current_stage;
+}
+
+/* records the outcome of an evaluated connection. different connections can be recorded concurrently */
+void Tail_Sampler::record(int conn_ind, float set_push_value, int set_num_pushes){
+	this->evaluated[conn_ind] = 1;
+	this->push_value[conn_ind] = set_push_value;
+	this->num_pushes[conn_ind] = set_num_pushes;
+}
+
+/* uses the pilot outcomes to pick the connections that are evaluated during the focused stage, and makes that the current stage */
+void Tail_Sampler::plan_focused_stage(unsigned int seed){
+	int num_conns = (int)this->stage.size();
+	int num_lengths = (int)this->entries_limit[DRIVER].size();
+	int num_strata = 0;
+	for (int iconn = 0; iconn < num_conns; iconn++){
+		num_strata = max(num_strata, this->stratum[iconn]+1);
+	}
+
+	/* the pilot's estimate of the tail cutoff at each length, for drivers and fanout */
+	vector<float> cutoff[2];
+	for (int itype = DRIVER; itype <= RECEIVER; itype++){
+		Tail_Estimate pilot_estimate = this->estimate((e_pin_type)itype);
+		cutoff[itype] = pilot_estimate.cutoff;
+	}
+
+	/* pilot connections of each stratum and how many of them fell into the tail */
+	vector<double> stratum_pilot(num_strata, 0.0);
+	vector<double> stratum_hits(num_strata, 0.0);
+	vector<double> length_pilot[2];
+	vector<double> length_hits[2];
+	for (int itype = DRIVER; itype <= RECEIVER; itype++){
+		length_pilot[itype].assign(num_lengths, 0.0);
+		length_hits[itype].assign(num_lengths, 0.0);
+	}
+	vector<int> stratum_type(num_strata, DRIVER);
+	vector<int> stratum_length(num_strata, 0);
+	int num_pilot_evaluated = 0;
+	for (int iconn = 0; iconn < num_conns; iconn++){
+		if (!this->eligible[iconn]){
+			continue;
+		}
+		int istratum = this->stratum[iconn];
+		int itype = this->pin_type[iconn];
+		int ilen = this->length[iconn];
+		stratum_type[istratum] = itype;
+		stratum_length[istratum] = ilen;
+		if (!this->evaluated[iconn]){
+			continue;
+		}
+
+		num_pilot_evaluated++;
+		bool in_tail = (cutoff[itype][ilen] != UNDEFINED && this->push_value[iconn] <= cutoff[itype][ilen]);
+		stratum_pilot[istratum] += 1.0;
+		length_pilot[itype][ilen] += 1.0;
+		if (in_tail){
+			stratum_hits[istratum] += 1.0;
+			length_hits[itype][ilen] += 1.0;
+		}
+	}
+
+	/* fraction of each stratum that is expected to fall into the tail */
+	vector<double> tail_fraction(num_strata, 0.0);
+	for (int istratum = 0; istratum < num_strata; istratum++){
+		int itype = stratum_type[istratum];
+		int ilen = stratum_length[istratum];
+		double length_fraction = (length_pilot[itype][ilen] > 0 ? length_hits[itype][ilen] / length_pilot[itype][ilen] : 1.0);
+		tail_fraction[istratum] = (stratum_hits[istratum] + TAIL_SAMPLING_PRIOR_CONNS * length_fraction) /
+		                          (stratum_pilot[istratum] + TAIL_SAMPLING_PRIOR_CONNS);
+	}
+
+	/* connections left out by the pilot are evaluated with probability min(1, lambda * tail fraction). find the lambda that spends
+	   the rest of the budget */
+	vector<int> stratum_candidates(num_strata, 0);
+	int num_candidates = 0;
+	for (int iconn = 0; iconn < num_conns; iconn++){
+		if (this->eligible[iconn] && this->stage[iconn] == TAIL_STAGE_NONE){
+			stratum_candidates[ this->stratum[iconn] ]++;
+			num_candidates++;
+		}
+	}
+	double remaining_budget = max(0.0, this->budget * this->num_eligible - num_pilot_evaluated);
+
+	double lambda_low = 0;
+	double lambda_high = 1;
+	for (int iter = 0; iter < 64; iter++){
+		double expected = 0;
+		for (int istratum = 0; istratum < num_strata; istratum++){
+			expected += stratum_candidates[istratum] * min(1.0, lambda_high * tail_fraction[istratum]);
+		}
+		if (expected >= remaining_budget || expected >= num_candidates){
+			break;
+		}
+		lambda_high *= 2;
+	}
+	for (int iter = 0; iter < 64; iter++){
+		double lambda = 0.5 * (lambda_low + lambda_high);
+		double expected = 0;
+		for (int istratum = 0; istratum < num_strata; istratum++){
+			expected += stratum_candidates[istratum] * min(1.0, lambda * tail_fraction[istratum]);
+		}
+		if (expected > remaining_budget){
+			lambda_high = lambda;
+		} else {
+			lambda_low = lambda;
+		}
+	}
+	vector<double> focused_rate(num_strata, 0.0);
+	for (int istratum = 0; istratum < num_strata; istratum++){
+		focused_rate[istratum] = min(1.0, lambda_low * tail_fraction[istratum]);
+	}
+
+	/* pick the focused connections. every connection that could have been picked in either stage has the same inclusion probability */
+	int num_focused = 0;
+	for (int iconn = 0; iconn < num_conns; iconn++){
+		if (!this->eligible[iconn] || this->out_of_reach[iconn]){
+			continue;
+		}
+		double rate = focused_rate[ this->stratum[iconn] ];
+		this->inclusion_prob[iconn] = (float)(this->pilot_rate + (1.0 - this->pilot_rate) * rate);
+		if (this->stage[iconn] == TAIL_STAGE_NONE && get_conn_random(seed, iconn, TAIL_STAGE_FOCUSED) < rate){
+			this->stage[iconn] = TAIL_STAGE_FOCUSED;
+			num_focused++;
+		}
+	}
+	this->current_stage = TAIL_STAGE_FOCUSED;
+
+	cout << "Tail sampling: pilot evaluated " << num_pilot_evaluated << " of " << this->num_eligible << " connections (" << num_strata <<
+	        " strata); focused stage evaluates " << num_focused << " more" << endl;
+}
+
+/* estimates the tail sums of the specified kind of source */
+Tail_Estimate Tail_Sampler::estimate(e_pin_type source_pin_type) const{
+	int num_conns = (int)this->stage.size();
+	int num_lengths = (int)this->entries_limit[source_pin_type].size();
+
+	Tail_Estimate result;
+	result.tail_sum.assign(num_lengths, 0.0);
+	result.tail_sum_variance.assign(num_lengths, 0.0);
+	result.cutoff.assign(num_lengths, UNDEFINED);
+	result.num_evaluated.assign(num_lengths, 0);
+	result.num_conns.assign(num_lengths, 0);
+
+	/* evaluated connections at each length, sorted by their queue value */
+	vector< vector< pair<float,int> > > length_conns(num_lengths);
+	for (int iconn = 0; iconn < num_conns; iconn++){
+		if (!this->eligible[iconn] || this->pin_type[iconn] != source_pin_type){
+			continue;
+		}
+		result.num_conns[ this->length[iconn] ]++;
+		if (this->evaluated[iconn]){
+			length_conns[ this->length[iconn] ].push_back( make_pair(this->push_value[iconn], iconn) );
+		}
+	}
+
+	for (int ilen = 0; ilen < num_lengths; ilen++){
+		vector< pair<float,int> > &conns = length_conns[ilen];
+		result.num_evaluated[ilen] = (int)conns.size();
+		double limit = this->entries_limit[source_pin_type][ilen];
+		if (conns.empty() || limit <= 0){
+			continue;
+		}
+		sort(conns.begin(), conns.end());
+
+		/* accumulate weighted queue entries up to the limit */
+		double num_entries = 0;
+		double tail_sum = 0;
+		bool limit_reached = false;
+		for (int ientry = 0; ientry < (int)conns.size() && !limit_reached; ientry++){
+			int iconn = conns[ientry].second;
+			double weighted_entries = this->num_pushes[iconn] / (double)this->inclusion_prob[iconn];
+			double entries_taken = min(weighted_entries, limit - num_entries);
+			tail_sum += entries_taken * conns[ientry].first;
+			num_entries += entries_taken;
+			result.cutoff[ilen] = conns[ientry].first;
+			limit_reached = (num_entries >= limit);
+		}
+		result.tail_sum[ilen] = tail_sum;
+		result.total_tail_sum += tail_sum;
+
+		/* connections are sampled independently, so the variance is a sum over the linearized contributions of the sample */
+		for (int ientry = 0; ientry < (int)conns.size(); ientry++){
+			int iconn = conns[ientry].second;
+			double value = conns[ientry].first;
+			if (value > result.cutoff[ilen]){
+				break;
+			}
+			double contribution = this->num_pushes[iconn] * (limit_reached ? value - result.cutoff[ilen] : value);
+			double prob = this->inclusion_prob[iconn];
+			result.tail_sum_variance[ilen] += (1.0 - prob) / (prob*prob) * contribution*contribution;
+		}
+		result.total_variance += result.tail_sum_variance[ilen];
+	}
+
+	return result;
+}
+
+/* returns the number of connections evaluated over both stages */
+int Tail_Sampler::get_num_evaluated() const{
+	int num_evaluated = 0;
+	for (int iconn = 0; iconn < (int)this->evaluated.size(); iconn++){
+		num_evaluated += this->evaluated[iconn];
+	}
+	return num_evaluated;
+}
+
+
+/* returns a pseudo-random number in [0,1) that only depends on the seed, the connection and the stage (so that the sample doesn't
+   depend on the order in which threads analyze connections) */
+static double get_conn_random(unsigned int seed, int conn_ind, int stage_ind){
+	/* splitmix64 over the combined inputs */
+	unsigned long long z = ((unsigned long long)seed << 32) ^ ((unsigned long long)conn_ind << 2) ^ (unsigned long long)stage_ind;
+	z += 0x9e3779b97f4a7c15ULL;
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	z = z ^ (z >> 31);
+	return (double)(z >> 11) / (double)(1ULL << 53);
+}
+
+/* returns the index of the stratum with the specified key, adding a new stratum if there is none */
+static int get_stratum_ind(map<long long, int> &strata, long long key){
+	map<long long, int>::iterator it = strata.find(key);
+	if (it != strata.end()){
+		return it->second;
+	}
+	int stratum_ind = (int)strata.size();
+	strata[key] = stratum_ind;
+	return stratum_ind;
+}
@@ -0,0 +1,98 @@
+#ifndef TAIL_SAMPLING_H
+#define TAIL_SAMPLING_H
+
+#include <vector>
+#include "wotan_types.h"
+#include "connection_plan.h"
+
+
+/**** Defines ****/
+/* share of the tail sampling budget that is spent on the uniform pilot stage */
+#define TAIL_SAMPLING_PILOT_SHARE 0.4
+
+/* weight (in pilot connections) given to the tail fraction of a connection's length when estimating the tail fraction of its stratum */
+#define TAIL_SAMPLING_PRIOR_CONNS 2.0
+
+
+/**** Enums ****/
+/* the stage of tail sampling in which a planned connection is evaluated */
+enum e_tail_stage{
+	TAIL_STAGE_NONE = 0,	/* not evaluated */
+	TAIL_STAGE_PILOT,	/* evaluated during the uniform pilot stage */
+	TAIL_STAGE_FOCUSED	/* evaluated during the second stage, which oversamples the strata that the pilot found in the tail */
+};
+
+
+/**** Classes ****/
+/* the estimated sum of the worst connection probabilities at each length, for one kind of source (drivers or fanout) */
+class Tail_Estimate{
+public:
+	std::vector<double> tail_sum;		/* [0..max_conn_length] estimated sum of the worst push values at each length */
+	std::vector<double> tail_sum_variance;	/* [0..max_conn_length] estimated variance of the above */
+	std::vector<float> cutoff;		/* [0..max_conn_length] largest push value counted into the tail sum (UNDEFINED if none) */
+	std::vector<int> num_evaluated;		/* [0..max_conn_length] number of connections evaluated at each length */
+	std::vector<int> num_conns;		/* [0..max_conn_length] number of connections at each length */
+	double total_tail_sum;			/* estimated sum of the tails over all lengths */
+	double total_variance;			/* estimated variance of the above */
+
+	Tail_Estimate();
+};
+
+/* Two-stage importance sampling of the connections analyzed during probability analysis. The routability metric only looks at
+   the worst connections at each length, so most evaluations of a uniform sample are spent on connections that never make it
+   into the metric. A uniform pilot stage first evaluates a fraction of the planned connections. Connections are grouped into
+   strata of structurally similar connections (pin type, length, source and sink pin classes, tile offset, and whether the source
+   tile is within a connection length of the FPGA perimeter), and the pilot gives the fraction of each stratum that falls into the
+   tail. A focused stage then samples the remaining connections of each stratum in proportion to that fraction. Every evaluated
+   connection is weighted by the inverse of its probability of having been evaluated (see tail_sampling.cxx) */
+class Tail_Sampler{
+public:
+	int num_eligible;			/* number of planned connections that take part in probability analysis */
+	double budget;				/* fraction of the eligible connections to be evaluated (in expectation) */
+	double pilot_rate;			/* probability of a connection being evaluated during the pilot stage */
+	e_tail_stage current_stage;		/* connections of this stage are the ones evaluated by the current pass over the plan */
+
+	/* [0..num_planned_conns-1] */
+	std::vector<char> eligible;		/* whether the connection takes part in probability analysis */
+	std::vector<char> out_of_reach;		/* whether the connection's search is skipped anyway (always evaluated) */
+	std::vector<char> stage;		/* e_tail_stage in which the connection is evaluated */
+	std::vector<int> stratum;		/* stratum of the connection */
+	std::vector<char> pin_type;		/* e_pin_type of the connection's source */
+	std::vector<short> length;
+	std::vector<float> inclusion_prob;	/* probability of the connection being evaluated in either stage */
+	/* outcomes of evaluated connections */
+	std::vector<char> evaluated;
+	std::vector<float> push_value;		/* the value that would have been pushed onto the worst-connection queue */
+	std::vector<int> num_pushes;		/* how many times it would have been pushed */
+
+	/* [DRIVER/RECEIVER][0..max_conn_length] number of entries of the worst-connection queues */
+	std::vector<int> entries_limit[2];
+
+	Tail_Sampler();
+
+	/* assigns the connections of the plan to strata and picks the ones that are evaluated during the pilot stage. 'budget' is the
+	   fraction of the connections to be evaluated over both stages */
+	void init(User_Options *user_opts, Analysis_Settings *analysis_settings, Arch_Structs *arch_structs, Routing_Structs *routing_structs,
+	          const Connection_Plan &connection_plan, double set_budget);
+	/* sets the number of entries of the worst-connection queue of the specified kind of source at each length */
+	void set_entries_limit(e_pin_type source_pin_type, const std::vector<int> &limits);
+
+	/* returns whether the specified planned connection is to be evaluated during the current stage */
+	bool evaluate_now(int conn_ind) const;
+	/* records the outcome of an evaluated connection. different connections can be recorded concurrently */
+	void record(int conn_ind, float set_push_value, int set_num_pushes);
+
+	/* uses the pilot outcomes to pick the connections that are evaluated during the focused stage, and makes that the current stage */
+	void plan_focused_stage(unsigned int seed);
+
+	/* estimates the tail sums of the specified kind of source */
+	Tail_Estimate estimate(e_pin_type source_pin_type) const;
+
+	/* returns the number of connections evaluated over both stages */
+	int get_num_evaluated() const;
+	/* forgets everything */
+	void clear();
+};
+
+
+#endif
@@ -16,17 +16,22 @@ using namespace std;
 typedef set< Node_Waiting > t_nodes_waiting;
 
 
+/**** Globals ****/
+/* number of nodes popped by the topological traversals of each thread. used to profile the cost of analyzed connections */
+static thread_local long long f_thread_traversal_pops = 0;
+
+
 /**** Function Declarations ****/
 /* Used during topological traversal. Selectively puts the nodes specified in edge_list onto queue.
    Manages the sorted nodes_waiting structure which is used to deal with cycles during topological traversal.
    usr_exec_child_iterated -- executed after it is verified that a given child is legal (can be NULL) */
-static void put_children_on_queue_and_update_structs(int *edge_list, int num_nodes, int parent_ind, t_rr_node &rr_node, t_ss_distances &ss_distances,
+static void put_children_on_queue_and_update_structs(int *edge_list, int num_nodes, int parent_ind, t_rr_node &rr_node, const Node_Values &node_values, t_ss_distances &ss_distances,
 					t_node_topo_inf &node_topo_inf, queue<int> &Q, t_nodes_waiting &nodes_waiting, e_traversal_dir traversal_dir,
 					int max_path_weight, int from_node_ind, int to_node_ind, User_Options *user_opts, void *user_data,
 					t_usr_child_iterated_func usr_exec_child_iterated);
 /* puts specified child node onto the sorted 'nodes_waiting' structure. this structure is sorted by a path weight 
    (which will be determined in this function), and the child's node index serving as a tie breaker */
-static void put_child_onto_nodes_waiting_structure(int child_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, 
+static void put_child_onto_nodes_waiting_structure(int child_ind, t_rr_node &rr_node, const Node_Values &node_values, t_ss_distances &ss_distances, 
 			t_node_topo_inf &node_topo_inf, e_traversal_dir traversal_dir, t_nodes_waiting &nodes_waiting);
 
 
@@ -40,7 +45,7 @@ static void put_child_onto_nodes_waiting_structure(int child_ind, t_rr_node &rr_
 
    All passed-in function pointers can be NULL
 */
-void do_topological_traversal(int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
+void do_topological_traversal(int from_node_ind, int to_node_ind, t_rr_node &rr_node, const Node_Values &node_values, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
 			e_traversal_dir traversal_dir, int max_path_weight, User_Options *user_opts, void *user_data,
 			t_usr_node_popped_func usr_exec_node_popped,
 			t_usr_child_iterated_func usr_exec_child_iterated,
@@ -74,6 +79,7 @@ void do_topological_traversal(int from_node_ind, int to_node_ind, t_rr_node &rr_
 	}
 
 	/* now use queue to traverse the graph */
+	int num_popped = 0;
 	while ( !Q.empty() ){
 		int node_ind;
 		int *edge_list;
@@ -81,6 +87,7 @@ void do_topological_traversal(int from_node_ind, int to_node_ind, t_rr_node &rr_
 
 		node_ind = Q.front();
 		Q.pop();
+		num_popped++;
 
 		/* get edges along which to expand */
 		if (traversal_dir == FORWARD_TRAVERSAL){
@@ -94,11 +101,11 @@ void do_topological_traversal(int from_node_ind, int to_node_ind, t_rr_node &rr_
 
 		/* EXECUTE USER-DEFINED FUNCTION */
 		if (usr_exec_node_popped != NULL){
-			usr_exec_node_popped(node_ind, from_node_ind, to_node_ind, rr_node, ss_distances, node_topo_inf, traversal_dir, max_path_weight, user_opts, user_data);
+			usr_exec_node_popped(node_ind, from_node_ind, to_node_ind, rr_node, node_values, ss_distances, node_topo_inf, traversal_dir, max_path_weight, user_opts, user_data);
 		}
 
 		/* put children onto queue or nodes_waiting structure */
-		put_children_on_queue_and_update_structs(edge_list, num_edges, node_ind, rr_node, ss_distances, node_topo_inf,
+		put_children_on_queue_and_update_structs(edge_list, num_edges, node_ind, rr_node, node_values, ss_distances, node_topo_inf,
 						Q, nodes_waiting, traversal_dir, max_path_weight, from_node_ind, to_node_ind,
 						user_opts, user_data, usr_exec_child_iterated);
 
@@ -124,18 +131,26 @@ void do_topological_traversal(int from_node_ind, int to_node_ind, t_rr_node &rr_
 		}
 	}
 
+	f_thread_traversal_pops += num_popped;
+
 	/* EXECUTE USER-DEFINED FUNCTION */
 	if (usr_exec_traversal_done != NULL){
-		usr_exec_traversal_done(from_node_ind, to_node_ind, rr_node, ss_distances, node_topo_inf, traversal_dir, max_path_weight, user_opts, user_data);
+		usr_exec_traversal_done(from_node_ind, to_node_ind, rr_node, node_values, ss_distances, node_topo_inf, traversal_dir, max_path_weight, user_opts, user_data);
 	}
 }
 
 
+/* returns the total number of nodes that the calling thread has popped off the expansion queues of topological traversals */
+long long get_thread_traversal_pops(){
+	return f_thread_traversal_pops;
+}
+
+
 /* Used during topological traversal. Selectively puts the nodes specified in edge_list onto queue.
    Manages the sorted nodes_waiting structure which is used to deal with cycles during topological traversal.
 
    usr_exec_child_iterated -- executed after it is verified that a given child is legal (can be NULL) */
-static void put_children_on_queue_and_update_structs(int *edge_list, int num_nodes, int parent_ind, t_rr_node &rr_node, t_ss_distances &ss_distances,
+static void put_children_on_queue_and_update_structs(int *edge_list, int num_nodes, int parent_ind, t_rr_node &rr_node, const Node_Values &node_values, t_ss_distances &ss_distances,
 					t_node_topo_inf &node_topo_inf, queue<int> &Q, t_nodes_waiting &nodes_waiting, e_traversal_dir traversal_dir,
 					int max_path_weight, int from_node_ind, int to_node_ind, User_Options *user_opts, void *user_data,
 					t_usr_child_iterated_func usr_exec_child_iterated){
@@ -156,7 +171,7 @@ static void put_children_on_queue_and_update_structs(int *edge_list, int num_nod
 		}
 
 		/* skip nodes which cannot carry a legal path from source to sink */
-		if ( !ss_distances[node_ind].is_legal(rr_node[node_ind].get_weight(), max_path_weight) ){
+		if ( !ss_distances[node_ind].is_legal(node_values.weight[node_ind], max_path_weight) ){
 			continue;	
 		}
 
@@ -164,7 +179,7 @@ static void put_children_on_queue_and_update_structs(int *edge_list, int num_nod
 		/* EXECUTE USER-DEFINED FUNCTION */
 		bool ignore_node = false;
 		if (usr_exec_child_iterated != NULL){
-			ignore_node = usr_exec_child_iterated(parent_ind, inode, node_ind, rr_node, ss_distances, node_topo_inf, traversal_dir, 
+			ignore_node = usr_exec_child_iterated(parent_ind, inode, node_ind, rr_node, node_values, ss_distances, node_topo_inf, traversal_dir, 
 			                                     max_path_weight, from_node_ind, to_node_ind, user_opts, user_data);
 		}
 		if (ignore_node){
@@ -182,11 +197,11 @@ static void put_children_on_queue_and_update_structs(int *edge_list, int num_nod
 		if (traversal_dir == FORWARD_TRAVERSAL){
 			node_topo_inf[node_ind].increment_times_visited_from_source();
 			num_times_visited = node_topo_inf[node_ind].get_times_visited_from_source();
-			num_node_legal_parents = node_topo_inf[node_ind].set_and_or_get_num_legal_in_nodes(node_ind, rr_node, ss_distances, max_path_weight);
+			num_node_legal_parents = node_topo_inf[node_ind].set_and_or_get_num_legal_in_nodes(node_ind, rr_node, node_values, ss_distances, max_path_weight);
 		} else {
 			node_topo_inf[node_ind].increment_times_visited_from_sink();
 			num_times_visited = node_topo_inf[node_ind].get_times_visited_from_sink();
-			num_node_legal_parents = node_topo_inf[node_ind].set_and_or_get_num_legal_out_nodes(node_ind, rr_node, ss_distances, max_path_weight);
+			num_node_legal_parents = node_topo_inf[node_ind].set_and_or_get_num_legal_out_nodes(node_ind, rr_node, node_values, ss_distances, max_path_weight);
 		}
 
 		/* if this node is the destination node */
@@ -200,7 +215,7 @@ static void put_children_on_queue_and_update_structs(int *edge_list, int num_nod
 
 		if (num_times_visited == 1 && remaining_dependencies > 0){
 			/* visiting this node for the first time and it still has unmet dependencies -- push onto nodes_waiting structure */
-			put_child_onto_nodes_waiting_structure(node_ind, rr_node, ss_distances, node_topo_inf, traversal_dir, 
+			put_child_onto_nodes_waiting_structure(node_ind, rr_node, node_values, ss_distances, node_topo_inf, traversal_dir, 
 			                                       nodes_waiting);
 
 		} else if (num_times_visited == 1 && remaining_dependencies == 0){
@@ -235,7 +250,7 @@ static void put_children_on_queue_and_update_structs(int *edge_list, int num_nod
 
 /* puts specified child node onto the sorted 'nodes_waiting' structure. this structure is sorted by a path weight 
    (which will be determined in this function), and the child's node index serving as a tie breaker */
-static void put_child_onto_nodes_waiting_structure(int child_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, 
+static void put_child_onto_nodes_waiting_structure(int child_ind, t_rr_node &rr_node, const Node_Values &node_values, t_ss_distances &ss_distances, 
 			t_node_topo_inf &node_topo_inf, e_traversal_dir traversal_dir, t_nodes_waiting &nodes_waiting){
 
 	/* Currently the path weight attributed to the child node is the shortest path from the 
@@ -255,7 +270,7 @@ static void put_child_onto_nodes_waiting_structure(int child_ind, t_rr_node &rr_
 	   //	2nd level: min path weight to source (by ascending order)
 	   //	3rd level: pointer of node (by ascending order)
 
-	int child_weight = rr_node[child_ind].get_weight();
+	int child_weight = node_values.weight[child_ind];
 
 	int source_dist = ss_distances[child_ind].get_source_distance();
 	int sink_dist = ss_distances[child_ind].get_sink_distance();
@@ -6,13 +6,13 @@
 
 /**** Typedefs ****/
 /* function type that is executed when node is popped from expansion queue during topological traversal */
-typedef void(*t_usr_node_popped_func)(int popped_node, int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, 
+typedef void(*t_usr_node_popped_func)(int popped_node, int from_node_ind, int to_node_ind, t_rr_node &rr_node, const Node_Values &node_values, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, 
                           e_traversal_dir traversal_dir, int max_path_weight, User_Options *user_opts, void *user_data);
 /* function type that is executed when topological traversal is complete */
-typedef void(*t_usr_traversal_done_func)(int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, 
+typedef void(*t_usr_traversal_done_func)(int from_node_ind, int to_node_ind, t_rr_node &rr_node, const Node_Values &node_values, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf, 
                           e_traversal_dir traversal_dir, int max_path_weight, User_Options *user_opts, void *user_data);
 /* function type that is executed while iterating over a node's children (execution not guaranteed) */
-typedef bool(*t_usr_child_iterated_func)(int parent_ind, int parent_edge_ind, int node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
+typedef bool(*t_usr_child_iterated_func)(int parent_ind, int parent_edge_ind, int node_ind, t_rr_node &rr_node, const Node_Values &node_values, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
                           e_traversal_dir traversal_dir, int max_path_weight, int from_node_ind, int to_node_ind, User_Options *user_opts, void *user_data);
 
 
@@ -28,12 +28,15 @@ typedef bool(*t_usr_child_iterated_func)(int parent_ind, int parent_edge_ind, in
 
    All passed-in function pointers can be NULL
 */
-void do_topological_traversal(int from_node_ind, int to_node_ind, t_rr_node &rr_node, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
+void do_topological_traversal(int from_node_ind, int to_node_ind, t_rr_node &rr_node, const Node_Values &node_values, t_ss_distances &ss_distances, t_node_topo_inf &node_topo_inf,
 			e_traversal_dir traversal_dir, int max_path_weight, User_Options *user_opts, void *user_data,
 			t_usr_node_popped_func usr_exec_node_popped,
 			t_usr_child_iterated_func usr_exec_child_iterated,
 			t_usr_traversal_done_func usr_exec_traversal_done);
 
+/* returns the total number of nodes that the calling thread has popped off the expansion queues of topological traversals */
+long long get_thread_traversal_pops();
+
 
 
 
@@ -0,0 +1,449 @@
+/*
+	Capture and offline replay of the workloads of the enumerate and propagate kernels.
+
+	Optimizing the traversal kernels requires benchmarking them on the connections seen in real runs, but the routing graphs
+of real runs are large. A kernel only reads the legal subgraph of its connection though, along with the frozen weights and
+demands of the subgraph nodes and their distances to the source and sink. A trace holds just that for one connection,
+with the subgraph renumbered, together with the results that the kernels produced on the full graph. Replay rebuilds each
+subgraph as a small routing graph, reruns the kernels on it, and checks that they reproduce the captured results bit for bit --
+so a kernel change that alters results (even by reassociating a floating-point sum) is caught by the replay that times it.
+
+	Traces are written in the native byte order of the machine, so a trace file is meant to be replayed on the same kind of
+machine it was captured on.
+*/
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <sstream>
+#include "traversal_trace.h"
+#include "analysis_main.h"
+#include "exception.h"
+#include "wotan_util.h"
+
+using namespace std;
+
+
+/**** Defines ****/
+/* identifies trace files */
+#define TRACE_FILE_MAGIC "wotan_traces"
+
+/* bump this whenever the format of trace files changes */
+#define TRACE_FORMAT_VERSION 1
+
+
+/**** Function Declarations ****/
+/* returns the subgraph index of the specified rr node, or UNDEFINED if the node isn't part of the subgraph */
+static int get_subgraph_ind(const vector<int> &subgraph_nodes, int rr_ind);
+/* writes a value to the specified binary file */
+template<typename T> static void write_value(ofstream &file, const T &value);
+/* writes a vector (prefixed by its size) to the specified binary file */
+template<typename T> static void write_vector(ofstream &file, const vector<T> &values);
+/* reads a value from the specified binary file */
+template<typename T> static void read_value(ifstream &file, T *value);
+/* reads a vector (prefixed by its size) from the specified binary file */
+template<typename T> static void read_vector(ifstream &file, vector<T> *values);
+/* returns whether two values have the same binary representation */
+template<typename T> static bool same_bits(const T &value1, const T &value2);
+/* compares the results of a replayed trace against the captured ones. returns an empty string if they match, and a description
+   of the first difference otherwise */
+static string compare_trace_results(const Traversal_Trace &trace, const t_demand_record &demand_record, float prob_routable,
+			const double *sink_buckets);
+
+
+
+/**** Function Definitions ****/
+/*==== Traversal_Trace Class ====*/
+Traversal_Trace::Traversal_Trace(){
+	this->source_rr_ind = UNDEFINED;
+	this->sink_rr_ind = UNDEFINED;
+	this->source_ind = UNDEFINED;
+	this->sink_ind = UNDEFINED;
+	this->conn_length = UNDEFINED;
+	this->max_path_weight = UNDEFINED;
+	this->num_buckets = UNDEFINED;
+	this->scaling_factor = UNDEFINED;
+	this->prob_routable = UNDEFINED;
+}
+
+int Traversal_Trace::get_num_nodes() const{
+	return (int)this->node_type.size();
+}
+/*==== END Traversal_Trace Class ====*/
+
+
+/* sets up the specified trace with the legal subgraph of the connection between the specified source/sink nodes, along with the
+   node values and distances that the kernels read. source/sink distances must already be set, and the nodes visited by the
+   distance searches listed in nodes_visited. the rr node index of every subgraph node is returned in subgraph_nodes (sorted) */
+void capture_trace_subgraph(int source_node_ind, int sink_node_ind, t_rr_node &rr_node, const Node_Values &node_values,
+			const t_ss_distances &ss_distances, const vector<int> &nodes_visited, int max_path_weight, Traversal_Trace *trace,
+			vector<int> &subgraph_nodes){
+
+	/* the traversals start at the source and sink, and don't go past nodes that are illegal. every legal node has had both
+	   of its distances set, so it was visited by the distance searches (possibly more than once) */
+	subgraph_nodes.clear();
+	subgraph_nodes.push_back(source_node_ind);
+	subgraph_nodes.push_back(sink_node_ind);
+	for (int ivisited = 0; ivisited < (int)nodes_visited.size(); ivisited++){
+		int node_ind = nodes_visited[ivisited];
+		if (ss_distances[node_ind].is_legal(node_values.weight[node_ind], max_path_weight)){
+			subgraph_nodes.push_back(node_ind);
+		}
+	}
+	sort(subgraph_nodes.begin(), subgraph_nodes.end());
+	subgraph_nodes.erase( unique(subgraph_nodes.begin(), subgraph_nodes.end()), subgraph_nodes.end() );
+
+	int num_nodes = (int)subgraph_nodes.size();
+	trace->source_rr_ind = source_node_ind;
+	trace->sink_rr_ind = sink_node_ind;
+	trace->source_ind = get_subgraph_ind(subgraph_nodes, source_node_ind);
+	trace->sink_ind = get_subgraph_ind(subgraph_nodes, sink_node_ind);
+	trace->max_path_weight = max_path_weight;
+
+	trace->node_type.assign(num_nodes, 0);
+	trace->weight.assign(num_nodes, 0);
+	trace->demand.assign(num_nodes, 0);
+	trace->source_distance.assign(num_nodes, UNDEFINED);
+	trace->sink_distance.assign(num_nodes, UNDEFINED);
+	trace->num_out_edges.assign(num_nodes, 0);
+	trace->num_in_edges.assign(num_nodes, 0);
+	trace->out_edges.clear();
+	trace->in_edges.clear();
+
+	for (int inode = 0; inode < num_nodes; inode++){
+		int node_ind = subgraph_nodes[inode];
+		trace->node_type[inode] = (char)rr_node[node_ind].get_rr_type();
+		trace->weight[inode] = node_values.weight[node_ind];
+		trace->demand[inode] = node_values.demand[node_ind];
+		trace->source_distance[inode] = ss_distances[node_ind].get_source_distance();
+		trace->sink_distance[inode] = ss_distances[node_ind].get_sink_distance();
+
+		/* edges that leave the subgraph lead to illegal nodes, which the traversals skip anyway */
+		for (int iedge = 0; iedge < rr_node[node_ind].get_num_out_edges(); iedge++){
+			int child_ind = get_subgraph_ind(subgraph_nodes, rr_node[node_ind].out_edges[iedge]);
+			if (child_ind != UNDEFINED){
+				trace->out_edges.push_back(child_ind);
+				trace->num_out_edges[inode]++;
+			}
+		}
+		for (int iedge = 0; iedge < rr_node[node_ind].get_num_in_edges(); iedge++){
+			int parent_ind = get_subgraph_ind(subgraph_nodes, rr_node[node_ind].in_edges[iedge]);
+			if (parent_ind != UNDEFINED){
+				trace->in_edges.push_back(parent_ind);
+				trace->num_in_edges[inode]++;
+			}
+		}
+	}
+}
+
+/* writes the specified traces to a binary file */
+void write_traversal_traces(string file_path, const t_traversal_traces &traces){
+	ofstream file(file_path.c_str(), ios::out | ios::binary | ios::trunc);
+	if (!file.is_open()){
+		WTHROW(EX_OTHER, "Could not open trace file " << file_path << " for writing");
+	}
+
+	file.write(TRACE_FILE_MAGIC, strlen(TRACE_FILE_MAGIC));
+	write_value(file, (int)TRACE_FORMAT_VERSION);
+	write_value(file, (int)traces.size());
+
+	for (int itrace = 0; itrace < (int)traces.size(); itrace++){
+		const Traversal_Trace &trace = traces[itrace];
+		write_value(file, trace.source_rr_ind);
+		write_value(file, trace.sink_rr_ind);
+		write_value(file, trace.source_ind);
+		write_value(file, trace.sink_ind);
+		write_value(file, trace.conn_length);
+		write_value(file, trace.max_path_weight);
+		write_value(file, trace.num_buckets);
+		write_value(file, trace.scaling_factor);
+
+		write_vector(file, trace.node_type);
+		write_vector(file, trace.weight);
+		write_vector(file, trace.demand);
+		write_vector(file, trace.source_distance);
+		write_vector(file, trace.sink_distance);
+		write_vector(file, trace.num_out_edges);
+		write_vector(file, trace.num_in_edges);
+		write_vector(file, trace.out_edges);
+		write_vector(file, trace.in_edges);
+
+		write_value(file, (int)trace.demand_record.size());
+		for (int ientry = 0; ientry < (int)trace.demand_record.size(); ientry++){
+			write_value(file, trace.demand_record[ientry].first);
+			write_value(file, trace.demand_record[ientry].second);
+		}
+		write_value(file, trace.prob_routable);
+		write_vector(file, trace.sink_buckets);
+	}
+
+	if (!file.good()){
+		WTHROW(EX_OTHER, "Failed to write trace file " << file_path);
+	}
+}
+
+/* reads traces from a binary file written by write_traversal_traces */
+void read_traversal_traces(string file_path, t_traversal_traces *traces){
+	ifstream file(file_path.c_str(), ios::in | ios::binary);
+	if (!file.is_open()){
+		WTHROW(EX_OTHER, "Could not open trace file " << file_path);
+	}
+
+	string magic(strlen(TRACE_FILE_MAGIC), ' ');
+	file.read(&magic[0], magic.size());
+	int version = UNDEFINED;
+	read_value(file, &version);
+	if (magic != TRACE_FILE_MAGIC || version != TRACE_FORMAT_VERSION){
+		WTHROW(EX_OTHER, file_path << " is not a trace file of format version " << TRACE_FORMAT_VERSION);
+	}
+
+	int num_traces;
+	read_value(file, &num_traces);
+	traces->assign(num_traces, Traversal_Trace());
+
+	for (int itrace = 0; itrace < num_traces; itrace++){
+		Traversal_Trace &trace = (*traces)[itrace];
+		read_value(file, &trace.source_rr_ind);
+		read_value(file, &trace.sink_rr_ind);
+		read_value(file, &trace.source_ind);
+		read_value(file, &trace.sink_ind);
+		read_value(file, &trace.conn_length);
+		read_value(file, &trace.max_path_weight);
+		read_value(file, &trace.num_buckets);
+		read_value(file, &trace.scaling_factor);
+
+		read_vector(file, &trace.node_type);
+		read_vector(file, &trace.weight);
+		read_vector(file, &trace.demand);
+		read_vector(file, &trace.source_distance);
+		read_vector(file, &trace.sink_distance);
+		read_vector(file, &trace.num_out_edges);
+		read_vector(file, &trace.num_in_edges);
+		read_vector(file, &trace.out_edges);
+		read_vector(file, &trace.in_edges);
+
+		int num_entries;
+		read_value(file, &num_entries);
+		trace.demand_record.assign(num_entries, make_pair(0, 0.0F));
+		for (int ientry = 0; ientry < num_entries; ientry++){
+			read_value(file, &trace.demand_record[ientry].first);
+			read_value(file, &trace.demand_record[ientry].second);
+		}
+		read_value(file, &trace.prob_routable);
+		read_vector(file, &trace.sink_buckets);
+
+		/* a corrupt trace would send the kernels out of bounds */
+		int num_nodes = trace.get_num_nodes();
+		long long num_out_edges = 0;
+		long long num_in_edges = 0;
+		for (int inode = 0; inode < num_nodes; inode++){
+			num_out_edges += trace.num_out_edges[inode];
+			num_in_edges += trace.num_in_edges[inode];
+		}
+		if ((int)trace.weight.size() != num_nodes || (int)trace.demand.size() != num_nodes || (int)trace.source_distance.size() != num_nodes ||
+		    (int)trace.sink_distance.size() != num_nodes || (int)trace.num_out_edges.size() != num_nodes ||
+		    (int)trace.num_in_edges.size() != num_nodes || num_out_edges != (long long)trace.out_edges.size() ||
+		    num_in_edges != (long long)trace.in_edges.size() || trace.source_ind < 0 || trace.source_ind >= num_nodes ||
+		    trace.sink_ind < 0 || trace.sink_ind >= num_nodes || (int)trace.sink_buckets.size() != trace.num_buckets ||
+		    trace.max_path_weight >= trace.num_buckets){
+			WTHROW(EX_OTHER, "Trace " << itrace << " of " << file_path << " is inconsistent");
+		}
+	}
+}
+
+/* reruns the enumerate and propagate kernels on every trace of the specified file, checks that they reproduce the captured
+   results bit for bit, and prints how long the kernels took. throws if any result differs */
+void replay_traversal_traces(string file_path, User_Options *user_opts){
+	t_traversal_traces traces;
+	read_traversal_traces(file_path, &traces);
+	int num_traces = (int)traces.size();
+
+	cout << "Replaying " << num_traces << " traversal traces from " << file_path << " (fastest of " << TRACE_REPLAY_ROUNDS <<
+	        " runs of each kernel per trace)" << endl;
+
+	double enumerate_seconds = 0;
+	double propagate_seconds = 0;
+	long long total_nodes = 0;
+	long long total_edges = 0;
+	int num_mismatched = 0;
+	for (int itrace = 0; itrace < num_traces; itrace++){
+		const Traversal_Trace &trace = traces[itrace];
+		int num_nodes = trace.get_num_nodes();
+		int num_buckets = trace.num_buckets;
+
+		/* rebuild the subgraph as a routing graph of its own */
+		t_rr_node rr_node(num_nodes);
+		int out_edge_ind = 0;
+		int in_edge_ind = 0;
+		for (int inode = 0; inode < num_nodes; inode++){
+			rr_node[inode].set_rr_type( (e_rr_type)trace.node_type[inode] );
+
+			rr_node[inode].alloc_out_edges_and_switches(trace.num_out_edges[inode]);
+			for (int iedge = 0; iedge < trace.num_out_edges[inode]; iedge++){
+				rr_node[inode].out_edges[iedge] = trace.out_edges[out_edge_ind++];
+				rr_node[inode].out_switches[iedge] = 0;
+			}
+			rr_node[inode].alloc_in_edges_and_switches(trace.num_in_edges[inode]);
+			for (int iedge = 0; iedge < trace.num_in_edges[inode]; iedge++){
+				rr_node[inode].in_edges[iedge] = trace.in_edges[in_edge_ind++];
+				rr_node[inode].in_switches[iedge] = 0;
+			}
+		}
+
+		Node_Values node_values;
+		node_values.weight = trace.weight;
+		node_values.demand = trace.demand;
+
+		t_ss_distances ss_distances(num_nodes, SS_Distances());
+		for (int inode = 0; inode < num_nodes; inode++){
+			ss_distances[inode].set_source_distance(trace.source_distance[inode]);
+			ss_distances[inode].set_sink_distance(trace.sink_distance[inode]);
+		}
+
+		t_node_topo_inf node_topo_inf(num_nodes, Node_Topological_Info());
+		vector<double> bucket_storage(2 * (size_t)num_buckets * num_nodes);
+		for (int inode = 0; inode < num_nodes; inode++){
+			node_topo_inf[inode].buckets.assign_source_sink_buckets(&bucket_storage[2 * (size_t)num_buckets * inode], num_buckets);
+		}
+
+		/* run the kernels. demand that the enumerate kernel adds to the rr nodes of the subgraph isn't read back by either kernel */
+		double best_enumerate_seconds = 0;
+		double best_propagate_seconds = 0;
+		string mismatch = "";
+		for (int iround = 0; iround < TRACE_REPLAY_ROUNDS; iround++){
+			t_demand_record demand_record;
+			demand_record.reserve(trace.demand_record.size());
+
+			double start_time = get_wall_seconds();
+			enumerate_subgraph_paths(trace.source_ind, trace.sink_ind, rr_node, node_values, ss_distances, node_topo_inf, trace.max_path_weight,
+			                         user_opts, trace.scaling_factor, &demand_record);
+			double seconds = get_wall_seconds() - start_time;
+			best_enumerate_seconds = (iround == 0 ? seconds : min(best_enumerate_seconds, seconds));
+
+			for (int inode = 0; inode < num_nodes; inode++){
+				node_topo_inf[inode].clear();
+			}
+
+			start_time = get_wall_seconds();
+			float prob_routable = propagate_subgraph_probability(trace.source_ind, trace.sink_ind, rr_node, node_values, ss_distances,
+			                                                     node_topo_inf, trace.max_path_weight, user_opts, NULL, NULL);
+			seconds = get_wall_seconds() - start_time;
+			best_propagate_seconds = (iround == 0 ? seconds : min(best_propagate_seconds, seconds));
+
+			if (mismatch.empty()){
+				mismatch = compare_trace_results(trace, demand_record, prob_routable, node_topo_inf[trace.sink_ind].buckets.source_buckets);
+			}
+
+			for (int inode = 0; inode < num_nodes; inode++){
+				node_topo_inf[inode].clear();
+			}
+		}
+
+		enumerate_seconds += best_enumerate_seconds;
+		propagate_seconds += best_propagate_seconds;
+		total_nodes += num_nodes;
+		total_edges += (long long)trace.out_edges.size();
+
+		if (!mismatch.empty()){
+			if (num_mismatched < TRACE_REPLAY_MISMATCHES_LISTED){
+				cout << "  trace " << itrace << " (source " << trace.source_rr_ind << " -> sink " << trace.sink_rr_ind << "): " << mismatch << endl;
+			}
+			num_mismatched++;
+		}
+	}
+
+	cout << "  " << total_nodes << " subgraph nodes and " << total_edges << " subgraph edges in total" << endl;
+	cout << "  enumerate kernel: " << 1e3 * enumerate_seconds << " ms (" << 1e9 * enumerate_seconds / max(1LL, total_nodes) << " ns per subgraph node)" << endl;
+	cout << "  propagate kernel: " << 1e3 * propagate_seconds << " ms (" << 1e9 * propagate_seconds / max(1LL, total_nodes) << " ns per subgraph node)" << endl;
+
+	if (num_mismatched > 0){
+		WTHROW(EX_PATH_ENUM, num_mismatched << " of " << num_traces << " traces did not reproduce the captured kernel results");
+	}
+	cout << "  kernel results of all traces match the captured results bit for bit" << endl;
+}
+
+/* compares the results of a replayed trace against the captured ones. returns an empty string if they match, and a description
+   of the first difference otherwise */
+static string compare_trace_results(const Traversal_Trace &trace, const t_demand_record &demand_record, float prob_routable,
+			const double *sink_buckets){
+	stringstream mismatch;
+	mismatch.precision(17);
+
+	if (demand_record.size() != trace.demand_record.size()){
+		mismatch << "enumerate contributed demand to " << demand_record.size() << " nodes instead of " << trace.demand_record.size();
+		return mismatch.str();
+	}
+	for (int ientry = 0; ientry < (int)demand_record.size(); ientry++){
+		if (demand_record[ientry].first != trace.demand_record[ientry].first ||
+		    !same_bits(demand_record[ientry].second, trace.demand_record[ientry].second)){
+			mismatch << "demand contribution " << ientry << " is " << demand_record[ientry].second << " to node " << demand_record[ientry].first <<
+			            " instead of " << trace.demand_record[ientry].second << " to node " << trace.demand_record[ientry].first;
+			return mismatch.str();
+		}
+	}
+
+	if (!same_bits(prob_routable, trace.prob_routable)){
+		mismatch << "propagate returned a probability of " << prob_routable << " instead of " << trace.prob_routable;
+		return mismatch.str();
+	}
+	for (int ibucket = 0; ibucket < trace.num_buckets; ibucket++){
+		if (!same_bits(sink_buckets[ibucket], trace.sink_buckets[ibucket])){
+			mismatch << "sink bucket " << ibucket << " is " << sink_buckets[ibucket] << " instead of " << trace.sink_buckets[ibucket];
+			return mismatch.str();
+		}
+	}
+
+	return mismatch.str();
+}
+
+/* returns the subgraph index of the specified rr node, or UNDEFINED if the node isn't part of the subgraph */
+static int get_subgraph_ind(const vector<int> &subgraph_nodes, int rr_ind){
+	vector<int>::const_iterator it = lower_bound(subgraph_nodes.begin(), subgraph_nodes.end(), rr_ind);
+	if (it == subgraph_nodes.end() || (*it) != rr_ind){
+		return UNDEFINED;
+	}
+	return (int)(it - subgraph_nodes.begin());
+}
+
+/* writes a value to the specified binary file */
+template<typename T> static void write_value(ofstream &file, const T &value){
+	file.write((const char*)&value, sizeof(T));
+}
+
+/* writes a vector (prefixed by its size) to the specified binary file */
+template<typename T> static void write_vector(ofstream &file, const vector<T> &values){
+	write_value(file, (int)values.size());
+	if (!values.empty()){
+		file.write((const char*)&values[0], values.size() * sizeof(T));
+	}
+}
+
+/* reads a value from the specified binary file */
+template<typename T> static void read_value(ifstream &file, T *value){
+	file.read((char*)value, sizeof(T));
+	if (!file.good()){
+		WTHROW(EX_OTHER, "Trace file ended unexpectedly");
+	}
+}
+
+/* reads a vector (prefixed by its size) from the specified binary file */
+template<typename T> static void read_vector(ifstream &file, vector<T> *values){
+	int num_values;
+	read_value(file, &num_values);
+	if (num_values < 0){
+		WTHROW(EX_OTHER, "Trace file has a vector of negative size");
+	}
+	values->assign(num_values, T());
+	if (num_values > 0){
+		file.read((char*)&(*values)[0], (size_t)num_values * sizeof(T));
+		if (!file.good()){
+			WTHROW(EX_OTHER, "Trace file ended unexpectedly");
+		}
+	}
+}
+
+/* returns whether two values have the same binary representation */
+template<typename T> static bool same_bits(const T &value1, const T &value2){
+	return memcmp(&value1, &value2, sizeof(T)) == 0;
+}
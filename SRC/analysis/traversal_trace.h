@@ -0,0 +1,79 @@
+#ifndef TRAVERSAL_TRACE_H
+#define TRAVERSAL_TRACE_H
+
+#include <vector>
+#include <string>
+#include "wotan_types.h"
+#include "enumerate.h"
+
+
+/**** Defines ****/
+/* number of times the kernels are rerun on each trace during replay. the fastest run of each kernel is timed */
+#define TRACE_REPLAY_ROUNDS 5
+
+/* number of mismatching traces that are listed when a replay doesn't reproduce the captured results */
+#define TRACE_REPLAY_MISMATCHES_LISTED 10
+
+
+/**** Classes ****/
+/* The workload of the enumerate and propagate kernels for one connection, as captured from an analysis run: the legal subgraph of
+   the connection, the node values and source/sink distances that the kernels read, and the results that they produced.
+   Subgraph nodes are renumbered 0..num_nodes-1 in the order of their rr node indices, which keeps the order in which the
+   topological traversals break cycles */
+class Traversal_Trace{
+public:
+	int source_rr_ind;			/* rr node indices of the source and sink in the captured graph (for reference only) */
+	int sink_rr_ind;
+	int source_ind;				/* subgraph indices of the source and sink */
+	int sink_ind;
+	int conn_length;
+	int max_path_weight;			/* max path weight of the connection, as adjusted by its source-sink distance */
+	int num_buckets;			/* number of source (and sink) buckets of each node */
+	float scaling_factor;			/* scaling factor with which the connection's paths were enumerated */
+
+	/* [0..num_nodes-1] */
+	std::vector<char> node_type;		/* e_rr_type of each node */
+	std::vector<short> weight;		/* frozen node weights */
+	std::vector<float> demand;		/* frozen (effective) node demands */
+	std::vector<int> source_distance;
+	std::vector<int> sink_distance;
+	std::vector<short> num_out_edges;	/* number of edges to other subgraph nodes. edges keep the order of the rr node edge lists */
+	std::vector<short> num_in_edges;
+
+	std::vector<int> out_edges;		/* edges of node 0, then of node 1, etc */
+	std::vector<int> in_edges;
+
+	/* the results of the kernels */
+	t_demand_record demand_record;		/* demand contributed to each node by the enumerate kernel, in order of contribution */
+	float prob_routable;			/* connection probability returned by the propagate kernel */
+	std::vector<double> sink_buckets;	/* [0..num_buckets-1] source buckets of the sink after the propagate kernel */
+
+	Traversal_Trace();
+
+	int get_num_nodes() const;
+};
+
+/* traces captured for a sample of connections */
+typedef std::vector< Traversal_Trace > t_traversal_traces;
+
+
+/**** Function Declarations ****/
+/* sets up the specified trace with the legal subgraph of the connection between the specified source/sink nodes, along with the
+   node values and distances that the kernels read. source/sink distances must already be set, and the nodes visited by the
+   distance searches listed in nodes_visited. the rr node index of every subgraph node is returned in subgraph_nodes (sorted) */
+void capture_trace_subgraph(int source_node_ind, int sink_node_ind, t_rr_node &rr_node, const Node_Values &node_values,
+			const t_ss_distances &ss_distances, const std::vector<int> &nodes_visited, int max_path_weight, Traversal_Trace *trace,
+			std::vector<int> &subgraph_nodes);
+
+/* writes the specified traces to a binary file */
+void write_traversal_traces(std::string file_path, const t_traversal_traces &traces);
+
+/* reads traces from a binary file written by write_traversal_traces */
+void read_traversal_traces(std::string file_path, t_traversal_traces *traces);
+
+/* reruns the enumerate and propagate kernels on every trace of the specified file, checks that they reproduce the captured
+   results bit for bit, and prints how long the kernels took. throws if any result differs */
+void replay_traversal_traces(std::string file_path, User_Options *user_opts);
+
+
+#endif
@@ -0,0 +1,273 @@
+/*
+	Kernels for the per-edge and per-node bucket loops of path enumeration and probability propagation.
+
+	Most connections are analyzed with a small adjusted maximum path weight, so only the first few dozen buckets of each
+node can ever hold paths. For such connections a kernel with a compile-time bucket count is picked once per connection.
+The fixed-width kernels process the whole width of the bucket array without data-dependent branches: empty buckets are
+blended rather than skipped, and the bucket window is folded into a mask up front. This lets the compiler unroll and
+vectorize the loops with the plain -O3 flags of the build. The results are bit-identical to those of the generic loops,
+which remain in use for connections with larger path weights.
+*/
+
+#include <array>
+#include <algorithm>
+#include "bucket_kernels.h"
+#include "wotan_types.h"
+#include "wotan_util.h"
+
+using namespace std;
+
+
+/**** Function Declarations ****/
+/* fixed-width versions of the bucket kernels */
+template <int N> static void add_bucket_path_counts_fixed(const double * __restrict parent_buckets, double * __restrict child_buckets,
+			int first, int last, int child_weight);
+template <int N> static void or_bucket_probabilities_fixed(const double * __restrict parent_buckets, double * __restrict child_buckets,
+			int last, int child_weight);
+template <int N> static void scale_bucket_probabilities_fixed(double * __restrict buckets, double factor);
+
+/* generic versions of the bucket kernels */
+static void add_bucket_path_counts_generic(const double *parent_buckets, double *child_buckets, int first, int last, int child_weight);
+static void or_bucket_probabilities_generic(const double *parent_buckets, double *child_buckets, int last, int child_weight);
+static void scale_bucket_probabilities_generic(double *buckets, int last, double factor);
+
+
+
+/**** Function Definitions ****/
+/* returns the narrowest fixed-width kernel that covers buckets [0, max_bucket], or the generic kernel if none does. meant to
+   be called once per connection, with the largest bucket index the connection's traversal can write to */
+e_bucket_kernel select_bucket_kernel(int max_bucket){
+	e_bucket_kernel kernel;
+	if (max_bucket < 0){
+		kernel = BUCKET_KERNEL_GENERIC;
+	} else if (max_bucket < 16){
+		kernel = BUCKET_KERNEL_16;
+	} else if (max_bucket < 32){
+		kernel = BUCKET_KERNEL_32;
+	} else if (max_bucket < 48){
+		kernel = BUCKET_KERNEL_48;
+	} else if (max_bucket < 64){
+		kernel = BUCKET_KERNEL_64;
+	} else {
+		kernel = BUCKET_KERNEL_GENERIC;
+	}
+	return kernel;
+}
+
+/* returns the number of buckets processed by the specified kernel (0 for the generic kernel) */
+int get_bucket_kernel_width(e_bucket_kernel kernel){
+	int width;
+	switch (kernel){
+		case BUCKET_KERNEL_16:
+			width = 16;
+			break;
+		case BUCKET_KERNEL_32:
+			width = 32;
+			break;
+		case BUCKET_KERNEL_48:
+			width = 48;
+			break;
+		case BUCKET_KERNEL_64:
+			width = 64;
+			break;
+		default:
+			width = 0;
+			break;
+	}
+	return width;
+}
+
+/* adds the path counts held by parent buckets [first, last] to the child buckets 'child_weight' further up. both nodes have
+   'num_buckets' buckets. empty buckets hold UNDEFINED */
+void add_bucket_path_counts(e_bucket_kernel kernel, const double *parent_buckets, double *child_buckets, int num_buckets,
+			int first, int last, int child_weight){
+	if (last < first){
+		return;
+	}
+
+	/* a fixed-width kernel touches child buckets [child_weight, child_weight + width) */
+	int width = get_bucket_kernel_width(kernel);
+	if (last >= width || child_weight + width > num_buckets){
+		kernel = BUCKET_KERNEL_GENERIC;
+	}
+
+	switch (kernel){
+		case BUCKET_KERNEL_16:
+			add_bucket_path_counts_fixed<16>(parent_buckets, child_buckets, first, last, child_weight);
+			break;
+		case BUCKET_KERNEL_32:
+			add_bucket_path_counts_fixed<32>(parent_buckets, child_buckets, first, last, child_weight);
+			break;
+		case BUCKET_KERNEL_48:
+			add_bucket_path_counts_fixed<48>(parent_buckets, child_buckets, first, last, child_weight);
+			break;
+		case BUCKET_KERNEL_64:
+			add_bucket_path_counts_fixed<64>(parent_buckets, child_buckets, first, last, child_weight);
+			break;
+		default:
+			add_bucket_path_counts_generic(parent_buckets, child_buckets, first, last, child_weight);
+			break;
+	}
+}
+
+/* ORs the probabilities held by parent buckets [0, last] into the child buckets 'child_weight' further up. both nodes have
+   'num_buckets' buckets. empty buckets hold UNDEFINED */
+void or_bucket_probabilities(e_bucket_kernel kernel, const double *parent_buckets, double *child_buckets, int num_buckets,
+			int last, int child_weight){
+	if (last < 0){
+		return;
+	}
+
+	int width = get_bucket_kernel_width(kernel);
+	if (last >= width || child_weight + width > num_buckets){
+		kernel = BUCKET_KERNEL_GENERIC;
+	}
+
+	switch (kernel){
+		case BUCKET_KERNEL_16:
+			or_bucket_probabilities_fixed<16>(parent_buckets, child_buckets, last, child_weight);
+			break;
+		case BUCKET_KERNEL_32:
+			or_bucket_probabilities_fixed<32>(parent_buckets, child_buckets, last, child_weight);
+			break;
+		case BUCKET_KERNEL_48:
+			or_bucket_probabilities_fixed<48>(parent_buckets, child_buckets, last, child_weight);
+			break;
+		case BUCKET_KERNEL_64:
+			or_bucket_probabilities_fixed<64>(parent_buckets, child_buckets, last, child_weight);
+			break;
+		default:
+			or_bucket_probabilities_generic(parent_buckets, child_buckets, last, child_weight);
+			break;
+	}
+}
+
+/* multiplies the probability held by each non-empty bucket by 'factor'. buckets past 'last' must be empty; a fixed-width
+   kernel may visit them but leaves them untouched */
+void scale_bucket_probabilities(e_bucket_kernel kernel, double *buckets, int num_buckets, int last, double factor){
+	int width = get_bucket_kernel_width(kernel);
+	if (last >= width || width > num_buckets){
+		kernel = BUCKET_KERNEL_GENERIC;
+	}
+
+	switch (kernel){
+		case BUCKET_KERNEL_16:
+			scale_bucket_probabilities_fixed<16>(buckets, factor);
+			break;
+		case BUCKET_KERNEL_32:
+			scale_bucket_probabilities_fixed<32>(buckets, factor);
+			break;
+		case BUCKET_KERNEL_48:
+			scale_bucket_probabilities_fixed<48>(buckets, factor);
+			break;
+		case BUCKET_KERNEL_64:
+			scale_bucket_probabilities_fixed<64>(buckets, factor);
+			break;
+		default:
+			scale_bucket_probabilities_generic(buckets, min(last, num_buckets-1), factor);
+			break;
+	}
+}
+
+
+/* The fixed-width kernels are written as separate passes over std::arrays so that each pass is a straight-line loop the
+   compiler can vectorize. FP comparisons are kept to (in)equality tests, which don't trap, and the bucket window is turned
+   into a mask with a single unsigned compare. An empty child bucket contributes 0, so that e.g. 0 + p == p exactly */
+template <int N> static void add_bucket_path_counts_fixed(const double * __restrict parent_buckets, double * __restrict child_buckets,
+			int first, int last, int child_weight){
+	double *target_buckets = child_buckets + child_weight;
+	array<double, N> propagated;
+	array<double, N> sum;
+
+	/* parent values inside the window; everything else is treated as empty */
+	for (int ibucket = 0; ibucket < N; ibucket++){
+		double parent_value = parent_buckets[ibucket];
+		propagated[ibucket] = ((unsigned)(ibucket - first) <= (unsigned)(last - first)) ? parent_value : UNDEFINED;
+	}
+	for (int ibucket = 0; ibucket < N; ibucket++){
+		double child_value = target_buckets[ibucket];
+		double base = (child_value == UNDEFINED ? 0.0 : child_value);
+		sum[ibucket] = base + propagated[ibucket];
+	}
+	for (int ibucket = 0; ibucket < N; ibucket++){
+		double child_value = target_buckets[ibucket];
+		double new_value = sum[ibucket];
+		target_buckets[ibucket] = (propagated[ibucket] != UNDEFINED) ? new_value : child_value;
+	}
+}
+
+template <int N> static void or_bucket_probabilities_fixed(const double * __restrict parent_buckets, double * __restrict child_buckets,
+			int last, int child_weight){
+	double *target_buckets = child_buckets + child_weight;
+	array<double, N> propagated;
+	array<double, N> result;
+
+	for (int ibucket = 0; ibucket < N; ibucket++){
+		double parent_value = parent_buckets[ibucket];
+		propagated[ibucket] = ((unsigned)ibucket <= (unsigned)last) ? parent_value : UNDEFINED;
+	}
+	/* same operation order as or_two_probs(child, parent) */
+	for (int ibucket = 0; ibucket < N; ibucket++){
+		double child_value = target_buckets[ibucket];
+		double base = (child_value == UNDEFINED ? 0.0 : child_value);
+		double parent_value = propagated[ibucket];
+		result[ibucket] = base + parent_value - base*parent_value;
+	}
+	for (int ibucket = 0; ibucket < N; ibucket++){
+		double child_value = target_buckets[ibucket];
+		double new_value = result[ibucket];
+		target_buckets[ibucket] = (propagated[ibucket] != UNDEFINED) ? new_value : child_value;
+	}
+}
+
+template <int N> static void scale_bucket_probabilities_fixed(double * __restrict buckets, double factor){
+	array<double, N> scaled;
+
+	for (int ibucket = 0; ibucket < N; ibucket++){
+		scaled[ibucket] = buckets[ibucket] * factor;
+	}
+	for (int ibucket = 0; ibucket < N; ibucket++){
+		double value = buckets[ibucket];
+		double new_value = scaled[ibucket];
+		buckets[ibucket] = (value != UNDEFINED) ? new_value : value;
+	}
+}
+
+
+static void add_bucket_path_counts_generic(const double *parent_buckets, double *child_buckets, int first, int last, int child_weight){
+	for (int ibucket = first; ibucket <= last; ibucket++){
+		if (parent_buckets[ibucket] == UNDEFINED){
+			continue;
+		}
+
+		int target_bucket = ibucket + child_weight;
+		if (child_buckets[target_bucket] == UNDEFINED){
+			child_buckets[target_bucket] = parent_buckets[ibucket];
+		} else {
+			child_buckets[target_bucket] += parent_buckets[ibucket];
+		}
+	}
+}
+
+static void or_bucket_probabilities_generic(const double *parent_buckets, double *child_buckets, int last, int child_weight){
+	for (int ibucket = 0; ibucket <= last; ibucket++){
+		if (parent_buckets[ibucket] == UNDEFINED){
+			continue;
+		}
+
+		int target_bucket = ibucket + child_weight;
+		if (child_buckets[target_bucket] == UNDEFINED){
+			child_buckets[target_bucket] = parent_buckets[ibucket];
+		} else {
+			child_buckets[target_bucket] = or_two_probs(child_buckets[target_bucket], parent_buckets[ibucket]);
+		}
+	}
+}
+
+static void scale_bucket_probabilities_generic(double *buckets, int last, double factor){
+	for (int ibucket = 0; ibucket <= last; ibucket++){
+		if (buckets[ibucket] != UNDEFINED){
+			buckets[ibucket] = buckets[ibucket] * factor;
+		}
+	}
+}
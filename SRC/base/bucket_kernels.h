@@ -0,0 +1,39 @@
+#ifndef BUCKET_KERNELS_H
+#define BUCKET_KERNELS_H
+
+
+/**** Enums ****/
+/* The kernel used for the bucket loops of a connection. A fixed-width kernel processes a fixed number of buckets from the
+   start of a node's bucket array without branching on bucket contents, which lets the compiler unroll and vectorize it.
+   The generic kernel loops over the active buckets only */
+enum e_bucket_kernel{
+	BUCKET_KERNEL_GENERIC = 0,
+	BUCKET_KERNEL_16,
+	BUCKET_KERNEL_32,
+	BUCKET_KERNEL_48,
+	BUCKET_KERNEL_64
+};
+
+
+/**** Function Declarations ****/
+/* returns the narrowest fixed-width kernel that covers buckets [0, max_bucket], or the generic kernel if none does. meant to
+   be called once per connection, with the largest bucket index the connection's traversal can write to */
+e_bucket_kernel select_bucket_kernel(int max_bucket);
+
+/* returns the number of buckets processed by the specified kernel (0 for the generic kernel) */
+int get_bucket_kernel_width(e_bucket_kernel kernel);
+
+/* adds the path counts held by parent buckets [first, last] to the child buckets 'child_weight' further up. both nodes have
+   'num_buckets' buckets. empty buckets hold UNDEFINED */
+void add_bucket_path_counts(e_bucket_kernel kernel, const double *parent_buckets, double *child_buckets, int num_buckets,
+			int first, int last, int child_weight);
+
+/* ORs the probabilities held by parent buckets [0, last] into the child buckets 'child_weight' further up. both nodes have
+   'num_buckets' buckets. empty buckets hold UNDEFINED */
+void or_bucket_probabilities(e_bucket_kernel kernel, const double *parent_buckets, double *child_buckets, int num_buckets,
+			int last, int child_weight);
+
+/* multiplies the probability held by each non-empty bucket in [0, last] by 'factor' */
+void scale_bucket_probabilities(e_bucket_kernel kernel, double *buckets, int num_buckets, int last, double factor);
+
+#endif
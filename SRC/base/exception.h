@@ -12,6 +12,20 @@
 				Wotan_Exception ex(exss.str(), std::string(__FILE__), __LINE__, ex_type);		\
 				throw ex;} while(false) 
 
+/* Level of sanity checking compiled into the hot paths of path enumeration / probability analysis:
+	0 -- no checks (production runs)
+	1 -- cheap checks: constant-time checks that aren't inside inner loops
+	2 -- paranoid: per-iteration bounds checks and whole extra verification loops (regression runs)
+   Normally set from the Makefile */
+#ifndef WOTAN_CHECK_LEVEL
+#define WOTAN_CHECK_LEVEL 1
+#endif
+
+/* Throws the specified exception if 'condition' doesn't hold. The check is only compiled in if WOTAN_CHECK_LEVEL is at least
+   'level'. Use as:
+	WCHECK(2, index < size, EX_PATH_ENUM, "index out of bounds: " << index); */
+#define WCHECK(level, condition, ex_type, message) do {if (WOTAN_CHECK_LEVEL >= (level) && !(condition)){					WTHROW(ex_type, message);} } while(false)
+
 /**** Enums ****/
 /* enumerate various exceptions. has to match ex_type_string variable */
 enum e_ex_type{
@@ -1,5 +1,6 @@
 #include <cstdlib>
 #include <cstring>
+#include <cstdio>
 #include <sstream>
 #include <set>
 #include "wotan_init.h"
@@ -9,6 +10,8 @@
 #include "io.h"
 #include "draw.h"
 #include "parse_rr_structs_file.h"
+#include "analysis_main.h"
+#include "wotan_scratch.h"
 
 using namespace std;
 
@@ -42,9 +45,6 @@ void wotan_init(int argc, char **argv, User_Options *user_opts, Arch_Structs *ar
 
 	wotan_print_title();
 
-	//may be changed when command-line arguments are read-in
-	srand(3);
-
 	/* check that we have the minimum number of arguments */
 	if (argc < 2){
 		wotan_print_usage();
@@ -54,26 +54,55 @@ void wotan_init(int argc, char **argv, User_Options *user_opts, Arch_Structs *ar
 	/* parse user-specified options into user_opts variable */
 	wotan_parse_command_args(argc, argv, user_opts);
 
-	/* parse user-specified rr structs file into Wotan's architecture and routing structures */
-	parse_rr_structs_file(user_opts->rr_structs_file, arch_structs, routing_structs, user_opts->rr_structs_mode);
+	/* replaying captured traces doesn't need a routing graph */
+	if (!user_opts->replay_traces_file.empty()){
+		if (user_opts->self_congestion_mode != MODE_NONE){
+			WTHROW(EX_INIT, "Traces can only be replayed with self-congestion mode 'none'");
+		}
+		return;
+	}
 
-	/* if Wotan structures are initialized from a structures file dumped by VPR, then Wotan 
-	   structures aren't complete just yet. need to allocate and set incoming edges for each node.
-	   Do this for sinks first, and then for the rest of the nodes later
-	   	- Virtual sources are created for sinks, 2nd step necessary to account for those newly-created virtual sources */
-	initialize_reverse_node_edges_and_switches(routing_structs, UNDEFINED); 
+	/* seed is kept in user_opts since it also identifies a run for the purposes of result caching */
+	srand(user_opts->seed);
+
+	/* set up out-of-core mode (if requested) before any of the large arrays are allocated */
+	init_scratch(user_opts->scratch_dir);
+
+	/* if an analysis window was specified, only the part of the routing graph that can be reached by connections
+	   from the window's tiles needs to be loaded */
+	Parse_Region parse_region;
+	if (user_opts->use_window && user_opts->rr_structs_mode == RR_STRUCTS_VPR){
+		int halo = get_analysis_window_halo(user_opts);
+		parse_region.enabled = true;
+		parse_region.xlow = user_opts->window_xlow - halo;
+		parse_region.ylow = user_opts->window_ylow - halo;
+		parse_region.xhigh = user_opts->window_xhigh + halo;
+		parse_region.yhigh = user_opts->window_yhigh + halo;
+	}
 
-	/* create virtual sources for all sinks -- this allows (in effect) enumerating of paths from ipins */
-	create_virtual_sources(routing_structs);
+	/* the graphs of a batch of simple graphs are parsed one at a time during analysis */
+	if (user_opts->simple_batch_results_file.empty()){
+		/* parse user-specified rr structs file into Wotan's architecture and routing structures */
+		parse_rr_structs_file(user_opts->rr_structs_file, arch_structs, routing_structs, user_opts->rr_structs_mode, parse_region);
+
+		/* if Wotan structures are initialized from a structures file dumped by VPR, then Wotan 
+		   structures aren't complete just yet. need to allocate and set incoming edges for each node.
+		   Do this for sinks first, and then for the rest of the nodes later
+		   	- Virtual sources are created for sinks, 2nd step necessary to account for those newly-created virtual sources */
+		initialize_reverse_node_edges_and_switches(routing_structs, UNDEFINED); 
 
-	/* all nodes */
-	initialize_reverse_node_edges_and_switches(routing_structs, UNDEFINED); 
+		/* create virtual sources for all sinks -- this allows (in effect) enumerating of paths from ipins */
+		create_virtual_sources(routing_structs);
+
+		/* all nodes */
+		initialize_reverse_node_edges_and_switches(routing_structs, UNDEFINED); 
+	}
 
 	if (user_opts->rr_structs_mode == RR_STRUCTS_VPR){
 		/* initialize analysis settings */
 		analysis_settings->alloc_and_set_pin_probabilities(user_opts->opin_probability, user_opts->ipin_probability, arch_structs);
 		analysis_settings->alloc_and_set_length_probabilities(user_opts);
-		analysis_settings->alloc_and_set_test_tile_coords(arch_structs, routing_structs);
+		analysis_settings->alloc_and_set_test_tile_coords(user_opts, arch_structs, routing_structs);
 
 		/* initialize path count history structures of rr nodes */
 		int fill_type_ind = arch_structs->get_fill_type_index();
@@ -87,7 +116,7 @@ void wotan_init(int argc, char **argv, User_Options *user_opts, Arch_Structs *ar
 	}
 
 	/* initialize rr node weights */
-	routing_structs->init_rr_node_weights();
+	routing_structs->init_rr_node_weights(user_opts);
 
 	/* check initialized state */
 	check_setup(user_opts, arch_structs, routing_structs);
@@ -111,6 +140,18 @@ void wotan_init(int argc, char **argv, User_Options *user_opts, Arch_Structs *ar
 	return;
 }
 
+/* Parses the simple graph at the specified location and initializes its routing structures the same way as wotan_init does
+   for a single graph */
+void init_simple_graph(const Simple_Graph_Location &location, User_Options *user_opts, Routing_Structs *routing_structs){
+	parse_simple_graph(location, routing_structs);
+
+	initialize_reverse_node_edges_and_switches(routing_structs, UNDEFINED);
+	create_virtual_sources(routing_structs);
+	initialize_reverse_node_edges_and_switches(routing_structs, UNDEFINED);
+
+	routing_structs->init_rr_node_weights(user_opts);
+}
+
 
 /* Parses the command line options. Options are parsed into the user_opts variable */
 static void wotan_parse_command_args(int argc, char **argv, User_Options *user_opts){
@@ -159,6 +200,24 @@ static void wotan_parse_command_args(int argc, char **argv, User_Options *user_o
 			}
 
 			user_opts->num_threads = atoi(argv[iopt]);
+		} else if ( strcmp(argv[iopt], "-weight_epoch") == 0 ){
+			/* number of connections to enumerate between node weight snapshots */
+			iopt++;
+
+			if (iopt >= argc){
+				WTHROW(EX_INIT, "Expected an argument for the -weight_epoch option");
+			}
+
+			user_opts->weight_epoch_conns = atoi(argv[iopt]);
+		} else if ( strcmp(argv[iopt], "-demand_iterations") == 0 ){
+			/* maximum number of path enumeration passes used to bring node demands to a fixed point */
+			iopt++;
+
+			if (iopt >= argc){
+				WTHROW(EX_INIT, "Expected an argument for the -demand_iterations option");
+			}
+
+			user_opts->demand_iterations = atoi(argv[iopt]);
 		} else if ( strcmp(argv[iopt], "-max_connection_length") == 0 ){
 			/* maximum connection length to consider during path enumeration */
 			iopt++;
@@ -258,6 +317,15 @@ static void wotan_parse_command_args(int argc, char **argv, User_Options *user_o
 			}
 
 			user_opts->target_reliability = target_reliability;
+		} else if ( strcmp(argv[iopt], "-search_proxy_length") == 0 ){
+			/* maximum connection length of the proxy probes that start a search for the demand multiplier */
+			iopt++;
+
+			if (iopt >= argc){
+				WTHROW(EX_INIT, "Expected an argument for the -search_proxy_length option");
+			}
+
+			user_opts->search_proxy_length = atoi(argv[iopt]);
 		} else if ( strcmp(argv[iopt], "-self_congestion") == 0 ){
 			/* method to deal with self congestion */
 			iopt++;
@@ -275,6 +343,115 @@ static void wotan_parse_command_args(int argc, char **argv, User_Options *user_o
 			} else {
 				WTHROW(EX_INIT, "Unrecognized self_congestion mode: " << argv[iopt]);
 			}
+		} else if ( strcmp(argv[iopt], "-enumerate_engine") == 0 ){
+			/* engine used for path enumeration */
+			iopt++;
+
+			if (iopt >= argc){
+				WTHROW(EX_INIT, "Expected an argument for the -enumerate_engine option");
+			}
+
+			if ( strcmp(argv[iopt], "traverse") == 0 ){
+				user_opts->enumerate_engine = ENGINE_TRAVERSE;
+			} else if ( strcmp(argv[iopt], "tiled") == 0 ){
+				user_opts->enumerate_engine = ENGINE_TILED;
+			} else if ( strcmp(argv[iopt], "verify") == 0 ){
+				user_opts->enumerate_engine = ENGINE_VERIFY;
+			} else {
+				WTHROW(EX_INIT, "Unrecognized enumerate engine: " << argv[iopt]);
+			}
+		} else if ( strcmp(argv[iopt], "-probability_mode") == 0 ){
+			/* method used to estimate the probability of routing a connection */
+			iopt++;
+
+			if (iopt >= argc){
+				WTHROW(EX_INIT, "Expected an argument for the -probability_mode option");
+			}
+
+			if ( strcmp(argv[iopt], "propagate") == 0 ){
+				user_opts->probability_mode = PROPAGATE;
+			} else if ( strcmp(argv[iopt], "cutline") == 0 ){
+				user_opts->probability_mode = CUTLINE;
+			} else if ( strcmp(argv[iopt], "cutline_simple") == 0 ){
+				user_opts->probability_mode = CUTLINE_SIMPLE;
+			} else if ( strcmp(argv[iopt], "cutline_recursive") == 0 ){
+				user_opts->probability_mode = CUTLINE_RECURSIVE;
+			} else if ( strcmp(argv[iopt], "reliability_polynomial") == 0 ){
+				user_opts->probability_mode = RELIABILITY_POLYNOMIAL;
+			} else if ( strcmp(argv[iopt], "monte_carlo") == 0 ){
+				user_opts->probability_mode = MONTE_CARLO;
+			} else if ( strcmp(argv[iopt], "exact") == 0 ){
+				user_opts->probability_mode = EXACT;
+			} else {
+				WTHROW(EX_INIT, "Unrecognized probability mode: " << argv[iopt]);
+			}
+		} else if ( strcmp(argv[iopt], "-monte_carlo_trials") == 0 ){
+			/* number of Monte Carlo trials per connection */
+			iopt++;
+
+			if (iopt >= argc){
+				WTHROW(EX_INIT, "Expected an argument for the -monte_carlo_trials option");
+			}
+
+			user_opts->monte_carlo_trials = atoi(argv[iopt]);
+		} else if ( strcmp(argv[iopt], "-exact_frontier_limit") == 0 ){
+			/* widest frontier for which exact reliability is computed */
+			iopt++;
+
+			if (iopt >= argc){
+				WTHROW(EX_INIT, "Expected an argument for the -exact_frontier_limit option");
+			}
+
+			user_opts->exact_frontier_limit = atoi(argv[iopt]);
+		} else if ( strcmp(argv[iopt], "-validate_estimators") == 0 ){
+			user_opts->validate_estimators = true;
+		} else if ( strcmp(argv[iopt], "-tail_sampling") == 0 ){
+			/* fraction of the planned connections evaluated by two-stage sampling of the worst-connection tail */
+			iopt++;
+
+			if (iopt >= argc){
+				WTHROW(EX_INIT, "Expected an argument for the -tail_sampling option");
+			}
+
+			user_opts->tail_sampling_budget = atof(argv[iopt]);
+		} else if ( strcmp(argv[iopt], "-profile_connections") == 0 ){
+			/* profile the cost of every analyzed connection, listing this many of the most expensive ones */
+			iopt++;
+
+			if (iopt >= argc){
+				WTHROW(EX_INIT, "Expected an argument for the -profile_connections option");
+			}
+
+			user_opts->profile_conns_listed = atoi(argv[iopt]);
+		} else if ( strcmp(argv[iopt], "-profile_graph") == 0 ){
+			user_opts->profile_graph = true;
+		} else if ( strcmp(argv[iopt], "-capture_traces") == 0 ){
+			/* capture the kernel workloads of this many connections after the analysis */
+			iopt++;
+
+			if (iopt >= argc){
+				WTHROW(EX_INIT, "Expected an argument for the -capture_traces option");
+			}
+
+			user_opts->num_captured_traces = atoi(argv[iopt]);
+		} else if ( strcmp(argv[iopt], "-trace_file") == 0 ){
+			/* file to which captured traces are written */
+			iopt++;
+
+			if (iopt >= argc){
+				WTHROW(EX_INIT, "Expected an argument for the -trace_file option");
+			}
+
+			user_opts->trace_file = argv[iopt];
+		} else if ( strcmp(argv[iopt], "-replay_traces") == 0 ){
+			/* replay the kernels on the traces in this file */
+			iopt++;
+
+			if (iopt >= argc){
+				WTHROW(EX_INIT, "Expected an argument for the -replay_traces option");
+			}
+
+			user_opts->replay_traces_file = argv[iopt];
 		} else if ( strcmp(argv[iopt], "-seed") == 0 ){
 			/* seed for random numbers */
 			iopt++;
@@ -288,7 +465,105 @@ static void wotan_parse_command_args(int argc, char **argv, User_Options *user_o
 			unsigned int seed;
 			ss >> seed;
 
-			srand(seed);
+			user_opts->seed = seed;
+		} else if ( strcmp(argv[iopt], "-cache_dir") == 0 ){
+			/* directory in which final analysis results are cached */
+			iopt++;
+
+			if (iopt >= argc){
+				WTHROW(EX_INIT, "Expected an argument for the -cache_dir option");
+			}
+
+			user_opts->cache_dir = argv[iopt];
+		} else if ( strcmp(argv[iopt], "-cache_size_limit") == 0 ){
+			/* maximum size of the result cache, in MB */
+			iopt++;
+
+			if (iopt >= argc){
+				WTHROW(EX_INIT, "Expected an argument for the -cache_size_limit option");
+			}
+
+			stringstream ss;
+			ss << argv[iopt];
+			float cache_size_limit;
+			ss >> cache_size_limit;
+
+			if (cache_size_limit <= 0){
+				WTHROW(EX_INIT, "Expected cache size limit to be > 0. Got " << cache_size_limit);
+			}
+
+			user_opts->cache_size_limit = cache_size_limit;
+		} else if ( strcmp(argv[iopt], "-cache_bypass") == 0 ){
+			/* don't look up results in the cache (but still write the result of this run to it) */
+			user_opts->cache_bypass = true;
+		} else if ( strcmp(argv[iopt], "-scratch_dir") == 0 ){
+			/* back large arrays with files in this directory */
+			iopt++;
+
+			if (iopt >= argc){
+				WTHROW(EX_INIT, "Expected an argument for the -scratch_dir option");
+			}
+
+			user_opts->scratch_dir = argv[iopt];
+		} else if ( strcmp(argv[iopt], "-sensitivity_map") == 0 ){
+			/* write the sensitivity of the routability metric to node demands into this file */
+			iopt++;
+
+			if (iopt >= argc){
+				WTHROW(EX_INIT, "Expected an argument for the -sensitivity_map option");
+			}
+
+			user_opts->sensitivity_map_file = argv[iopt];
+		} else if ( strcmp(argv[iopt], "-calibrate_path_weight") == 0 ){
+			/* calibrate the maximum path weight of each connection length to stay within this error */
+			iopt++;
+
+			if (iopt >= argc){
+				WTHROW(EX_INIT, "Expected an argument for the -calibrate_path_weight option");
+			}
+
+			user_opts->path_weight_tolerance = atof(argv[iopt]);
+		} else if ( strcmp(argv[iopt], "-path_weight_table") == 0 ){
+			/* read per-length maximum path weights from (or write calibrated ones to) this file */
+			iopt++;
+
+			if (iopt >= argc){
+				WTHROW(EX_INIT, "Expected an argument for the -path_weight_table option");
+			}
+
+			user_opts->path_weight_table_file = argv[iopt];
+		} else if ( strcmp(argv[iopt], "-simple_batch") == 0 ){
+			/* analyze a batch of simple graphs and write the results of each to this CSV file */
+			iopt++;
+
+			if (iopt >= argc){
+				WTHROW(EX_INIT, "Expected an argument for the -simple_batch option");
+			}
+
+			user_opts->simple_batch_results_file = argv[iopt];
+		} else if ( strcmp(argv[iopt], "-window") == 0 ){
+			/* only analyze the tiles inside the specified window */
+			iopt++;
+
+			if (iopt >= argc){
+				WTHROW(EX_INIT, "Expected an argument for the -window option");
+			}
+
+			int xlow, ylow, xhigh, yhigh;
+			char trailing;
+			int num_read = sscanf(argv[iopt], "%d,%d,%d,%d%c", &xlow, &ylow, &xhigh, &yhigh, &trailing);
+			if (num_read != 4){
+				WTHROW(EX_INIT, "Expected the -window option argument to be of the form x0,y0,x1,y1. Got " << argv[iopt]);
+			}
+			if (xlow > xhigh || ylow > yhigh){
+				WTHROW(EX_INIT, "Expected the lower window coordinates to not exceed the upper ones. Got " << argv[iopt]);
+			}
+
+			user_opts->use_window = true;
+			user_opts->window_xlow = xlow;
+			user_opts->window_ylow = ylow;
+			user_opts->window_xhigh = xhigh;
+			user_opts->window_yhigh = yhigh;
 		} else if ( strcmp(argv[iopt], "-nodisp") == 0 ){
 			/* no graphics */
 			user_opts->nodisp = true;
@@ -319,7 +594,15 @@ static void wotan_print_usage(){
 	cout << "Usage:" << endl;
 	cout << "\t./wotan -rr_structs_file <file_path> [-rr_structs_mode <VPR/simple>] [-threads <num_threads>] [-max_connection_length <max_length>]" << endl <<
 		"\t\t[-analyze_core <y/n>] [-use_routing_node_demand <demand>]" << endl <<
-		"\t\t[-demand_multiplier <multiplier>] [-self_congestion_mode <none/radius/path_dependence>] [-seed <value>] [-nodisp]" << endl << endl;
+		"\t\t[-demand_multiplier <multiplier>] [-self_congestion_mode <none/radius/path_dependence>] [-seed <value>] [-nodisp]" << endl <<
+		"\t\t[-cache_dir <path>] [-cache_size_limit <MB>] [-cache_bypass] [-window <x0,y0,x1,y1>]" << endl <<
+		"\t\t[-scratch_dir <path>] [-weight_epoch <num_conns>] [-demand_iterations <max_passes>] [-sensitivity_map <file_path>]" << endl <<
+		"\t\t[-enumerate_engine <traverse/tiled/verify>] [-calibrate_path_weight <tolerance>] [-path_weight_table <file_path>]" << endl <<
+		"\t\t[-probability_mode <propagate/cutline/cutline_simple/cutline_recursive/reliability_polynomial/monte_carlo/exact>]" << endl <<
+		"\t\t[-monte_carlo_trials <num_trials>] [-exact_frontier_limit <num_nodes>] [-validate_estimators] [-simple_batch <csv_file_path>]" << endl <<
+		"\t\t[-tail_sampling <budget>] [-search_proxy_length <max_length>] [-profile_connections <num_listed>]" << endl <<
+		"\t\t[-profile_graph] [-capture_traces <num_traces> -trace_file <file_path>]" << endl <<
+		"\t./wotan -replay_traces <file_path>" << endl << endl;
 
 	cout << "Options:" << endl;
 
@@ -359,6 +642,118 @@ static void wotan_print_usage(){
 
 	cout << "\t-seed: specified the seed for the random number generator" << endl << endl;
 
+	cout << "\t-cache_dir: if specified, final analysis results (metrics and node demands) are cached in this directory, keyed on a hash" << endl;
+	cout << "\t            of the rr structs file and all analysis-relevant options. A later run with an identical graph and options" << endl;
+	cout << "\t            reuses the cached result instead of redoing the analysis (disabled by default)" << endl << endl;
+
+	cout << "\t-cache_size_limit: maximum size of the cache directory in MB. Least-recently used entries are evicted once" << endl;
+	cout << "\t                   this is exceeded (default is 256)" << endl << endl;
+
+	cout << "\t-cache_bypass: if specified, the cache is not consulted; the result of this run still replaces any cached entry" << endl << endl;
+
+	cout << "\t-window: if specified, only the tiles inside the window (inclusive tile coordinates) are analyzed, and only the part of" << endl;
+	cout << "\t         the routing graph within a halo of about 2*max_connection_length tiles around the window is loaded. Demands near" << endl;
+	cout << "\t         the window edge only account for connections from tiles inside the window (disabled by default)" << endl << endl;
+
+	cout << "\t-scratch_dir: if specified, Wotan runs in out-of-core mode: the largest arrays (per-thread node buckets, child demand" << endl;
+	cout << "\t              contributions, path count histories) are backed by files in this directory (preferably on a local SSD) so" << endl;
+	cout << "\t              that the OS can page them to disk. Test tiles are scheduled in spatial blocks to keep paging local, and" << endl;
+	cout << "\t              page fault and block I/O statistics are reported at the end of the run (disabled by default)" << endl << endl;
+
+	cout << "\t-weight_epoch: node weights seen by path enumeration are snapshotted from node demands once per analysis phase. If" << endl;
+	cout << "\t               specified, the snapshot is instead refreshed after every <num_conns> connections (over all threads)." << endl;
+	cout << "\t               All threads synchronize at each refresh, so results depend on the epoch size and thread count but" << endl;
+	cout << "\t               not on thread timing (default is 0 -- once per phase)" << endl << endl;
+
+	cout << "\t-demand_iterations: node weights depend on node demands, so the demand enumerated in a single pass is not self-consistent." << endl;
+	cout << "\t                    If greater than 1, path enumeration is repeated with weights frozen from the previous pass until no" << endl;
+	cout << "\t                    node weight changes, or until this many passes have been made. Each pass after the first only" << endl;
+	cout << "\t                    re-enumerates connections whose subgraph contains a node whose weight changed, replacing their" << endl;
+	cout << "\t                    previous demand contributions. Requires the traverse enumerate engine, the 'none' self-congestion" << endl;
+	cout << "\t                    mode and no -weight_epoch (default is 1 -- a single pass)" << endl << endl;
+
+	cout << "\t-sensitivity_map: if specified, an extra pass after probability analysis back-propagates the routability metric through" << endl;
+	cout << "\t                  each analyzed connection to get the derivative of the metric w.r.t. the demand of every routing node." << endl;
+	cout << "\t                  The resulting per-node and per-tile criticality map is written to the specified file and the most" << endl;
+	cout << "\t                  critical tiles are printed (disabled by default)" << endl << endl;
+
+	cout << "\t-calibrate_path_weight: if specified, the maximum path weight of each connection length is calibrated before analysis." << endl;
+	cout << "\t                        A sample of connections of each length is enumerated and analyzed under a range of bounds, and" << endl;
+	cout << "\t                        the smallest bound for which the mean error in connection probability and in enumerated demand" << endl;
+	cout << "\t                        (w.r.t. the largest bound) stays within the specified tolerance is used for the rest of the run." << endl;
+	cout << "\t                        Requires the 'none' self-congestion mode (disabled by default)" << endl << endl;
+
+	cout << "\t-path_weight_table: if calibrating, the chosen bounds are written to this file. Otherwise bounds are read from this" << endl;
+	cout << "\t                    file if it exists and was calibrated for the same architecture family (same logic block, channel" << endl;
+	cout << "\t                    widths, switches and wire spans; the size of the FPGA may differ)" << endl << endl;
+
+	cout << "\t-enumerate_engine: selects how paths are enumerated" << endl;
+	cout << "\t\ttraverse -- traverse the rr graph for every connection (default)" << endl;
+	cout << "\t\ttiled -- in a uniform fabric the demand contributed by a connection only depends on the neighbourhood of tiles it spans." << endl;
+	cout << "\t\t         The demand of a traversed connection is recorded relative to its source tile and replayed for later" << endl;
+	cout << "\t\t         connections of the same source/sink classes and offset whose neighbourhood is identical (same nodes, edges" << endl;
+	cout << "\t\t         and node weights). Requires the 'none' self-congestion mode and no -weight_epoch" << endl;
+	cout << "\t\tverify -- traverse every connection, but compare against the template wherever the tiled engine would have" << endl;
+	cout << "\t\t          replayed one, and report the largest difference" << endl << endl;
+
+	cout << "\t-probability_mode: selects how the probability of routing each connection is estimated from node demands" << endl;
+	cout << "\t\tpropagate -- propagate path probabilities from source to sink, assuming paths are independent (default)" << endl;
+	cout << "\t\tcutline, cutline_simple, cutline_recursive -- look at the probability of every node along a level of a" << endl;
+	cout << "\t\t          topological traversal being unavailable" << endl;
+	cout << "\t\treliability_polynomial -- evaluate the reliability polynomial of the subgraph (requires -use_routing_node_demand)" << endl;
+	cout << "\t\tmonte_carlo -- sample node availability (each node is blocked with probability equal to its demand) for many" << endl;
+	cout << "\t\t          trials at once, packed as bit lanes, and propagate reachability through the legal subgraph. Makes no" << endl;
+	cout << "\t\t          independence assumption; confidence intervals are reported with the results" << endl;
+	cout << "\t\texact -- compute the exact probability of reaching the sink by building a frontier-based decision diagram over" << endl;
+	cout << "\t\t          the legal subgraph. Connections whose frontier grows too wide are analyzed with 'propagate' instead" << endl << endl;
+
+	cout << "\t-monte_carlo_trials: number of trials sampled for each connection by the monte_carlo probability mode. Rounded up" << endl;
+	cout << "\t                     to a multiple of 64 (default is 256)" << endl << endl;
+
+	cout << "\t-exact_frontier_limit: connections whose frontier (nodes reached but not yet expanded) grows wider than this are not" << endl;
+	cout << "\t                       analyzed exactly by the exact probability mode (default is 40)" << endl << endl;
+
+	cout << "\t-validate_estimators: if specified, every connection analyzed during probability analysis is also estimated with the" << endl;
+	cout << "\t                      monte_carlo mode and with each of the analytic modes, and the error of each analytic mode is" << endl;
+	cout << "\t                      reported per connection length. The exact mode is included for connections to which it" << endl;
+	cout << "\t                      applies (disabled by default)" << endl << endl;
+
+	cout << "\t-search_proxy_length: a search for the demand multiplier (-search_for_reliability) first brackets the target with" << endl;
+	cout << "\t                      cheap proxy probes, which only analyze connections up to this length and estimate their" << endl;
+	cout << "\t                      probabilities with the cutline_simple mode. Full-fidelity probes then refine the multiplier." << endl;
+	cout << "\t                      0 disables proxy probes (default is 3)" << endl << endl;
+
+	cout << "\t-tail_sampling: evaluate only this fraction (in (0,1]) of the planned connections during probability analysis. A" << endl;
+	cout << "\t                uniform pilot sample locates the kinds of connections (by pin classes, tile offset, and closeness" << endl;
+	cout << "\t                to the FPGA edge) that end up among the worst connections, and the rest of the budget oversamples" << endl;
+	cout << "\t                them. The routability metric is then estimated from the weighted sample and reported with its" << endl;
+	cout << "\t                95% confidence interval (disabled by default)" << endl << endl;
+
+	cout << "\t-profile_connections: record the wall time, legal subgraph size and number of popped nodes of every connection analyzed" << endl;
+	cout << "\t                      during path enumeration and probability analysis. Percentiles of each are printed per analysis phase," << endl;
+	cout << "\t                      kind of source (driver/fanout) and connection length, followed by this many of the most expensive" << endl;
+	cout << "\t                      connections of the phase, identified by their source and sink nodes (disabled by default)" << endl << endl;
+
+	cout << "\t-profile_graph: instead of analyzing the architecture, print node and edge counts by node type, fan-in/fan-out" << endl;
+	cout << "\t                distributions, strongly connected components and channel widths of the routing graph, along with" << endl;
+	cout << "\t                the memory taken by each analysis thread. A sample of the planned connections of each length is" << endl;
+	cout << "\t                analyzed to predict the time path enumeration and probability analysis would take with the given" << endl;
+	cout << "\t                options and number of threads (disabled by default)" << endl << endl;
+
+	cout << "\t-capture_traces: after the analysis, capture the workloads of the path enumeration and probability propagation kernels" << endl;
+	cout << "\t                 for this many connections, spread evenly over the connections analyzed for probability, and write" << endl;
+	cout << "\t                 them to the file given by -trace_file. A trace holds the legal subgraph of its connection with the" << endl;
+	cout << "\t                 node values and distances the kernels read, and the results they produced (disabled by default)" << endl << endl;
+
+	cout << "\t-replay_traces: instead of analyzing an architecture, rerun the kernels on the traces in the specified file, check that" << endl;
+	cout << "\t                they reproduce the captured results bit for bit, and print how long they took. Only self-congestion" << endl;
+	cout << "\t                mode 'none' is supported" << endl << endl;
+
+	cout << "\t-simple_batch: analyze a batch of simple graphs (requires '-rr_structs_mode simple'). The rr structs file may then hold" << endl;
+	cout << "\t               any number of rr_node sections, one per graph, or be a directory of such files. Graphs are analyzed" << endl;
+	cout << "\t               independently on the worker threads and the connection probability of each is written to the" << endl;
+	cout << "\t               specified CSV file as soon as it is known (disabled by default)" << endl << endl;
+
 	cout << "\t-nodisp: if specified, graphics will be disabled (graphics are enabled by default)" << endl << endl;
 }
 
@@ -395,11 +790,169 @@ static void check_setup( User_Options *user_opts, Arch_Structs *arch_structs, Ro
 		}
 	}
 
+	/* check that the analysis window lies within the FPGA interior */
+	if (user_opts->use_window){
+		if (user_opts->rr_structs_mode != RR_STRUCTS_VPR){
+			WTHROW(EX_INIT, "The -window option can only be used with the VPR rr structs mode");
+		}
+		if (user_opts->window_xlow < 1 || user_opts->window_ylow < 1 ||
+		    user_opts->window_xhigh > grid_size_x-2 || user_opts->window_yhigh > grid_size_y-2){
+			WTHROW(EX_INIT, "Analysis window (" << user_opts->window_xlow << "," << user_opts->window_ylow << ")-(" << user_opts->window_xhigh <<
+					"," << user_opts->window_yhigh << ") must lie within the FPGA interior (1,1)-(" << grid_size_x-2 << "," << grid_size_y-2 << ")");
+		}
+	}
+
 	/* check that the number of threads to be used during analysis is greater than 0 */
 	if (user_opts->num_threads <= 0){
 		WTHROW(EX_INIT, "Number of threads to be used during path enumeration has to be greater than 0");
 	}
 
+	if (user_opts->weight_epoch_conns < 0){
+		WTHROW(EX_INIT, "Expected the -weight_epoch value to be >= 0. Got " << user_opts->weight_epoch_conns);
+	}
+
+	if (user_opts->path_weight_tolerance != UNDEFINED){
+		if (user_opts->path_weight_tolerance <= 0){
+			WTHROW(EX_INIT, "Expected the -calibrate_path_weight value to be > 0. Got " << user_opts->path_weight_tolerance);
+		}
+		if (user_opts->rr_structs_mode != RR_STRUCTS_VPR){
+			WTHROW(EX_INIT, "The -calibrate_path_weight option can only be used with the VPR rr structs mode");
+		}
+		/* calibration enumerates sample connections and then takes their demand back out */
+		if (user_opts->self_congestion_mode != MODE_NONE){
+			WTHROW(EX_INIT, "The -calibrate_path_weight option can only be used with the 'none' self-congestion mode");
+		}
+	}
+
+	if (!user_opts->simple_batch_results_file.empty() && user_opts->rr_structs_mode != RR_STRUCTS_SIMPLE){
+		WTHROW(EX_INIT, "The -simple_batch option can only be used with the simple rr structs mode");
+	}
+
+	if (user_opts->demand_iterations < 1){
+		WTHROW(EX_INIT, "Expected the -demand_iterations value to be >= 1. Got " << user_opts->demand_iterations);
+	}
+	if (user_opts->demand_iterations > 1){
+		if (user_opts->rr_structs_mode != RR_STRUCTS_VPR){
+			WTHROW(EX_INIT, "The -demand_iterations option can only be used with the VPR rr structs mode");
+		}
+		/* contributions of a connection can only be replaced if they consist of node demand alone */
+		if (user_opts->self_congestion_mode != MODE_NONE){
+			WTHROW(EX_INIT, "The -demand_iterations option can only be used with the 'none' self-congestion mode");
+		}
+		if (user_opts->enumerate_engine != ENGINE_TRAVERSE){
+			WTHROW(EX_INIT, "The -demand_iterations option can only be used with the traverse enumerate engine");
+		}
+		if (user_opts->weight_epoch_conns > 0){
+			WTHROW(EX_INIT, "The -demand_iterations option cannot be combined with -weight_epoch");
+		}
+		if (user_opts->target_reliability != UNDEFINED){
+			WTHROW(EX_INIT, "The -demand_iterations option cannot be combined with a search for the demand multiplier");
+		}
+	}
+
+	if (user_opts->enumerate_engine != ENGINE_TRAVERSE){
+		if (user_opts->rr_structs_mode != RR_STRUCTS_VPR){
+			WTHROW(EX_INIT, "The tiled enumerate engine can only be used with the VPR rr structs mode");
+		}
+		if (user_opts->self_congestion_mode != MODE_NONE){
+			WTHROW(EX_INIT, "The tiled enumerate engine can only be used with the 'none' self-congestion mode");
+		}
+		if (user_opts->weight_epoch_conns > 0){
+			WTHROW(EX_INIT, "The tiled enumerate engine cannot be combined with -weight_epoch");
+		}
+	}
+
+	if (user_opts->monte_carlo_trials <= 0){
+		WTHROW(EX_INIT, "Expected the -monte_carlo_trials value to be > 0. Got " << user_opts->monte_carlo_trials);
+	}
+	if (user_opts->exact_frontier_limit <= 0){
+		WTHROW(EX_INIT, "Expected the -exact_frontier_limit value to be > 0. Got " << user_opts->exact_frontier_limit);
+	}
+	/* trials are packed 64 to a word */
+	user_opts->monte_carlo_trials = ((user_opts->monte_carlo_trials + 63) / 64) * 64;
+
+	if (user_opts->probability_mode == RELIABILITY_POLYNOMIAL && user_opts->use_routing_node_demand == UNDEFINED){
+		WTHROW(EX_INIT, "The reliability_polynomial probability mode requires the -use_routing_node_demand option");
+	}
+	if (user_opts->probability_mode != PROPAGATE && user_opts->self_congestion_mode == MODE_PATH_DEPENDENCE){
+		WTHROW(EX_INIT, "The path_dependence self-congestion mode can only be used with the propagate probability mode");
+	}
+	if (user_opts->validate_estimators){
+		if (user_opts->rr_structs_mode != RR_STRUCTS_VPR){
+			WTHROW(EX_INIT, "The -validate_estimators option can only be used with the VPR rr structs mode");
+		}
+		if (user_opts->self_congestion_mode == MODE_PATH_DEPENDENCE){
+			WTHROW(EX_INIT, "The -validate_estimators option cannot be combined with the path_dependence self-congestion mode");
+		}
+	}
+
+	if (user_opts->profile_conns_listed != UNDEFINED){
+		if (user_opts->profile_conns_listed < 0){
+			WTHROW(EX_INIT, "Expected the -profile_connections value to be >= 0. Got " << user_opts->profile_conns_listed);
+		}
+		if (user_opts->rr_structs_mode != RR_STRUCTS_VPR){
+			WTHROW(EX_INIT, "The -profile_connections option can only be used with the VPR rr structs mode");
+		}
+	}
+
+	if (user_opts->profile_graph && user_opts->rr_structs_mode != RR_STRUCTS_VPR){
+		WTHROW(EX_INIT, "The -profile_graph option can only be used with the VPR rr structs mode");
+	}
+
+	if (user_opts->num_captured_traces != UNDEFINED){
+		if (user_opts->num_captured_traces < 1){
+			WTHROW(EX_INIT, "Expected the -capture_traces value to be >= 1. Got " << user_opts->num_captured_traces);
+		}
+		if (user_opts->trace_file.empty()){
+			WTHROW(EX_INIT, "The -capture_traces option requires a -trace_file");
+		}
+		if (user_opts->rr_structs_mode != RR_STRUCTS_VPR){
+			WTHROW(EX_INIT, "The -capture_traces option can only be used with the VPR rr structs mode");
+		}
+		if (user_opts->self_congestion_mode != MODE_NONE){
+			WTHROW(EX_INIT, "The -capture_traces option can only be used with self-congestion mode 'none'");
+		}
+		if (user_opts->profile_graph){
+			WTHROW(EX_INIT, "The -capture_traces option cannot be combined with -profile_graph");
+		}
+	} else if (!user_opts->trace_file.empty()){
+		WTHROW(EX_INIT, "The -trace_file option requires -capture_traces");
+	}
+
+	if (user_opts->search_proxy_length < 0){
+		WTHROW(EX_INIT, "Expected the -search_proxy_length value to be >= 0. Got " << user_opts->search_proxy_length);
+	}
+
+	if (user_opts->tail_sampling_budget != UNDEFINED){
+		if (user_opts->tail_sampling_budget <= 0 || user_opts->tail_sampling_budget > 1){
+			WTHROW(EX_INIT, "Expected the -tail_sampling value to be in (0,1]. Got " << user_opts->tail_sampling_budget);
+		}
+		if (user_opts->rr_structs_mode != RR_STRUCTS_VPR){
+			WTHROW(EX_INIT, "The -tail_sampling option can only be used with the VPR rr structs mode");
+		}
+		if (user_opts->probability_mode == MONTE_CARLO){
+			WTHROW(EX_INIT, "The -tail_sampling option cannot be combined with the monte_carlo probability mode");
+		}
+		if (user_opts->validate_estimators){
+			WTHROW(EX_INIT, "The -tail_sampling option cannot be combined with -validate_estimators");
+		}
+		if (!user_opts->sensitivity_map_file.empty()){
+			WTHROW(EX_INIT, "The -tail_sampling option cannot be combined with -sensitivity_map");
+		}
+	}
+
+	if (!user_opts->sensitivity_map_file.empty()){
+		if (user_opts->probability_mode != PROPAGATE){
+			WTHROW(EX_INIT, "The -sensitivity_map option can only be used with the propagate probability mode");
+		}
+		if (user_opts->rr_structs_mode != RR_STRUCTS_VPR){
+			WTHROW(EX_INIT, "The -sensitivity_map option can only be used with the VPR rr structs mode");
+		}
+		if (user_opts->target_reliability != UNDEFINED){
+			WTHROW(EX_INIT, "The -sensitivity_map option cannot be combined with a search for the demand multiplier");
+		}
+	}
+
 	/* if user wants a specific routing node demand (via -use_routing_node_demand) option, then path count histories should not be kept */
 	if (user_opts->use_routing_node_demand > 0){
 		if (user_opts->self_congestion_mode != MODE_NONE){
@@ -2,6 +2,7 @@
 #define WOTAN_INIT_H
 
 #include "wotan_types.h"
+#include "parse_rr_structs_file.h"
 
 
 /**** Function Declarations ****/
@@ -9,6 +10,10 @@
 void wotan_init(int argc, char **argv, User_Options *user_opts, Arch_Structs *arch_structs, Routing_Structs *routing_structs,
                 Analysis_Settings *analysis_settings);
 
+/* Parses the simple graph at the specified location and initializes its routing structures the same way as wotan_init does
+   for a single graph */
+void init_simple_graph(const Simple_Graph_Location &location, User_Options *user_opts, Routing_Structs *routing_structs);
+
 
 
 #endif /* WOTAN_INIT_H */
@@ -0,0 +1,232 @@
+/*
+	Scratch memory for Wotan's large per-node arrays.
+
+	The biggest allocations during analysis are the per-thread node buckets (one set of path-weight buckets per node per
+thread), and -- depending on the self-congestion mode -- per-node child demand contributions and path count histories.
+When these don't fit into RAM, an out-of-core mode can be enabled by specifying a scratch directory (ideally on a local
+SSD). The arrays are then placed in file-backed shared mappings of unlinked files in that directory, and the OS pages
+them to and from disk as needed instead of the process running out of memory.
+
+	Per-thread buckets are allocated as one contiguous region per thread (see Scratch_Region) which is released after each
+analysis pass. Per-node arrays that live until the end of the run are carved out of a bump-allocated arena.
+*/
+
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <algorithm>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include "wotan_scratch.h"
+#include "wotan_types.h"
+#include "exception.h"
+
+using namespace std;
+
+
+/**** Defines ****/
+/* size of each chunk of the persistent scratch arena */
+#define SCRATCH_ARENA_CHUNK_BYTES (64*1024*1024)
+
+/* alignment of allocations from the scratch arena */
+#define SCRATCH_ALIGNMENT 16
+
+
+/**** File-Scope Variables ****/
+/* directory in which scratch files are created. empty if out-of-core mode is disabled */
+static string f_scratch_dir = "";
+
+/* protects the arena and the statistics below */
+static pthread_mutex_t f_scratch_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* chunks of the persistent scratch arena, and the offset of the first free byte in the last chunk */
+static vector<Scratch_Region*> f_arena_chunks;
+static size_t f_arena_offset = 0;
+
+/* scratch memory statistics */
+static double f_bytes_mapped = 0;
+static double f_peak_bytes_mapped = 0;
+static double f_arena_bytes_used = 0;
+static int f_num_regions_created = 0;
+static struct rusage f_usage_at_init;
+
+
+/**** Function Declarations ****/
+/* updates the mapped memory statistics by the specified number of bytes */
+static void update_bytes_mapped(double delta_bytes);
+
+
+/**** Function Definitions ****/
+/*==== Scratch_Region Class ====*/
+Scratch_Region::Scratch_Region(size_t set_num_bytes){
+	this->base = NULL;
+	this->fd = UNDEFINED;
+
+	/* zero-sized mappings aren't allowed */
+	this->num_bytes = max(set_num_bytes, (size_t)1);
+
+	void *mapped = MAP_FAILED;
+	if (scratch_enabled()){
+		/* create a file in the scratch directory and unlink it right away -- the space is reclaimed as soon as the
+		   region is unmapped (or the process exits) */
+		string path_template = f_scratch_dir + "/wotan_scratch.XXXXXX";
+		vector<char> path( path_template.begin(), path_template.end() );
+		path.push_back('\0');
+
+		this->fd = mkstemp(&path[0]);
+		if (this->fd < 0){
+			WTHROW(EX_OTHER, "Could not create scratch file in " << f_scratch_dir << ": " << strerror(errno));
+		}
+		unlink(&path[0]);
+
+		/* the file is sparse: pages that are never written don't take up disk space */
+		if (ftruncate(this->fd, (off_t)this->num_bytes) != 0){
+			close(this->fd);
+			WTHROW(EX_OTHER, "Could not size scratch file to " << this->num_bytes << " bytes: " << strerror(errno));
+		}
+
+		mapped = mmap(NULL, this->num_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, this->fd, 0);
+	} else {
+		mapped = mmap(NULL, this->num_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	}
+
+	if (mapped == MAP_FAILED){
+		if (this->fd != UNDEFINED){
+			close(this->fd);
+		}
+		WTHROW(EX_OTHER, "Could not map " << this->num_bytes << " bytes of scratch memory: " << strerror(errno));
+	}
+	this->base = (char*)mapped;
+
+	update_bytes_mapped( (double)this->num_bytes );
+}
+
+Scratch_Region::~Scratch_Region(){
+	if (this->base != NULL){
+		munmap(this->base, this->num_bytes);
+		update_bytes_mapped( -(double)this->num_bytes );
+	}
+	if (this->fd != UNDEFINED){
+		close(this->fd);
+	}
+	this->base = NULL;
+	this->fd = UNDEFINED;
+}
+
+void *Scratch_Region::get_base() const{
+	return this->base;
+}
+
+size_t Scratch_Region::get_num_bytes() const{
+	return this->num_bytes;
+}
+
+/* returns true if the specified pointer points into this region */
+bool Scratch_Region::contains(const void *ptr) const{
+	const char *p = (const char*)ptr;
+	return (p >= this->base && p < this->base + this->num_bytes);
+}
+/*==== END Scratch_Region Class ====*/
+
+
+/* enables out-of-core mode if the specified scratch directory is not empty. must be called before any scratch memory is allocated */
+void init_scratch(string scratch_dir){
+	f_scratch_dir = scratch_dir;
+	while (f_scratch_dir.size() > 1 && f_scratch_dir[f_scratch_dir.size()-1] == '/'){
+		f_scratch_dir.erase(f_scratch_dir.size()-1);
+	}
+
+	getrusage(RUSAGE_SELF, &f_usage_at_init);
+
+	if (scratch_enabled()){
+		if (access(f_scratch_dir.c_str(), W_OK) != 0){
+			WTHROW(EX_INIT, "Scratch directory " << f_scratch_dir << " does not exist or is not writable");
+		}
+		cout << "Out-of-core mode: large arrays are backed by files in " << f_scratch_dir << endl;
+	}
+}
+
+/* returns true if out-of-core mode is enabled */
+bool scratch_enabled(){
+	return !f_scratch_dir.empty();
+}
+
+/* allocates the specified number of bytes from the (persistent) scratch arena. memory allocated this way is only released
+   when the program exits */
+void *scratch_alloc(size_t num_bytes){
+	/* round up to keep subsequent allocations aligned */
+	num_bytes = (num_bytes + SCRATCH_ALIGNMENT - 1) / SCRATCH_ALIGNMENT * SCRATCH_ALIGNMENT;
+
+	pthread_mutex_lock(&f_scratch_mutex);
+
+	if (f_arena_chunks.empty() || f_arena_offset + num_bytes > f_arena_chunks.back()->get_num_bytes()){
+		/* start a new chunk. the unused tail of the previous chunk is never touched and so doesn't take up space */
+		pthread_mutex_unlock(&f_scratch_mutex);
+		Scratch_Region *chunk = new Scratch_Region( max(num_bytes, (size_t)SCRATCH_ARENA_CHUNK_BYTES) );
+		pthread_mutex_lock(&f_scratch_mutex);
+
+		f_arena_chunks.push_back(chunk);
+		f_arena_offset = 0;
+	}
+
+	char *result = (char*)f_arena_chunks.back()->get_base() + f_arena_offset;
+	f_arena_offset += num_bytes;
+	f_arena_bytes_used += (double)num_bytes;
+
+	pthread_mutex_unlock(&f_scratch_mutex);
+
+	return result;
+}
+
+/* returns true if the specified pointer was allocated with scratch_alloc */
+bool is_scratch_memory(const void *ptr){
+	if (!scratch_enabled()){
+		return false;
+	}
+
+	bool result = false;
+	pthread_mutex_lock(&f_scratch_mutex);
+	for (int ichunk = 0; ichunk < (int)f_arena_chunks.size(); ichunk++){
+		if (f_arena_chunks[ichunk]->contains(ptr)){
+			result = true;
+			break;
+		}
+	}
+	pthread_mutex_unlock(&f_scratch_mutex);
+
+	return result;
+}
+
+/* prints the amount of scratch memory mapped along with page fault and block I/O statistics accumulated since init_scratch */
+void print_scratch_stats(){
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+
+	double mb = 1024.0 * 1024.0;
+
+	streamsize old_precision = cout.precision(4);
+	pthread_mutex_lock(&f_scratch_mutex);
+	cout << "Scratch memory: peak " << f_peak_bytes_mapped / mb << " MB mapped in " << f_num_regions_created << " regions; " <<
+	        "arena " << f_arena_bytes_used / mb << " MB in " << f_arena_chunks.size() << " chunks" << endl;
+	pthread_mutex_unlock(&f_scratch_mutex);
+
+	cout << "Page faults: " << usage.ru_minflt - f_usage_at_init.ru_minflt << " minor, " << usage.ru_majflt - f_usage_at_init.ru_majflt << " major" << endl;
+	cout << "Block I/O operations: " << usage.ru_inblock - f_usage_at_init.ru_inblock << " in, " << usage.ru_oublock - f_usage_at_init.ru_oublock << " out" << endl;
+	cout.precision(old_precision);
+}
+
+
+/* updates the mapped memory statistics by the specified number of bytes */
+static void update_bytes_mapped(double delta_bytes){
+	pthread_mutex_lock(&f_scratch_mutex);
+	f_bytes_mapped += delta_bytes;
+	f_peak_bytes_mapped = max(f_peak_bytes_mapped, f_bytes_mapped);
+	if (delta_bytes > 0){
+		f_num_regions_created++;
+	}
+	pthread_mutex_unlock(&f_scratch_mutex);
+}
@@ -0,0 +1,75 @@
+#ifndef WOTAN_SCRATCH_H
+#define WOTAN_SCRATCH_H
+
+#include <string>
+#include <cstddef>
+
+
+/**** Defines ****/
+/* in out-of-core mode, test tiles are scheduled in square blocks of this many tiles per side so that connections analyzed
+   close together in time touch rr nodes (and hence scratch pages) that are close together in memory */
+#define SCRATCH_TILE_BLOCK_SIZE 4
+
+
+/**** Classes ****/
+/* A contiguous block of scratch memory. In out-of-core mode the block is backed by an (unlinked) file in the scratch
+   directory so that the OS can page it out to disk instead of running out of RAM. Otherwise the block is anonymous memory.
+   The block is zero-filled and is unmapped when the object is destroyed */
+class Scratch_Region{
+private:
+	char *base;
+	size_t num_bytes;
+	int fd;					/* file descriptor of the backing file. UNDEFINED for anonymous memory */
+
+	/* regions own their memory and can't be copied */
+	Scratch_Region(const Scratch_Region&);
+	Scratch_Region& operator=(const Scratch_Region&);
+
+public:
+	Scratch_Region(size_t set_num_bytes);
+	~Scratch_Region();
+
+	void *get_base() const;
+	size_t get_num_bytes() const;
+
+	/* returns true if the specified pointer points into this region */
+	bool contains(const void *ptr) const;
+};
+
+
+/**** Function Declarations ****/
+/* enables out-of-core mode if the specified scratch directory is not empty. must be called before any scratch memory is allocated */
+void init_scratch(std::string scratch_dir);
+
+/* returns true if out-of-core mode is enabled */
+bool scratch_enabled();
+
+/* allocates the specified number of bytes from the (persistent) scratch arena. memory allocated this way is only released
+   when the program exits */
+void *scratch_alloc(size_t num_bytes);
+
+/* returns true if the specified pointer was allocated with scratch_alloc */
+bool is_scratch_memory(const void *ptr);
+
+/* prints the amount of scratch memory mapped along with page fault and block I/O statistics accumulated since init_scratch */
+void print_scratch_stats();
+
+
+/* allocates an array of 'num' elements. in out-of-core mode the array is carved out of the file-backed scratch arena,
+   otherwise it comes from the heap. only meant for plain data types (no constructors are run in out-of-core mode) */
+template <typename T> T *scratch_new_array(size_t num){
+	if (scratch_enabled()){
+		return static_cast<T*>( scratch_alloc(num * sizeof(T)) );
+	}
+	return new T[num];
+}
+
+/* frees an array allocated with scratch_new_array. scratch arena memory is released in bulk at exit, so this is a no-op for it */
+template <typename T> void scratch_delete_array(T *array){
+	if (array == NULL || is_scratch_memory(array)){
+		return;
+	}
+	delete [] array;
+}
+
+#endif
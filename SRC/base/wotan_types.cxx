@@ -1,12 +1,24 @@
 
 #include <cmath>
+#include <algorithm>
 #include "io.h"
 #include "exception.h"
 #include "wotan_types.h"
+#include "wotan_scratch.h"
 
 using namespace std;
 
 
+/* Node_Buckets::get_num_paths keeps the sink path prefix sums of windows of up to this many buckets on the stack */
+#define NODE_BUCKETS_LOCAL_WINDOW 256
+
+
+/* returns the number of paths held by a node bucket (empty buckets hold UNDEFINED) */
+static inline double paths_in_bucket(double bucket){
+	return (bucket == UNDEFINED ? 0.0 : bucket);
+}
+
+
 /* this has to exactly match e_rr_type */
 const string g_rr_type_string[NUM_RR_TYPES]{
 	"SOURCE",
@@ -25,26 +37,75 @@ const string g_rr_structs_mode_string[NUM_RR_STRUCTS_MODES]{
 	"RR_STRUCTS_SIMPLE"
 };
 
+/* this has to exactly match e_probability_mode */
+const string g_probability_mode_string[NUM_PROBABILITY_MODES]{
+	"propagate",
+	"cutline",
+	"cutline_simple",
+	"cutline_recursive",
+	"reliability_polynomial",
+	"monte_carlo",
+	"exact"
+};
+
 /*==== User Options Class ====*/
 User_Options::User_Options(){
 	this->nodisp = false;
 	this->rr_structs_mode = RR_STRUCTS_UNDEFINED;
 	this->num_threads = 1;
+	this->weight_epoch_conns = 0;
+	this->demand_iterations = 1;
 	this->max_connection_length = 3;
 	this->analyze_core = true;
 
 	this->use_routing_node_demand = UNDEFINED;
 
 	this->target_reliability = UNDEFINED;
+	this->search_proxy_length = 3;
 
 	this->self_congestion_mode = MODE_NONE;
 
+	this->enumerate_engine = ENGINE_TRAVERSE;
+
+	this->probability_mode = PROPAGATE;
+	this->monte_carlo_trials = 256;
+	this->exact_frontier_limit = 40;
+	this->validate_estimators = false;
+	this->tail_sampling_budget = UNDEFINED;
+	this->profile_conns_listed = UNDEFINED;
+	this->profile_graph = false;
+	this->num_captured_traces = UNDEFINED;
+	this->trace_file = "";
+	this->replay_traces_file = "";
+
 	/* pin pbobabilities can be initialized from a file in the future, but for now set them
 	   to some default values */
 	this->ipin_probability = 0.0;	//was 0.3
 	this->opin_probability = 0.6;
 	this->demand_multiplier = 1.0;
 
+	this->seed = 3;
+
+	this->use_window = false;
+	this->window_xlow = UNDEFINED;
+	this->window_ylow = UNDEFINED;
+	this->window_xhigh = UNDEFINED;
+	this->window_yhigh = UNDEFINED;
+
+	this->scratch_dir = "";
+
+	/* result caching is disabled unless a cache directory is specified */
+	this->cache_dir = "";
+	this->cache_size_limit = 256.0;
+	this->cache_bypass = false;
+
+	this->sensitivity_map_file = "";
+
+	this->path_weight_tolerance = UNDEFINED;
+	this->path_weight_table_file = "";
+
+	this->simple_batch_results_file = "";
+
 	/* length probabilities can be initialized from a file in the future, but for now set them
 	   to some default value */
 	this->length_probabilities.assign(20, 0);
@@ -136,7 +197,7 @@ void Analysis_Settings::alloc_and_set_length_probabilities(User_Options *user_op
 }
 
 /* allocates the test tile coords list and sets it based on the routing architecture */
-void Analysis_Settings::alloc_and_set_test_tile_coords(Arch_Structs *arch_structs, Routing_Structs *routing_structs){
+void Analysis_Settings::alloc_and_set_test_tile_coords(User_Options *user_opts, Arch_Structs *arch_structs, Routing_Structs *routing_structs){
 	this->test_tile_coords.clear();
 
 	/* TODO: Ideally what we want is to find the set of test tiles from which we can perform enumeration
@@ -147,21 +208,60 @@ void Analysis_Settings::alloc_and_set_test_tile_coords(Arch_Structs *arch_struct
 	//Coordinate coord(5,5);
 	//this->test_tile_coords.push_back(coord);
 
-	for (int ix = 1; ix < grid_size_x-1; ix++){
-		for (int iy = 1; iy < grid_size_y-1; iy++){
-			Coordinate coord(ix, iy);
-			this->test_tile_coords.push_back(coord);
+	/* the interior of the FPGA (i.e. excluding perimeter I/O), limited to the analysis window if one was specified */
+	int from_x = 1;
+	int to_x = grid_size_x-2;
+	int from_y = 1;
+	int to_y = grid_size_y-2;
+	if (user_opts->use_window){
+		from_x = max(from_x, user_opts->window_xlow);
+		to_x = min(to_x, user_opts->window_xhigh);
+		from_y = max(from_y, user_opts->window_ylow);
+		to_y = min(to_y, user_opts->window_yhigh);
+	}
+
+	/* in out-of-core mode tiles are visited in square blocks so that consecutively analyzed connections touch nearby rr nodes */
+	int block_size = 1;
+	if (!user_opts->scratch_dir.empty()){
+		block_size = SCRATCH_TILE_BLOCK_SIZE;
+	}
+
+	for (int block_x = from_x; block_x <= to_x; block_x += block_size){
+		for (int block_y = from_y; block_y <= to_y; block_y += block_size){
+			for (int ix = block_x; ix <= min(to_x, block_x + block_size - 1); ix++){
+				for (int iy = block_y; iy <= min(to_y, block_y + block_size - 1); iy++){
+					Coordinate coord(ix, iy);
+					this->test_tile_coords.push_back(coord);
+				}
+			}
 		}
 	}
 }
 
 /* returns maximum allowable path weight according to passed in connection length */
 int Analysis_Settings::get_max_path_weight(int conn_length){
+	/* a calibrated bound takes precedence */
+	if (conn_length < (int)this->max_path_weight_table.size() && this->max_path_weight_table[conn_length] != UNDEFINED){
+		return this->max_path_weight_table[conn_length];
+	}
+
 	/* this is a provisional scheme; will probably change later. but for now will set max
 	   path weight to give some flexibility in enumerating paths of the connection */
 	int max_path_weight = 15 + conn_length*1.3;	//XXX why does increasing max path weight lead to better results when 100% of connections are still being enumerated???
 	return max_path_weight;
 }
+
+/* returns the largest maximum path weight over lengths [0..max_conn_length]. lengths that never occur are left out */
+int Analysis_Settings::get_largest_max_path_weight(int max_conn_length){
+	int largest = 0;
+	for (int ilen = 0; ilen <= max_conn_length; ilen++){
+		if (ilen < (int)this->length_probabilities.size() && PROBS_EQUAL(this->length_probabilities[ilen], 0.0)){
+			continue;
+		}
+		largest = max(largest, this->get_max_path_weight(ilen));
+	}
+	return largest;
+}
 /*==== END Analysis_Settings Class ====*/
 
 
@@ -374,7 +474,6 @@ void RR_Node_Base::set_direction(e_direction dir){
 RR_Node::RR_Node(){
 	this->is_virtual_source = false;
 	this->num_in_edges = UNDEFINED;
-	this->weight = UNDEFINED;
 	this->in_edges = NULL;
 	this->in_switches = NULL;
 	this->clear_demand();
@@ -403,7 +502,6 @@ RR_Node::RR_Node(const RR_Node &obj) : RR_Node_Base(obj){
 
 	this->is_virtual_source = false;
 	this->num_in_edges = obj.get_num_in_edges();
-	this->weight = obj.get_weight();
 	this->demand = obj.get_demand(NULL);
 	this->num_lb_sources_and_sinks = obj.num_lb_sources_and_sinks;
 	this->virtual_source_node_ind = obj.get_virtual_source_node_ind();
@@ -449,13 +547,13 @@ void RR_Node::alloc_source_sink_path_history(int set_num_lb_sources_and_sinks){
 		}
 
 		/* allocate */
-		this->source_sink_path_history = new float** [history_radius+1];
+		this->source_sink_path_history = scratch_new_array<float**>(history_radius+1);
 		for (int iradius = 0; iradius <= history_radius; iradius++){
 			int circumference = max(1, 4*iradius);
-			this->source_sink_path_history[iradius] = new float* [circumference];
+			this->source_sink_path_history[iradius] = scratch_new_array<float*>(circumference);
 
 			for (int ic = 0; ic < circumference; ic++){
-				this->source_sink_path_history[iradius][ic] = new float [set_num_lb_sources_and_sinks];
+				this->source_sink_path_history[iradius][ic] = scratch_new_array<float>(set_num_lb_sources_and_sinks);
 
 				/* initialize elements to UNDEFINED */
 				for (int is = 0; is < set_num_lb_sources_and_sinks; is++){
@@ -484,11 +582,11 @@ void RR_Node::alloc_child_demand_contributions(int max_path_weight){
 		return;
 	}
 
-	this->child_demand_contributions = new float* [this->get_num_out_edges()];
+	this->child_demand_contributions = scratch_new_array<float*>(this->get_num_out_edges());
 
 	/* allocate "max_path_weight" buckets for each outgoing edge */
 	for (short iedge = 0; iedge < this->get_num_out_edges(); iedge++){
-		this->child_demand_contributions[iedge] = new float [max_path_weight+1];
+		this->child_demand_contributions[iedge] = scratch_new_array<float>(max_path_weight+1);
 		for (int ibucket = 0; ibucket < max_path_weight+1; ibucket++){
 			this->child_demand_contributions[iedge][ibucket] = 0.0;
 		}
@@ -501,10 +599,10 @@ void RR_Node::alloc_child_demand_contributions(int max_path_weight){
 void RR_Node::free_child_demand_contributions(){
 	if (this->num_child_demand_buckets != UNDEFINED){
 		for (short iedge = 0; iedge < this->get_num_out_edges(); iedge++){
-			delete [] this->child_demand_contributions[iedge];
+			scratch_delete_array(this->child_demand_contributions[iedge]);
 		}
 
-		delete [] this->child_demand_contributions;
+		scratch_delete_array(this->child_demand_contributions);
 		this->child_demand_contributions = NULL;
 
 		this->num_child_demand_buckets = UNDEFINED;
@@ -540,11 +638,11 @@ void RR_Node::free_allocated_members(){
 			int circumference = max(1, 4*iradius);
 
 			for (int ic = 0; ic < circumference; ic++){
-				delete this->source_sink_path_history[iradius][ic];
+				scratch_delete_array(this->source_sink_path_history[iradius][ic]);
 			}
-			delete [] this->source_sink_path_history[iradius];
+			scratch_delete_array(this->source_sink_path_history[iradius]);
 		}
-		delete [] this->source_sink_path_history;
+		scratch_delete_array(this->source_sink_path_history);
 		this->source_sink_path_history = NULL;
 
 		this->path_count_history_radius = UNDEFINED;
@@ -559,16 +657,15 @@ void RR_Node::clear_demand(){
 	this->demand = 0.0;
 }
 
-/* increment node demand by specified value */
-void RR_Node::increment_demand(double value, float demand_multiplier){
+/* increment node demand by specified value. the node's weight is not affected until node values are next frozen (see Node_Values) */
+void RR_Node::increment_demand(double value){
 	pthread_mutex_lock(&this->my_mutex);
 	this->demand += value;
-	this->set_weight(demand_multiplier);
 	pthread_mutex_unlock(&this->my_mutex);
 }
 
-/* sets weight of this node */
-void RR_Node::set_weight(float demand_multiplier){
+/* returns the weight of this node given its current demand */
+short RR_Node::compute_weight(float demand_multiplier) const{
 	/* weight of node is its wirelength usage */
 	//short x_low, y_low, x_high, y_high;
 	//x_low = this->get_xlow();
@@ -588,7 +685,7 @@ void RR_Node::set_weight(float demand_multiplier){
 		my_weight = ceil(my_weight);
 	}
 	
-	this->weight = my_weight;
+	return (short)my_weight;
 }
 
 /* sets the index of the virtual source node corresponding to this node. can be used for enumerating paths from non-source nodes */
@@ -633,14 +730,6 @@ short RR_Node::get_num_in_edges() const{
 	return this->num_in_edges;
 }
 
-/* returns weight of this node */
-float RR_Node::get_weight() const{
-	//pthread_mutex_lock(&this->my_mutex);
-	float _weight = this->weight;
-	//pthread_mutex_unlock(&this->my_mutex);
-	return _weight;
-}
-
 /* returns index of virtual source node corresponding to this node */
 int RR_Node::get_virtual_source_node_ind() const{
 	return this->virtual_source_node_ind;
@@ -1079,6 +1168,77 @@ int Arch_Structs::get_num_block_types() const{
 
 /*==== END Arch_Structs Class ====*/
 
+/*==== Node_Values Class ====*/
+/* the range of nodes whose values are frozen by one thread */
+class Freeze_Range_Info{
+public:
+	Node_Values *node_values;
+	t_rr_node *rr_node;
+	User_Options *user_opts;
+	int from_node;
+	int to_node;		/* exclusive */
+};
+
+/* freezes weights and effective demands of the nodes in the range specified by the Freeze_Range_Info passed in */
+static void *freeze_node_value_range(void *ptr){
+	Freeze_Range_Info *info = (Freeze_Range_Info*)ptr;
+	info->node_values->freeze_range(*info->rr_node, info->user_opts, info->from_node, info->to_node);
+	return NULL;
+}
+
+Node_Values::Node_Values(){
+	this->num_snapshots = 0;
+}
+
+/* recomputes weights and effective demands from the current state of the rr nodes, splitting the work over 'num_threads' threads */
+void Node_Values::freeze(t_rr_node &rr_node, User_Options *user_opts, int num_threads){
+	int num_nodes = (int)rr_node.size();
+	this->weight.resize(num_nodes);
+	this->demand.resize(num_nodes);
+
+	num_threads = max(1, min(num_threads, num_nodes));
+	int nodes_per_thread = (num_nodes + num_threads - 1) / num_threads;
+
+	vector<Freeze_Range_Info> ranges(num_threads);
+	vector<pthread_t> threads(num_threads);
+	for (int ithread = 0; ithread < num_threads; ithread++){
+		ranges[ithread].node_values = this;
+		ranges[ithread].rr_node = &rr_node;
+		ranges[ithread].user_opts = user_opts;
+		ranges[ithread].from_node = min(num_nodes, ithread * nodes_per_thread);
+		ranges[ithread].to_node = min(num_nodes, (ithread+1) * nodes_per_thread);
+	}
+
+	/* the calling thread does the first range itself */
+	for (int ithread = 1; ithread < num_threads; ithread++){
+		int result = pthread_create(&threads[ithread], NULL, freeze_node_value_range, (void*) &ranges[ithread]);
+		if (result != 0){
+			WTHROW(EX_OTHER, "Could not create thread to freeze node values. pthread_create returned " << result);
+		}
+	}
+	freeze_node_value_range( (void*) &ranges[0] );
+	for (int ithread = 1; ithread < num_threads; ithread++){
+		pthread_join(threads[ithread], NULL);
+	}
+
+	this->num_snapshots++;
+}
+
+/* recomputes weights and effective demands of nodes [from_node, to_node). the arrays must already be sized, and no other thread
+   may be reading the specified range while it is being frozen */
+void Node_Values::freeze_range(t_rr_node &rr_node, User_Options *user_opts, int from_node, int to_node){
+	float demand_multiplier = 1.0;
+	if (user_opts != NULL){
+		demand_multiplier = user_opts->demand_multiplier;
+	}
+
+	for (int inode = from_node; inode < to_node; inode++){
+		this->weight[inode] = rr_node[inode].compute_weight(demand_multiplier);
+		this->demand[inode] = (float)rr_node[inode].get_demand(user_opts);
+	}
+}
+/*==== END Node_Values Class ====*/
+
 /*==== Routing_Structs Class ====*/
 /* allocate and create the specified number of uninitialized rr nodes */
 void Routing_Structs::alloc_and_create_rr_node(int n_rr_nodes){
@@ -1110,13 +1270,9 @@ void Routing_Structs::alloc_and_create_rr_node_index(int num_rr_types, int x_siz
 	this->rr_node_index.assign(num_rr_types, x_vec);
 }
 
-/* initializes node weights */
-void Routing_Structs::init_rr_node_weights(){
-	int num_nodes = this->get_num_rr_nodes();
-	
-	for (int inode = 0; inode < num_nodes; inode++){
-		this->rr_node[inode].set_weight(1.0);
-	}
+/* initializes node weights (and effective demands) */
+void Routing_Structs::init_rr_node_weights(User_Options *user_opts){
+	this->node_values.freeze(this->rr_node, user_opts, 1);
 }
 
 /* returns number of rr nodes */
@@ -1325,11 +1481,14 @@ Node_Buckets::Node_Buckets(){
 	this->num_sink_buckets = UNDEFINED;
 	this->source_buckets = NULL;
 	this->sink_buckets = NULL;
+	this->external_storage = false;
 }
 
 Node_Buckets::~Node_Buckets(){
-	delete [] this->source_buckets;
-	delete [] this->sink_buckets;
+	if (!this->external_storage){
+		delete [] this->source_buckets;
+		delete [] this->sink_buckets;
+	}
 	this->source_buckets = NULL;
 	this->sink_buckets = NULL;
 	this->num_source_buckets = UNDEFINED;
@@ -1339,6 +1498,7 @@ Node_Buckets::~Node_Buckets(){
 Node_Buckets::Node_Buckets(int max_path_weight_bound){
 	this->num_source_buckets = UNDEFINED;
 	this->num_sink_buckets = UNDEFINED;
+	this->external_storage = false;
 
 	this->alloc_source_sink_buckets(max_path_weight_bound+1, max_path_weight_bound+1);	//[0..max_path_weight+bound]
 }
@@ -1360,19 +1520,38 @@ void Node_Buckets::alloc_source_sink_buckets(int set_num_source_buckets, int set
 
 	this->num_source_buckets = set_num_source_buckets;
 	this->num_sink_buckets = set_num_sink_buckets;
+	this->external_storage = false;
+}
+
+/* points the source/sink buckets into externally-owned storage of 2*set_num_buckets doubles */
+void Node_Buckets::assign_source_sink_buckets(double *storage, int set_num_buckets){
+	this->source_buckets = storage;
+	this->sink_buckets = storage + set_num_buckets;
+
+	for (int ibucket = 0; ibucket < set_num_buckets; ibucket++){
+		this->source_buckets[ibucket] = UNDEFINED;
+		this->sink_buckets[ibucket] = UNDEFINED;
+	}
+
+	this->num_source_buckets = set_num_buckets;
+	this->num_sink_buckets = set_num_buckets;
+	this->external_storage = true;
 }
 
 /* deallocate memory for bucket structures */
 void Node_Buckets::free_source_sink_buckets(){
 	//TODO: does this never get called?
-	delete [] this->source_buckets;
-	delete [] this->sink_buckets;
+	if (!this->external_storage){
+		delete [] this->source_buckets;
+		delete [] this->sink_buckets;
+	}
 	this->source_buckets = NULL;
 	this->sink_buckets = NULL;
 
 	this->num_source_buckets = 0;
 	this->num_sink_buckets = 0;
 	this->bucket_mode = BY_PATH_WEIGHT;
+	this->external_storage = false;
 }
 
 /* resets all bucket entries to 0 */
@@ -1422,15 +1601,68 @@ e_bucket_mode Node_Buckets::get_bucket_mode() const{
 /* returns number of legal paths which go through the node associated with this structure */
 float Node_Buckets::get_num_paths(int my_node_weight, int my_dist_to_source, int max_path_weight ) const{
 
+	/* both the source and the sink buckets of this node include its weight. a path of weight i from the source (source bucket i)
+	   therefore combines with any path of weight up to my_node_weight + max_path_weight - i to the sink. with P[j] the sum of
+	   sink buckets 0..j:
+		paths = sum over i = my_dist_to_source..max_path_weight of source_buckets[i] * P[my_node_weight + max_path_weight - i] */
+	int window_size = max_path_weight - my_dist_to_source + 1;
+	if (window_size <= 0){
+		return 0;
+	}
+	int first_j = my_node_weight;
+	int last_j = first_j + window_size - 1;
+
+	WCHECK(1, max_path_weight < this->num_source_buckets, EX_PATH_ENUM, "Out of bounds: " << " i: " << max_path_weight << " source_buckets: " << this->num_source_buckets);
+	WCHECK(1, last_j < this->num_sink_buckets, EX_PATH_ENUM, "Out of bounds: " << " j: " << last_j << " sink_buckets: " << this->num_sink_buckets);
+
+	/* P over the window, stored back to front so that entry t lines up with source bucket my_dist_to_source + t */
+	double local_prefix[NODE_BUCKETS_LOCAL_WINDOW];
+	vector<double> heap_prefix;
+	double *window_prefix = local_prefix;
+	if (window_size > NODE_BUCKETS_LOCAL_WINDOW){
+		heap_prefix.resize(window_size);
+		window_prefix = &heap_prefix[0];
+	}
+
+	double sink_paths = 0;
+	for (int j = 0; j < first_j; j++){
+		sink_paths += paths_in_bucket(this->sink_buckets[j]);
+	}
+	for (int k = 0; k < window_size; k++){
+		sink_paths += paths_in_bucket(this->sink_buckets[first_j + k]);
+		window_prefix[window_size-1 - k] = sink_paths;
+	}
+
+	/* dot product of the active source window with P. independent partial sums let the compiler overlap (and vectorize) the
+	   multiply-adds */
+	const double *window_source = this->source_buckets + my_dist_to_source;
+	double sum0 = 0, sum1 = 0, sum2 = 0, sum3 = 0;
+	int t = 0;
+	for ( ; t + 4 <= window_size; t += 4){
+		sum0 += paths_in_bucket(window_source[t]) * window_prefix[t];
+		sum1 += paths_in_bucket(window_source[t+1]) * window_prefix[t+1];
+		sum2 += paths_in_bucket(window_source[t+2]) * window_prefix[t+2];
+		sum3 += paths_in_bucket(window_source[t+3]) * window_prefix[t+3];
+	}
+	for ( ; t < window_size; t++){
+		sum0 += paths_in_bucket(window_source[t]) * window_prefix[t];
+	}
+	float paths_through_node = (float)((sum0 + sum1) + (sum2 + sum3));
+
+	WCHECK(2, fabs(paths_through_node - get_num_paths_sequential(my_node_weight, my_dist_to_source, max_path_weight)) <= 1e-4 * fabs(paths_through_node) + 1e-30,
+	       EX_PATH_ENUM, "Path count mismatch: " << paths_through_node << " vs " << get_num_paths_sequential(my_node_weight, my_dist_to_source, max_path_weight));
+
+	return paths_through_node;
+}
+
+/* computes the same as get_num_paths with one running sum, bucket by bucket. kept to check get_num_paths against */
+float Node_Buckets::get_num_paths_sequential(int my_node_weight, int my_dist_to_source, int max_path_weight ) const{
+
 	float paths_through_node = 0;
 
 	float incremental_sink_paths = 0;
 	int next_j = my_node_weight + 1;
 
-	if (next_j >= this->num_sink_buckets){
-		WTHROW(EX_PATH_ENUM, "Out of bounds: " << " next_j: " << next_j << " sink_buckets: " << this->num_sink_buckets);
-	}
-
 	for (int j = 0; j < next_j; j++){
 		if (this->sink_buckets[j] != UNDEFINED){
 			incremental_sink_paths += this->sink_buckets[j];
@@ -1438,13 +1670,6 @@ float Node_Buckets::get_num_paths(int my_node_weight, int my_dist_to_source, int
 	}
 
 	for (int i = max_path_weight; i >= my_dist_to_source; i--){
-		if (next_j >= this->num_sink_buckets){
-			WTHROW(EX_PATH_ENUM, "Out of bounds: " << " next_j: " << next_j << " sink_buckets: " << this->num_sink_buckets);
-		}
-		if (i >= this->num_source_buckets){
-			WTHROW(EX_PATH_ENUM, "Out of bounds: " << " i: " << i << " source_buckets: " << this->num_source_buckets);
-		}
-
 		if (this->source_buckets[i] != UNDEFINED){
 			paths_through_node += this->source_buckets[i] * incremental_sink_paths;
 		}
@@ -1605,7 +1830,8 @@ bool Node_Topological_Info::get_was_visited() const{
 
 /* returns number of legal nodes that have edges into this node. if this value is
    not yet set, then it gets set as well */
-short Node_Topological_Info::set_and_or_get_num_legal_in_nodes(int my_node_index, t_rr_node &rr_node, t_ss_distances &ss_distances, int max_path_weight){
+short Node_Topological_Info::set_and_or_get_num_legal_in_nodes(int my_node_index, t_rr_node &rr_node, const Node_Values &node_values, t_ss_distances &ss_distances,
+                                                                int max_path_weight){
 
 	if (this->num_legal_in_nodes == UNDEFINED){
 		/* if not yet set, then calculate and set */
@@ -1615,7 +1841,7 @@ short Node_Topological_Info::set_and_or_get_num_legal_in_nodes(int my_node_index
 		edge_list = rr_node[my_node_index].in_edges;
 		num_edges = rr_node[my_node_index].get_num_in_edges();
 
-		this->num_legal_in_nodes = this->get_num_legal_nodes(edge_list, num_edges, rr_node, ss_distances, max_path_weight);
+		this->num_legal_in_nodes = this->get_num_legal_nodes(edge_list, num_edges, node_values, ss_distances, max_path_weight);
 	}
 
 	return this->num_legal_in_nodes;
@@ -1623,7 +1849,8 @@ short Node_Topological_Info::set_and_or_get_num_legal_in_nodes(int my_node_index
 
 /* returns number of legal nodes to which this node has edges. if this value is
    not yet set, then it gets set as well */
-short Node_Topological_Info::set_and_or_get_num_legal_out_nodes(int my_node_index, t_rr_node &rr_node, t_ss_distances &ss_distances, int max_path_weight){
+short Node_Topological_Info::set_and_or_get_num_legal_out_nodes(int my_node_index, t_rr_node &rr_node, const Node_Values &node_values, t_ss_distances &ss_distances,
+                                                                 int max_path_weight){
 
 	if (this->num_legal_out_nodes == UNDEFINED){
 		/* if not yet set, then calculate and set */
@@ -1633,20 +1860,20 @@ short Node_Topological_Info::set_and_or_get_num_legal_out_nodes(int my_node_inde
 		edge_list = rr_node[my_node_index].out_edges;
 		num_edges = rr_node[my_node_index].get_num_out_edges();
 
-		this->num_legal_out_nodes = this->get_num_legal_nodes(edge_list, num_edges, rr_node, ss_distances, max_path_weight);
+		this->num_legal_out_nodes = this->get_num_legal_nodes(edge_list, num_edges, node_values, ss_distances, max_path_weight);
 	}
 
 	return this->num_legal_out_nodes;
 }
 
 /* returns number of legal nodes on specified edge list */
-short Node_Topological_Info::get_num_legal_nodes(int *edge_list, int num_edges, t_rr_node &rr_node, t_ss_distances &ss_distances, int max_path_weight){
+short Node_Topological_Info::get_num_legal_nodes(int *edge_list, int num_edges, const Node_Values &node_values, t_ss_distances &ss_distances, int max_path_weight){
 	int num_legal_nodes = 0;
 
 	/* check how many nodes belonging to this edge list are legal */
 	for (int iedge = 0; iedge < num_edges; iedge++){
 		int node_ind = edge_list[iedge];
-		int node_weight = rr_node[node_ind].get_weight();
+		int node_weight = node_values.weight[node_ind];
 
 		//TODO: should check whether node can have legal path through *me* as opposed to a legal path through itself
 		if ( ss_distances[node_ind].is_legal(node_weight, max_path_weight) ){
@@ -107,6 +107,43 @@ enum e_self_congestion_mode{
 	MODE_PATH_DEPENDENCE
 };
 
+/* Engines for path enumeration:
+	ENGINE_TRAVERSE -- paths of every connection are enumerated by traversing the rr graph
+	ENGINE_TILED -- the demand contributed by a connection is recorded as a template relative to its source tile. A later
+	                connection with the same source/sink classes and offset, whose neighbourhood of tiles is identical
+	                (same nodes, edges and node weights), replays the translated template instead of being traversed
+	ENGINE_VERIFY -- every connection is traversed, but wherever the tiled engine would have replayed a template, the
+	                 template is compared against the traversal */
+enum e_enumerate_engine{
+	ENGINE_TRAVERSE = 0,
+	ENGINE_TILED,
+	ENGINE_VERIFY
+};
+
+/* specifies mode of probability analysis to do
+   PROPAGATE: probabilities are propagated from source to sink using bucket structures.
+   	Can estimate probabilities of reaching a node by looking at the probabilities of reaching
+	that node's parents (and so forth)
+   CUTLINE: probability of reaching sink is analyzed by looking at probabilities along different
+   	levels of a topological traversal through a graph (i.e. can't reach sink if an entire level
+	is unavailable for routing)
+   MONTE_CARLO: node availability is sampled (each node blocked with probability equal to its demand) for a
+   	number of trials at once, and reachability of the sink is propagated through the same legal subgraph.
+	Doesn't assume that paths are independent, so it also serves as ground truth for the other modes
+   EXACT: the exact probability of reaching the sink through the legal subgraph is computed by building a frontier-based
+   	decision diagram over the subgraph. Connections whose frontier grows too wide fall back to PROPAGATE */
+enum e_probability_mode{
+	PROPAGATE = 0,
+	CUTLINE,
+	CUTLINE_SIMPLE,
+	CUTLINE_RECURSIVE,
+	RELIABILITY_POLYNOMIAL,
+	MONTE_CARLO,
+	EXACT,
+	NUM_PROBABILITY_MODES
+};
+extern const std::string g_probability_mode_string[NUM_PROBABILITY_MODES];
+
 
 /**** Forward Declarations ****/
 class RR_Node;
@@ -115,6 +152,7 @@ class RR_Switch_Inf;
 class Grid_Tile;
 class Arch_Structs;
 class Routing_Structs;
+class Node_Values;
 class SS_Distances;
 class Node_Buckets;
 class Node_Topological_Info;
@@ -165,16 +203,56 @@ public:
 						   demand for all non-routing nodes will be considered to be 0 */
 
 	int num_threads;			/* number of threads to use for path enumeration & probability analysis */
+	int weight_epoch_conns;			/* during path enumeration, node weights are re-snapshotted after every this many connections
+						   (over all threads). 0 means weights are only snapshotted once per analysis phase */
+	int demand_iterations;			/* maximum number of path enumeration passes. passes after the first re-enumerate only the connections
+						   whose subgraph contains a node whose weight changed, until node weights reach a fixed point */
 
 	float target_reliability; 		/* if not UNDEFINED, Wotan will search for a demand multiplier that results in the specified value of reliability */
+	int search_proxy_length;		/* maximum connection length of the cheap proxy probes that start the above search (0 if there are none) */
 
 	e_self_congestion_mode self_congestion_mode;	/* method for dealing with self-congestion effects. see comment on enum */
 
+	e_enumerate_engine enumerate_engine;	/* how paths are enumerated. see comment on enum */
+
+	e_probability_mode probability_mode;	/* how the probability of routing a connection is estimated. see comment on enum */
+	int monte_carlo_trials;			/* number of trials sampled per connection in MONTE_CARLO mode (a multiple of 64) */
+	int exact_frontier_limit;		/* in EXACT mode, connections whose frontier grows wider than this many nodes fall back to PROPAGATE */
+	bool validate_estimators;		/* if set, every estimator is compared against a Monte Carlo estimate during probability analysis */
+	float tail_sampling_budget;		/* if not UNDEFINED, only this fraction of the planned connections is evaluated during probability analysis (see tail_sampling.h) */
+	int profile_conns_listed;		/* if not UNDEFINED, the cost of every analyzed connection is profiled, and this many of the most
+						   expensive connections of each analysis phase are listed (see conn_profile.h) */
+	bool profile_graph;			/* if set, the routing graph is profiled and the cost of analyzing it is predicted instead of running the analysis */
+	int num_captured_traces;		/* if not UNDEFINED, the kernel workloads of this many connections are captured after the analysis (see traversal_trace.h) */
+	std::string trace_file;			/* file to which captured traces are written */
+	std::string replay_traces_file;		/* if not empty, the kernels are replayed on the traces in this file instead of analyzing a routing graph */
+
 	double ipin_probability;
 	double opin_probability;
 	double demand_multiplier;
 	t_prob_list length_probabilities;
 
+	unsigned int seed;			/* seed for the random number generator */
+
+	bool use_window;			/* if set, only the tiles in the window below are analyzed, and only the part of the graph around the window is loaded */
+	int window_xlow;			/* window bounds (inclusive, in grid tile coordinates) */
+	int window_ylow;
+	int window_xhigh;
+	int window_yhigh;
+
+	std::string scratch_dir;		/* if not empty, large per-node arrays are backed by files in this directory (out-of-core mode) */
+
+	std::string cache_dir;			/* if not empty, final analysis results are cached in (and looked up from) this directory */
+	float cache_size_limit;			/* maximum size (in MB) of the result cache directory. least-recently used entries are evicted beyond this */
+	bool cache_bypass;			/* if set, the cache is not consulted but the result of this run is still written to it */
+
+	std::string sensitivity_map_file;	/* if not empty, the sensitivity of the routability metric to each node's demand is written to this file */
+
+	float path_weight_tolerance;		/* if not UNDEFINED, the maximum path weight of each connection length is calibrated to stay within this error */
+	std::string path_weight_table_file;	/* if not empty, per-length maximum path weights are read from (or, when calibrating, written to) this file */
+
+	std::string simple_batch_results_file;	/* if not empty, the rr structs file (or directory) holds a batch of simple graphs whose results are written to this CSV file */
+
 	User_Options();
 };
 
@@ -204,16 +282,22 @@ public:
 	   before being stored in this particular list (such that they add up to 1) */
 	t_prob_list length_probabilities;
 
+	/* [0..max_conn_length] maximum path weight of each connection length, if calibrated (see path_weight_table.h). lengths
+	   beyond the end of the table, or with an UNDEFINED entry, use the default bound */
+	std::vector<int> max_path_weight_table;
+
 
 	/* set methods */
 	void alloc_and_set_pin_probabilities(double driver_prob,		/* set probabilities of driver/receiver pins (belonging to fill block type) */
 	                                     double receiver_prob,
 	                                     Arch_Structs *arch_structs);
 	void alloc_and_set_length_probabilities(User_Options*);			/* set length probabilities (based on length probabilities from User_Options) */
-	void alloc_and_set_test_tile_coords(Arch_Structs*, Routing_Structs*);	/* allocates the test_tile_coords list and sets it based on routing architecture */
+	void alloc_and_set_test_tile_coords(User_Options*, Arch_Structs*,	/* allocates the test_tile_coords list and sets it based on routing architecture */
+	                                    Routing_Structs*);			/*   (and the analysis window, if one was specified) */
 
 	/* get methods */
 	int get_max_path_weight(int conn_length);				/* returns maximum allowable path weight according to passed in connection length */
+	int get_largest_max_path_weight(int max_conn_length);			/* returns the largest maximum path weight over occurring lengths [0..max_conn_length] */
 };
 
 
@@ -281,7 +365,6 @@ public:
 class RR_Node : public RR_Node_Base {
 private:
 	short num_in_edges;				/* number of edges linking into this node */
-	float weight;					/* weight of this node */
 	double demand;					/* fractional demand for this node. used for routability analysis */
 
 	
@@ -349,15 +432,14 @@ public:
 
 	/* set methods */
 	void clear_demand();
-	void increment_demand(double increment, float demand_multiplier);
+	void increment_demand(double increment);
 	void set_virtual_source_node_ind(int);
-	void set_weight(float demand_multiplier);
 	void set_is_virtual_source(bool is_virt);
 
 	/* get methods */
 	short get_num_in_edges() const;
 	double get_demand(User_Options*) const;
-	float get_weight() const;
+	short compute_weight(float demand_multiplier) const;	/* weight of this node given its current demand. see Node_Values */
 	int get_virtual_source_node_ind() const;
 	bool get_is_virtual_source() const;
 
@@ -515,6 +597,27 @@ public:
 };
 
 
+/* Node weights and effective node demands, frozen into contiguous arrays once per analysis phase (and whenever demands are
+   otherwise changed in bulk). Traversal and estimator code reads weights/demands from here rather than from the rr node objects,
+   so the routing node demand policy and the demand multiplier are applied once per node rather than on every read */
+class Node_Values{
+public:
+	std::vector<short> weight;			/* [0..num_rr_nodes-1]. weight of each node (see RR_Node::compute_weight) */
+	std::vector<float> demand;			/* [0..num_rr_nodes-1]. effective demand of each node (see RR_Node::get_demand) */
+
+	int num_snapshots;				/* number of times node values have been frozen so far */
+
+	Node_Values();
+
+	/* recomputes weights and effective demands from the current state of the rr nodes, splitting the work over 'num_threads' threads */
+	void freeze(t_rr_node &rr_node, User_Options *user_opts, int num_threads);
+
+	/* recomputes weights and effective demands of nodes [from_node, to_node). the arrays must already be sized, and no other thread
+	   may be reading the specified range while it is being frozen */
+	void freeze_range(t_rr_node &rr_node, User_Options *user_opts, int from_node, int to_node);
+};
+
+
 /* contains routing structures */
 class Routing_Structs{
 private:
@@ -524,6 +627,7 @@ public:
 	t_rr_node rr_node;				/* a 1-D array of rr nodes */
 	t_rr_switch_inf rr_switch_inf;			/* a 1-D array of rr switch types */
 	t_rr_node_index rr_node_index;			/* a matrix for lookups of rr nodes at some physical location */
+	Node_Values node_values;			/* frozen node weights and effective demands */
 
 	/* allocator functions. if we want to move from vectors to C-style arrays, can change this, and deallocate in destructor */
 	void alloc_and_create_rr_node(int);
@@ -533,7 +637,7 @@ public:
 
 	void alloc_and_create_rr_node_index(int num_rr_types, int x_size, int y_size);
 
-	void init_rr_node_weights();
+	void init_rr_node_weights(User_Options *user_opts);
 
 	/* get methods */
 	int get_num_rr_nodes() const;
@@ -627,6 +731,10 @@ private:
 	int num_source_buckets;
 	int num_sink_buckets;
 	e_bucket_mode bucket_mode;
+	bool external_storage;			/* true if the bucket arrays point into storage owned by someone else (and so shouldn't be freed here) */
+
+	/* computes the same as get_num_paths with one running sum, bucket by bucket. kept to check get_num_paths against */
+	float get_num_paths_sequential(int my_node_weight, int my_dist_to_source, int max_path_weight) const;
 
 public:
 
@@ -639,6 +747,8 @@ public:
 
 	/* allocator methods */
 	void alloc_source_sink_buckets(int set_num_source_buckets, int set_num_sink_buckets);
+	/* points the source/sink buckets into externally-owned storage of 2*set_num_buckets doubles */
+	void assign_source_sink_buckets(double *storage, int set_num_buckets);
 
 	/* free methods */
 	void free_source_sink_buckets();
@@ -682,7 +792,7 @@ private:
 protected:
 
 	/* returns number of legal nodes on specified edge list */
-	short get_num_legal_nodes(int *edge_list, int num_edges, t_rr_node &rr_node, t_ss_distances &ss_distances, int max_path_weight);
+	short get_num_legal_nodes(int *edge_list, int num_edges, const Node_Values &node_values, t_ss_distances &ss_distances, int max_path_weight);
 public:
 	pthread_mutex_t my_mutex;
 
@@ -733,10 +843,10 @@ public:
 
 	/* returns number of legal nodes that have edges into this node. if this value is
 	   not yet set, then it gets calculated and set as well */
-	short set_and_or_get_num_legal_in_nodes(int my_node_index, t_rr_node &rr_node, t_ss_distances &ss_distances, int max_path_weight);
+	short set_and_or_get_num_legal_in_nodes(int my_node_index, t_rr_node &rr_node, const Node_Values &node_values, t_ss_distances &ss_distances, int max_path_weight);
 	/* returns number of legal nodes to which this node has edges. if this value is
 	not yet set, then it gets calculated and set as well */
-	short set_and_or_get_num_legal_out_nodes(int my_node_index, t_rr_node &rr_node, t_ss_distances &ss_distances, int max_path_weight);
+	short set_and_or_get_num_legal_out_nodes(int my_node_index, t_rr_node &rr_node, const Node_Values &node_values, t_ss_distances &ss_distances, int max_path_weight);
 };
 
 #endif
@@ -1,5 +1,6 @@
 
 #include <cmath>
+#include <ctime>
 #include <utility>
 #include <functional>
 #include "wotan_util.h"
@@ -21,6 +22,13 @@ bool contains_substring(std::string str, std::string substr){
 	return result;
 }
 
+/* returns the time (in seconds) on a monotonic wall clock. only differences between returned values are meaningful */
+double get_wall_seconds(){
+	struct timespec time_spec;
+	clock_gettime(CLOCK_MONOTONIC, &time_spec);
+	return (double)time_spec.tv_sec + 1e-9 * (double)time_spec.tv_nsec;
+}
+
 /* ORs two independent probability numbers */
 template <typename T> T or_two_probs(T p1, T p2){
 	T result;
@@ -108,16 +116,20 @@ template <typename T> My_Bounded_Priority_Queue<T>::My_Bounded_Priority_Queue(in
 	this->set_max_weight(max_w);
 }
 
-/* sets maximum weight */
+/* sets maximum weight. the queue must be empty */
 template <typename T> void My_Bounded_Priority_Queue<T>::set_max_weight(int max_w){
-	if (max_weight == UNDEFINED){
-		this->max_weight = max_w;
-	
-		/* size the priority queue.
-		   priority queue will have weight 0..max_w */
-		this->my_pq.assign(max_w + 1, queue<T>());
-	} else {
-		WTHROW(EX_OTHER, "Not allowing re-sizing of bounded-height priority queue. May be implemented later.");
+	if (max_w < 0){
+		WTHROW(EX_OTHER, "Bounded-height priority queue can't have a negative maximum weight: " << max_w);
+	}
+	if (this->num_objects != 0){
+		WTHROW(EX_OTHER, "Can't change the maximum weight of a non-empty bounded-height priority queue");
+	}
+	this->max_weight = max_w;
+
+	/* priority queue will have weight 0..max_w. buckets are only ever added, never released */
+	if ((int)this->bucket_head.size() < max_w + 1){
+		this->bucket_head.resize(max_w + 1, UNDEFINED);
+		this->bucket_tail.resize(max_w + 1, UNDEFINED);
 	}
 }
 
@@ -127,7 +139,18 @@ template <typename T> void My_Bounded_Priority_Queue<T>::push(T object, int weig
 		WTHROW(EX_OTHER, "Object pushed into bounded-height priority queue has weight outside 0..max_weight. Object weight: " << weight << "  Max weight: " << this->max_weight);
 	}
 
-	this->my_pq[weight].push( object );
+	int entry_ind = (int)this->entry_object.size();
+	this->entry_object.push_back( object );
+	this->entry_next.push_back( UNDEFINED );
+
+	/* append to the back of the bucket */
+	if (this->bucket_head[weight] == UNDEFINED){
+		this->bucket_head[weight] = entry_ind;
+		this->touched_buckets.push_back( weight );
+	} else {
+		this->entry_next[ this->bucket_tail[weight] ] = entry_ind;
+	}
+	this->bucket_tail[weight] = entry_ind;
 	this->num_objects++;
 
 	/* update current lowest weight */
@@ -139,20 +162,20 @@ template <typename T> void My_Bounded_Priority_Queue<T>::push(T object, int weig
 /* pop lowest-weight object from queue */
 template <typename T> void My_Bounded_Priority_Queue<T>::pop(){
 	if (this->current_lowest_weight != UNDEFINED){
-		this->my_pq[this->current_lowest_weight].pop();
+		int weight = this->current_lowest_weight;
+		int next_ind = this->entry_next[ this->bucket_head[weight] ];
+		this->bucket_head[weight] = next_ind;
 		this->num_objects--;
 
-		int objects_at_current_lowest = (int)this->my_pq[this->current_lowest_weight].size();
+		if (next_ind == UNDEFINED){
+			this->bucket_tail[weight] = UNDEFINED;
 
-		if (objects_at_current_lowest == 0){
 			if (this->num_objects == 0){
 				this->current_lowest_weight = UNDEFINED;
 			} else {
 				/* must search for the next current lowest weight */
-				for (int iweight = this->current_lowest_weight; iweight <= this->max_weight; iweight++){
-					int num_objs = (int)this->my_pq[iweight].size();
-
-					if (num_objs > 0){
+				for (int iweight = weight+1; iweight <= this->max_weight; iweight++){
+					if (this->bucket_head[iweight] != UNDEFINED){
 						this->current_lowest_weight = iweight;
 						break;
 					}
@@ -169,7 +192,7 @@ template <typename T> const T& My_Bounded_Priority_Queue<T>::top() const{
 		WTHROW(EX_OTHER, "Called top on empty bounded-height priority queue");
 	}
 
-	const T &obj = this->my_pq[this->current_lowest_weight].front();
+	const T &obj = this->entry_object[ this->bucket_head[this->current_lowest_weight] ];
 
 	return obj;
 }
@@ -184,11 +207,19 @@ template <typename T> int My_Bounded_Priority_Queue<T>::size() const{
 	return this->num_objects;
 }
 
-/* clears entire priority queue */
+/* clears entire priority queue. the maximum weight and allocated storage are kept */
 template <typename T> void My_Bounded_Priority_Queue<T>::clear(){
-	this->max_weight = UNDEFINED;
-	this->current_lowest_weight = UNDEFINED;	
-	this->num_objects = UNDEFINED;
+	for (int ibucket = 0; ibucket < (int)this->touched_buckets.size(); ibucket++){
+		int weight = this->touched_buckets[ibucket];
+		this->bucket_head[weight] = UNDEFINED;
+		this->bucket_tail[weight] = UNDEFINED;
+	}
+	this->touched_buckets.clear();
+	this->entry_object.clear();
+	this->entry_next.clear();
+
+	this->current_lowest_weight = UNDEFINED;
+	this->num_objects = 0;
 }
 
 /* IMPORTANT: the bounded-height priority queue will only work for types explicitely specified in below templates */
@@ -40,10 +40,17 @@ std::ostream& operator<<(std::ostream &os, const Coordinate &coord);
    the maximum, as set in the constructor / the set_max_weight function.
    The weight of an object being pushed-in is given to the 'push' function alongside the object.
    Having a queue of a fixed weight allows push/top operation to have complexity of O(1) and the
-   pop operation to have a complexity of O(max_weight) */
+   pop operation to have a complexity of O(max_weight).
+   Each weight bucket is a FIFO linked list threaded through one flat entry array, so that the queue does no allocations
+   once it has grown to its working size. clear() only resets the buckets that were pushed into, which makes it cheap
+   to reuse one queue across many traversals */
 template <typename T> class My_Bounded_Priority_Queue{
 private:
-	std::vector< std::queue<T> > my_pq;	/* will implement fixed-size priority queue */
+	std::vector<T> entry_object;		/* objects in the order in which they were pushed */
+	std::vector<int> entry_next;		/* index of the next entry in the same bucket, or UNDEFINED */
+	std::vector<int> bucket_head;		/* [0..max_weight] index of the first entry in each bucket, or UNDEFINED */
+	std::vector<int> bucket_tail;		/* [0..max_weight] index of the last entry in each bucket, or UNDEFINED */
+	std::vector<int> touched_buckets;	/* buckets that have been pushed into since the last clear */
 	int max_weight;				/* the fixed size of the priority queue */
 	int current_lowest_weight;		/* lowest-weight at which an object exists*/
 	int num_objects;			/* number of objects in priority queue */
@@ -52,7 +59,7 @@ public:
 	My_Bounded_Priority_Queue();
 	My_Bounded_Priority_Queue(int max_w);
 
-	/* sets maximum weight */
+	/* sets maximum weight. the queue must be empty */
 	void set_max_weight(int max_w);
 
 	/* push, pop, top */
@@ -66,7 +73,7 @@ public:
 	/* # of entries in priority queue */
 	int size() const;
 
-	/* clears entire priority queue */
+	/* clears entire priority queue. the maximum weight and allocated storage are kept */
 	void clear();
 };
 
@@ -97,6 +104,9 @@ public:
 /* specifies whether the string contains the given substring */
 bool contains_substring(std::string str, std::string substr);
 
+/* returns the time (in seconds) on a monotonic wall clock. only differences between returned values are meaningful */
+double get_wall_seconds();
+
 /* ORs two independent probability numbers */
 template <typename T> T or_two_probs(T p1, T p2);
 
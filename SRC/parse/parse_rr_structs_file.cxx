@@ -4,6 +4,9 @@
 #include <cstring>
 #include <cstdlib>
 #include <cstdio>
+#include <algorithm>
+#include <dirent.h>
+#include <sys/stat.h>
 #include "exception.h"
 #include "io.h"
 #include "wotan_types.h"
@@ -26,33 +29,76 @@ enum e_file_section{
 };
 
 
+/**** Typedefs ****/
+/* maps the index of a node in the rr structs file to its index in the rr_node structure (UNDEFINED if the node isn't loaded) */
+typedef vector<int> t_node_map;
+
+
 /**** Function Declarations ****/
+/* does a quick pass over the rr node section of the specified file to determine which nodes overlap the parse region.
+   fills 'node_map' with the compact index of each such node and returns the number of nodes to be loaded */
+static int map_nodes_in_region(string rr_structs_file, const Parse_Region &parse_region, t_node_map &node_map);
 /* returns the file section which is just about to begin based on that section's 'header' line */
 static e_file_section get_line_section(string header_line);
 /* parses lines of the referenced file, expecting that they belong to the specified section.
    continues parsing until the .end directive is hit. 
    creates the structure(s) into which the section is parsed */
 static void make_struct_and_parse_section(e_file_section section, string header_line, fstream &file, 
-		Arch_Structs *arch_structs, Routing_Structs *routing_structs);
-/* parses rr node section of file into created rr_node structure */
-static void parse_rr_node_section(int num_rr_nodes, t_rr_node &rr_node, fstream &file);
+		Arch_Structs *arch_structs, Routing_Structs *routing_structs, const Parse_Region &parse_region, t_node_map *node_map);
+/* parses rr node section of file into created rr_node structure. if 'node_map' is not NULL, only mapped nodes are loaded */
+static void parse_rr_node_section(int num_rr_nodes, t_rr_node &rr_node, fstream &file, t_node_map *node_map);
 /* parses rr switch section of file into created rr_switch_inf structure */
 static void parse_rr_switch_inf_section(int num_rr_switches, t_rr_switch_inf &rr_switch_inf, fstream &file);
 /* parses block types section of file into created block_type structure */
 static void parse_block_type_section(int num_block_types, t_block_type &block_type, fstream &file);
 /* parses grid section of file into the created grid structure */
 static void parse_grid_section(int x_size, int y_size, t_grid &grid, fstream &file);
-/* parses rr node indices section of file into the created rr_node_index structure */
-static void parse_rr_node_index_section(int num_rr_types, int x_size, int y_size, t_rr_node_index &rr_node_index, fstream &file);
+/* parses rr node indices section of file into the created rr_node_index structure. if 'node_map' is not NULL, node indices
+   are translated through it and the index lists of tiles outside the parse region are left empty */
+static void parse_rr_node_index_section(int num_rr_types, int x_size, int y_size, t_rr_node_index &rr_node_index, fstream &file,
+		const Parse_Region &parse_region, t_node_map *node_map);
 /* checks whether an sscanf function read as many arguments as were expected and throws an exception if not. 'line' is the line that was scanned */
 static void check_expected_vs_read(int num_expected, int num_read, string line);
 
 /**** Function Definitions ****/
-/* Parses the specified rr structs file according the specified rr structs mode */
-void parse_rr_structs_file( std::string rr_structs_file, Arch_Structs *arch_structs, Routing_Structs *routing_structs, e_rr_structs_mode rr_structs_mode ){
+Parse_Region::Parse_Region(){
+	this->enabled = false;
+	this->xlow = UNDEFINED;
+	this->ylow = UNDEFINED;
+	this->xhigh = UNDEFINED;
+	this->yhigh = UNDEFINED;
+}
+
+/* returns true if the specified tile span overlaps this region (or if the region is not enabled) */
+bool Parse_Region::overlaps(int span_xlow, int span_ylow, int span_xhigh, int span_yhigh) const{
+	if (!this->enabled){
+		return true;
+	}
+
+	bool result = (span_xlow <= this->xhigh && span_xhigh >= this->xlow &&
+	               span_ylow <= this->yhigh && span_yhigh >= this->ylow);
+	return result;
+}
+
+
+/* Parses the specified rr structs file according the specified rr structs mode. If 'parse_region' is enabled, only
+   the part of the graph overlapping that region is materialized */
+void parse_rr_structs_file( std::string rr_structs_file, Arch_Structs *arch_structs, Routing_Structs *routing_structs, e_rr_structs_mode rr_structs_mode,
+                            const Parse_Region &parse_region ){
 
 	cout << "Parsing structs file (" << rr_structs_file << ") in mode " << g_rr_structs_mode_string[rr_structs_mode] << endl;
 
+	/* if only a region of the graph is to be loaded, figure out which nodes belong to it before the nodes are allocated */
+	t_node_map node_map;
+	t_node_map *node_map_ptr = NULL;
+	if (parse_region.enabled){
+		int num_region_nodes = map_nodes_in_region(rr_structs_file, parse_region, node_map);
+		node_map_ptr = &node_map;
+
+		cout << "Loading " << num_region_nodes << " of " << node_map.size() << " rr nodes (region x " << parse_region.xlow << ".." << parse_region.xhigh <<
+		        ", y " << parse_region.ylow << ".." << parse_region.yhigh << ")" << endl;
+	}
+
 	/* open the file for reading */
 	fstream file;
 	open_file(&file, rr_structs_file, ios::in);
@@ -72,8 +118,122 @@ void parse_rr_structs_file( std::string rr_structs_file, Arch_Structs *arch_stru
 			}
 		}
 
-		make_struct_and_parse_section(section, section_line, file, arch_structs, routing_structs);
+		make_struct_and_parse_section(section, section_line, file, arch_structs, routing_structs, parse_region, node_map_ptr);
+	}
+}
+
+/* Finds the graphs of a batch of simple graphs. 'rr_structs_path' is either a file holding one rr node section per graph or a
+   directory of such files (which are read in alphabetical order) */
+void find_simple_graphs( std::string rr_structs_path, std::vector<Simple_Graph_Location> *graphs ){
+	graphs->clear();
+
+	struct stat path_stat;
+	if (stat(rr_structs_path.c_str(), &path_stat) != 0){
+		WTHROW(EX_INIT, "Could not access rr structs path: " << rr_structs_path);
+	}
+
+	/* get the list of files to scan */
+	vector<string> files;
+	if (S_ISDIR(path_stat.st_mode)){
+		DIR *dir = opendir(rr_structs_path.c_str());
+		if (dir == NULL){
+			WTHROW(EX_INIT, "Could not open rr structs directory: " << rr_structs_path);
+		}
+		struct dirent *entry;
+		while ( (entry = readdir(dir)) != NULL ){
+			string file_path = rr_structs_path + "/" + entry->d_name;
+			struct stat file_stat;
+			if (entry->d_name[0] != '.' && stat(file_path.c_str(), &file_stat) == 0 && S_ISREG(file_stat.st_mode)){
+				files.push_back(file_path);
+			}
+		}
+		closedir(dir);
+		sort(files.begin(), files.end());
+	} else {
+		files.push_back(rr_structs_path);
+	}
+
+	/* each rr node section header marks the start of a graph */
+	for (int ifile = 0; ifile < (int)files.size(); ifile++){
+		fstream file;
+		open_file(&file, files[ifile], ios::in);
+
+		int section = 0;
+		string line;
+		streampos line_offset = file.tellg();
+		while ( getline(file, line) ){
+			if ( contains_substring(line, ".rr_node(") ){
+				Simple_Graph_Location location;
+				location.file = files[ifile];
+				location.offset = line_offset;
+				location.section = section;
+				graphs->push_back(location);
+				section++;
+			}
+			line_offset = file.tellg();
+		}
+	}
+}
+
+/* Parses the rr node section at the specified location into 'routing_structs' */
+void parse_simple_graph( const Simple_Graph_Location &location, Routing_Structs *routing_structs ){
+	fstream file;
+	open_file(&file, location.file, ios::in);
+	file.seekg(location.offset);
+
+	string header_line;
+	getline(file, header_line);
+	if (get_line_section(header_line) != NODE_SECTION){
+		WTHROW(EX_INIT, "Expected an rr node section at offset " << location.offset << " of " << location.file);
+	}
+
+	Parse_Region parse_region;
+	make_struct_and_parse_section(NODE_SECTION, header_line, file, NULL, routing_structs, parse_region, NULL);
+}
+
+/* does a quick pass over the rr node section of the specified file to determine which nodes overlap the parse region.
+   fills 'node_map' with the compact index of each such node and returns the number of nodes to be loaded */
+static int map_nodes_in_region(string rr_structs_file, const Parse_Region &parse_region, t_node_map &node_map){
+	fstream file;
+	open_file(&file, rr_structs_file, ios::in);
+
+	node_map.clear();
+	int num_kept = 0;
+
+	/* skip to the rr node section */
+	string line;
+	while ( getline(file, line) ){
+		if ( get_line_section(line) == NODE_SECTION ){
+			break;
+		}
+	}
+
+	/* only the node lines (not edge lines) are of interest here */
+	while ( getline(file, line) && line != ".end rr_node" ){
+		if ( !contains_substring(line, "rr_type(") ){
+			continue;
+		}
+
+		int node_num;
+		int xlow, ylow, xhigh, yhigh;
+		char rr_type_buf[20];
+		int num_read = sscanf(line.c_str(), " node_%d: rr_type(%[^()]) xlow(%d) xhigh(%d) ylow(%d) yhigh(%d)",
+		                      &node_num, rr_type_buf, &xlow, &xhigh, &ylow, &yhigh);
+		check_expected_vs_read(6, num_read, line);
+
+		if (node_num != (int)node_map.size()){
+			WTHROW(EX_INIT, "Expected the dumped rr nodes to be in ascending order by index");
+		}
+
+		if ( parse_region.overlaps(xlow, ylow, xhigh, yhigh) ){
+			node_map.push_back(num_kept);
+			num_kept++;
+		} else {
+			node_map.push_back(UNDEFINED);
+		}
 	}
+
+	return num_kept;
 }
 
 /* returns the file section which is just about to begin based on that section's 'header' line */
@@ -105,7 +265,7 @@ static e_file_section get_line_section(string header_line){
    continues parsing until the .end directive is hit. 
    creates the structure(s) into which the section is parsed */
 static void make_struct_and_parse_section(e_file_section section, string header_line, fstream &file, 
-		Arch_Structs *arch_structs, Routing_Structs *routing_structs){
+		Arch_Structs *arch_structs, Routing_Structs *routing_structs, const Parse_Region &parse_region, t_node_map *node_map){
 
 	/* check which section of the dumped VPR structs file the header line represents, create
 	   the corresponding data structure, and then parse that section */
@@ -115,9 +275,20 @@ static void make_struct_and_parse_section(e_file_section section, string header_
 		t_rr_node &rr_node = routing_structs->rr_node;
 		sscanf(header_line.c_str(), ".rr_node(%d)", (&num_rr_nodes));
 
-		routing_structs->alloc_and_create_rr_node(num_rr_nodes);
+		/* only nodes overlapping the parse region are allocated */
+		int num_loaded_nodes = num_rr_nodes;
+		if (node_map != NULL){
+			num_loaded_nodes = 0;
+			for (int inode = 0; inode < (int)node_map->size(); inode++){
+				if ((*node_map)[inode] != UNDEFINED){
+					num_loaded_nodes++;
+				}
+			}
+		}
 
-		parse_rr_node_section(num_rr_nodes, rr_node, file);
+		routing_structs->alloc_and_create_rr_node(num_loaded_nodes);
+
+		parse_rr_node_section(num_rr_nodes, rr_node, file, node_map);
 
 	} else if (section == SWITCH_SECTION) {
 		/* rr switch inf */
@@ -166,7 +337,7 @@ static void make_struct_and_parse_section(e_file_section section, string header_
 
 		routing_structs->alloc_and_create_rr_node_index(num_rr_types, x_size, y_size);
 
-		parse_rr_node_index_section(num_rr_types, x_size, y_size, rr_node_index, file);
+		parse_rr_node_index_section(num_rr_types, x_size, y_size, rr_node_index, file, parse_region, node_map);
 
 	} else if (section == IN_BETWEEN_SECTIONS) {
 		/* header line empty -- not in any section. can skip */
@@ -176,10 +347,12 @@ static void make_struct_and_parse_section(e_file_section section, string header_
 	}
 }
 
-/* parses rr node section of file into created rr_node structure */
-static void parse_rr_node_section(int num_rr_nodes, t_rr_node &rr_node, fstream &file){
+/* parses rr node section of file into created rr_node structure. if 'node_map' is not NULL, only mapped nodes are loaded */
+static void parse_rr_node_section(int num_rr_nodes, t_rr_node &rr_node, fstream &file, t_node_map *node_map){
 
 	int inode = 0;
+	vector<int> region_edges;
+	vector<int> region_switches;
 	string line;
 	getline(file, line);
 	while (line != ".end rr_node"){
@@ -223,6 +396,55 @@ static void parse_rr_node_section(int num_rr_nodes, t_rr_node &rr_node, fstream
 			WTHROW(EX_INIT, "Expected the dumped rr nodes to be in ascending order by index");
 		}
 
+		/* the next line tells us how many edges there are */
+		getline(file, line);
+		int num_edges;
+		sscanf(line.c_str(), "  .edges(%d)", &num_edges);
+
+		if (node_map != NULL){
+			/* only part of the graph is being loaded. skip nodes outside the parse region and drop edges leading out of it */
+			int region_ind = (*node_map)[inode];
+			region_edges.clear();
+			region_switches.clear();
+
+			getline(file, line);
+			while (line != "  .end edges"){
+				int edge_num, edge, sw;
+
+				num_expected = 3;
+				num_read = sscanf(line.c_str(), "   %d: edge(%d) switch(%d)", &edge_num, &edge, &sw);
+
+				check_expected_vs_read(num_expected, num_read, line);
+
+				if (region_ind != UNDEFINED && (*node_map)[edge] != UNDEFINED){
+					region_edges.push_back( (*node_map)[edge] );
+					region_switches.push_back( sw );
+				}
+				getline(file, line);
+			}
+
+			if (region_ind != UNDEFINED){
+				RR_Node &node = rr_node[region_ind];
+				node.set_rr_type(rr_type);
+				node.set_coordinates(xlow, ylow, xhigh, yhigh);
+				node.set_R(R);
+				node.set_C(C);
+				node.set_ptc_num(ptc_num);
+				node.set_fan_in(fan_in);
+				node.set_direction((e_direction)direction);
+
+				node.alloc_out_edges_and_switches( (short)region_edges.size() );
+				for (int iedge = 0; iedge < (int)region_edges.size(); iedge++){
+					node.out_edges[iedge] = region_edges[iedge];
+					node.out_switches[iedge] = region_switches[iedge];
+				}
+			}
+
+			inode++;
+			getline(file, line);
+			continue;
+		}
+
 		/* assign values to rr node */
 		rr_node[inode].set_rr_type(rr_type);
 		rr_node[inode].set_coordinates(xlow, ylow, xhigh, yhigh);
@@ -233,11 +455,6 @@ static void parse_rr_node_section(int num_rr_nodes, t_rr_node &rr_node, fstream
 
 		rr_node[inode].set_direction((e_direction)direction);
 
-		/* the next line tells us how many edges there are */
-		getline(file, line);
-		int num_edges;
-		sscanf(line.c_str(), "  .edges(%d)", &num_edges);
-
 		/* allocate the edge and switch arrays */
 		rr_node[inode].alloc_out_edges_and_switches(num_edges);
 
@@ -480,8 +697,10 @@ static void parse_grid_section(int x_size, int y_size, t_grid &grid, fstream &fi
 }
 
 
-/* parses rr node indices section of file into the created rr_node_index structure */
-static void parse_rr_node_index_section(int num_rr_types, int x_size, int y_size, t_rr_node_index &rr_node_index, fstream &file){
+/* parses rr node indices section of file into the created rr_node_index structure. if 'node_map' is not NULL, node indices
+   are translated through it and the index lists of tiles outside the parse region are left empty */
+static void parse_rr_node_index_section(int num_rr_types, int x_size, int y_size, t_rr_node_index &rr_node_index, fstream &file,
+		const Parse_Region &parse_region, t_node_map *node_map){
 
 	string line;
 	getline(file, line);	//first line of rr node index section
@@ -505,8 +724,11 @@ static void parse_rr_node_index_section(int num_rr_types, int x_size, int y_size
 
 		check_expected_vs_read(num_expected, num_read, line);
 
-		/* create the node vector */
-		rr_node_index[rr_type][x][y].assign(num_nodes, UNDEFINED);
+		/* create the node vector (tiles outside the parse region get no index entries) */
+		bool tile_in_region = parse_region.overlaps(x, y, x, y);
+		if (tile_in_region){
+			rr_node_index[rr_type][x][y].assign(num_nodes, UNDEFINED);
+		}
 		
 		/* read in the list of nodes at this rr_type/x/y location */
 		getline(file, line);
@@ -518,6 +740,14 @@ static void parse_rr_node_index_section(int num_rr_types, int x_size, int y_size
 
 			check_expected_vs_read(num_expected, num_read, line);
 
+			if (!tile_in_region){
+				getline(file, line);
+				continue;
+			}
+
+			if (node_map != NULL && node >= 0){
+				node = (*node_map)[node];
+			}
 			rr_node_index[rr_type][x][y][node_num] = node;
 
 			getline(file, line);
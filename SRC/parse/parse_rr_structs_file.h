@@ -2,10 +2,49 @@
 #define PARSE_RR_STRUCTS_FILE_H
 
 #include <string>
+#include <vector>
+#include <fstream>
+
+/**** Classes ****/
+/* A rectangular region of grid tiles (bounds are inclusive). If enabled, only rr nodes which overlap this region
+   are parsed from the rr structs file; the parsed nodes are renumbered compactly and edges to nodes outside
+   the region are dropped */
+class Parse_Region{
+public:
+	bool enabled;
+	int xlow;
+	int ylow;
+	int xhigh;
+	int yhigh;
+
+	Parse_Region();
+
+	/* returns true if the specified tile span overlaps this region (or if the region is not enabled) */
+	bool overlaps(int span_xlow, int span_ylow, int span_xhigh, int span_yhigh) const;
+};
+
+/* Locates one graph of a batch of simple (one-source/one-sink) graphs: the rr node section at the specified offset
+   of the specified file */
+class Simple_Graph_Location{
+public:
+	std::string file;
+	std::streampos offset;		/* offset of the section's '.rr_node(...)' header line */
+	int section;			/* index of the rr node section within the file */
+};
+
 
 /**** Function Declarations ****/
-/* Parses the specified rr structs file according the specified rr structs mode */
-void parse_rr_structs_file( std::string rr_structs_file, Arch_Structs *arch_structs, Routing_Structs *routing_structs, e_rr_structs_mode rr_structs_mode );
+/* Parses the specified rr structs file according the specified rr structs mode. If 'parse_region' is enabled, only
+   the part of the graph overlapping that region is materialized */
+void parse_rr_structs_file( std::string rr_structs_file, Arch_Structs *arch_structs, Routing_Structs *routing_structs, e_rr_structs_mode rr_structs_mode,
+                            const Parse_Region &parse_region );
+
+/* Finds the graphs of a batch of simple graphs. 'rr_structs_path' is either a file holding one rr node section per graph or a
+   directory of such files (which are read in alphabetical order) */
+void find_simple_graphs( std::string rr_structs_path, std::vector<Simple_Graph_Location> *graphs );
+
+/* Parses the rr node section at the specified location into 'routing_structs' */
+void parse_simple_graph( const Simple_Graph_Location &location, Routing_Structs *routing_structs );
 
 /* If Wotan is being initialized based on an rr structs file then backwards edges/switches need to be determined 
    for each node as a post-processing step. Do this for the pins specified by 'node_type'. if node_type == UNDEFINED,